@@ -22,6 +22,7 @@
 #include "led.h"
 #include "utils.h"
 #include "serial_port.h"
+#include "console.h"
 
 #define DEBUG
 
@@ -34,34 +35,32 @@
 #endif
 
 /**
- * @brief Checks serial port frames
+ * @brief Controls LEDs from terminal - :LED <number> <ON|OFF>
+ * @param argumentCount Number of arguments
+ * @param arguments Arguments
+ * @return Result of the command
  */
-static void checkForSerialPortFrames(void) {
-  const int FRAME_MAX_SIZE = 32;
-  char frameBuffer[FRAME_MAX_SIZE];   // buffer for receiving commands from PC
-  int commandLength;
-
-  // check for new frames from PC
-  // if it does not work play with the CR=CR+LF setting in the PC terminal
-  if (SerialPort_getFrame(frameBuffer, &commandLength, FRAME_MAX_SIZE) ==
-      SERIAL_PORT_GOT_FRAME) {
-    println("Got frame of length %d: %s", (int)commandLength, (char*)frameBuffer);
-
-    // control LED0 from terminal
-    if (!strcmp((char*)frameBuffer, ":LED 0 ON")) {
-      Led_changeState(LED_NUMBER0, LED_ON);
-    }
-    if (!strcmp((char*)frameBuffer, ":LED 0 OFF")) {
-      Led_changeState(LED_NUMBER0, LED_OFF);
-    }
-    if (!strcmp((char*)frameBuffer, ":LED 1 ON")) {
-      Led_changeState(LED_NUMBER1, LED_ON);
-    }
-    if (!strcmp((char*)frameBuffer, ":LED 1 OFF")) {
-      Led_changeState(LED_NUMBER1, LED_OFF);
-    }
+static ConsoleResultCode ledCommand(int argumentCount, char* arguments[]) {
+  int number;
+  if (argumentCount != 3 || !Console_parseInteger(arguments[1], &number) ||
+      number < LED_NUMBER0 || number > LED_NUMBER3) {
+    return CONSOLE_INVALID_ARGUMENTS;
+  }
+  if (!strcmp(arguments[2], "ON")) {
+    Led_changeState((LedNumber)number, LED_ON);
+  } else if (!strcmp(arguments[2], "OFF")) {
+    Led_changeState((LedNumber)number, LED_OFF);
+  } else {
+    return CONSOLE_INVALID_ARGUMENTS;
   }
+  return CONSOLE_OK;
 }
+/**
+ * @brief Commands received from PC (sorted by name)
+ */
+static const ConsoleCommand commands[] = {
+  {":LED", ledCommand, ":LED <number> <ON|OFF>"},
+};
 /**
  * @brief Callback for performing periodic tasks
  */
@@ -80,6 +79,7 @@ int main(void) {
 
   const int COMM_BAUD_RATE = 115200;
   SerialPort_initialize(COMM_BAUD_RATE);
+  Console_initialize(commands, CONSOLE_NUMBER_OF_COMMANDS(commands));
   println("Starting program"); // Print a string to terminal
 
   Led_addNewLed(LED_NUMBER0);
@@ -99,9 +99,8 @@ int main(void) {
 
   while (TRUE) {
     Timer_softwareTimersUpdate();
-    checkForSerialPortFrames();
-//    Timer_delayMicros(100*1000);
-//    Led_toggle(LED_NUMBER0);
+    Console_process();
+    Timer_sleepUntilEvent(); // wakes up on timer deadline or any other IRQ
   }
   return 0;
 }
@@ -22,6 +22,7 @@
 #include "led.h"
 #include "utils.h"
 #include "serial_port.h"
+#include "console.h"
 #include "hmc5883l.h"
 
 #define DEBUG
@@ -34,6 +35,33 @@
 #define println(str, args...) (void)0
 #endif
 
+/**
+ * @brief Controls LEDs from terminal - :LED <number> <ON|OFF>
+ * @param argumentCount Number of arguments
+ * @param arguments Arguments
+ * @return Result of the command
+ */
+static ConsoleResultCode ledCommand(int argumentCount, char* arguments[]) {
+  int number;
+  if (argumentCount != 3 || !Console_parseInteger(arguments[1], &number) ||
+      number < LED_NUMBER0 || number > LED_NUMBER3) {
+    return CONSOLE_INVALID_ARGUMENTS;
+  }
+  if (!strcmp(arguments[2], "ON")) {
+    Led_changeState((LedNumber)number, LED_ON);
+  } else if (!strcmp(arguments[2], "OFF")) {
+    Led_changeState((LedNumber)number, LED_OFF);
+  } else {
+    return CONSOLE_INVALID_ARGUMENTS;
+  }
+  return CONSOLE_OK;
+}
+/**
+ * @brief Commands received from PC (sorted by name)
+ */
+static const ConsoleCommand commands[] = {
+  {":LED", ledCommand, ":LED <number> <ON|OFF>"},
+};
 /**
  * @brief Callback for performing periodic tasks
  */
@@ -41,28 +69,8 @@ void softTimerCallback(void) {
 
   Led_toggle(LED_NUMBER2);
 
-  const int FRAME_MAX_SIZE = 10;
-  char frameBuffer[FRAME_MAX_SIZE];   // buffer for receiving commands from PC
-  int length;                         // length of command
-
-  // check for new frames from PC
-  if (SerialPort_getFrame(frameBuffer, &length, FRAME_MAX_SIZE) == SERIAL_PORT_GOT_FRAME) {
-    println("Got frame of length %d: %s", (int)length, (char*)frameBuffer);
-
-    // control LED0 from terminal
-    if (!strcmp((char*)frameBuffer, ":LED 0 ON")) {
-      Led_changeState(LED_NUMBER0, LED_ON);
-    }
-    if (!strcmp((char*)frameBuffer, ":LED 0 OFF")) {
-      Led_changeState(LED_NUMBER0, LED_OFF);
-    }
-    if (!strcmp((char*)frameBuffer, ":LED 1 ON")) {
-      Led_changeState(LED_NUMBER1, LED_ON);
-    }
-    if (!strcmp((char*)frameBuffer, ":LED 1 OFF")) {
-      Led_changeState(LED_NUMBER1, LED_OFF);
-    }
-  }
+  // execute commands received from PC (e.g. ":LED 0 ON")
+  Console_process();
 
   float direction = Hmc5883l_readAngle();
   println("%.2f", direction);
@@ -81,9 +89,11 @@ void softTimerCallback(void) {
   */
 int main(void) {
   CommonHal_initialize();
+  Timer_initialize();
   Timer_delayMillis(100);
   const int COMM_BAUD_RATE = 115200;
   SerialPort_initialize(COMM_BAUD_RATE);
+  Console_initialize(commands, CONSOLE_NUMBER_OF_COMMANDS(commands));
   println("Starting program"); // Print a string to terminal
   Led_addNewLed(LED_NUMBER0);
   Led_addNewLed(LED_NUMBER1);
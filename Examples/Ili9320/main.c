@@ -19,6 +19,7 @@
 #include "timers.h"
 #include "led.h"
 #include "serial_port.h"
+#include "console.h"
 #include "common_hal.h"
 #include "keys.h"
 #include "graphics.h"
@@ -27,6 +28,7 @@
 #include "font_10x20.h"
 #include "font_8x16.h"
 #include "tsc2046.h"
+#include "log.h"
 #include "fat.h"
 #include "utils.h"
 #include <stdio.h>
@@ -52,33 +54,40 @@
 static void tscEvent1(int x, int y);
 static void tscEvent2(int x, int y);
 
+/**
+ * @brief Controls LEDs from terminal - :LED <number> <ON|OFF>
+ * @param argumentCount Number of arguments
+ * @param arguments Arguments
+ * @return Result of the command
+ */
+static ConsoleResultCode ledCommand(int argumentCount, char* arguments[]) {
+  int number;
+  if (argumentCount != 3 || !Console_parseInteger(arguments[1], &number) ||
+      number < LED_NUMBER0 || number > LED_NUMBER3) {
+    return CONSOLE_INVALID_ARGUMENTS;
+  }
+  if (!strcmp(arguments[2], "ON")) {
+    Led_changeState((LedNumber)number, LED_ON);
+  } else if (!strcmp(arguments[2], "OFF")) {
+    Led_changeState((LedNumber)number, LED_OFF);
+  } else {
+    return CONSOLE_INVALID_ARGUMENTS;
+  }
+  return CONSOLE_OK;
+}
+/**
+ * @brief Commands received from PC (sorted by name)
+ */
+static const ConsoleCommand commands[] = {
+  {":LED", ledCommand, ":LED <number> <ON|OFF>"},
+};
 /**
  * @brief Callback for performing periodic tasks
  */
 void softTimerCallback(void) {
 
-  const int FRAME_MAX_SIZE = 10;
-  char frameBuffer[FRAME_MAX_SIZE];   // buffer for receiving commands from PC
-  int length;                         // length of command
-
-  // check for new frames from PC
-  if (SerialPort_getFrame(frameBuffer, &length, FRAME_MAX_SIZE) == SERIAL_PORT_GOT_FRAME) {
-    println("Got frame of length %d: %s", (int)length, (char*)frameBuffer);
-
-    // control LED0 from terminal
-    if (!strcmp((char*)frameBuffer, ":LED 0 ON")) {
-      Led_changeState(LED_NUMBER0, LED_ON);
-    }
-    if (!strcmp((char*)frameBuffer, ":LED 0 OFF")) {
-      Led_changeState(LED_NUMBER0, LED_OFF);
-    }
-    if (!strcmp((char*)frameBuffer, ":LED 1 ON")) {
-      Led_changeState(LED_NUMBER1, LED_ON);
-    }
-    if (!strcmp((char*)frameBuffer, ":LED 1 OFF")) {
-      Led_changeState(LED_NUMBER1, LED_OFF);
-    }
-  }
+  // execute commands received from PC (e.g. ":LED 0 ON")
+  Console_process();
 }
 
 /**
@@ -87,9 +96,12 @@ void softTimerCallback(void) {
 int main(void) {
 
   CommonHal_initialize();
+  Timer_initialize();
 
   const int COMM_BAUD_RATE = 115200;
   SerialPort_initialize(COMM_BAUD_RATE);
+  Console_initialize(commands, CONSOLE_NUMBER_OF_COMMANDS(commands));
+  Log_initialize(NULL); // driver logs are printed in the main loop
   println("Starting program"); // Print a string to terminal
 
   Led_addNewLed(LED_NUMBER0);
@@ -107,6 +119,8 @@ int main(void) {
   lcdDriver.setWindow = ILI9320_SetWindow;
   lcdDriver.drawPixel = ILI9320_DrawPixel;
   lcdDriver.drawNextPixel = ILI9320_DrawNextPixel;
+  lcdDriver.fillRect = ILI9320_FillNextPixels;
+  lcdDriver.writePixels = ILI9320_WriteNextPixels;
   lcdDriver.setGramAddress = ILI9320_SetCursor;
   lcdDriver.horizontalGramUpdate = ILI9320_SetHorizontalGramUpdateDirection;
   lcdDriver.verticalGramUpdate = ILI9320_SetVerticalGramUpdateDirection;
@@ -183,6 +197,7 @@ int main(void) {
 
   while (TRUE) {
     Timer_softwareTimersUpdate(); // run timers
+    Log_process(); // print deferred driver logs
     TSC2046_Update();
   }
 }
@@ -22,7 +22,10 @@
 #include "led.h"
 #include "utils.h"
 #include "serial_port.h"
+#include "console.h"
 #include "ir_codes.h"
+#include "scheduler.h"
+#include "irq_monitor.h"
 
 #define DEBUG
 
@@ -35,38 +38,137 @@
 #endif
 
 /**
- * @brief Checks serial port frames
+ * @brief Controls LEDs from terminal - :LED <number> <ON|OFF>
+ * @param argumentCount Number of arguments
+ * @param arguments Arguments
+ * @return Result of the command
  */
-static void checkForSerialPortFrames(void) {
-  const int FRAME_MAX_SIZE = 32;
-  char frameBuffer[FRAME_MAX_SIZE];   // buffer for receiving commands from PC
-  int commandLength;
+static ConsoleResultCode ledCommand(int argumentCount, char* arguments[]) {
+  int number;
+  if (argumentCount != 3 || !Console_parseInteger(arguments[1], &number) ||
+      number < LED_NUMBER0 || number > LED_NUMBER3) {
+    return CONSOLE_INVALID_ARGUMENTS;
+  }
+  if (!strcmp(arguments[2], "ON")) {
+    Led_changeState((LedNumber)number, LED_ON);
+  } else if (!strcmp(arguments[2], "OFF")) {
+    Led_changeState((LedNumber)number, LED_OFF);
+  } else {
+    return CONSOLE_INVALID_ARGUMENTS;
+  }
+  return CONSOLE_OK;
+}
+/**
+ * @brief Prints IRQ statistics - :IRQ [RESET|HISTOGRAM]
+ * @details Handlers are monitored with IRQ_MONITOR_ENABLE defined.
+ * @param argumentCount Number of arguments
+ * @param arguments Arguments
+ * @return Result of the command
+ */
+static ConsoleResultCode irqCommand(int argumentCount, char* arguments[]) {
+  if (argumentCount == 1) {
+    IrqMonitor_printStatistics();
+  } else if (argumentCount == 2 && !strcmp(arguments[1], "RESET")) {
+    IrqMonitor_resetStatistics();
+  } else if (argumentCount == 2 && !strcmp(arguments[1], "HISTOGRAM")) {
+    IrqMonitor_printHistograms();
+  } else {
+    return CONSOLE_INVALID_ARGUMENTS;
+  }
+  return CONSOLE_OK;
+}
+/**
+ * @brief Prints use of memory per linker section - :MEMORY
+ * @param argumentCount Number of arguments
+ * @param arguments Arguments
+ * @return Result of the command
+ */
+static ConsoleResultCode memoryCommand(int argumentCount, char* arguments[]) {
+  CommonHal_printMemoryMap();
+  return CONSOLE_OK;
+}
+/**
+ * @brief Prints run time of the tasks - :TASKS
+ * @param argumentCount Number of arguments
+ * @param arguments Arguments
+ * @return Result of the command
+ */
+static ConsoleResultCode tasksCommand(int argumentCount, char* arguments[]) {
+  Scheduler_printStatistics();
+  return CONSOLE_OK;
+}
+/**
+ * @brief Commands received from PC (sorted by name)
+ */
+static const ConsoleCommand commands[] = {
+  {":IRQ", irqCommand, ":IRQ [RESET|HISTOGRAM]"},
+  {":LED", ledCommand, ":LED <number> <ON|OFF>"},
+  {":MEMORY", memoryCommand, ":MEMORY"},
+  {":TASKS", tasksCommand, ":TASKS"},
+};
+/**
+ * @brief Event signals
+ */
+enum {
+  SIGNAL_BLINK,         ///< Blink timer expired
+  SIGNAL_COMMAND_LINE,  ///< Command line received from PC
+  SIGNAL_IR_FRAME,      ///< Remote frame received (parameter - address << 8 | command)
+};
 
-  // check for new frames from PC
-  // if it does not work play with the CR=CR+LF setting in the PC terminal
-  if (SerialPort_getFrame(frameBuffer, &commandLength, FRAME_MAX_SIZE) == SERIAL_PORT_GOT_FRAME) {
-    println("Got frame of length %d: %s", (int)commandLength, (char*)frameBuffer);
+static SchedulerEvent blinkEvents[2];   ///< Blink task queue
+static SchedulerEvent consoleEvents[4]; ///< Console task queue
+static SchedulerEvent remoteEvents[8];  ///< Remote control task queue
+static SchedulerTask blinkTask;         ///< Blinks a LED
+static SchedulerTask consoleTask;       ///< Executes commands from PC
+static SchedulerTask remoteTask;        ///< Handles remote control keys
+static SchedulerTimer blinkTimer;       ///< Wakes up blink task
 
-    // control LED0 from terminal
-    if (!strcmp((char*)frameBuffer, ":LED 0 ON")) {
-      Led_changeState(LED_NUMBER0, LED_ON);
-    }
-    if (!strcmp((char*)frameBuffer, ":LED 0 OFF")) {
-      Led_changeState(LED_NUMBER0, LED_OFF);
-    }
-    if (!strcmp((char*)frameBuffer, ":LED 1 ON")) {
-      Led_changeState(LED_NUMBER1, LED_ON);
-    }
-    if (!strcmp((char*)frameBuffer, ":LED 1 OFF")) {
-      Led_changeState(LED_NUMBER1, LED_OFF);
-    }
+/**
+ * @brief Blinks a LED
+ * @param task Task
+ * @param event Event
+ */
+static void blinkHandler(SchedulerTask* task, const SchedulerEvent* event) {
+  Led_toggle(LED_NUMBER2);
+}
+/**
+ * @brief Executes received command lines
+ * @param task Task
+ * @param event Event
+ */
+static void consoleHandler(SchedulerTask* task, const SchedulerEvent* event) {
+  while (Console_process() != CONSOLE_NO_COMMAND) {
   }
 }
 /**
- * @brief Callback for performing periodic tasks
+ * @brief Toggles LEDs with remote keys 0 to 3
+ * @param task Task
+ * @param event Event
  */
-void softTimerCallback(void) {
-  Led_toggle(LED_NUMBER2);
+static void remoteHandler(SchedulerTask* task, const SchedulerEvent* event) {
+  const int ADDRESS_SHIFT = 8;
+  const uint32_t COMMAND_MASK = 0xff;
+  int command = event->parameter & COMMAND_MASK;
+  println("Remote %u key %d", (unsigned int)(event->parameter >> ADDRESS_SHIFT), command);
+  if (command >= LED_NUMBER0 && command <= LED_NUMBER3) {
+    Led_toggle((LedNumber)command);
+  }
+}
+/**
+ * @brief Passes received frame to remote task (IRQ)
+ * @param address Remote address
+ * @param command Remote command
+ * @param toggleBit Toggle bit
+ */
+static void irFrameCallback(uint8_t address, uint8_t command, Boolean toggleBit) {
+  Scheduler_post(&remoteTask, SIGNAL_IR_FRAME, (uint32_t)address << 8 | command);
+}
+/**
+ * @brief Wakes up console task (IRQ)
+ * @param context Unused
+ */
+static void commandLineCallback(void* context) {
+  Scheduler_post(&consoleTask, SIGNAL_COMMAND_LINE, 0);
 }
 /**
   * @brief  Main program
@@ -74,9 +176,11 @@ void softTimerCallback(void) {
 int main(void) {
   CommonHal_initialize();
   Timer_initialize();
+  IrqMonitor_initialize();
 
   const int COMM_BAUD_RATE = 115200;
   SerialPort_initialize(COMM_BAUD_RATE);
+  Console_initialize(commands, CONSOLE_NUMBER_OF_COMMANDS(commands));
   println("Starting program"); // Print a string to terminal
 
   Led_addNewLed(LED_NUMBER0);
@@ -87,19 +191,24 @@ int main(void) {
   Led_changeState(LED_NUMBER1, LED_ON);
   Led_changeState(LED_NUMBER2, LED_ON);
   Led_changeState(LED_NUMBER3, LED_ON);
+
+  // every driver IRQ only posts an event - the work is done in the tasks
+  Scheduler_initialize();
+  Scheduler_addTask(&blinkTask, "blink", 0, blinkHandler, NULL,
+      blinkEvents, SCHEDULER_QUEUE_LENGTH(blinkEvents));
+  Scheduler_addTask(&consoleTask, "console", 1, consoleHandler, NULL,
+      consoleEvents, SCHEDULER_QUEUE_LENGTH(consoleEvents));
+  Scheduler_addTask(&remoteTask, "remote", 2, remoteHandler, NULL,
+      remoteEvents, SCHEDULER_QUEUE_LENGTH(remoteEvents));
+
   IrCodes_initialize();
+  IrCodes_setFrameCallback(irFrameCallback);
+  SerialPort_setReceiveCallback(SerialPort_getDebugConsole(), commandLineCallback, NULL);
 
-  // Add a soft timer with callback
-  const int SOFT_TIMER_PERIOD_MILLIS = 1000;
-  int timerId = Timer_addSoftwareTimer(SOFT_TIMER_PERIOD_MILLIS,
-      softTimerCallback);
-  Timer_startSoftwareTimer(timerId);
+  const int BLINK_PERIOD_MILLIS = 1000;
+  Scheduler_initializeTimer(&blinkTimer, &blinkTask, SIGNAL_BLINK);
+  Scheduler_startTimer(&blinkTimer, BLINK_PERIOD_MILLIS, BLINK_PERIOD_MILLIS);
 
-  while (TRUE) {
-    Timer_softwareTimersUpdate();
-    checkForSerialPortFrames();
-    Timer_delayMicros(100*1000);
-    Led_toggle(LED_NUMBER2);
-  }
+  Scheduler_run();
   return 0;
 }
@@ -19,10 +19,13 @@
 #include "timers.h"
 #include "led.h"
 #include "serial_port.h"
+#include "console.h"
 #include "common_hal.h"
 #include "keys.h"
 #include "fat.h"
 #include "sdcard.h"
+#include "log.h"
+#include "profiler.h"
 #include "utils.h"
 #include <stdio.h>
 #include <string.h>
@@ -37,33 +40,61 @@
 #define println(str, args...) (void)0
 #endif
 
+/**
+ * @brief Controls LEDs from terminal - :LED <number> <ON|OFF>
+ * @param argumentCount Number of arguments
+ * @param arguments Arguments
+ * @return Result of the command
+ */
+static ConsoleResultCode ledCommand(int argumentCount, char* arguments[]) {
+  int number;
+  if (argumentCount != 3 || !Console_parseInteger(arguments[1], &number) ||
+      number < LED_NUMBER0 || number > LED_NUMBER3) {
+    return CONSOLE_INVALID_ARGUMENTS;
+  }
+  if (!strcmp(arguments[2], "ON")) {
+    Led_changeState((LedNumber)number, LED_ON);
+  } else if (!strcmp(arguments[2], "OFF")) {
+    Led_changeState((LedNumber)number, LED_OFF);
+  } else {
+    return CONSOLE_INVALID_ARGUMENTS;
+  }
+  return CONSOLE_OK;
+}
+/**
+ * @brief Prints profiler zones - :PROFILE [RESET|TRACE]
+ * @details Zones are compiled in with PROFILER_ENABLE defined. The output of
+ * :PROFILE TRACE can be converted with profiler_trace.py.
+ * @param argumentCount Number of arguments
+ * @param arguments Arguments
+ * @return Result of the command
+ */
+static ConsoleResultCode profileCommand(int argumentCount, char* arguments[]) {
+  if (argumentCount == 1) {
+    Profiler_printStatistics();
+  } else if (argumentCount == 2 && !strcmp(arguments[1], "RESET")) {
+    Profiler_resetStatistics();
+  } else if (argumentCount == 2 && !strcmp(arguments[1], "TRACE")) {
+    Profiler_printTrace();
+  } else {
+    return CONSOLE_INVALID_ARGUMENTS;
+  }
+  return CONSOLE_OK;
+}
+/**
+ * @brief Commands received from PC (sorted by name)
+ */
+static const ConsoleCommand commands[] = {
+  {":LED", ledCommand, ":LED <number> <ON|OFF>"},
+  {":PROFILE", profileCommand, ":PROFILE [RESET|TRACE]"},
+};
 /**
  * @brief Callback for performing periodic tasks
  */
 void softTimerCallback(void) {
 
-  const int FRAME_MAX_SIZE = 10;
-  char frameBuffer[FRAME_MAX_SIZE];   // buffer for receiving commands from PC
-  int length;                         // length of command
-
-  // check for new frames from PC
-  if (SerialPort_getFrame(frameBuffer, &length, FRAME_MAX_SIZE) == SERIAL_PORT_GOT_FRAME) {
-    println("Got frame of length %d: %s", (int)length, (char*)frameBuffer);
-
-    // control LED0 from terminal
-    if (!strcmp((char*)frameBuffer, ":LED 0 ON")) {
-      Led_changeState(LED_NUMBER0, LED_ON);
-    }
-    if (!strcmp((char*)frameBuffer, ":LED 0 OFF")) {
-      Led_changeState(LED_NUMBER0, LED_OFF);
-    }
-    if (!strcmp((char*)frameBuffer, ":LED 1 ON")) {
-      Led_changeState(LED_NUMBER1, LED_ON);
-    }
-    if (!strcmp((char*)frameBuffer, ":LED 1 OFF")) {
-      Led_changeState(LED_NUMBER1, LED_OFF);
-    }
-  }
+  // execute commands received from PC (e.g. ":LED 0 ON")
+  Console_process();
 }
 
 /**
@@ -72,9 +103,13 @@ void softTimerCallback(void) {
 int main(void) {
 
   CommonHal_initialize();
+  Timer_initialize();
+  Profiler_initialize();
 
   const int COMM_BAUD_RATE = 115200;
   SerialPort_initialize(COMM_BAUD_RATE);
+  Console_initialize(commands, CONSOLE_NUMBER_OF_COMMANDS(commands));
+  Log_initialize(NULL); // driver logs are printed in the main loop
   println("Starting program"); // Print a string to terminal
 
   Led_addNewLed(LED_NUMBER0);
@@ -86,7 +121,10 @@ int main(void) {
   int timerId = Timer_addSoftwareTimer(SOFT_TIMER_PERIOD_MILLIS, softTimerCallback);
   Timer_startSoftwareTimer(timerId);
 
-  FAT_Init(SD_Initialize, SD_ReadSectors, SD_WriteSectors);
+  static BlockDevice sdCard;
+  SD_EnableCrc(TRUE);
+  SD_InitializeBlockDevice(&sdCard);
+  FAT_Init(&sdCard);
   int hello = FAT_OpenFile("HELLO   TXT");
   uint8_t data[100];
 
@@ -104,6 +142,25 @@ int main(void) {
   i += FAT_ReadFile(hamlet, data+i, 30);
   Utils_hexdumpWithCharacters(data, i);
 
+  Log_process(); // print driver logs before the measurement
+
+  // Measure SPI throughput of sector reads. Build with and without
+  // SPI_HAL_USE_HAL_TRANSFERS to compare the register and HAL paths. This only
+  // means something on the board - the difference is in the SPI peripheral
+  // accesses, which the host tests in Tests can't reproduce.
+  const int BENCHMARK_SECTORS = 64;
+  const int BYTES_IN_SECTOR = 512;
+  static uint8_t benchmarkBuffer[512];
+  unsigned int startTime = Timer_getTimeMillis();
+  for (int sector = 0; sector < BENCHMARK_SECTORS; sector++) {
+    BlockDevice_readBlocks(&sdCard, benchmarkBuffer, sector, 1);
+  }
+  unsigned int elapsedMillis = Timer_getTimeMillis() - startTime;
+  if (elapsedMillis > 0) {
+    println("Read %d bytes in %u ms: %u bytes/s", BENCHMARK_SECTORS * BYTES_IN_SECTOR,
+        elapsedMillis, (BENCHMARK_SECTORS * BYTES_IN_SECTOR * 1000u) / elapsedMillis);
+  }
+
   char message[] = "Hello world, from STM32 to FAT driver new one"; // length 37
 
 //  FAT_MoveWrPtr(hello, 500);
@@ -112,5 +169,6 @@ int main(void) {
 
   while (TRUE) {
     Timer_softwareTimersUpdate(); // run timers
+    Log_process(); // print deferred driver logs
   }
 }
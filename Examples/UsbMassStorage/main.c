@@ -0,0 +1,82 @@
+/**
+ * @file    main.c
+ * @brief   SD card exposed to the PC as a USB mass storage device
+ * @date    19.10.2026
+ * @author  Michal Ksiezopolski
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#include "timers.h"
+#include "led.h"
+#include "serial_port.h"
+#include "common_hal.h"
+#include "sdcard.h"
+#include "usb_mass_storage.h"
+#include "log.h"
+#include "utils.h"
+#include <stdio.h>
+
+#define DEBUG
+
+#ifdef DEBUG
+#define print(str, args...) printf(""str"%s",##args,"")
+#define println(str, args...) printf("MAIN--> "str"%s",##args,"\r\n")
+#else
+#define print(str, args...) (void)0
+#define println(str, args...) (void)0
+#endif
+
+static BlockDevice sdCard; ///< SD card exposed to the host
+
+/**
+ * @brief Callback for performing periodic tasks
+ */
+void softTimerCallback(void) {
+  Led_toggle(LED_NUMBER2);
+  println("Blocks read %u, written %u, errors %u",
+      (unsigned int)sdCard.statistics.blocksRead,
+      (unsigned int)sdCard.statistics.blocksWritten,
+      (unsigned int)sdCard.statistics.errors);
+}
+
+int main(void) {
+
+  CommonHal_initialize();
+  Timer_initialize();
+
+  const int COMM_BAUD_RATE = 115200;
+  SerialPort_initialize(COMM_BAUD_RATE);
+  Log_initialize(NULL); // driver logs are printed in the main loop
+  println("Starting program"); // Print a string to terminal
+
+  Led_addNewLed(LED_NUMBER0);
+  Led_addNewLed(LED_NUMBER2);
+
+  // Add a soft timer with callback
+  const int SOFT_TIMER_PERIOD_MILLIS = 1000;
+  int timerId = Timer_addSoftwareTimer(SOFT_TIMER_PERIOD_MILLIS, softTimerCallback);
+  Timer_startSoftwareTimer(timerId);
+
+  SD_EnableCrc(TRUE);
+  if (SD_InitializeBlockDevice(&sdCard) != BLOCK_DEVICE_OK) {
+    println("SD card initialization failed");
+    Led_changeState(LED_NUMBER0, LED_ON);
+  } else {
+    UsbMassStorage_initialize(&sdCard);
+  }
+
+  while (TRUE) {
+    Timer_softwareTimersUpdate(); // run timers
+    UsbMassStorage_process(); // answer the host
+    Log_process(); // print deferred driver logs
+  }
+}
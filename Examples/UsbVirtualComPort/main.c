@@ -1,6 +1,6 @@
 /**
  * @file    main.c
- * @brief   Blinky test
+ * @brief   Terminal over the USB virtual COM port
  * @date    07.10.2016
  * @author  Michal Ksiezopolski
  *
@@ -19,7 +19,8 @@
 #include <string.h>
 #include "common_hal.h"
 #include "timers.h"
-#include "comm.h"
+#include "serial_port.h"
+#include "console.h"
 #include "led.h"
 #include "utils.h"
 
@@ -33,59 +34,68 @@
 #define println(str, args...) (void)0
 #endif
 
+/**
+ * @brief Controls LEDs from terminal - :LED <number> <ON|OFF>
+ * @param argumentCount Number of arguments
+ * @param arguments Arguments
+ * @return Result of the command
+ */
+static ConsoleResultCode ledCommand(int argumentCount, char* arguments[]) {
+  int number;
+  if (argumentCount != 3 || !Console_parseInteger(arguments[1], &number) ||
+      number < LED_NUMBER0 || number > LED_NUMBER3) {
+    return CONSOLE_INVALID_ARGUMENTS;
+  }
+  if (!strcmp(arguments[2], "ON")) {
+    Led_changeState((LedNumber)number, LED_ON);
+  } else if (!strcmp(arguments[2], "OFF")) {
+    Led_changeState((LedNumber)number, LED_OFF);
+  } else {
+    return CONSOLE_INVALID_ARGUMENTS;
+  }
+  return CONSOLE_OK;
+}
+/**
+ * @brief Commands received from PC (sorted by name)
+ */
+static const ConsoleCommand commands[] = {
+  {":LED", ledCommand, ":LED <number> <ON|OFF>"},
+};
 /**
  * @brief Callback for performing periodic tasks
  */
 void softTimerCallback(void) {
 
-  LED_Toggle(_LED2);
+  Led_toggle(LED_NUMBER2);
   println("Hello world");
 
-  const int FRAME_MAX_SIZE = 10;
-  char frameBuffer[FRAME_MAX_SIZE];   // buffer for receiving commands from PC
-  int length;                         // length of command
-
-  // check for new frames from PC
-  if (COMM_GetFrame(frameBuffer, &length, FRAME_MAX_SIZE) == COMM_GOT_FRAME) {
-    println("Got frame of length %d: %s", (int)length, (char*)frameBuffer);
-
-    // control LED0 from terminal
-    if (!strcmp((char*)frameBuffer, ":LED 0 ON")) {
-      LED_ChangeState(_LED0, LED_ON);
-    }
-    if (!strcmp((char*)frameBuffer, ":LED 0 OFF")) {
-      LED_ChangeState(_LED0, LED_OFF);
-    }
-    if (!strcmp((char*)frameBuffer, ":LED 1 ON")) {
-      LED_ChangeState(_LED1, LED_ON);
-    }
-    if (!strcmp((char*)frameBuffer, ":LED 1 OFF")) {
-      LED_ChangeState(_LED1, LED_OFF);
-    }
-  }
+  // execute commands received from PC (e.g. ":LED 0 ON")
+  Console_process();
 }
 /**
   * @brief  Main program
   */
 int main(void) {
 
-  COMMON_HAL_Init();
+  CommonHal_initialize();
+  Timer_initialize();
 
   const int COMM_BAUD_RATE = 115200;
-  COMM_Initialize(COMM_BAUD_RATE);
+  SerialPort_initialize(COMM_BAUD_RATE); // baud rate has no effect on USB
+  Console_initialize(commands, CONSOLE_NUMBER_OF_COMMANDS(commands));
   println("Starting program"); // Print a string to terminal
 
-  LED_Add(_LED0);
-  LED_Add(_LED1);
-  LED_Add(_LED2);
+  Led_addNewLed(LED_NUMBER0);
+  Led_addNewLed(LED_NUMBER1);
+  Led_addNewLed(LED_NUMBER2);
 
   // Add a soft timer with callback
   const int SOFT_TIMER_PERIOD_MILLIS = 1000;
-  int timerId = TIMER_AddSoftTimer(SOFT_TIMER_PERIOD_MILLIS, softTimerCallback);
-  TIMER_StartSoftTimer(timerId);
+  int timerId = Timer_addSoftwareTimer(SOFT_TIMER_PERIOD_MILLIS, softTimerCallback);
+  Timer_startSoftwareTimer(timerId);
 
   while (TRUE) {
-    TIMER_SoftTimersUpdate();
+    Timer_softwareTimersUpdate();
   }
 
   return 0;
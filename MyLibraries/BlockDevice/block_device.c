@@ -0,0 +1,342 @@
+/**
+ * @file    block_device.c
+ * @brief   Block device abstraction layer for storage drivers.
+ * @date    19.10.2026
+ * @author  Michal Ksiezopolski
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#include "block_device.h"
+#include <stdlib.h>
+
+/**
+ * @addtogroup BLOCK_DEVICE
+ * @{
+ */
+
+#define DEFAULT_BLOCK_SIZE 512 ///< Block size used if driver doesn't report geometry
+
+static BlockDeviceResultCode checkRange(BlockDevice* device, uint32_t block,
+    uint32_t count);
+
+/**
+ * @brief Initializes a block device for a whole storage device.
+ * @details Calls the initialization function of the driver and reads
+ * the geometry of the device.
+ * @param device Block device structure
+ * @param operations Operations of the driver
+ * @param driverContext Driver specific data passed to the operations
+ * @retval BLOCK_DEVICE_OK Device initialized
+ * @retval BLOCK_DEVICE_ERROR Driver initialization failed
+ */
+BlockDeviceResultCode BlockDevice_initialize(BlockDevice* device,
+    const BlockDeviceOperations* operations, void* driverContext) {
+
+  device->operations = operations;
+  device->driverContext = driverContext;
+  device->blockOffset = 0;
+  device->blockCount = UINT32_MAX;
+  device->blockSize = DEFAULT_BLOCK_SIZE;
+  device->cacheBuffer = NULL;
+  device->isCacheValid = FALSE;
+  device->statistics = (BlockDeviceStatistics){0};
+
+  if (operations->initialize != NULL &&
+      operations->initialize(driverContext) != 0) {
+    return BLOCK_DEVICE_ERROR;
+  }
+
+  if (operations->getGeometry != NULL) {
+    BlockDeviceGeometry geometry;
+    if (operations->getGeometry(driverContext, &geometry) != 0) {
+      return BLOCK_DEVICE_ERROR;
+    }
+    device->blockCount = geometry.blockCount;
+    device->blockSize = geometry.blockSize;
+  }
+  return BLOCK_DEVICE_OK;
+}
+/**
+ * @brief Initializes a block device for a partition of another device.
+ * @details The partition uses the driver of the parent device. All
+ * block numbers passed to the partition are relative to its start.
+ * The partition has its own statistics and cache.
+ * @param partition Block device structure of the partition
+ * @param parent Device containing the partition
+ * @param startBlock First block of partition (relative to parent)
+ * @param blockCount Number of blocks in partition
+ * @retval BLOCK_DEVICE_OK Partition initialized
+ * @retval BLOCK_DEVICE_OUT_OF_RANGE Partition doesn't fit in parent device
+ */
+BlockDeviceResultCode BlockDevice_initializePartition(BlockDevice* partition,
+    BlockDevice* parent, uint32_t startBlock, uint32_t blockCount) {
+
+  if (checkRange(parent, startBlock, blockCount) != BLOCK_DEVICE_OK) {
+    return BLOCK_DEVICE_OUT_OF_RANGE;
+  }
+  partition->operations = parent->operations;
+  partition->driverContext = parent->driverContext;
+  partition->blockOffset = parent->blockOffset + startBlock;
+  partition->blockCount = blockCount;
+  partition->blockSize = parent->blockSize;
+  partition->cacheBuffer = NULL;
+  partition->isCacheValid = FALSE;
+  partition->statistics = (BlockDeviceStatistics){0};
+  return BLOCK_DEVICE_OK;
+}
+/**
+ * @brief Reads blocks from device.
+ * @param device Block device
+ * @param buffer Buffer for data
+ * @param block First block to read
+ * @param count Number of blocks to read
+ * @retval BLOCK_DEVICE_OK Read successful
+ * @retval BLOCK_DEVICE_OUT_OF_RANGE Read beyond end of device
+ * @retval BLOCK_DEVICE_ERROR Driver error
+ */
+BlockDeviceResultCode BlockDevice_readBlocks(BlockDevice* device, uint8_t* buffer,
+    uint32_t block, uint32_t count) {
+
+  if (checkRange(device, block, count) != BLOCK_DEVICE_OK) {
+    return BLOCK_DEVICE_OUT_OF_RANGE;
+  }
+  device->statistics.readRequests++;
+  if (device->operations->readBlocks(device->driverContext, buffer,
+      device->blockOffset + block, count) != 0) {
+    device->statistics.errors++;
+    return BLOCK_DEVICE_ERROR;
+  }
+  device->statistics.blocksRead += count;
+  return BLOCK_DEVICE_OK;
+}
+/**
+ * @brief Writes blocks to device.
+ * @details If the cached block is overwritten the cache is invalidated.
+ * @param device Block device
+ * @param buffer Data to write
+ * @param block First block to write
+ * @param count Number of blocks to write
+ * @retval BLOCK_DEVICE_OK Write successful
+ * @retval BLOCK_DEVICE_OUT_OF_RANGE Write beyond end of device
+ * @retval BLOCK_DEVICE_ERROR Driver error
+ */
+BlockDeviceResultCode BlockDevice_writeBlocks(BlockDevice* device, uint8_t* buffer,
+    uint32_t block, uint32_t count) {
+
+  if (checkRange(device, block, count) != BLOCK_DEVICE_OK) {
+    return BLOCK_DEVICE_OUT_OF_RANGE;
+  }
+  if (device->isCacheValid && device->cachedBlock >= block &&
+      device->cachedBlock - block < count && buffer != device->cacheBuffer) {
+    device->isCacheValid = FALSE;
+  }
+  device->statistics.writeRequests++;
+  if (device->operations->writeBlocks(device->driverContext, buffer,
+      device->blockOffset + block, count) != 0) {
+    device->statistics.errors++;
+    return BLOCK_DEVICE_ERROR;
+  }
+  device->statistics.blocksWritten += count;
+  return BLOCK_DEVICE_OK;
+}
+/**
+ * @brief Flushes any data buffered by the driver to the medium.
+ * @param device Block device
+ * @retval BLOCK_DEVICE_OK Sync successful or not needed by driver
+ * @retval BLOCK_DEVICE_ERROR Driver error
+ */
+BlockDeviceResultCode BlockDevice_sync(BlockDevice* device) {
+  if (device->operations->sync == NULL) {
+    return BLOCK_DEVICE_OK;
+  }
+  if (device->operations->sync(device->driverContext) != 0) {
+    device->statistics.errors++;
+    return BLOCK_DEVICE_ERROR;
+  }
+  return BLOCK_DEVICE_OK;
+}
+/**
+ * @brief Informs the driver that the blocks are no longer used.
+ * @param device Block device
+ * @param block First unused block
+ * @param count Number of unused blocks
+ * @retval BLOCK_DEVICE_OK Trim successful
+ * @retval BLOCK_DEVICE_NOT_SUPPORTED Driver doesn't support trim
+ * @retval BLOCK_DEVICE_OUT_OF_RANGE Trim beyond end of device
+ * @retval BLOCK_DEVICE_ERROR Driver error
+ */
+BlockDeviceResultCode BlockDevice_trim(BlockDevice* device, uint32_t block,
+    uint32_t count) {
+
+  if (device->operations->trim == NULL) {
+    return BLOCK_DEVICE_NOT_SUPPORTED;
+  }
+  if (checkRange(device, block, count) != BLOCK_DEVICE_OK) {
+    return BLOCK_DEVICE_OUT_OF_RANGE;
+  }
+  if (device->isCacheValid && device->cachedBlock >= block &&
+      device->cachedBlock - block < count) {
+    device->isCacheValid = FALSE;
+  }
+  if (device->operations->trim(device->driverContext,
+      device->blockOffset + block, count) != 0) {
+    device->statistics.errors++;
+    return BLOCK_DEVICE_ERROR;
+  }
+  return BLOCK_DEVICE_OK;
+}
+/**
+ * @brief Submits an asynchronous request.
+ * @details If the driver doesn't support asynchronous requests, the request
+ * is executed immediately and the callback is called before this function
+ * returns. Statistics are updated on submission.
+ * @param device Block device
+ * @param request Request to execute
+ * @retval BLOCK_DEVICE_OK Request submitted
+ * @retval BLOCK_DEVICE_OUT_OF_RANGE Request beyond end of device
+ * @retval BLOCK_DEVICE_ERROR Driver couldn't accept the request
+ */
+BlockDeviceResultCode BlockDevice_submit(BlockDevice* device,
+    BlockDeviceRequest* request) {
+
+  if (device->operations->submit == NULL) {
+    BlockDeviceResultCode result;
+    if (request->operation == BLOCK_DEVICE_READ) {
+      result = BlockDevice_readBlocks(device, request->buffer, request->block,
+          request->count);
+    } else {
+      result = BlockDevice_writeBlocks(device, request->buffer, request->block,
+          request->count);
+    }
+    if (request->completeCb != NULL) {
+      request->completeCb(request, result);
+    }
+    return BLOCK_DEVICE_OK;
+  }
+
+  if (checkRange(device, request->block, request->count) != BLOCK_DEVICE_OK) {
+    return BLOCK_DEVICE_OUT_OF_RANGE;
+  }
+  if (request->operation == BLOCK_DEVICE_READ) {
+    device->statistics.readRequests++;
+    device->statistics.blocksRead += request->count;
+  } else {
+    device->isCacheValid = FALSE;
+    device->statistics.writeRequests++;
+    device->statistics.blocksWritten += request->count;
+  }
+  if (device->operations->submit(device->driverContext, request,
+      device->blockOffset + request->block) != 0) {
+    device->statistics.errors++;
+    return BLOCK_DEVICE_ERROR;
+  }
+  return BLOCK_DEVICE_OK;
+}
+/**
+ * @brief Returns the geometry of the device.
+ * @param device Block device
+ * @param geometry Geometry of the device (function writes this)
+ */
+void BlockDevice_getGeometry(BlockDevice* device, BlockDeviceGeometry* geometry) {
+  geometry->blockSize = device->blockSize;
+  geometry->blockCount = device->blockCount;
+}
+/**
+ * @brief Attaches a single block cache to the device.
+ * @param device Block device
+ * @param cacheBuffer Buffer of at least one block length
+ */
+void BlockDevice_attachCache(BlockDevice* device, uint8_t* cacheBuffer) {
+  device->cacheBuffer = cacheBuffer;
+  device->isCacheValid = FALSE;
+}
+/**
+ * @brief Reads a block into the cache buffer.
+ * @details If the block is already in the cache, the driver isn't called.
+ * @param device Block device
+ * @param block Block to read
+ * @retval BLOCK_DEVICE_OK Block is in the cache buffer
+ * @retval BLOCK_DEVICE_NO_CACHE No cache attached to device
+ * @retval BLOCK_DEVICE_OUT_OF_RANGE Read beyond end of device
+ * @retval BLOCK_DEVICE_ERROR Driver error
+ */
+BlockDeviceResultCode BlockDevice_readCachedBlock(BlockDevice* device, uint32_t block) {
+  const uint32_t NUMBER_OF_BLOCKS_TO_READ = 1;
+
+  if (device->cacheBuffer == NULL) {
+    return BLOCK_DEVICE_NO_CACHE;
+  }
+  if (device->isCacheValid && device->cachedBlock == block) {
+    device->statistics.cacheHits++;
+    return BLOCK_DEVICE_OK;
+  }
+  device->isCacheValid = FALSE;
+  BlockDeviceResultCode result = BlockDevice_readBlocks(device, device->cacheBuffer,
+      block, NUMBER_OF_BLOCKS_TO_READ);
+  if (result != BLOCK_DEVICE_OK) {
+    return result;
+  }
+  device->cachedBlock = block;
+  device->isCacheValid = TRUE;
+  return BLOCK_DEVICE_OK;
+}
+/**
+ * @brief Writes the cache buffer to a block (write-through).
+ * @details After the write the cache holds the given block.
+ * @param device Block device
+ * @param block Block to write
+ * @retval BLOCK_DEVICE_OK Block written
+ * @retval BLOCK_DEVICE_NO_CACHE No cache attached to device
+ * @retval BLOCK_DEVICE_OUT_OF_RANGE Write beyond end of device
+ * @retval BLOCK_DEVICE_ERROR Driver error
+ */
+BlockDeviceResultCode BlockDevice_writeCachedBlock(BlockDevice* device, uint32_t block) {
+  const uint32_t NUMBER_OF_BLOCKS_TO_WRITE = 1;
+
+  if (device->cacheBuffer == NULL) {
+    return BLOCK_DEVICE_NO_CACHE;
+  }
+  BlockDeviceResultCode result = BlockDevice_writeBlocks(device, device->cacheBuffer,
+      block, NUMBER_OF_BLOCKS_TO_WRITE);
+  if (result != BLOCK_DEVICE_OK) {
+    device->isCacheValid = FALSE;
+    return result;
+  }
+  device->cachedBlock = block;
+  device->isCacheValid = TRUE;
+  return BLOCK_DEVICE_OK;
+}
+/**
+ * @brief Invalidates the cache of the device.
+ * @param device Block device
+ */
+void BlockDevice_invalidateCache(BlockDevice* device) {
+  device->isCacheValid = FALSE;
+}
+/**
+ * @brief Checks if the given blocks are within the device.
+ * @param device Block device
+ * @param block First block
+ * @param count Number of blocks
+ * @retval BLOCK_DEVICE_OK Blocks within device
+ * @retval BLOCK_DEVICE_OUT_OF_RANGE Blocks outside of device
+ */
+BlockDeviceResultCode checkRange(BlockDevice* device, uint32_t block,
+    uint32_t count) {
+  if (block >= device->blockCount || count > device->blockCount - block) {
+    return BLOCK_DEVICE_OUT_OF_RANGE;
+  }
+  return BLOCK_DEVICE_OK;
+}
+/**
+ * @}
+ */
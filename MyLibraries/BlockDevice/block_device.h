@@ -0,0 +1,134 @@
+/**
+ * @file    block_device.h
+ * @brief   Block device abstraction layer for storage drivers.
+ * @date    19.10.2026
+ * @author  Michal Ksiezopolski
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#ifndef BLOCK_DEVICE_H_
+#define BLOCK_DEVICE_H_
+
+#include "utils.h"
+
+/**
+ * @defgroup  BLOCK_DEVICE BLOCK_DEVICE
+ * @brief     Block device abstraction layer between file systems and storage drivers.
+ */
+
+/**
+ * @addtogroup BLOCK_DEVICE
+ * @{
+ */
+
+/**
+ * @brief Block device errors
+ */
+typedef enum {
+  BLOCK_DEVICE_OK = 0,          //!< BLOCK_DEVICE_OK
+  BLOCK_DEVICE_ERROR,           //!< BLOCK_DEVICE_ERROR Driver reported an error
+  BLOCK_DEVICE_OUT_OF_RANGE,    //!< BLOCK_DEVICE_OUT_OF_RANGE Access beyond end of device
+  BLOCK_DEVICE_NOT_SUPPORTED,   //!< BLOCK_DEVICE_NOT_SUPPORTED Operation not supported by driver
+  BLOCK_DEVICE_NO_CACHE,        //!< BLOCK_DEVICE_NO_CACHE No cache buffer attached
+} BlockDeviceResultCode;
+/**
+ * @brief Geometry of a block device
+ */
+typedef struct {
+  uint32_t blockSize;   ///< Size of one block in bytes
+  uint32_t blockCount;  ///< Number of blocks on the device
+} BlockDeviceGeometry;
+/**
+ * @brief Statistics gathered for every block device
+ */
+typedef struct {
+  uint32_t readRequests;  ///< Number of read requests passed to the driver
+  uint32_t writeRequests; ///< Number of write requests passed to the driver
+  uint32_t blocksRead;    ///< Number of blocks read from the driver
+  uint32_t blocksWritten; ///< Number of blocks written to the driver
+  uint32_t cacheHits;     ///< Number of reads served from the cache
+  uint32_t errors;        ///< Number of errors reported by the driver
+} BlockDeviceStatistics;
+/**
+ * @brief Type of asynchronous request
+ */
+typedef enum {
+  BLOCK_DEVICE_READ,  //!< BLOCK_DEVICE_READ
+  BLOCK_DEVICE_WRITE, //!< BLOCK_DEVICE_WRITE
+} BlockDeviceOperation;
+/**
+ * @brief Asynchronous block device request
+ * @details The request has to stay valid until completeCb is called.
+ */
+typedef struct BlockDeviceRequest {
+  BlockDeviceOperation operation; ///< Read or write
+  uint8_t* buffer;                ///< Data buffer
+  uint32_t block;                 ///< First block (relative to the device)
+  uint32_t count;                 ///< Number of blocks
+  void (*completeCb)(struct BlockDeviceRequest* request, int result); ///< Called when request is finished
+  void* userContext;              ///< Context for the caller
+} BlockDeviceRequest;
+/**
+ * @brief Operations implemented by a storage driver
+ * @details Block numbers passed to the driver are absolute. The sync, trim
+ * and submit operations are optional and may be NULL.
+ */
+typedef struct {
+  int (*initialize) (void* driverContext);
+  int (*readBlocks) (void* driverContext, uint8_t* buffer, uint32_t block, uint32_t count);
+  int (*writeBlocks)(void* driverContext, uint8_t* buffer, uint32_t block, uint32_t count);
+  int (*sync)       (void* driverContext);
+  int (*trim)       (void* driverContext, uint32_t block, uint32_t count);
+  int (*getGeometry)(void* driverContext, BlockDeviceGeometry* geometry);
+  int (*submit)     (void* driverContext, BlockDeviceRequest* request, uint32_t absoluteBlock);
+} BlockDeviceOperations;
+/**
+ * @brief Block device
+ * @details A block device is either a whole storage device or a partition
+ * of one - a window of blocks starting at blockOffset.
+ */
+typedef struct {
+  const BlockDeviceOperations* operations; ///< Driver operations
+  void* driverContext;                     ///< Driver specific data
+  uint32_t blockOffset;                    ///< First block of the device on the storage
+  uint32_t blockCount;                     ///< Number of blocks of the device
+  uint32_t blockSize;                      ///< Size of one block in bytes
+  BlockDeviceStatistics statistics;        ///< Statistics of the device
+  uint8_t* cacheBuffer;                    ///< Buffer of a single block cache (NULL if unused)
+  uint32_t cachedBlock;                    ///< Block currently held in the cache
+  Boolean isCacheValid;                    ///< Does the cache hold valid data
+} BlockDevice;
+
+BlockDeviceResultCode BlockDevice_initialize         (BlockDevice* device,
+    const BlockDeviceOperations* operations, void* driverContext);
+BlockDeviceResultCode BlockDevice_initializePartition(BlockDevice* partition,
+    BlockDevice* parent, uint32_t startBlock, uint32_t blockCount);
+BlockDeviceResultCode BlockDevice_readBlocks         (BlockDevice* device, uint8_t* buffer,
+    uint32_t block, uint32_t count);
+BlockDeviceResultCode BlockDevice_writeBlocks        (BlockDevice* device, uint8_t* buffer,
+    uint32_t block, uint32_t count);
+BlockDeviceResultCode BlockDevice_sync               (BlockDevice* device);
+BlockDeviceResultCode BlockDevice_trim               (BlockDevice* device, uint32_t block,
+    uint32_t count);
+BlockDeviceResultCode BlockDevice_submit             (BlockDevice* device,
+    BlockDeviceRequest* request);
+void                  BlockDevice_getGeometry        (BlockDevice* device,
+    BlockDeviceGeometry* geometry);
+void                  BlockDevice_attachCache        (BlockDevice* device, uint8_t* cacheBuffer);
+BlockDeviceResultCode BlockDevice_readCachedBlock    (BlockDevice* device, uint32_t block);
+BlockDeviceResultCode BlockDevice_writeCachedBlock   (BlockDevice* device, uint32_t block);
+void                  BlockDevice_invalidateCache    (BlockDevice* device);
+/**
+ * @}
+ */
+
+#endif /* BLOCK_DEVICE_H_ */
@@ -0,0 +1,102 @@
+/**
+ * @file    ram_disk.c
+ * @brief   Block device driver keeping data in RAM.
+ * @date    19.10.2026
+ * @author  Michal Ksiezopolski
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#include "ram_disk.h"
+#include <string.h>
+
+/**
+ * @addtogroup BLOCK_DEVICE
+ * @{
+ */
+
+static int readBlocks(void* driverContext, uint8_t* buffer, uint32_t block,
+    uint32_t count);
+static int writeBlocks(void* driverContext, uint8_t* buffer, uint32_t block,
+    uint32_t count);
+static int trim(void* driverContext, uint32_t block, uint32_t count);
+static int getGeometry(void* driverContext, BlockDeviceGeometry* geometry);
+
+/**
+ * @brief RAM disk operations
+ */
+static const BlockDeviceOperations ramDiskOperations = {
+  .initialize   = NULL,
+  .readBlocks   = readBlocks,
+  .writeBlocks  = writeBlocks,
+  .sync         = NULL,
+  .trim         = trim,
+  .getGeometry  = getGeometry,
+  .submit       = NULL,
+};
+
+/**
+ * @brief Initializes a RAM disk block device.
+ * @param device Block device structure
+ * @param ramDisk RAM disk driver data
+ * @param memory Memory for disk contents (blockSize * blockCount bytes)
+ * @param blockSize Size of one block in bytes
+ * @param blockCount Number of blocks
+ * @return Result of block device initialization
+ */
+BlockDeviceResultCode RamDisk_initialize(BlockDevice* device, RamDisk* ramDisk,
+    uint8_t* memory, uint32_t blockSize, uint32_t blockCount) {
+  ramDisk->memory = memory;
+  ramDisk->blockSize = blockSize;
+  ramDisk->blockCount = blockCount;
+  return BlockDevice_initialize(device, &ramDiskOperations, ramDisk);
+}
+/**
+ * @brief Reads blocks from RAM
+ */
+int readBlocks(void* driverContext, uint8_t* buffer, uint32_t block,
+    uint32_t count) {
+  RamDisk* ramDisk = driverContext;
+  memcpy(buffer, ramDisk->memory + block * ramDisk->blockSize,
+      count * ramDisk->blockSize);
+  return 0;
+}
+/**
+ * @brief Writes blocks to RAM
+ */
+int writeBlocks(void* driverContext, uint8_t* buffer, uint32_t block,
+    uint32_t count) {
+  RamDisk* ramDisk = driverContext;
+  memcpy(ramDisk->memory + block * ramDisk->blockSize, buffer,
+      count * ramDisk->blockSize);
+  return 0;
+}
+/**
+ * @brief Zeroes out unused blocks
+ */
+int trim(void* driverContext, uint32_t block, uint32_t count) {
+  RamDisk* ramDisk = driverContext;
+  memset(ramDisk->memory + block * ramDisk->blockSize, 0,
+      count * ramDisk->blockSize);
+  return 0;
+}
+/**
+ * @brief Returns geometry of RAM disk
+ */
+int getGeometry(void* driverContext, BlockDeviceGeometry* geometry) {
+  RamDisk* ramDisk = driverContext;
+  geometry->blockSize = ramDisk->blockSize;
+  geometry->blockCount = ramDisk->blockCount;
+  return 0;
+}
+/**
+ * @}
+ */
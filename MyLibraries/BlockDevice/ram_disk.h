@@ -0,0 +1,44 @@
+/**
+ * @file    ram_disk.h
+ * @brief   Block device driver keeping data in RAM.
+ * @date    19.10.2026
+ * @author  Michal Ksiezopolski
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#ifndef RAM_DISK_H_
+#define RAM_DISK_H_
+
+#include "block_device.h"
+
+/**
+ * @addtogroup BLOCK_DEVICE
+ * @{
+ */
+
+/**
+ * @brief RAM disk driver data
+ */
+typedef struct {
+  uint8_t* memory;      ///< Memory holding the disk contents
+  uint32_t blockSize;   ///< Size of one block in bytes
+  uint32_t blockCount;  ///< Number of blocks in memory
+} RamDisk;
+
+BlockDeviceResultCode RamDisk_initialize(BlockDevice* device, RamDisk* ramDisk,
+    uint8_t* memory, uint32_t blockSize, uint32_t blockCount);
+
+/**
+ * @}
+ */
+
+#endif /* RAM_DISK_H_ */
@@ -7,7 +7,7 @@
 
 #include "bmp085.h"
 #include "i2c_hal.h"
-#include "timers.h"
+#include "coroutine.h"
 #include <stdio.h>
 #include <math.h>
 
@@ -71,6 +71,9 @@ typedef struct {
 static EepromCalibrationCoefficients eepromCalibrationCoefficients; ///< Calibration coefficents
 static float b5; ///< This factor is needed for both pressure and temperature
 
+static Coroutine measurementCoroutine; ///< State of measurement sequence
+
+static CoroutineState measure(Coroutine* coroutine);
 static void readCalibrationCoefficients(void);
 static void startMeasurement(Bmp085Measurements measurementType);
 static uint16_t readMeasurement(void);
@@ -89,47 +92,28 @@ void Bmp085_initialize(void) {
  * @details This function should be run in main
  */
 void Bmp085_readMeasurements(void) {
-  uint16_t temperatureMeasurement, pressureMeasurement;
-
-  typedef enum {
-    START_TEMPERATURE_MEASURMENT,
-    TEMPERATURE_DELAY,
-    START_PRESSURE_MEASUREMENT,
-    PRESSURE_DELAY,
-  } MeasurementState;
-
-  static MeasurementState state = START_TEMPERATURE_MEASURMENT;
-  static unsigned int conversionTimerMillis;
-
-  switch(state) {
-  case START_TEMPERATURE_MEASURMENT:
+  measure(&measurementCoroutine);
+}
+/**
+ * @brief Measures temperature and pressure in turn
+ * @details Waits for the conversions without blocking.
+ * @param coroutine Coroutine state
+ * @return Coroutine state (never finishes)
+ */
+CoroutineState measure(Coroutine* coroutine) {
+  COROUTINE_BEGIN(coroutine);
+  while (TRUE) {
     startMeasurement(MEASURMENT_TEMPERATURE);
-    conversionTimerMillis = Timer_getTimeMillis();
-    state = TEMPERATURE_DELAY;
-    break;
-  case TEMPERATURE_DELAY:
-    if (Timer_delayTimer(TEMPERATURE_CONVERSION_TIME_MILLIS, conversionTimerMillis)) {
-      temperatureMeasurement = readMeasurement();
-      float temperatureCelsius = calculateTemperatureDegreesCelsius(temperatureMeasurement);
-      println("Temperature = %.2f deg. Celsius", temperatureCelsius);
-      state = START_PRESSURE_MEASUREMENT;
-    }
-    break;
-  case START_PRESSURE_MEASUREMENT:
+    COROUTINE_AWAIT_DELAY(coroutine, TEMPERATURE_CONVERSION_TIME_MILLIS);
+    float temperatureCelsius = calculateTemperatureDegreesCelsius(readMeasurement());
+    println("Temperature = %.2f deg. Celsius", temperatureCelsius);
+
     startMeasurement(MEASUREMENT_PRESSURE_OVERSAMPLING0);
-    conversionTimerMillis = Timer_getTimeMillis();
-    state = PRESSURE_DELAY;
-    break;
-  case PRESSURE_DELAY:
-    if (Timer_delayTimer(PRESSURE_OVERSAMPLING0_CONVERSION_TIME_MILLIS,
-        conversionTimerMillis)) {
-      pressureMeasurement = readMeasurement();
-      float pressureHectopascals = calculatePressureHectopascals(pressureMeasurement);
-      println("Pressure = %.2f hPa", pressureHectopascals);
-      state = START_TEMPERATURE_MEASURMENT;
-    }
-    break;
+    COROUTINE_AWAIT_DELAY(coroutine, PRESSURE_OVERSAMPLING0_CONVERSION_TIME_MILLIS);
+    float pressureHectopascals = calculatePressureHectopascals(readMeasurement());
+    println("Pressure = %.2f hPa", pressureHectopascals);
   }
+  COROUTINE_END(coroutine);
 }
 /**
  * @brief Reads the calibration coefficients of BMP085
@@ -0,0 +1,94 @@
+/**
+ * @file    cobs.c
+ * @brief   Consistent Overhead Byte Stuffing.
+ * @date    19.10.2026
+ * @author  Michal Ksiezopolski
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#include "cobs.h"
+
+/**
+ * @addtogroup COBS
+ * @{
+ */
+
+#define MAXIMUM_CODE 0xff ///< Code of a block of 254 nonzero bytes not followed by zero
+
+/**
+ * @brief Encodes data
+ * @param input Data to encode
+ * @param length Length of data
+ * @param output Buffer for encoded data - COBS_MAXIMUM_ENCODED_LENGTH(length)
+ * bytes long, must not overlap input
+ * @return Length of encoded data (delimiter is not added)
+ */
+int Cobs_encode(const uint8_t* input, int length, uint8_t* output) {
+  int codeIndex = 0;  // where the code of the current block goes
+  int outputIndex = 1;
+  uint8_t code = 1;
+
+  for (int i = 0; i < length; i++) {
+    if (input[i] == 0) {
+      output[codeIndex] = code;
+      codeIndex = outputIndex++;
+      code = 1;
+      continue;
+    }
+    output[outputIndex++] = input[i];
+    code++;
+    // block full - start a new one (unless data ended)
+    if (code == MAXIMUM_CODE && i + 1 < length) {
+      output[codeIndex] = code;
+      codeIndex = outputIndex++;
+      code = 1;
+    }
+  }
+  output[codeIndex] = code;
+  return outputIndex;
+}
+/**
+ * @brief Decodes data
+ * @details Decoded data is never longer than encoded data and every byte is
+ * read before it is overwritten, so data can be decoded in place
+ * (output == input).
+ * @param input Encoded data (without delimiter)
+ * @param length Length of encoded data
+ * @param output Buffer for decoded data (at least length - 1 bytes)
+ * @return Length of decoded data or -1 if data is not valid COBS
+ */
+int Cobs_decode(const uint8_t* input, int length, uint8_t* output) {
+  int inputIndex = 0;
+  int outputIndex = 0;
+
+  while (inputIndex < length) {
+    uint8_t code = input[inputIndex++];
+    if (code == 0 || inputIndex + code - 1 > length) {
+      return -1;
+    }
+    for (int i = 1; i < code; i++) {
+      uint8_t data = input[inputIndex++];
+      if (data == 0) {
+        return -1;
+      }
+      output[outputIndex++] = data;
+    }
+    // block shorter than maximum ends with a zero (except the last one)
+    if (code != MAXIMUM_CODE && inputIndex < length) {
+      output[outputIndex++] = 0;
+    }
+  }
+  return outputIndex;
+}
+/**
+ * @}
+ */
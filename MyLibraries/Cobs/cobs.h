@@ -0,0 +1,49 @@
+/**
+ * @file    cobs.h
+ * @brief   Consistent Overhead Byte Stuffing.
+ * @details Encoded data contains no zero bytes, so a zero byte can mark
+ * the end of a frame. The overhead is one byte per started 254 bytes.
+ * @date    19.10.2026
+ * @author  Michal Ksiezopolski
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#ifndef COBS_H_
+#define COBS_H_
+
+#include <inttypes.h>
+
+/**
+ * @defgroup  COBS COBS
+ * @brief     Consistent Overhead Byte Stuffing
+ */
+
+/**
+ * @addtogroup COBS
+ * @{
+ */
+
+#define COBS_FRAME_DELIMITER 0x00 ///< Byte separating encoded frames
+
+/**
+ * @brief Maximum length of encoded data (without delimiter)
+ */
+#define COBS_MAXIMUM_ENCODED_LENGTH(length) ((length) + (length) / 254 + 1)
+
+int Cobs_encode (const uint8_t* input, int length, uint8_t* output);
+int Cobs_decode (const uint8_t* input, int length, uint8_t* output);
+
+/**
+ * @}
+ */
+
+#endif /* COBS_H_ */
@@ -0,0 +1,173 @@
+/**
+ * @file    console.c
+ * @brief   Table driven command dispatcher for the serial port.
+ * @date    19.10.2026
+ * @author  Michal Ksiezopolski
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#include "console.h"
+#include "serial_port.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef CONSOLE_DEBUG
+  #define CONSOLE_DEBUG
+#endif
+
+#ifdef CONSOLE_DEBUG
+  #define println(str, args...) printf("CONSOLE--> "str"%s",##args,"\r\n")
+#else
+  #define println(str, args...) (void)0
+#endif
+
+/**
+ * @addtogroup CONSOLE
+ * @{
+ */
+
+static const ConsoleCommand* commandTable;  ///< Registered commands (sorted by name)
+static int commandCount;                    ///< Number of registered commands
+
+static int splitIntoTokens(char* line, char* tokens[]);
+
+/**
+ * @brief Registers the command table
+ * @param commands Commands sorted by name (strcmp order)
+ * @param numberOfCommands Number of commands
+ * @retval CONSOLE_OK Commands registered
+ * @retval CONSOLE_TABLE_NOT_SORTED Table is not sorted or has duplicates
+ */
+ConsoleResultCode Console_initialize(const ConsoleCommand* commands, int numberOfCommands) {
+  for (int i = 1; i < numberOfCommands; i++) {
+    if (strcmp(commands[i - 1].name, commands[i].name) >= 0) {
+      println("Command %s not sorted", commands[i].name);
+      return CONSOLE_TABLE_NOT_SORTED;
+    }
+  }
+  commandTable = commands;
+  commandCount = numberOfCommands;
+  return CONSOLE_OK;
+}
+/**
+ * @brief Executes a command line received from the debug console (nonblocking)
+ * @details Works the same over USART and USB CDC - the line comes from
+ * SerialPort_getFrame. Call from the main loop.
+ * @return Result of the command or CONSOLE_NO_COMMAND if nothing was received
+ */
+ConsoleResultCode Console_process(void) {
+  char line[CONSOLE_LINE_LENGTH];
+  int length;
+  SerialPortResultCode result = SerialPort_getFrame(SerialPort_getDebugConsole(), line, &length,
+      CONSOLE_LINE_LENGTH);
+  if (result == SERIAL_PORT_NO_FRAME_READY) {
+    return CONSOLE_NO_COMMAND;
+  }
+  if (result != SERIAL_PORT_GOT_FRAME) {
+    return CONSOLE_FRAME_ERROR;
+  }
+  return Console_execute(line);
+}
+/**
+ * @brief Executes a command line
+ * @param line Null terminated command line (modified - split into tokens)
+ * @return Result of the command
+ */
+ConsoleResultCode Console_execute(char* line) {
+  char* arguments[CONSOLE_MAXIMUM_ARGUMENTS + 1];
+  int argumentCount = splitIntoTokens(line, arguments);
+  if (argumentCount == 0) {
+    return CONSOLE_NO_COMMAND;
+  }
+  if (argumentCount > CONSOLE_MAXIMUM_ARGUMENTS) {
+    println("Too many arguments");
+    return CONSOLE_TOO_MANY_ARGUMENTS;
+  }
+  const ConsoleCommand* command = Console_findCommand(arguments[0]);
+  if (command == NULL) {
+    println("Unknown command %s", arguments[0]);
+    return CONSOLE_UNKNOWN_COMMAND;
+  }
+  ConsoleResultCode result = command->handler(argumentCount, arguments);
+  if (result == CONSOLE_INVALID_ARGUMENTS && command->usage != NULL) {
+    println("Usage: %s", command->usage);
+  }
+  return result;
+}
+/**
+ * @brief Finds a command by name (binary search)
+ * @param name Command name
+ * @return Command or NULL if not found
+ */
+const ConsoleCommand* Console_findCommand(const char* name) {
+  int low = 0;
+  int high = commandCount - 1;
+  while (low <= high) {
+    int middle = (low + high) / 2;
+    int comparison = strcmp(name, commandTable[middle].name);
+    if (comparison == 0) {
+      return &commandTable[middle];
+    }
+    if (comparison < 0) {
+      high = middle - 1;
+    } else {
+      low = middle + 1;
+    }
+  }
+  return NULL;
+}
+/**
+ * @brief Converts an argument to integer (decimal or 0x prefixed hex)
+ * @param text Argument
+ * @param value Converted value
+ * @retval TRUE Argument is a valid number
+ * @retval FALSE Argument is not a number
+ */
+Boolean Console_parseInteger(const char* text, int* value) {
+  char* end;
+  long result = strtol(text, &end, 0);
+  if (end == text || *end != '\0') {
+    return FALSE;
+  }
+  *value = (int)result;
+  return TRUE;
+}
+/**
+ * @brief Splits command line into tokens separated by spaces (in place)
+ * @param line Command line
+ * @param tokens Table for CONSOLE_MAXIMUM_ARGUMENTS + 1 tokens
+ * @return Number of tokens (more than CONSOLE_MAXIMUM_ARGUMENTS if there are too many)
+ */
+int splitIntoTokens(char* line, char* tokens[]) {
+  int count = 0;
+  while (*line != '\0') {
+    // skip separators
+    while (*line == ' ' || *line == '\t' || *line == '\n') {
+      *line++ = '\0';
+    }
+    if (*line == '\0') {
+      break;
+    }
+    if (count > CONSOLE_MAXIMUM_ARGUMENTS) {
+      return count;
+    }
+    tokens[count++] = line;
+    while (*line != '\0' && *line != ' ' && *line != '\t' && *line != '\n') {
+      line++;
+    }
+  }
+  return count;
+}
+/**
+ * @}
+ */
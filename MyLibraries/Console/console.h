@@ -0,0 +1,87 @@
+/**
+ * @file    console.h
+ * @brief   Table driven command dispatcher for the serial port.
+ * @details Commands are looked up with a binary search, so the table has
+ * to be sorted by name (checked by Console_initialize):
+ * @code
+ * static const ConsoleCommand commands[] = {
+ *   {":LED",   ledCommand,   ":LED <number> <ON|OFF>"},
+ *   {":RESET", resetCommand, ":RESET"},
+ * };
+ * Console_initialize(commands, CONSOLE_NUMBER_OF_COMMANDS(commands));
+ * @endcode
+ * @date    19.10.2026
+ * @author  Michal Ksiezopolski
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#ifndef CONSOLE_H_
+#define CONSOLE_H_
+
+#include "utils.h"
+
+/**
+ * @defgroup  CONSOLE CONSOLE
+ * @brief     Table driven command dispatcher
+ */
+
+/**
+ * @addtogroup CONSOLE
+ * @{
+ */
+
+#define CONSOLE_MAXIMUM_ARGUMENTS 8  ///< Maximum number of tokens in a command line (including name)
+#define CONSOLE_LINE_LENGTH       64 ///< Maximum length of a command line
+
+/**
+ * @brief Number of commands in a command table
+ */
+#define CONSOLE_NUMBER_OF_COMMANDS(table) ((int)(sizeof(table) / sizeof((table)[0])))
+
+/**
+ * @brief Console result codes
+ */
+typedef enum {
+  CONSOLE_OK,                 //!< CONSOLE_OK
+  CONSOLE_NO_COMMAND,         //!< CONSOLE_NO_COMMAND No command line received
+  CONSOLE_UNKNOWN_COMMAND,    //!< CONSOLE_UNKNOWN_COMMAND
+  CONSOLE_INVALID_ARGUMENTS,  //!< CONSOLE_INVALID_ARGUMENTS
+  CONSOLE_TOO_MANY_ARGUMENTS, //!< CONSOLE_TOO_MANY_ARGUMENTS
+  CONSOLE_FRAME_ERROR,        //!< CONSOLE_FRAME_ERROR Invalid or too long command line
+  CONSOLE_TABLE_NOT_SORTED,   //!< CONSOLE_TABLE_NOT_SORTED
+} ConsoleResultCode;
+/**
+ * @brief Command handler
+ * @param argumentCount Number of tokens (arguments[0] is the command name)
+ * @param arguments Tokens - point into the command line, valid only during the call
+ */
+typedef ConsoleResultCode (*ConsoleHandler)(int argumentCount, char* arguments[]);
+/**
+ * @brief Console command
+ */
+typedef struct {
+  const char* name;       ///< Command name (first token)
+  ConsoleHandler handler; ///< Function executing the command
+  const char* usage;      ///< Usage printed on invalid arguments
+} ConsoleCommand;
+
+ConsoleResultCode     Console_initialize   (const ConsoleCommand* commands, int numberOfCommands);
+ConsoleResultCode     Console_process      (void);
+ConsoleResultCode     Console_execute      (char* line);
+const ConsoleCommand* Console_findCommand  (const char* name);
+Boolean               Console_parseInteger (const char* text, int* value);
+
+/**
+ * @}
+ */
+
+#endif /* CONSOLE_H_ */
@@ -0,0 +1,169 @@
+/**
+ * @file    coroutine.h
+ * @brief   Stackless coroutines (protothreads).
+ * @details A coroutine is a function which can wait in the middle of its
+ * code and return to the caller - the next call continues after the wait.
+ * Only the resume point is stored (in a Coroutine structure), so a coroutine
+ * costs a few bytes and no stack. Driver state machines can be written as
+ * straight code:
+ * @code
+ * static CoroutineState measure(Coroutine* coroutine) {
+ *   COROUTINE_BEGIN(coroutine);
+ *   while (TRUE) {
+ *     startConversion();
+ *     COROUTINE_AWAIT_DELAY(coroutine, CONVERSION_TIME_MILLIS);
+ *     readResult();
+ *   }
+ *   COROUTINE_END(coroutine);
+ * }
+ *
+ * // in main loop or a scheduler task
+ * measure(&measureCoroutine);
+ * @endcode
+ * Limitations: local variables are lost at every wait (use static variables
+ * or a context structure). The body is one big switch statement with a case
+ * at every wait, so a wait can't be put inside another switch statement.
+ * @date    19.10.2026
+ * @author  Michal Ksiezopolski
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#ifndef COROUTINE_H_
+#define COROUTINE_H_
+
+#include "utils.h"
+#include "timers.h"
+
+/**
+ * @defgroup  COROUTINE COROUTINE
+ * @brief     Stackless coroutines
+ */
+
+/**
+ * @addtogroup COROUTINE
+ * @{
+ */
+
+/**
+ * @brief Value returned by a coroutine
+ */
+typedef enum {
+  COROUTINE_RUNNING,  //!< Waiting - call again
+  COROUTINE_FINISHED, //!< Reached the end (next call starts from the beginning)
+} CoroutineState;
+/**
+ * @brief Coroutine state
+ * @details Initialize with COROUTINE_INITIALIZE (or zero it).
+ */
+typedef struct {
+  unsigned int resumePoint;   ///< Where the next call continues (0 - from the beginning)
+  uint32_t waitStartMicros;   ///< Start of COROUTINE_AWAIT_DELAY
+  uint32_t waitMicros;        ///< Length of COROUTINE_AWAIT_DELAY
+} Coroutine;
+
+#define COROUTINE_RESUME_POINT        (__COUNTER__ + 1) ///< Unique nonzero case value
+
+/**
+ * @brief Sets the coroutine to start from the beginning
+ */
+#define COROUTINE_INITIALIZE(coroutine) ((coroutine)->resumePoint = 0)
+/**
+ * @brief Starts the coroutine body - jumps to the last wait
+ */
+#define COROUTINE_BEGIN(coroutine) \
+  switch ((coroutine)->resumePoint) { \
+  case 0:
+/**
+ * @brief Ends the coroutine body
+ */
+#define COROUTINE_END(coroutine) \
+  } \
+  COROUTINE_INITIALIZE(coroutine); \
+  return COROUTINE_FINISHED
+/**
+ * @brief Finishes the coroutine before its end
+ */
+#define COROUTINE_EXIT(coroutine) do { \
+    COROUTINE_INITIALIZE(coroutine); \
+    return COROUTINE_FINISHED; \
+  } while (0)
+/**
+ * @brief Waits until the condition is true
+ * @details The condition is checked at every call of the coroutine - it
+ * returns at once if the condition is already true.
+ */
+#define COROUTINE_AWAIT(coroutine, condition) \
+  COROUTINE_AWAIT_(coroutine, condition, COROUTINE_RESUME_POINT)
+#define COROUTINE_AWAIT_(coroutine, condition, resumePoint_) do { \
+    (coroutine)->resumePoint = resumePoint_; \
+  case resumePoint_: \
+    if (!(condition)) { \
+      return COROUTINE_RUNNING; \
+    } \
+  } while (0)
+/**
+ * @brief Returns to the caller once, continues at next call
+ */
+#define COROUTINE_YIELD(coroutine) COROUTINE_YIELD_(coroutine, COROUTINE_RESUME_POINT)
+#define COROUTINE_YIELD_(coroutine, resumePoint_) do { \
+    (coroutine)->resumePoint = resumePoint_; \
+    return COROUTINE_RUNNING; \
+  case resumePoint_: ; \
+  } while (0)
+/**
+ * @brief Waits the given time in microseconds (up to 71 minutes)
+ */
+#define COROUTINE_AWAIT_DELAY_MICROS(coroutine, micros) do { \
+    (coroutine)->waitStartMicros = Timer_getTimeMicros(); \
+    (coroutine)->waitMicros = (micros); \
+    COROUTINE_AWAIT(coroutine, \
+        Timer_getTimeMicros() - (coroutine)->waitStartMicros >= (coroutine)->waitMicros); \
+  } while (0)
+/**
+ * @brief Waits the given time in milliseconds
+ */
+#define COROUTINE_AWAIT_DELAY(coroutine, millis) \
+  COROUTINE_AWAIT_DELAY_MICROS(coroutine, (uint32_t)(millis) * 1000)
+/**
+ * @brief Waits until a flag is set (e.g. by an IRQ) and clears it
+ * @details The flag should be a volatile Boolean. Events coming before the
+ * flag is cleared are merged into one.
+ */
+#define COROUTINE_AWAIT_EVENT(coroutine, flag) do { \
+    COROUTINE_AWAIT(coroutine, (flag)); \
+    (flag) = FALSE; \
+  } while (0)
+/**
+ * @brief Submits an SPI bus transaction and waits until it is done
+ * @details The bus runs the transfer from its IRQ while the coroutine is
+ * waiting. The transaction has to be static (or in a context structure), as
+ * it is used after the wait. If SpiBus_submit rejects the transaction, the
+ * coroutine doesn't wait - check for SPI_TRANSACTION_DONE afterwards.
+ * Requires spi_bus.h.
+ */
+#define COROUTINE_AWAIT_TRANSFER(coroutine, transaction) do { \
+    if (SpiBus_submit(transaction)) { \
+      COROUTINE_AWAIT(coroutine, (transaction)->state == SPI_TRANSACTION_DONE); \
+    } \
+  } while (0)
+/**
+ * @brief Runs another coroutine until it finishes
+ * @details The child should be initialized before. Example:
+ * COROUTINE_AWAIT_CHILD(coroutine, readSensor(&readCoroutine, sensor));
+ */
+#define COROUTINE_AWAIT_CHILD(coroutine, childCall) \
+  COROUTINE_AWAIT(coroutine, (childCall) == COROUTINE_FINISHED)
+/**
+ * @}
+ */
+
+#endif /* COROUTINE_H_ */
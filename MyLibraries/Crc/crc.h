@@ -0,0 +1,45 @@
+/**
+ * @file    crc.h
+ * @brief   Table driven CRC calculation functions.
+ * @date    19.10.2026
+ * @author  Michal Ksiezopolski
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#ifndef CRC_H_
+#define CRC_H_
+
+#include <inttypes.h>
+
+/**
+ * @defgroup  CRC CRC
+ * @brief     Table driven CRC calculation functions
+ */
+
+/**
+ * @addtogroup CRC
+ * @{
+ */
+
+#define CRC7_INITIAL_VALUE        0x00   ///< Initial value of CRC7 (SD commands)
+#define CRC16_CCITT_INITIAL_VALUE 0x0000 ///< Initial value of CRC16-CCITT (SD data blocks, XMODEM)
+
+uint8_t  Crc_updateCrc7          (uint8_t crc, const uint8_t* data, int length);
+uint8_t  Crc_calculateCrc7       (const uint8_t* data, int length);
+uint16_t Crc_updateCrc16Ccitt    (uint16_t crc, const uint8_t* data, int length);
+uint16_t Crc_calculateCrc16Ccitt (const uint8_t* data, int length);
+
+/**
+ * @}
+ */
+
+#endif /* CRC_H_ */
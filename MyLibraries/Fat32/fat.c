@@ -17,18 +17,17 @@
 
 #include "fat.h"
 #include "utils.h"
+#include "profiler.h"
 #include <stdio.h>
 #include <string.h>
 
-#define DEBUG_FAT
-
-#ifdef DEBUG_FAT
-  #define print(str, args...) printf(""str"%s",##args,"")
-  #define println(str, args...) printf("FAT--> "str"%s",##args,"\r\n")
-#else
-  #define print(str, args...) (void)0
-  #define println(str, args...) (void)0
+#ifndef FAT_LOG_LEVEL
+  #define FAT_LOG_LEVEL LOG_LEVEL_DEBUG ///< Log level of this module
 #endif
+#define LOG_MODULE_LEVEL FAT_LOG_LEVEL
+#include "log.h"
+
+#define println(str, args...) LOG_DEBUG("FAT--> "str, ##args)
 
 /**
  * @addtogroup FAT
@@ -235,15 +234,6 @@ typedef struct {
   uint8_t diskID;
   FAT_PartitionInfo partitionInfo[4];
 } FAT_DiskInfo;
-/**
- * @brief Physical layer callbacks.
- */
-typedef struct {
-  int (*phyInit)(void);
-  int (*phyReadSectors)(uint8_t* readBuffer, uint32_t sector, uint32_t count);
-  int (*phyWriteSectors)(uint8_t* writeBuffer, uint32_t sector, uint32_t count);
-} FAT_PhysicalCb;
-
 #define FAT_MAX_DISKS     2   ///< Maximum number of mounted disks
 #define MAX_OPENED_FILES  32  ///< Maximum number of opened files
 #define FAT_LAST_CLUSTER  0x0fffffff ///< Last cluster in file
@@ -255,8 +245,8 @@ typedef struct {
  */
 static FAT_File openedFiles[MAX_OPENED_FILES];
 static FAT_DiskInfo mountedDisks[FAT_MAX_DISKS]; ///< Disk info for mounted disks
-static uint8_t bufferForReadingSectors[512]; ///< Buffer for reading sectors
-static FAT_PhysicalCb phyCallbacks; ///< Physical layer callbacks
+static uint8_t bufferForReadingSectors[512]; ///< Buffer for reading sectors (cache of the volume)
+static BlockDevice volume; ///< Block device of the mounted partition
 static Boolean isFilesystemMounted;
 
 static uint32_t convertClusterToSector(uint32_t cluster);
@@ -271,31 +261,22 @@ static FAT_ErrorTypedef writeSector(uint32_t sector);
 
 /**
  * @brief Initialize FAT file system
- * @param phyInit Physical drive initialization function
- * @param phyReadSectors Read sectors function
- * @param phyWriteSectors Write sectors function
+ * @details All sectors of the partition are accessed through a partition
+ * block device, so sector numbers are relative to the start of the partition.
+ * @param device Initialized block device of the whole disk
  * @return
  */
-int FAT_Init(int (*phyInit)(void),
-    int (*phyReadSectors)(uint8_t* readBuffer, uint32_t sector,
-        uint32_t count),
-    int (*phyWriteSectors)(uint8_t* writeBuffer, uint32_t sector,
-        uint32_t count)) {
+int FAT_Init(BlockDevice* device) {
 
-  if (phyInit == NULL || phyReadSectors == NULL || phyWriteSectors == NULL) {
+  if (device == NULL) {
     return FAT_HAL_ERROR;
   }
 
-  phyCallbacks.phyInit = phyInit;
-  phyCallbacks.phyReadSectors = phyReadSectors;
-  phyCallbacks.phyWriteSectors = phyWriteSectors;
-
-  // initialize physical layer
-  phyCallbacks.phyInit();
-
   // Read MBR - first sector (0)
   const int MBR_SECTOR = 0;
-  if (readSector(MBR_SECTOR) != 0) {
+  const int NUMBER_OF_SECTORS_TO_READ = 1;
+  if (BlockDevice_readBlocks(device, bufferForReadingSectors, MBR_SECTOR,
+      NUMBER_OF_SECTORS_TO_READ) != BLOCK_DEVICE_OK) {
     return FAT_HAL_ERROR;
   }
 
@@ -334,8 +315,18 @@ int FAT_Init(int (*phyInit)(void),
     }
   }
 
+  // Access the first partition through its own block device
+  if (BlockDevice_initializePartition(&volume, device,
+      mountedDisks[0].partitionInfo[0].startSector,
+      mountedDisks[0].partitionInfo[0].lengthInSectors) != BLOCK_DEVICE_OK) {
+    println("Error: Partition outside of disk");
+    return FAT_WRONG_PARTITION_SIZE;
+  }
+  BlockDevice_attachCache(&volume, bufferForReadingSectors);
+
   // Read boot sector of first partition
-  if (readSector(mountedDisks[0].partitionInfo[0].startSector) != 0) {
+  const int BOOT_SECTOR = 0;
+  if (readSector(BOOT_SECTOR) != 0) {
     return FAT_HAL_ERROR;
   }
 
@@ -362,9 +353,8 @@ int FAT_Init(int (*phyInit)(void),
   println("Sectors per FAT =  %d", (unsigned int)bootSector->sectorsPerFAT32);
   println("Root cluster = %d", (unsigned int)bootSector->rootCluster);
 
-  // Sector on disk where FAT is (from start of disk)
-  uint32_t fatStart = mountedDisks[0].partitionInfo[0].startSector +
-      bootSector->reservedSectors;
+  // Sector where FAT is (from start of partition)
+  uint32_t fatStart = bootSector->reservedSectors;
   mountedDisks[0].partitionInfo[0].startFatSector = fatStart;
   println("FATs start at sector %d", (unsigned int)fatStart);
 
@@ -403,9 +393,9 @@ int FAT_OpenFile(const char* filename) {
 
   FAT_File file;
   strcpy(file.filename, filename);
-  println("%s: Opening file %s", __FUNCTION__, filename);
-
   int id = findFile(&file);
+  // the name is not logged - records keep only pointers to strings
+  println("%s: Opened file ID = %d", __FUNCTION__, id);
 
   if (id != -1) {
     // copy file information structure
@@ -423,9 +413,8 @@ int FAT_OpenFile(const char* filename) {
 int FAT_NewFile(const char* filename) {
   FAT_File file;
   strcpy(file.filename, filename);
-  println("%s: Opening file %s", __FUNCTION__, filename);
-
   int id = findFile(&file);
+  println("%s: File ID = %d", __FUNCTION__, id);
 
   // if file found
   if (id != -1) {
@@ -742,17 +731,10 @@ void updateRootEntry(int file) {
       (unsigned int)openedFiles[file].rootDirEntry);
   dirEntry += openedFiles[file].rootDirEntry;
 
-  char filename[12];
-  char* namePtr = (char*)dirEntry->filename;
-  // copy filename from directory entry
-  for (int k = 0; k < 11; k++) {
-    filename[k] = *namePtr++;
-  }
-  filename[11] = 0; // end string
   dirEntry->fileSize = openedFiles[file].fileSize;
 
-  println("%s: Updating root entry for file: %s, size %u", __FUNCTION__,
-      filename, (unsigned int)openedFiles[file].fileSize);
+  println("%s: Updating root entry for file ID = %u, size %u", __FUNCTION__,
+      (unsigned int)file, (unsigned int)openedFiles[file].fileSize);
 
   writeSector(sector);
 }
@@ -845,39 +827,25 @@ int getNextId(void) {
 }
 /**
  * @brief Convenience function for reading sectors.
- * @details It checks if the sector isn't in the buffer first
- * as a simple caching mechanism.
- * @param sector Sector to read.
+ * @details The sector is read into bufferForReadingSectors. The
+ * block device cache skips the read if the sector is already there.
+ * @param sector Sector to read (from start of partition).
  */
 FAT_ErrorTypedef readSector(uint32_t sector) {
-
-  const int NUMBER_OF_SECTORS_TO_READ = 1;
-  static uint32_t sectorCurrentlyInBuffer = UINT32_MAX;
-
-  // check if we already read the sector
-  if (sectorCurrentlyInBuffer == sector) {
-    println("%s: Sector %u already read", __FUNCTION__, sector);
-    return FAT_NO_ERROR;
-  }
-  int result = phyCallbacks.phyReadSectors(bufferForReadingSectors, sector,
-      NUMBER_OF_SECTORS_TO_READ);
-  if (result != 0) {
+  PROFILER_ZONE(fatReadSector);
+  if (BlockDevice_readCachedBlock(&volume, sector) != BLOCK_DEVICE_OK) {
     return FAT_HAL_READ_ERROR;
   }
-  sectorCurrentlyInBuffer = sector;
   println("%s: Read sector %u", __FUNCTION__, (unsigned int) sector);
-
   return FAT_NO_ERROR;
 }
 /**
  * @brief Convenience function for writing sectors.
- * @param sector Sector to write.
+ * @details Writes contents of bufferForReadingSectors.
+ * @param sector Sector to write (from start of partition).
  */
 FAT_ErrorTypedef writeSector(uint32_t sector) {
-  const int NUMBER_OF_SECTORS_TO_WRITE = 1;
-  int result = phyCallbacks.phyWriteSectors(bufferForReadingSectors, sector,
-      NUMBER_OF_SECTORS_TO_WRITE);
-  if (result != 0) {
+  if (BlockDevice_writeCachedBlock(&volume, sector) != BLOCK_DEVICE_OK) {
     return FAT_HAL_WRITE_ERROR;
   }
   println("%s: Written sector %u", __FUNCTION__, (unsigned int) sector);
@@ -891,8 +859,6 @@ FAT_ErrorTypedef writeSector(uint32_t sector) {
  */
 int findFile(FAT_File* file) {
 
-  println("%s: Searching for file %s", __FUNCTION__, file->filename);
-
   uint32_t i = 0, j = 0, k = 0;
 
   FAT_RootDirEntry* dirEntry = 0; // the directory entry
@@ -993,8 +959,8 @@ int findFile(FAT_File* file) {
       file->rdPtr = 0; // start reading from 1st byte
       file->wrPtr = 0; // start writing from 1st byte
 
-      println("%s: Found file %s of size %u, ID = %u!!!",
-          __FUNCTION__, file->filename, (unsigned int)file->fileSize,
+      println("%s: Found file of size %u, ID = %u!!!",
+          __FUNCTION__, (unsigned int)file->fileSize,
           (unsigned int)file->id);
       println("%s: File created on %02u.%02u.%04u at %02u:%02u:%02u",
           __FUNCTION__, date.fields.day,date.fields.month, date.fields.year+1980,
@@ -1035,7 +1001,7 @@ int findFile(FAT_File* file) {
 //  println("Root dir");
 //
 //  // read first sector of root dir
-//  phyCallbacks.phyReadSectors(buf,
+//  BlockDevice_readBlocks(&volume, buf,
 //      mountedDisks[0].partitionInfo[0].rootDirSector, 1);
 //
 //  FAT_RootDirEntry* dirEntry = (FAT_RootDirEntry*)buf;
@@ -1080,7 +1046,7 @@ int findFile(FAT_File* file) {
 //      println("File is at sector %d", (unsigned int)FAT_Cluster2Sector(cluster));
 //      println("File size is %d",(unsigned int)dirEntry->fileSize);
 //
-//      phyCallbacks.phyReadSectors(buf2, FAT_Cluster2Sector(cluster), 1);
+//      BlockDevice_readBlocks(&volume, buf2, FAT_Cluster2Sector(cluster), 1);
 //
 //      hexdump(buf2, 16);
 //      println("%s",buf2);
@@ -19,6 +19,7 @@
 #define FAT_H_
 
 #include <inttypes.h>
+#include "block_device.h"
 
 /**
  * @defgroup  FAT FAT
@@ -42,9 +43,7 @@ typedef enum {
   FAT_INCOMPATIBLE_SECTOR_LENGTH,
 } FAT_ErrorTypedef;
 
-int FAT_Init(int (*phyInit)(void),
-    int (*phyReadSectors)(uint8_t* buf, uint32_t sector, uint32_t count),
-    int (*phyWriteSectors)(uint8_t* buf, uint32_t sector, uint32_t count));
+int FAT_Init(BlockDevice* device);
 int FAT_OpenFile(const char* filename);
 int FAT_ReadFile(int file, uint8_t* data, int count);
 int FAT_MoveRdPtr(int file, int newWrPtr);
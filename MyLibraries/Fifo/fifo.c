@@ -17,12 +17,21 @@
 
 #include "fifo.h"
 #include <stdlib.h>
+#include <string.h>
 
 /**
  * @addtogroup FIFO
  * @{
  */
 
+/*
+ * The index written by the other side is read with acquire semantics and the
+ * own index is published with release semantics, so the data written to the
+ * buffer is visible before the index that makes it available (DMB on Cortex-M).
+ */
+#define LOAD_ACQUIRE(index)         __atomic_load_n(&(index), __ATOMIC_ACQUIRE)
+#define STORE_RELEASE(index, value) __atomic_store_n(&(index), (value), __ATOMIC_RELEASE)
+
 /**
  * @brief Add a FIFO.
  *
@@ -31,9 +40,12 @@
  * buffer pointer. The rest is handled automatically.
  *
  * @param fifo Pointer to FIFO structure
+ * @param dataBuffer Buffer for FIFO data
+ * @param length Length of the buffer - has to be a power of two
  * @retval FIFO_OK FIFO added successfully
  * @retval FIFO_ZERO_LENGTH FIFO length is 0
  * @retval FIFO_NULL_BUFFER Received buffer is null
+ * @retval FIFO_INVALID_LENGTH Length is not a power of two
  */
 FifoResultCode Fifo_addNewFifo(Fifo * fifo, char * dataBuffer, int length) {
 
@@ -45,14 +57,46 @@ FifoResultCode Fifo_addNewFifo(Fifo * fifo, char * dataBuffer, int length) {
     return FIFO_NULL_BUFFER;
   }
 
+  if (length < 0 || (length & (length - 1)) != 0) {
+    return FIFO_INVALID_LENGTH;
+  }
+
   fifo->dataBuffer = dataBuffer;
   fifo->length = length;
+  fifo->mask  = length - 1;
   fifo->tail  = 0;
   fifo->head  = 0;
-  fifo->count = 0;
 
   return FIFO_OK;
 }
+/**
+ * @brief Checks if FIFO is empty
+ * @param fifo Pointer to FIFO structure
+ * @retval TRUE FIFO is empty
+ * @retval FALSE FIFO is not empty
+ */
+Boolean Fifo_isEmpty(Fifo * fifo) {
+  if (LOAD_ACQUIRE(fifo->head) == LOAD_ACQUIRE(fifo->tail)) {
+    return TRUE;
+  }
+  return FALSE;
+}
+/**
+ * @brief Gets number of bytes in FIFO
+ * @param fifo Pointer to FIFO structure
+ * @return Number of bytes
+ */
+int Fifo_getCount(Fifo * fifo) {
+  return (int)(LOAD_ACQUIRE(fifo->head) - LOAD_ACQUIRE(fifo->tail));
+}
+/**
+ * @brief Gets number of free bytes in FIFO
+ * @param fifo Pointer to FIFO structure
+ * @return Number of free bytes
+ */
+int Fifo_getFreeSpace(Fifo * fifo) {
+  return fifo->length - Fifo_getCount(fifo);
+}
 /**
  * @brief Pushes data to FIFO.
  * @param fifo Pointer to FIFO structure
@@ -62,61 +106,207 @@ FifoResultCode Fifo_addNewFifo(Fifo * fifo, char * dataBuffer, int length) {
  */
 FifoResultCode Fifo_push(Fifo* fifo, char newData) {
 
+  unsigned int head = fifo->head;
+
   // Check for overflow
-  if (fifo->count == fifo->length) {
+  if (head - LOAD_ACQUIRE(fifo->tail) == (unsigned int)fifo->length) {
     return FIFO_FULL;
   }
 
-  fifo->dataBuffer[fifo->head++] = newData;
-  fifo->count++;
+  fifo->dataBuffer[head & fifo->mask] = newData;
+  STORE_RELEASE(fifo->head, head + 1);
 
-  if (fifo->head == fifo->length) {
-    fifo->head = 0; // start from beginning
+  return FIFO_OK;
+}
+/**
+ * @brief Pushes multiple bytes to FIFO.
+ * @details Copies as many bytes as fit (at most two memcpy calls) and
+ * publishes them at once.
+ * @param fifo Pointer to FIFO structure
+ * @param data Data to add
+ * @param length Number of bytes to add
+ * @return Number of bytes added
+ */
+int Fifo_pushMultiple(Fifo* fifo, const char* data, int length) {
+
+  unsigned int head = fifo->head;
+  int freeSpace = fifo->length - (int)(head - LOAD_ACQUIRE(fifo->tail));
+
+  if (length > freeSpace) {
+    length = freeSpace;
+  }
+  if (length <= 0) {
+    return 0;
   }
 
-  return FIFO_OK;
+  unsigned int start = head & fifo->mask;
+  int firstPart = fifo->length - start;
+  if (firstPart > length) {
+    firstPart = length;
+  }
+  memcpy(fifo->dataBuffer + start, data, firstPart);
+  memcpy(fifo->dataBuffer, data + firstPart, length - firstPart);
+  STORE_RELEASE(fifo->head, head + length);
+
+  return length;
+}
+/**
+ * @brief Gets the contiguous free space after head
+ * @details The producer can write directly to the span and then
+ * call Fifo_commit.
+ * @param fifo Pointer to FIFO structure
+ * @return Writable span (length 0 if FIFO is full)
+ */
+FifoSpan Fifo_getWritableSpan(Fifo* fifo) {
+
+  unsigned int head = fifo->head;
+  int freeSpace = fifo->length - (int)(head - LOAD_ACQUIRE(fifo->tail));
+  unsigned int start = head & fifo->mask;
+  int contiguous = fifo->length - start;
+
+  FifoSpan span;
+  span.data = fifo->dataBuffer + start;
+  span.length = (freeSpace < contiguous) ? freeSpace : contiguous;
+  return span;
 }
 /**
- * @brief Pops data from the FIFO.
+ * @brief Publishes data written to the writable span
  * @param fifo Pointer to FIFO structure
- * @param c data
- * @retval FIFO_OK Got valid data
+ * @param length Number of bytes written
+ */
+void Fifo_commit(Fifo* fifo, int length) {
+  STORE_RELEASE(fifo->head, fifo->head + length);
+}
+/**
+ * @brief Pops data from FIFO
+ * @param fifo Pointer to FIFO structure
+ * @param data Pointer to store popped data
+ * @retval FIFO_OK Data popped
  * @retval FIFO_EMPTY FIFO is empty
  */
-FifoResultCode Fifo_pop(Fifo* fifo, char* c) {
-  if (fifo->count == 0) {
+FifoResultCode Fifo_pop(Fifo* fifo, char* data) {
+
+  unsigned int tail = fifo->tail;
+
+  if (LOAD_ACQUIRE(fifo->head) == tail) {
     return FIFO_EMPTY;
   }
 
-  *c = fifo->dataBuffer[fifo->tail++];
-  fifo->count--;
+  *data = fifo->dataBuffer[tail & fifo->mask];
+  STORE_RELEASE(fifo->tail, tail + 1);
 
-  if (fifo->tail == fifo->length) {
-    fifo->tail = 0; // start from beginning
+  return FIFO_OK;
+}
+/**
+ * @brief Pops multiple bytes from FIFO
+ * @param fifo Pointer to FIFO structure
+ * @param data Buffer for popped data
+ * @param maximumLength Size of the buffer
+ * @return Number of bytes popped
+ */
+int Fifo_popMultiple(Fifo* fifo, char* data, int maximumLength) {
+
+  unsigned int tail = fifo->tail;
+  int length = (int)(LOAD_ACQUIRE(fifo->head) - tail);
+
+  if (length > maximumLength) {
+    length = maximumLength;
+  }
+  if (length <= 0) {
+    return 0;
   }
 
+  unsigned int start = tail & fifo->mask;
+  int firstPart = fifo->length - start;
+  if (firstPart > length) {
+    firstPart = length;
+  }
+  memcpy(data, fifo->dataBuffer + start, firstPart);
+  memcpy(data + firstPart, fifo->dataBuffer, length - firstPart);
+  STORE_RELEASE(fifo->tail, tail + length);
+
+  return length;
+}
+/**
+ * @brief Reads data from FIFO without removing it
+ * @param fifo Pointer to FIFO structure
+ * @param offset Position counted from the oldest byte
+ * @param data Pointer to store data
+ * @retval FIFO_OK Data read
+ * @retval FIFO_EMPTY Less than offset + 1 bytes in FIFO
+ */
+FifoResultCode Fifo_peek(Fifo* fifo, int offset, char* data) {
+
+  unsigned int tail = fifo->tail;
+
+  if (offset < 0 || (int)(LOAD_ACQUIRE(fifo->head) - tail) <= offset) {
+    return FIFO_EMPTY;
+  }
+  *data = fifo->dataBuffer[(tail + offset) & fifo->mask];
   return FIFO_OK;
 }
 /**
- * @brief Checks whether the FIFO is empty.
+ * @brief Finds the first occurrence of a character in FIFO
+ * @details Searches both contiguous parts of the data with memchr.
  * @param fifo Pointer to FIFO structure
- * @retval TRUE FIFO is empty
- * @retval FALSE FIFO is not empty
+ * @param searchedCharacter Character to find
+ * @return Offset of the character counted from the oldest byte or -1 if not found
  */
-Boolean Fifo_isEmpty(Fifo * fifo) {
-  if (fifo->count == 0) {
-    return TRUE;
+int Fifo_find(Fifo* fifo, char searchedCharacter) {
+
+  unsigned int tail = fifo->tail;
+  int count = (int)(LOAD_ACQUIRE(fifo->head) - tail);
+  unsigned int start = tail & fifo->mask;
+  int firstPart = fifo->length - start;
+  if (firstPart > count) {
+    firstPart = count;
   }
-  return FALSE;
+
+  const char* found = memchr(fifo->dataBuffer + start, searchedCharacter, firstPart);
+  if (found != NULL) {
+    return found - (fifo->dataBuffer + start);
+  }
+  found = memchr(fifo->dataBuffer, searchedCharacter, count - firstPart);
+  if (found != NULL) {
+    return firstPart + (found - fifo->dataBuffer);
+  }
+  return -1;
 }
 /**
- * @brief Flush the FIFO
+ * @brief Gets the contiguous data after tail
+ * @details The consumer can read (or send by DMA) directly from the span
+ * and then call Fifo_consume. Data which wraps around the end of the buffer
+ * is returned by the next call.
+ * @param fifo Pointer to FIFO structure
+ * @return Readable span (length 0 if FIFO is empty)
+ */
+FifoSpan Fifo_getReadableSpan(Fifo* fifo) {
+
+  unsigned int tail = fifo->tail;
+  int count = (int)(LOAD_ACQUIRE(fifo->head) - tail);
+  unsigned int start = tail & fifo->mask;
+  int contiguous = fifo->length - start;
+
+  FifoSpan span;
+  span.data = fifo->dataBuffer + start;
+  span.length = (count < contiguous) ? count : contiguous;
+  return span;
+}
+/**
+ * @brief Removes data read from the readable span
+ * @param fifo Pointer to FIFO structure
+ * @param length Number of bytes to remove
+ */
+void Fifo_consume(Fifo* fifo, int length) {
+  STORE_RELEASE(fifo->tail, fifo->tail + length);
+}
+/**
+ * @brief Removes all data from FIFO
+ * @details Consumer side function - drops everything pushed so far.
  * @param fifo Pointer to FIFO structure
  */
 void Fifo_flush(Fifo * fifo) {
-  fifo->tail  = 0;
-  fifo->head  = 0;
-  fifo->count = 0;
+  STORE_RELEASE(fifo->tail, LOAD_ACQUIRE(fifo->head));
 }
 /**
  * @}
@@ -32,30 +32,55 @@
 
 /**
  * @brief FIFO structure typedef.
+ * @details Single producer, single consumer ring buffer. Only the producer
+ * writes head and only the consumer writes tail, so one side can run in an
+ * IRQ and the other in main without disabling interrupts. Both indices run
+ * freely and are masked with the power of two length.
  */
 typedef struct {
-  int   head;       ///< Head
-  int   tail;       ///< Tail
-  char* dataBuffer; ///< Pointer to buffer
-  int   length;     ///< Maximum length of FIFO
-  int   count;      ///< Current number of data elements
+  volatile unsigned int head; ///< Write index (modified by producer only)
+  volatile unsigned int tail; ///< Read index (modified by consumer only)
+  char* dataBuffer;           ///< Pointer to buffer
+  int   length;               ///< Maximum length of FIFO (power of two)
+  unsigned int mask;          ///< Mask for indexing the buffer (length - 1)
 } Fifo;
+/**
+ * @brief Contiguous part of the FIFO buffer
+ */
+typedef struct {
+  char* data;   ///< Start of the span
+  int   length; ///< Number of bytes in the span
+} FifoSpan;
 /**
  * @brief Error codes
  */
 typedef enum {
-  FIFO_OK,         //!< FIFO_OK
-  FIFO_ZERO_LENGTH,//!< FIFO_ZERO_LENGTH
-  FIFO_NULL_BUFFER,//!< FIFO_NULL_BUFFER
-  FIFO_FULL,       //!< FIFO_FULL
-  FIFO_EMPTY,      //!< FIFO_EMPTY
+  FIFO_OK,            //!< FIFO_OK
+  FIFO_ZERO_LENGTH,   //!< FIFO_ZERO_LENGTH
+  FIFO_NULL_BUFFER,   //!< FIFO_NULL_BUFFER
+  FIFO_FULL,          //!< FIFO_FULL
+  FIFO_EMPTY,         //!< FIFO_EMPTY
+  FIFO_INVALID_LENGTH,//!< FIFO_INVALID_LENGTH (not a power of two)
 } FifoResultCode;
 
-FifoResultCode Fifo_addNewFifo (Fifo * fifo, char * dataBuffer, int length);
-FifoResultCode Fifo_push       (Fifo * fifo, char newData);
-FifoResultCode Fifo_pop        (Fifo * fifo, char * data);
-Boolean        Fifo_isEmpty    (Fifo * fifo);
-void           Fifo_flush      (Fifo * fifo);
+// setup and state
+FifoResultCode Fifo_addNewFifo      (Fifo * fifo, char * dataBuffer, int length);
+Boolean        Fifo_isEmpty         (Fifo * fifo);
+int            Fifo_getCount        (Fifo * fifo);
+int            Fifo_getFreeSpace    (Fifo * fifo);
+// producer side
+FifoResultCode Fifo_push            (Fifo * fifo, char newData);
+int            Fifo_pushMultiple    (Fifo * fifo, const char * data, int length);
+FifoSpan       Fifo_getWritableSpan (Fifo * fifo);
+void           Fifo_commit          (Fifo * fifo, int length);
+// consumer side
+FifoResultCode Fifo_pop             (Fifo * fifo, char * data);
+int            Fifo_popMultiple     (Fifo * fifo, char * data, int maximumLength);
+FifoResultCode Fifo_peek            (Fifo * fifo, int offset, char * data);
+int            Fifo_find            (Fifo * fifo, char searchedCharacter);
+FifoSpan       Fifo_getReadableSpan (Fifo * fifo);
+void           Fifo_consume         (Fifo * fifo, int length);
+void           Fifo_flush           (Fifo * fifo);
 /**
  * @}
  */
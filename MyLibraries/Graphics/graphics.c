@@ -17,6 +17,7 @@
 
 #include "graphics.h"
 #include "ili9320.h"
+#include "profiler.h"
 #include <math.h>
 #include <string.h>
 
@@ -26,6 +27,7 @@
  */
 
 #define RGB_TO_UNSIGNED_INT(red, green, blue) ((unsigned int)(((red)<<16)|((green)<<8)|(blue)))
+#define PIXEL_BUFFER_LENGTH 64 ///< Number of pixels sent to the driver at once
 
 GRAPH_LcdDriverTypedef lcdDriver;
 
@@ -50,8 +52,19 @@ typedef struct {
   uint32_t importantColors;
 } BMP_File;
 
+/**
+ * @brief Pixels collected for writePixels of the driver
+ */
+typedef struct {
+  uint16_t pixels[PIXEL_BUFFER_LENGTH]; ///< Colors in 565 format
+  int count;                            ///< Number of collected pixels
+} PixelBuffer;
+
 static GRAPH_FontTypedef currentFont;         ///< Currently set font
 
+static void addPixel(PixelBuffer* buffer, unsigned int convertedColor);
+static void flushPixels(PixelBuffer* buffer);
+
 /**
  * @brief Convert RGB value to 565 format.
  * @param rgbColor Color
@@ -90,10 +103,15 @@ void GRAPH_ClearScreen(unsigned int rgbColor) {
  */
 void GRAPH_DrawFilledRectangle(int x, int y, int width, int height, unsigned int color) {
 
+  PROFILER_ZONE(graphDrawFilledRectangle);
   unsigned int convertedColor = GRAPH_ConvertRgbTo565(color);
 
   lcdDriver.setWindow(x, y, width, height);
   lcdDriver.setGramAddress(x, y);
+  if (lcdDriver.fillRect != NULL) {
+    lcdDriver.fillRect(convertedColor, width * height);
+    return;
+  }
   for (int i = 0; i < width * height; i++) {
     lcdDriver.drawNextPixel(convertedColor);
   }
@@ -121,6 +139,7 @@ void GRAPH_DrawImage(int x, int y, GRAPH_ImageTypedef * image, Boolean flipped)
 
   unsigned int red, green, blue, rgbColor;
   int currentPosition;
+  PixelBuffer buffer = {.count = 0};
   lcdDriver.horizontalGramUpdate();
   lcdDriver.setWindow(x, y, image->columns, image->rows);
   lcdDriver.setGramAddress(x, y);
@@ -132,9 +151,10 @@ void GRAPH_DrawImage(int x, int y, GRAPH_ImageTypedef * image, Boolean flipped)
       green = image->data[currentPosition+GREEN_PIXEL_DATA];
       blue = image->data[currentPosition+BLUE_PIXEL_DATA];
       rgbColor = RGB_TO_UNSIGNED_INT(red, green, blue);
-      lcdDriver.drawNextPixel(GRAPH_ConvertRgbTo565(rgbColor));
+      addPixel(&buffer, GRAPH_ConvertRgbTo565(rgbColor));
     }
   }
+  flushPixels(&buffer);
   lcdDriver.verticalGramUpdate();
 }
 /**
@@ -172,19 +192,21 @@ void GRAPH_DrawChar(char character, int x, int y, unsigned int foregroundColor,
       currentFont.bytesPerColumn * rowInCharacterTable; // first byte of row
 
   int bitmask;
+  PixelBuffer buffer = {.count = 0};
 
   for (int i = 0; i < currentFont.columnCount; i++) {
     for (int j = 0; j < currentFont.bytesPerColumn; j++) {
       bitmask = 0x01; // start from lowest bit
       for (int k = 0; k < BITS_PER_BYTE; k++, bitmask <<= 1) { // for 8 bits in byte
         if (currentFont.data[currentPosition + i * currentFont.bytesPerColumn + j] & bitmask) {
-          lcdDriver.drawNextPixel(convertedForegroundColor);
+          addPixel(&buffer, convertedForegroundColor);
         } else {
-          lcdDriver.drawNextPixel(convertedBackgroundColor);
+          addPixel(&buffer, convertedBackgroundColor);
         }
       }
     }
   }
+  flushPixels(&buffer);
 }
 /**
  * @brief Writes a string on the LCD
@@ -375,7 +397,31 @@ void GRAPH_DrawLine(int x1, int y1, int x2, int y2, unsigned int foregroundColor
     }
   }
 }
-
+/**
+ * @brief Adds a pixel to the buffer (drawn at once if the driver can't write buffers)
+ * @param buffer Pixel buffer
+ * @param convertedColor Color in 565 format
+ */
+void addPixel(PixelBuffer* buffer, unsigned int convertedColor) {
+  if (lcdDriver.writePixels == NULL) {
+    lcdDriver.drawNextPixel(convertedColor);
+    return;
+  }
+  buffer->pixels[buffer->count++] = convertedColor;
+  if (buffer->count == PIXEL_BUFFER_LENGTH) {
+    flushPixels(buffer);
+  }
+}
+/**
+ * @brief Sends the collected pixels to the driver
+ * @param buffer Pixel buffer
+ */
+void flushPixels(PixelBuffer* buffer) {
+  if (buffer->count > 0) {
+    lcdDriver.writePixels(buffer->pixels, buffer->count);
+    buffer->count = 0;
+  }
+}
 /**
  * @}
  */
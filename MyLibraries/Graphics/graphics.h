@@ -69,6 +69,12 @@ typedef struct {
   int bytesPerPixel;  ///< Number of bytes per pixel
 } GRAPH_ImageTypedef;
 
+/**
+ * @brief LCD driver functions
+ * @details fillRect and writePixels draw many pixels at the next GRAM
+ * addresses at once (colors in 565 format). They are optional - when set
+ * to NULL the pixels are drawn one by one with drawNextPixel.
+ */
 typedef struct {
   int width;
   int height;
@@ -76,6 +82,8 @@ typedef struct {
   void (*drawPixel)(int x, int y, unsigned int rgbColor);
   void (*setGramAddress)(int x, int y);
   void (*drawNextPixel)(unsigned int rgbColor);
+  void (*fillRect)(unsigned int rgbColor, int count);
+  void (*writePixels)(const uint16_t* pixels, int count);
   void (*setWindow)(int x, int y, int width, int height);
   void (*horizontalGramUpdate)(void);
   void (*verticalGramUpdate)(void);
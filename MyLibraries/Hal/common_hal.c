@@ -19,6 +19,7 @@
 #include "common_hal.h"
 #include "led_hal.h"
 #include "utils.h"
+#include <stdio.h>
 
 #ifdef BOARD_STM32F4_DISCOVERY
   #define HAL_ERROR_LED_NUMBER 3 ///< Number of LED for HAL errors
@@ -145,29 +146,45 @@ static void systemClockConfig(void) {
   }
 }
 /**
-  * @brief  Configure the MPU attributes as Write Through for SRAM1/2.
+  * @brief  Configure the MPU attributes as Write Back for SRAM1/2 and as
+  *         non-cacheable for the DMA buffers in SRAM2.
   * @note   The Base Address is 0x20010000 since this memory interface is the AXI.
   *         The Region Size is 256KB, it is related to SRAM1 and SRAM2  memory size.
+  *         Drivers keep DMA buffers in SRAM1 coherent with the DMA_BUFFER
+  *         functions, buffers in SRAM2 (DMARAM in mem.ld) need no maintenance.
   */
 static void configureMpu(void) {
+  extern char _dma_ram_start; // SRAM2 - has to match the region size
   MPU_Region_InitTypeDef mpuInitialization;
   HAL_MPU_Disable();
 
-  /* Configure the MPU attributes as WT for SRAM */
+  /* Configure the MPU attributes as WB with write allocate for SRAM */
   mpuInitialization.Enable = MPU_REGION_ENABLE;
   mpuInitialization.BaseAddress = 0x20010000;
   mpuInitialization.Size = MPU_REGION_SIZE_256KB;
   mpuInitialization.AccessPermission = MPU_REGION_FULL_ACCESS;
-  mpuInitialization.IsBufferable = MPU_ACCESS_NOT_BUFFERABLE;
+  mpuInitialization.IsBufferable = MPU_ACCESS_BUFFERABLE;
   mpuInitialization.IsCacheable = MPU_ACCESS_CACHEABLE;
   mpuInitialization.IsShareable = MPU_ACCESS_NOT_SHAREABLE;
   mpuInitialization.Number = MPU_REGION_NUMBER0;
-  mpuInitialization.TypeExtField = MPU_TEX_LEVEL0;
+  mpuInitialization.TypeExtField = MPU_TEX_LEVEL1;
   mpuInitialization.SubRegionDisable = 0x00;
   mpuInitialization.DisableExec = MPU_INSTRUCTION_ACCESS_ENABLE;
 
   HAL_MPU_ConfigRegion(&mpuInitialization);
 
+  /* Configure the MPU attributes as non-cacheable for SRAM2 (overrides region 0) */
+  mpuInitialization.BaseAddress = (uint32_t)(uintptr_t)&_dma_ram_start;
+  mpuInitialization.Size = MPU_REGION_SIZE_16KB;
+  mpuInitialization.IsBufferable = MPU_ACCESS_NOT_BUFFERABLE;
+  mpuInitialization.IsCacheable = MPU_ACCESS_NOT_CACHEABLE;
+  mpuInitialization.IsShareable = MPU_ACCESS_SHAREABLE;
+  mpuInitialization.Number = MPU_REGION_NUMBER1;
+  mpuInitialization.TypeExtField = MPU_TEX_LEVEL1;
+  mpuInitialization.DisableExec = MPU_INSTRUCTION_ACCESS_DISABLE;
+
+  HAL_MPU_ConfigRegion(&mpuInitialization);
+
   HAL_MPU_Enable(MPU_PRIVILEGED_DEFAULT);
 }
 /**
@@ -188,7 +205,7 @@ void CommonHal_initialize(void) {
   LedHal_changeLedState(HAL_ERROR_LED_NUMBER, FALSE);
 
 #ifdef BOARD_STM32F7_DISCOVERY
-  /* Configure the MPU attributes as Write Through */
+  /* Configure the MPU attributes as Write Back (DMA buffers non-cacheable) */
   configureMpu();
 
   /* Enable the CPU Cache */
@@ -214,6 +231,73 @@ void CommonHal_errorHandler(void) {
 
   }
 }
+/**
+ * @brief Puts the core to sleep (WFI) until the next interrupt
+ * @details The pending work is checked with IRQs disabled - an IRQ coming
+ * after the check still wakes up WFI, so its event can't be missed. Peripherals
+ * (timers, DMA, USART) keep running in sleep mode.
+ * @param hasPendingWork Function returning TRUE if the core shouldn't sleep (may be NULL)
+ */
+void CommonHal_sleepUntilInterrupt(Boolean (*hasPendingWork)(void)) {
+  __disable_irq();
+  if (hasPendingWork == NULL || !hasPendingWork()) {
+    __DSB();
+    __WFI();
+  }
+  __enable_irq();
+}
+/**
+ * @brief Prints the use of FLASH, RAM and core coupled RAM (FASTRAM) per section
+ * @details Sizes come from the linker script symbols. The heap is the part of
+ * RAM after .noinit, the main stack is at the end of FASTRAM - its current
+ * depth is measured from the stack pointer.
+ */
+void CommonHal_printMemoryMap(void) {
+  // linker script symbols - only their addresses are meaningful
+  extern char _flash_start, _flash_end, _etext, _sifast_data;
+  extern char _ram_start, _ram_end, _sdata, _edata, _sbss, _ebss, _noinit, _end_noinit;
+  extern char _fast_ram_start, _fast_ram_end, _sfast_data, _efast_data, _sfast_bss, _efast_bss;
+  extern char _sdma_buffers, _edma_buffers;
+  extern char _estack, _Minimum_Stack_Size;
+  const struct {
+    const char* name;
+    const char* start;
+    const char* end;
+  } SECTIONS[] = {
+    {".text",        &_flash_start,  &_etext},
+    {".data",        &_sdata,        &_edata},
+    {".bss",         &_sbss,         &_ebss},
+    {".dma_buffers", &_sdma_buffers, &_edma_buffers},
+    {".noinit",      &_noinit,       &_end_noinit},
+    {"heap",         &_end_noinit,   &_ram_end},
+    {".fast_data",   &_sfast_data,   &_efast_data},
+    {".fast_bss",    &_sfast_bss,    &_efast_bss},
+    {"stack",        &_efast_bss,    &_estack},
+  };
+  const struct {
+    const char* name;
+    const char* start;
+    const char* end;
+    const char* used;
+  } REGIONS[] = {
+    {"FLASH",   &_flash_start,    &_flash_end,    &_sifast_data +
+        (&_efast_data - &_sfast_data)},
+    {"RAM",     &_ram_start,      &_ram_end,      &_end_noinit},
+    {"FASTRAM", &_fast_ram_start, &_fast_ram_end, &_efast_bss},
+  };
+  printf("MEMORY--> %-12s %10s %8s\r\n", "section", "start", "size");
+  for (unsigned int i = 0; i < sizeof(SECTIONS) / sizeof(SECTIONS[0]); i++) {
+    printf("MEMORY--> %-12s 0x%08x %8u\r\n", SECTIONS[i].name,
+        (unsigned int)(uintptr_t)SECTIONS[i].start, (unsigned int)(SECTIONS[i].end - SECTIONS[i].start));
+  }
+  for (unsigned int i = 0; i < sizeof(REGIONS) / sizeof(REGIONS[0]); i++) {
+    printf("MEMORY--> %-12s %8u of %8u bytes used\r\n", REGIONS[i].name,
+        (unsigned int)(REGIONS[i].used - REGIONS[i].start),
+        (unsigned int)(REGIONS[i].end - REGIONS[i].start));
+  }
+  printf("MEMORY--> stack depth %u bytes (minimum reserved %u)\r\n",
+      (unsigned int)(&_estack - (char*)(uintptr_t)__get_MSP()), (unsigned int)(uintptr_t)&_Minimum_Stack_Size);
+}
 /**
   * @brief   This function handles NMI exception.
   */
@@ -20,8 +20,11 @@
 #define INC_COMMON_HAL_H_
 
 #include "boards.h"
+#include "utils.h"
 
 void CommonHal_initialize(void);
 void CommonHal_errorHandler(void);
+void CommonHal_sleepUntilInterrupt(Boolean (*hasPendingWork)(void));
+void CommonHal_printMemoryMap(void);
 
 #endif /* INC_COMMON_HAL_H_ */
@@ -0,0 +1,138 @@
+/**
+ * @file    dma_buffer.c
+ * @brief   DMA buffers coherent with the data cache
+ * @date    19.10.2026
+ * @author  Michal Ksiezopolski
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#include "dma_buffer.h"
+#include "boards.h"
+
+/**
+ * @addtogroup DMA_BUFFER
+ * @{
+ */
+
+#ifdef BOARD_STM32F7_DISCOVERY
+static uint32_t getDataCacheSize(void);
+#endif
+
+/**
+ * @brief Writes the buffer back from the D-cache, so DMA reads current data
+ * @param buffer Buffer (does not have to be aligned)
+ * @param length Buffer length
+ */
+void DmaBuffer_cleanBeforeTransmit(const void* buffer, size_t length) {
+#ifdef BOARD_STM32F7_DISCOVERY
+  if (!DmaBuffer_isCacheable(buffer, length)) {
+    return;
+  }
+  uintptr_t start = (uintptr_t)buffer & ~(DMA_BUFFER_CACHE_LINE_SIZE - 1);
+  uintptr_t end = DMA_BUFFER_SIZE((uintptr_t)buffer + length);
+  if (end - start > getDataCacheSize()) {
+    SCB_CleanDCache(); // cheaper than walking more lines than the cache holds
+  } else {
+    SCB_CleanDCache_by_Addr((uint32_t*)start, (int32_t)(end - start));
+  }
+#endif
+}
+/**
+ * @brief Removes the buffer from the D-cache before DMA writes it
+ * @details Dirty lines written back later would overwrite the received data.
+ * @param buffer Buffer (DMA_BUFFER)
+ * @param length Buffer length
+ */
+void DmaBuffer_invalidateBeforeReceive(void* buffer, size_t length) {
+#ifdef BOARD_STM32F7_DISCOVERY
+  if (!DmaBuffer_isCacheable(buffer, length)) {
+    return;
+  }
+  uintptr_t start = (uintptr_t)buffer & ~(DMA_BUFFER_CACHE_LINE_SIZE - 1);
+  uintptr_t end = DMA_BUFFER_SIZE((uintptr_t)buffer + length);
+  if (end - start > getDataCacheSize()) {
+    SCB_CleanInvalidateDCache();
+  } else {
+    SCB_CleanInvalidateDCache_by_Addr((uint32_t*)start, (int32_t)(end - start));
+  }
+#endif
+}
+/**
+ * @brief Discards cached lines of the buffer after DMA wrote it
+ * @details The core may have loaded the lines again during the transfer
+ * (speculative reads). Lines shared with other data at unaligned ends are
+ * cleaned as well - their data written by the core during the transfer is
+ * kept, but the received bytes in them may be lost, so use DMA_BUFFER.
+ * @param buffer Buffer (DMA_BUFFER)
+ * @param length Buffer length
+ */
+void DmaBuffer_invalidateAfterReceive(void* buffer, size_t length) {
+#ifdef BOARD_STM32F7_DISCOVERY
+  if (!DmaBuffer_isCacheable(buffer, length)) {
+    return;
+  }
+  uintptr_t start = (uintptr_t)buffer & ~(DMA_BUFFER_CACHE_LINE_SIZE - 1);
+  uintptr_t end = DMA_BUFFER_SIZE((uintptr_t)buffer + length);
+  if (end - start > getDataCacheSize()) {
+    // the buffer has no dirty lines since DmaBuffer_invalidateBeforeReceive
+    SCB_CleanInvalidateDCache();
+    return;
+  }
+  if (start != (uintptr_t)buffer) {
+    SCB_CleanInvalidateDCache_by_Addr((uint32_t*)start, DMA_BUFFER_CACHE_LINE_SIZE);
+    start += DMA_BUFFER_CACHE_LINE_SIZE;
+  }
+  if (end > start && end != (uintptr_t)buffer + length) {
+    end -= DMA_BUFFER_CACHE_LINE_SIZE;
+    SCB_CleanInvalidateDCache_by_Addr((uint32_t*)end, DMA_BUFFER_CACHE_LINE_SIZE);
+  }
+  if (end > start) {
+    SCB_InvalidateDCache_by_Addr((uint32_t*)start, (int32_t)(end - start));
+  }
+#endif
+}
+/**
+ * @brief Checks if the buffer needs cache maintenance
+ * @param buffer Buffer
+ * @param length Buffer length
+ * @return TRUE if a part of the buffer is in the cached RAM
+ */
+Boolean DmaBuffer_isCacheable(const void* buffer, size_t length) {
+#ifdef BOARD_STM32F7_DISCOVERY
+  // only SRAM1 is cached - DTCM, SRAM2 and flash (never written by the core) are skipped
+  extern char _ram_start, _ram_end;
+  const char* address = buffer;
+  return (address < &_ram_end && address + length > &_ram_start) ? TRUE : FALSE;
+#else
+  return FALSE;
+#endif
+}
+#ifdef BOARD_STM32F7_DISCOVERY
+/**
+ * @brief Gets the size of the D-cache (read from the cache size ID register once)
+ * @return Size of D-cache in bytes
+ */
+uint32_t getDataCacheSize(void) {
+  static uint32_t dataCacheSize;
+  if (dataCacheSize == 0) {
+    SCB->CSSELR = 0; // level 1 data cache
+    __DSB();
+    uint32_t ccsidr = SCB->CCSIDR;
+    dataCacheSize = (CCSIDR_SETS(ccsidr) + 1) * (CCSIDR_WAYS(ccsidr) + 1) *
+        DMA_BUFFER_CACHE_LINE_SIZE;
+  }
+  return dataCacheSize;
+}
+#endif
+/**
+ * @}
+ */
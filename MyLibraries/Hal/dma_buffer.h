@@ -0,0 +1,89 @@
+/**
+ * @file    dma_buffer.h
+ * @brief   DMA buffers coherent with the data cache
+ * @details On the F7 the D-cache sits between the core and SRAM1, while DMA
+ * streams access the memory directly. A driver keeps its buffers coherent
+ * with the cache in one of two ways:
+ * - A cacheable buffer defined with DMA_BUFFER (whole cache lines, so no
+ *   other data shares its lines) and maintained around every transfer:
+ *   DmaBuffer_cleanBeforeTransmit before DMA reads it,
+ *   DmaBuffer_invalidateBeforeReceive before DMA writes it and
+ *   DmaBuffer_invalidateAfterReceive before the core reads what DMA wrote.
+ *   Only the lines of the transfer are touched, the rest of the cache keeps
+ *   working.
+ * - A buffer placed in the non-cacheable SRAM2 with DMA_NONCACHEABLE. No
+ *   maintenance is needed, every core access goes to the memory. Best for
+ *   descriptors and small buffers read or written piece by piece.
+ * @code
+ * static DMA_BUFFER(sectorBuffer, 512);
+ *
+ * DmaBuffer_invalidateBeforeReceive(sectorBuffer, 512);
+ * ... start DMA into sectorBuffer, wait for completion ...
+ * DmaBuffer_invalidateAfterReceive(sectorBuffer, 512);
+ *
+ * static MEMORY_POOL_BUFFER(frameBuffer, FRAME_LENGTH, 8) DMA_NONCACHEABLE;
+ * @endcode
+ * The functions skip buffers which are not cached (DTCM, SRAM2) and do
+ * nothing on the F4, which has no data cache.
+ * @date    19.10.2026
+ * @author  Michal Ksiezopolski
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#ifndef DMA_BUFFER_H_
+#define DMA_BUFFER_H_
+
+#include "utils.h"
+#include <inttypes.h>
+#include <stddef.h>
+
+/**
+ * @defgroup  DMA_BUFFER DMA_BUFFER
+ * @brief     DMA buffers coherent with the data cache
+ */
+
+/**
+ * @addtogroup DMA_BUFFER
+ * @{
+ */
+
+#define DMA_BUFFER_CACHE_LINE_SIZE 32 ///< Size of a D-cache line of the Cortex-M7
+
+/**
+ * @brief Aligns a variable or structure field to a cache line
+ */
+#define DMA_BUFFER_ALIGNED __attribute__((aligned(DMA_BUFFER_CACHE_LINE_SIZE)))
+/**
+ * @brief Length rounded up to whole cache lines
+ */
+#define DMA_BUFFER_SIZE(length) \
+  (((length) + DMA_BUFFER_CACHE_LINE_SIZE - 1) & ~(DMA_BUFFER_CACHE_LINE_SIZE - 1))
+/**
+ * @brief Defines a cacheable DMA buffer occupying whole cache lines
+ */
+#define DMA_BUFFER(buffer, length) \
+  uint8_t buffer[DMA_BUFFER_SIZE(length)] DMA_BUFFER_ALIGNED
+/**
+ * @brief Places a static variable in the non-cacheable DMA RAM
+ * @details The variable is not initialized by the startup code.
+ */
+#define DMA_NONCACHEABLE __attribute__((section(".dma_buffers")))
+
+void    DmaBuffer_cleanBeforeTransmit     (const void* buffer, size_t length);
+void    DmaBuffer_invalidateBeforeReceive (void* buffer, size_t length);
+void    DmaBuffer_invalidateAfterReceive  (void* buffer, size_t length);
+Boolean DmaBuffer_isCacheable             (const void* buffer, size_t length);
+/**
+ * @}
+ */
+
+#endif /* DMA_BUFFER_H_ */
@@ -7,6 +7,7 @@
 
 #include "hardware_timers.h"
 #include "common_hal.h"
+#include "irq_monitor.h"
 
 #define NUMBER_OF_HARDWARE_TIMERS 1
 
@@ -15,12 +16,19 @@
 typedef struct {
   TIM_HandleTypeDef * handle;
   void (*overflowCb)(void);
+  void (*compareCb)(void);      ///< Callback for compare channel 1 match
+  uint32_t previousCount;       ///< Counter value at last 64 bit read
+  uint32_t counterWraps;        ///< Number of counter wraps (upper 32 bits)
   Boolean isInitialzed;
 } TimerControl;
 
 static TimerControl timerControl[NUMBER_OF_HARDWARE_TIMERS];
 static TIM_HandleTypeDef timer5Handle; ///< Timer 5 handle
 
+#ifdef IRQ_MONITOR_ENABLE
+static uint32_t getCyclesSinceEvent(TIM_HandleTypeDef* handle);
+#endif
+
 /**
  * @brief Initalize system timer
  * @param timer Timer number
@@ -67,10 +75,107 @@ void HardwareTimers_configureTimerAsIrqWithCallback(HardwareTimers timer, int fr
     CommonHal_errorHandler();
   }
 }
+/**
+ * @brief Starts a 32 bit timer counting freely (no overflow IRQs)
+ * @details Compare channel 1 generates an IRQ when the counter reaches the value
+ * set by HardwareTimers_setCompare. The timer keeps counting in sleep mode.
+ * @param timer Timer number
+ * @param countingFrequencyHz Counter frequency in Hz (e.g. 1000000 for microseconds)
+ * @param compareCb Callback for compare match (called from IRQ)
+ */
+void HardwareTimers_configureTimerAsFreeRunningWithCompare(HardwareTimers timer,
+    int countingFrequencyHz, void (*compareCb)(void)) {
+  uint32_t coreClockToTimerClockRatio;
+  switch (timer) {
+  case HARDWARE_TIMERS_TIMER5:
+    // TIM5 clock runs at half of the core clock
+    coreClockToTimerClockRatio = 2;
+    __HAL_RCC_TIM5_CLK_ENABLE();
+    HAL_NVIC_SetPriority(TIM5_IRQn, TIMER5_IRQ_PRIORITY, 0);
+    HAL_NVIC_EnableIRQ(TIM5_IRQn);
+    timerControl[timer].handle = &timer5Handle;
+    timer5Handle.Instance = TIM5;
+    break;
+  default:
+    return;
+  }
+  timerControl[timer].isInitialzed = TRUE;
+  timerControl[timer].compareCb = compareCb;
+  timerControl[timer].previousCount = 0;
+  timerControl[timer].counterWraps = 0;
+
+  const int TIMER_START_COUNT_FROM_ZERO_OFFSET = 1;
+  timerControl[timer].handle->Init.Period = UINT32_MAX;
+  timerControl[timer].handle->Init.Prescaler = SystemCoreClock / coreClockToTimerClockRatio /
+      countingFrequencyHz - TIMER_START_COUNT_FROM_ZERO_OFFSET;
+  timerControl[timer].handle->Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
+  timerControl[timer].handle->Init.CounterMode = TIM_COUNTERMODE_UP;
+  timerControl[timer].handle->Init.RepetitionCounter = 0;
+  if (HAL_TIM_Base_Init(timerControl[timer].handle) != HAL_OK) {
+    CommonHal_errorHandler();
+  }
+  // channel 1 stays in the reset (frozen output compare) mode - only the flag is used
+  if (HAL_TIM_Base_Start(timerControl[timer].handle) != HAL_OK) {
+    CommonHal_errorHandler();
+  }
+}
+/**
+ * @brief Gets the counter value
+ * @param timer Timer number
+ * @return Counter value
+ */
+uint32_t HardwareTimers_getCounter(HardwareTimers timer) {
+  return __HAL_TIM_GET_COUNTER(timerControl[timer].handle);
+}
+/**
+ * @brief Gets the counter value extended to 64 bits
+ * @details Counter wraps are counted, so this function has to be called at
+ * least once per wrap period. Can be called from IRQs.
+ * @param timer Timer number
+ * @return Counter value
+ */
+uint64_t HardwareTimers_getCounter64(HardwareTimers timer) {
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+  uint32_t count = __HAL_TIM_GET_COUNTER(timerControl[timer].handle);
+  if (count < timerControl[timer].previousCount) {
+    timerControl[timer].counterWraps++;
+  }
+  timerControl[timer].previousCount = count;
+  uint64_t result = ((uint64_t)timerControl[timer].counterWraps << 32) | count;
+  __set_PRIMASK(primask);
+  return result;
+}
+/**
+ * @brief Sets the value of compare channel 1
+ * @details If the counter has already passed the value, the compare IRQ is
+ * triggered at once, so a deadline is never missed.
+ * @param timer Timer number
+ * @param compareValue Counter value generating the IRQ
+ */
+void HardwareTimers_setCompare(HardwareTimers timer, uint32_t compareValue) {
+  TIM_HandleTypeDef * handle = timerControl[timer].handle;
+  __HAL_TIM_SET_COMPARE(handle, TIM_CHANNEL_1, compareValue);
+  __HAL_TIM_CLEAR_FLAG(handle, TIM_FLAG_CC1);
+  __HAL_TIM_ENABLE_IT(handle, TIM_IT_CC1);
+  if ((int32_t)(__HAL_TIM_GET_COUNTER(handle) - compareValue) >= 0) {
+    handle->Instance->EGR = TIM_EGR_CC1G; // too late - generate the event by software
+  }
+}
 /**
  * @brief This function handles TIM5 interrupt request
  */
 void TIM5_IRQHandler(void) {
+  IRQ_MONITOR(tim5);
+  IRQ_MONITOR_LATENCY(tim5, getCyclesSinceEvent(&timer5Handle));
+  if (__HAL_TIM_GET_FLAG(&timer5Handle, TIM_FLAG_CC1) != RESET) {
+    if (__HAL_TIM_GET_IT_SOURCE(&timer5Handle, TIM_IT_CC1) != RESET) {
+      __HAL_TIM_CLEAR_IT(&timer5Handle, TIM_IT_CC1);
+      if (timerControl[HARDWARE_TIMERS_TIMER5].compareCb) {
+        timerControl[HARDWARE_TIMERS_TIMER5].compareCb();
+      }
+    }
+  }
   if (__HAL_TIM_GET_FLAG(&timer5Handle, TIM_FLAG_UPDATE) != RESET) {
     if (__HAL_TIM_GET_IT_SOURCE(&timer5Handle, TIM_IT_UPDATE) != RESET) {
       __HAL_TIM_CLEAR_IT(&timer5Handle, TIM_IT_UPDATE);
@@ -80,3 +185,21 @@ void TIM5_IRQHandler(void) {
     }
   }
 }
+#ifdef IRQ_MONITOR_ENABLE
+/**
+ * @brief Calculates the time since the event of a timer IRQ (entry latency)
+ * @details The counter restarts at the update event, the compare event is
+ * at the counter value set in the compare register.
+ * @param handle Timer handle
+ * @return Core cycles since the event
+ */
+uint32_t getCyclesSinceEvent(TIM_HandleTypeDef* handle) {
+  const uint32_t CORE_CLOCK_TO_TIMER_CLOCK_RATIO = 2;
+  uint32_t ticks = __HAL_TIM_GET_COUNTER(handle);
+  if (__HAL_TIM_GET_FLAG(handle, TIM_FLAG_CC1) != RESET &&
+      __HAL_TIM_GET_IT_SOURCE(handle, TIM_IT_CC1) != RESET) {
+    ticks -= __HAL_TIM_GET_COMPARE(handle, TIM_CHANNEL_1);
+  }
+  return ticks * (handle->Instance->PSC + 1) * CORE_CLOCK_TO_TIMER_CLOCK_RATIO;
+}
+#endif
@@ -16,5 +16,10 @@ typedef enum {
 
 void HardwareTimers_configureTimerAsIrqWithCallback(HardwareTimers timer, int frequency,
     void (*overflowCb)(void));
+void HardwareTimers_configureTimerAsFreeRunningWithCompare(HardwareTimers timer,
+    int countingFrequencyHz, void (*compareCb)(void));
+uint32_t HardwareTimers_getCounter(HardwareTimers timer);
+uint64_t HardwareTimers_getCounter64(HardwareTimers timer);
+void HardwareTimers_setCompare(HardwareTimers timer, uint32_t compareValue);
 
 #endif /* MYLIBRARIES_HAL_STM32F4_HARDWARE_TIMERS_H_ */
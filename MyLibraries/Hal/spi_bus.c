@@ -0,0 +1,322 @@
+/**
+ * @file    spi_bus.c
+ * @brief   Shared SPI bus with per device settings and a transaction queue
+ * @details Every bus has a queue of transactions which are run back to back
+ * from the SPI IRQ. Before a transaction starts the bus is switched to the
+ * clock, mode and frame size of its device and the chip select of the device
+ * is asserted. Drivers which talk to their device byte by byte (e.g. waiting
+ * for SD card tokens) acquire the bus instead - queued transactions are then
+ * started when the bus is released.
+ * @date    19.10.2026
+ * @author  Michal Ksiezopolski
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#include "spi_bus.h"
+#include "boards.h"
+
+/**
+ * @addtogroup SPI_BUS
+ * @{
+ */
+
+#define NUMBER_OF_BUSES 3 ///< Number of SPI peripherals (SPI_HAL_SPI1 - SPI_HAL_SPI3)
+#define DUMMY_BYTE      0xff
+#define DUMMY_BUFFER_LENGTH 32 ///< Number of dummy bytes sent at once (no data buffers)
+
+/**
+ * @brief Phase of the running transaction
+ */
+typedef enum {
+  PHASE_COMMAND,
+  PHASE_DATA,
+} TransactionPhase;
+
+/**
+ * @brief State of one SPI bus
+ */
+typedef struct {
+  SpiTransaction* head;         ///< First queued transaction
+  SpiTransaction* tail;         ///< Last queued transaction
+  SpiTransaction* current;      ///< Transaction on the bus
+  TransactionPhase phase;       ///< Phase of the current transaction
+  SpiDevice* owner;             ///< Device which acquired the bus
+  int remainingDummyFrames;     ///< Frames left to clock out in a data phase without buffers
+  Boolean isInitialized;        ///< Was the SPI initialized
+} SpiBusControl;
+
+static SpiBusControl buses[NUMBER_OF_BUSES]; ///< The buses
+static uint8_t dummyBuffer[DUMMY_BUFFER_LENGTH] = {
+    [0 ... DUMMY_BUFFER_LENGTH - 1] = DUMMY_BYTE}; ///< Sent when a transaction has no data buffers
+
+static void startNextTransaction(SpiBusControl* bus);
+static void startDataPhase(SpiBusControl* bus);
+static void sendDummyFrames(SpiBusControl* bus);
+static void transferComplete(SpiNumber spi);
+static void selectDevice(SpiDevice* device);
+static void deselectDevice(SpiDevice* device);
+static uint32_t enterCritical(void);
+static void exitCritical(uint32_t primask);
+
+/**
+ * @brief Adds a device to its bus
+ * @details Initializes the SPI the first time and configures the chip select pin.
+ * @param device Device description (has to stay valid)
+ */
+void SpiBus_addDevice(SpiDevice* device) {
+  if (device->spi >= NUMBER_OF_BUSES) {
+    return;
+  }
+  if (!buses[device->spi].isInitialized) {
+    SpiHal_initialize(device->spi);
+    buses[device->spi].isInitialized = TRUE;
+  }
+
+  SpiHal_initializeChipSelect(&device->chipSelect);
+}
+/**
+ * @brief Queues a transaction
+ * @details Can be called from IRQs. The transaction starts immediately if
+ * the bus is free.
+ * @param transaction Transaction to run
+ * @retval TRUE Transaction queued
+ * @retval FALSE Device not added to a bus or transaction already queued or
+ * running - its state is not changed
+ */
+Boolean SpiBus_submit(SpiTransaction* transaction) {
+  if (transaction->device->spi >= NUMBER_OF_BUSES ||
+      !buses[transaction->device->spi].isInitialized) {
+    return FALSE;
+  }
+  SpiBusControl* bus = &buses[transaction->device->spi];
+
+  uint32_t primask = enterCritical();
+  // queuing it twice would break the list
+  if (transaction->state == SPI_TRANSACTION_QUEUED ||
+      transaction->state == SPI_TRANSACTION_RUNNING) {
+    exitCritical(primask);
+    return FALSE;
+  }
+  transaction->state = SPI_TRANSACTION_QUEUED;
+  transaction->next = NULL;
+  if (bus->tail == NULL) {
+    bus->head = transaction;
+  } else {
+    bus->tail->next = transaction;
+  }
+  bus->tail = transaction;
+  startNextTransaction(bus);
+  exitCritical(primask);
+  return TRUE;
+}
+/**
+ * @brief Runs a transaction and waits until it is done
+ * @param transaction Transaction to run
+ * @retval TRUE Transaction done
+ * @retval FALSE Transaction rejected by SpiBus_submit
+ * @warning Blocking function! Must not be called from an IRQ with priority
+ * equal or higher than the SPI IRQ.
+ */
+Boolean SpiBus_transfer(SpiTransaction* transaction) {
+  if (!SpiBus_submit(transaction)) {
+    return FALSE;
+  }
+  while (transaction->state != SPI_TRANSACTION_DONE) {
+    // wait
+  }
+  return TRUE;
+}
+/**
+ * @brief Takes exclusive ownership of the bus
+ * @details Waits for the running transaction, switches the bus to the settings
+ * of the device and selects it. Afterwards the driver can use the SpiHal
+ * functions directly. Queued transactions wait until SpiBus_release.
+ * @param device Device which takes the bus
+ * @warning Blocking function! Not to be used in IRQs.
+ */
+void SpiBus_acquire(SpiDevice* device) {
+  SpiBusControl* bus = &buses[device->spi];
+
+  while (TRUE) {
+    uint32_t primask = enterCritical();
+    if (bus->current == NULL && bus->owner == NULL) {
+      bus->owner = device;
+      exitCritical(primask);
+      break;
+    }
+    exitCritical(primask);
+  }
+  SpiHal_configure(device->spi, &device->configuration);
+  selectDevice(device);
+}
+/**
+ * @brief Gives up ownership of the bus and starts queued transactions
+ * @param device Device which owns the bus
+ */
+void SpiBus_release(SpiDevice* device) {
+  SpiBusControl* bus = &buses[device->spi];
+
+  deselectDevice(device);
+  uint32_t primask = enterCritical();
+  bus->owner = NULL;
+  startNextTransaction(bus);
+  exitCritical(primask);
+}
+/**
+ * @brief Checks if the bus is free
+ * @param spi Bus number
+ * @retval TRUE No transaction queued or running and bus not acquired
+ * @retval FALSE Bus is used
+ */
+Boolean SpiBus_isIdle(SpiNumber spi) {
+  SpiBusControl* bus = &buses[spi];
+  return (bus->head == NULL && bus->current == NULL && bus->owner == NULL);
+}
+/**
+ * @brief Starts the first queued transaction if the bus is free
+ * @details Called with interrupts disabled or from the SPI IRQ.
+ */
+void startNextTransaction(SpiBusControl* bus) {
+  if (bus->current != NULL || bus->owner != NULL || bus->head == NULL) {
+    return;
+  }
+  SpiTransaction* transaction = bus->head;
+  bus->head = transaction->next;
+  if (bus->head == NULL) {
+    bus->tail = NULL;
+  }
+  bus->current = transaction;
+  transaction->state = SPI_TRANSACTION_RUNNING;
+
+  SpiHal_configure(transaction->device->spi, &transaction->device->configuration);
+  selectDevice(transaction->device);
+
+  if (transaction->commandLength > 0) {
+    bus->phase = PHASE_COMMAND;
+    SpiHal_transmitBufferIrq(transaction->device->spi, NULL,
+        transaction->commandBuffer, transaction->commandLength, transferComplete);
+  } else {
+    startDataPhase(bus);
+  }
+}
+/**
+ * @brief Starts the data phase of the current transaction
+ * @details Finishes the transaction if there is no data phase.
+ */
+void startDataPhase(SpiBusControl* bus) {
+  SpiTransaction* transaction = bus->current;
+  bus->phase = PHASE_DATA;
+
+  if (transaction->dataLength == 0) {
+    transferComplete(transaction->device->spi);
+    return;
+  }
+
+  if (transaction->transmitBuffer == NULL && transaction->receiveBuffer == NULL) {
+    // only clocks - no memory to receive into
+    bus->remainingDummyFrames = transaction->dataLength;
+    sendDummyFrames(bus);
+    return;
+  }
+
+  uint8_t* transmitBuffer = transaction->transmitBuffer;
+  if (transmitBuffer == NULL) {
+    // receive only - send dummy bytes from the receive buffer, every byte
+    // is sent before its place in the buffer is overwritten
+    int bytesToReceive = transaction->dataLength;
+    if (transaction->device->configuration.frameSize == SPI_HAL_FRAME_16BIT) {
+      bytesToReceive *= 2;
+    }
+    for (int i = 0; i < bytesToReceive; i++) {
+      transaction->receiveBuffer[i] = DUMMY_BYTE;
+    }
+    transmitBuffer = transaction->receiveBuffer;
+  }
+  SpiHal_transmitBufferIrq(transaction->device->spi, transaction->receiveBuffer,
+      transmitBuffer, transaction->dataLength, transferComplete);
+}
+/**
+ * @brief Sends the next part of the dummy frames of a data phase without buffers
+ */
+void sendDummyFrames(SpiBusControl* bus) {
+  SpiTransaction* transaction = bus->current;
+  int framesInBuffer = DUMMY_BUFFER_LENGTH;
+  if (transaction->device->configuration.frameSize == SPI_HAL_FRAME_16BIT) {
+    framesInBuffer /= 2;
+  }
+  int length = bus->remainingDummyFrames;
+  if (length > framesInBuffer) {
+    length = framesInBuffer;
+  }
+  bus->remainingDummyFrames -= length;
+  SpiHal_transmitBufferIrq(transaction->device->spi, NULL, dummyBuffer, length,
+      transferComplete);
+}
+/**
+ * @brief Called from the SPI IRQ when a phase ends
+ */
+void transferComplete(SpiNumber spi) {
+  SpiBusControl* bus = &buses[spi];
+  SpiTransaction* transaction = bus->current;
+
+  if (transaction == NULL) {
+    return;
+  }
+  if (bus->phase == PHASE_COMMAND) {
+    startDataPhase(bus);
+    return;
+  }
+  if (bus->remainingDummyFrames > 0) {
+    sendDummyFrames(bus);
+    return;
+  }
+
+  deselectDevice(transaction->device);
+  bus->current = NULL;
+  transaction->state = SPI_TRANSACTION_DONE;
+  if (transaction->transactionComplete != NULL) {
+    transaction->transactionComplete(transaction);
+  }
+  startNextTransaction(bus);
+}
+/**
+ * @brief Asserts chip select of the device
+ */
+void selectDevice(SpiDevice* device) {
+  SpiHal_selectChip(&device->chipSelect);
+}
+/**
+ * @brief Deasserts chip select of the device
+ */
+void deselectDevice(SpiDevice* device) {
+  SpiHal_deselectChip(&device->chipSelect);
+}
+/**
+ * @brief Disables interrupts
+ * @return Previous interrupt mask
+ */
+uint32_t enterCritical(void) {
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+  return primask;
+}
+/**
+ * @brief Restores interrupts
+ * @param primask Interrupt mask returned by enterCritical
+ */
+void exitCritical(uint32_t primask) {
+  __set_PRIMASK(primask);
+}
+
+/**
+ * @}
+ */
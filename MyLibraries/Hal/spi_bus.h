@@ -0,0 +1,83 @@
+/**
+ * @file    spi_bus.h
+ * @brief   Shared SPI bus with per device settings and a transaction queue
+ * @date    19.10.2026
+ * @author  Michal Ksiezopolski
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#ifndef SPI_BUS_H_
+#define SPI_BUS_H_
+
+#include "spi_hal.h"
+#include "utils.h"
+
+/**
+ * @defgroup  SPI_BUS SPI_BUS
+ * @brief     Arbitration of SPI buses shared by several devices
+ */
+
+/**
+ * @addtogroup SPI_BUS
+ * @{
+ */
+
+/**
+ * @brief Slave device on an SPI bus
+ */
+typedef struct {
+  SpiNumber spi;                  ///< Bus the device is connected to
+  SpiChipSelect chipSelect;       ///< Chip select pin of the device
+  SpiConfiguration configuration; ///< Clock, mode and frame size of the device
+} SpiDevice;
+
+/**
+ * @brief State of a transaction
+ */
+typedef enum {
+  SPI_TRANSACTION_IDLE,     //!< Not submitted
+  SPI_TRANSACTION_QUEUED,   //!< Waiting for the bus
+  SPI_TRANSACTION_RUNNING,  //!< On the bus
+  SPI_TRANSACTION_DONE,     //!< Finished
+} SpiTransactionState;
+
+/**
+ * @brief One chip select cycle: an optional command phase followed by an optional data phase
+ * @details The structure has to stay valid until the transaction is done. Lengths
+ * are given in frames. Zero it (e.g. with a designated initializer) before the
+ * first submit, so its state is SPI_TRANSACTION_IDLE.
+ */
+typedef struct SpiTransaction {
+  SpiDevice* device;                ///< Addressed device
+  uint8_t* commandBuffer;           ///< Command sent first (received data ignored)
+  int commandLength;                ///< Length of the command
+  uint8_t* transmitBuffer;          ///< Data to send (NULL sends 0xff)
+  uint8_t* receiveBuffer;           ///< Buffer for received data (NULL ignores it, both buffers NULL only clocks out 0xff)
+  int dataLength;                   ///< Length of the data phase
+  void (*transactionComplete)(struct SpiTransaction* transaction); ///< Called from IRQ when done (can be NULL)
+  void* userContext;                ///< Data for the callback
+  volatile SpiTransactionState state; ///< Current state
+  struct SpiTransaction* next;      ///< Next transaction in queue (internal)
+} SpiTransaction;
+
+void    SpiBus_addDevice  (SpiDevice* device);
+Boolean SpiBus_submit     (SpiTransaction* transaction);
+Boolean SpiBus_transfer   (SpiTransaction* transaction);
+void    SpiBus_acquire    (SpiDevice* device);
+void    SpiBus_release    (SpiDevice* device);
+Boolean SpiBus_isIdle     (SpiNumber spi);
+
+/**
+ * @}
+ */
+
+#endif /* SPI_BUS_H_ */
@@ -17,6 +17,7 @@
 
 #include "spi_hal.h"
 #include "common_hal.h"
+#include "profiler.h"
 #ifdef USE_F4_DISCOVERY
   #include <stm32f4xx_hal.h>
 #endif
@@ -66,11 +67,33 @@
 #define SPI1_CS_PIN                      GPIO_PIN_4
 #define SPI1_CS_PORT                     GPIOA
 
+#define SPI_IRQ_PRIORITY  5   ///< Priority of SPI IRQs used by interrupt transfers
+#define NUMBER_OF_SPIS    3   ///< Number of SPI peripherals (SPI_HAL_SPI1 - SPI_HAL_SPI3)
+
 static SPI_HandleTypeDef spi1Handle;
 static SPI_HandleTypeDef spi3Handle;
 
+static void (*transferCompleteCallback[NUMBER_OF_SPIS])(SpiNumber spi); ///< Callbacks of interrupt transfers
+
+static SPI_HandleTypeDef* getHandle(SpiNumber spi);
+#ifndef SPI_HAL_USE_HAL_TRANSFERS
+static inline uint8_t transferByteRegister(SPI_TypeDef* instance, uint8_t dataToSend);
+static inline void burstTransfer(SPI_TypeDef* instance, uint8_t* receiveBuffer,
+    uint8_t* transmitBuffer, uint8_t fillByte, int length);
+static uint8_t transmitByteSpi1(uint8_t dataToSend);
+static uint8_t transmitByteSpi3(uint8_t dataToSend);
+#endif
+static GPIO_TypeDef* getChipSelectPort(const SpiChipSelect* chipSelect);
+static SpiNumber getSpiNumberFromHandle(SPI_HandleTypeDef* spiHandle);
+
 #define SPI_MAX_DELAY_TIME 500 ///< Maximum delay for polling mode
 
+/*
+ * Polled transfers drive the SPI data register directly. Define
+ * SPI_HAL_USE_HAL_TRANSFERS to go through HAL_SPI_TransmitReceive instead
+ * (slower, but easier to debug).
+ */
+
 /**
  * @brief Initialize SPI and SS pin.
  */
@@ -153,9 +176,16 @@ void SpiHal_deselect(SpiNumber spi) {
 void SpiHal_sendBuffer(SpiNumber spi, uint8_t* transmitBuffer,
     int length) {
 
+#ifndef SPI_HAL_USE_HAL_TRANSFERS
+  SPI_HandleTypeDef * spiHandle = getHandle(spi);
+  if (spiHandle != NULL) {
+    burstTransfer(spiHandle->Instance, NULL, transmitBuffer, 0, length);
+  }
+#else
   while (length--) {
     SpiHal_transmitByte(spi, *transmitBuffer++);
   }
+#endif
   return;
 
 //  SPI_HandleTypeDef * spiHandle;
@@ -189,9 +219,17 @@ void SpiHal_sendBuffer(SpiNumber spi, uint8_t* transmitBuffer,
 void SpiHal_readBuffer(SpiNumber spi, uint8_t* receiveBuffer,
     int length) {
 
+#ifndef SPI_HAL_USE_HAL_TRANSFERS
+  const uint8_t DUMMY_BYTE = 0xff;
+  SPI_HandleTypeDef * spiHandle = getHandle(spi);
+  if (spiHandle != NULL) {
+    burstTransfer(spiHandle->Instance, receiveBuffer, NULL, DUMMY_BYTE, length);
+  }
+#else
   while (length--) {
     *receiveBuffer++ = SpiHal_transmitByte(spi, 0xff);
   }
+#endif
   return;
 
 //  SPI_HandleTypeDef * spiHandle;
@@ -244,6 +282,133 @@ void SpiHal_transmitBuffer(SpiNumber spi, uint8_t* receiveBuffer,
     CommonHal_errorHandler();
   }
 }
+/**
+ * @brief Changes clock, mode and frame size of the SPI
+ * @details The peripheral is only reinitialized if the settings differ from the
+ * current ones, so switching between devices with the same settings is cheap.
+ * @param spi SPI to configure
+ * @param configuration Requested settings
+ */
+void SpiHal_configure(SpiNumber spi, const SpiConfiguration* configuration) {
+
+  SPI_HandleTypeDef * spiHandle = getHandle(spi);
+  if (spiHandle == NULL) {
+    return;
+  }
+
+  // BR bits of CR1 - the prescalers are consecutive values
+  uint32_t prescaler = SPI_BAUDRATEPRESCALER_2 +
+      configuration->prescaler * (SPI_BAUDRATEPRESCALER_4 - SPI_BAUDRATEPRESCALER_2);
+  uint32_t polarity = SPI_POLARITY_LOW;
+  if (configuration->mode == SPI_HAL_MODE2 || configuration->mode == SPI_HAL_MODE3) {
+    polarity = SPI_POLARITY_HIGH;
+  }
+  uint32_t phase = SPI_PHASE_1EDGE;
+  if (configuration->mode == SPI_HAL_MODE1 || configuration->mode == SPI_HAL_MODE3) {
+    phase = SPI_PHASE_2EDGE;
+  }
+  uint32_t dataSize = SPI_DATASIZE_8BIT;
+  if (configuration->frameSize == SPI_HAL_FRAME_16BIT) {
+    dataSize = SPI_DATASIZE_16BIT;
+  }
+
+  if (spiHandle->Init.BaudRatePrescaler == prescaler &&
+      spiHandle->Init.CLKPolarity == polarity &&
+      spiHandle->Init.CLKPhase == phase &&
+      spiHandle->Init.DataSize == dataSize) {
+    return;
+  }
+
+  spiHandle->Init.BaudRatePrescaler = prescaler;
+  spiHandle->Init.CLKPolarity       = polarity;
+  spiHandle->Init.CLKPhase          = phase;
+  spiHandle->Init.DataSize          = dataSize;
+
+  if (HAL_SPI_Init(spiHandle) != HAL_OK) {
+    CommonHal_errorHandler();
+  }
+}
+/**
+ * @brief Configures a chip select pin as output in the inactive (high) state
+ * @param chipSelect Chip select pin
+ */
+void SpiHal_initializeChipSelect(const SpiChipSelect* chipSelect) {
+  GPIO_TypeDef* port = getChipSelectPort(chipSelect);
+  if (port == NULL) {
+    return;
+  }
+
+  switch (chipSelect->port) {
+  case SPI_HAL_PORT_A:
+    __HAL_RCC_GPIOA_CLK_ENABLE();
+    break;
+  case SPI_HAL_PORT_B:
+    __HAL_RCC_GPIOB_CLK_ENABLE();
+    break;
+  case SPI_HAL_PORT_C:
+    __HAL_RCC_GPIOC_CLK_ENABLE();
+    break;
+  case SPI_HAL_PORT_D:
+    __HAL_RCC_GPIOD_CLK_ENABLE();
+    break;
+  case SPI_HAL_PORT_E:
+    __HAL_RCC_GPIOE_CLK_ENABLE();
+    break;
+  }
+
+  GPIO_InitTypeDef gpioInitialization;
+  gpioInitialization.Pin    = 1 << chipSelect->pin;
+  gpioInitialization.Mode   = GPIO_MODE_OUTPUT_PP;
+  gpioInitialization.Pull   = GPIO_NOPULL;
+  gpioInitialization.Speed  = GPIO_SPEED_FREQ_VERY_HIGH;
+  HAL_GPIO_WritePin(port, 1 << chipSelect->pin, GPIO_PIN_SET);
+  HAL_GPIO_Init(port, &gpioInitialization);
+}
+/**
+ * @brief Selects a chip (drives its chip select low)
+ * @param chipSelect Chip select pin
+ */
+void SpiHal_selectChip(const SpiChipSelect* chipSelect) {
+  HAL_GPIO_WritePin(getChipSelectPort(chipSelect), 1 << chipSelect->pin, GPIO_PIN_RESET);
+}
+/**
+ * @brief Deselects a chip (drives its chip select high)
+ * @param chipSelect Chip select pin
+ */
+void SpiHal_deselectChip(const SpiChipSelect* chipSelect) {
+  HAL_GPIO_WritePin(getChipSelectPort(chipSelect), 1 << chipSelect->pin, GPIO_PIN_SET);
+}
+/**
+ * @brief Transmits multiple data on SPI using the SPI IRQ
+ * @details Returns immediately, transferComplete is called from the IRQ
+ * when the transfer ends.
+ * @param spi SPI to send data on
+ * @param receiveBuffer Receive buffer (NULL if received data is not needed)
+ * @param transmitBuffer Transmit buffer
+ * @param length Number of frames to transmit
+ * @param transferComplete Function called when the transfer ends
+ */
+void SpiHal_transmitBufferIrq(SpiNumber spi, uint8_t* receiveBuffer,
+    uint8_t* transmitBuffer, int length, void (*transferComplete)(SpiNumber spi)) {
+
+  SPI_HandleTypeDef * spiHandle = getHandle(spi);
+  if (spiHandle == NULL) {
+    return;
+  }
+
+  transferCompleteCallback[spi] = transferComplete;
+
+  HAL_StatusTypeDef result;
+  if (receiveBuffer == NULL) {
+    result = HAL_SPI_Transmit_IT(spiHandle, transmitBuffer, length);
+  } else {
+    result = HAL_SPI_TransmitReceive_IT(spiHandle, transmitBuffer,
+        receiveBuffer, length);
+  }
+  if (result != HAL_OK) {
+    CommonHal_errorHandler();
+  }
+}
 /**
  * @brief Sends and receives one byte to the SPI slave
  * @param spi SPI to send data on
@@ -254,6 +419,16 @@ uint8_t SpiHal_transmitByte(SpiNumber spi, uint8_t dataToSend) {
 
   const uint8_t INVALID_DATA = 0xff;
 
+#ifndef SPI_HAL_USE_HAL_TRANSFERS
+  switch (spi) {
+  case SPI_HAL_SPI3:
+    return transmitByteSpi3(dataToSend);
+  case SPI_HAL_SPI1:
+    return transmitByteSpi1(dataToSend);
+  default:
+    return INVALID_DATA;
+  }
+#else
   SPI_HandleTypeDef * spiHandle;
 
   switch (spi) {
@@ -276,7 +451,149 @@ uint8_t SpiHal_transmitByte(SpiNumber spi, uint8_t dataToSend) {
     CommonHal_errorHandler();
   }
   return receivedData;
+#endif
 }
+/**
+ * @brief Gets handle of the given SPI
+ * @param spi SPI number
+ * @return Handle or NULL if SPI is not supported
+ */
+SPI_HandleTypeDef* getHandle(SpiNumber spi) {
+  switch (spi) {
+  case SPI_HAL_SPI1:
+    return &spi1Handle;
+  case SPI_HAL_SPI3:
+    return &spi3Handle;
+  default:
+    return NULL;
+  }
+}
+#ifndef SPI_HAL_USE_HAL_TRANSFERS
+/**
+ * @brief Sends and receives one byte using the SPI registers
+ * @details The peripheral is enabled here since HAL enables it only
+ * on the first HAL transfer.
+ * @param instance SPI peripheral
+ * @param dataToSend Data to send
+ * @return Received data
+ */
+inline uint8_t transferByteRegister(SPI_TypeDef* instance, uint8_t dataToSend) {
+  // 8 bit access - on F7 a 16 bit access would send two frames
+  volatile uint8_t* dataRegister = (volatile uint8_t*)&instance->DR;
+
+  if ((instance->CR1 & SPI_CR1_SPE) == 0) {
+    instance->CR1 |= SPI_CR1_SPE;
+  }
+  while ((instance->SR & SPI_SR_TXE) == 0) {
+    // wait for empty transmit buffer
+  }
+  *dataRegister = dataToSend;
+  while ((instance->SR & SPI_SR_RXNE) == 0) {
+    // wait for received byte
+  }
+  return *dataRegister;
+}
+/**
+ * @brief Transfers a buffer keeping the transmit buffer primed
+ * @details The next byte is written before the previous one is read, so the
+ * SPI clock runs without gaps between bytes. Only writing the next byte and
+ * reading the previous one is done with interrupts disabled - at most two
+ * bytes are in flight, so the receive register can never overrun.
+ * @param instance SPI peripheral
+ * @param receiveBuffer Buffer for received data (NULL if not needed)
+ * @param transmitBuffer Data to send (NULL sends fillByte)
+ * @param fillByte Byte sent if transmitBuffer is NULL
+ * @param length Number of bytes
+ */
+inline void burstTransfer(SPI_TypeDef* instance, uint8_t* receiveBuffer,
+    uint8_t* transmitBuffer, uint8_t fillByte, int length) {
+
+  volatile uint8_t* dataRegister = (volatile uint8_t*)&instance->DR;
+
+  if (length <= 0) {
+    return;
+  }
+  if ((instance->CR1 & SPI_CR1_SPE) == 0) {
+    instance->CR1 |= SPI_CR1_SPE;
+  }
+
+  while ((instance->SR & SPI_SR_TXE) == 0) {
+    // wait for empty transmit buffer
+  }
+  *dataRegister = (transmitBuffer != NULL) ? transmitBuffer[0] : fillByte;
+
+  for (int i = 1; i < length; i++) {
+    uint8_t nextByte = (transmitBuffer != NULL) ? transmitBuffer[i] : fillByte;
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    while ((instance->SR & SPI_SR_TXE) == 0) {
+      // wait until previous byte moves to shift register
+    }
+    *dataRegister = nextByte;
+    while ((instance->SR & SPI_SR_RXNE) == 0) {
+      // wait for previous byte
+    }
+    uint8_t receivedByte = *dataRegister;
+    __set_PRIMASK(primask);
+    if (receiveBuffer != NULL) {
+      receiveBuffer[i - 1] = receivedByte;
+    }
+  }
+
+  while ((instance->SR & SPI_SR_RXNE) == 0) {
+    // wait for last byte
+  }
+  uint8_t receivedByte = *dataRegister;
+  if (receiveBuffer != NULL) {
+    receiveBuffer[length - 1] = receivedByte;
+  }
+}
+/**
+ * @brief Sends and receives one byte on SPI1
+ */
+uint8_t transmitByteSpi1(uint8_t dataToSend) {
+  return transferByteRegister(SPI1, dataToSend);
+}
+/**
+ * @brief Sends and receives one byte on SPI3
+ */
+uint8_t transmitByteSpi3(uint8_t dataToSend) {
+  return transferByteRegister(SPI3, dataToSend);
+}
+#endif
+/**
+ * @brief Gets GPIO port of a chip select pin
+ * @param chipSelect Chip select pin
+ * @return GPIO port
+ */
+GPIO_TypeDef* getChipSelectPort(const SpiChipSelect* chipSelect) {
+  switch (chipSelect->port) {
+  case SPI_HAL_PORT_A:
+    return GPIOA;
+  case SPI_HAL_PORT_B:
+    return GPIOB;
+  case SPI_HAL_PORT_C:
+    return GPIOC;
+  case SPI_HAL_PORT_D:
+    return GPIOD;
+  case SPI_HAL_PORT_E:
+    return GPIOE;
+  default:
+    return NULL;
+  }
+}
+/**
+ * @brief Gets SPI number based on the handle
+ * @details Used for identifying SPI in IRQ handler
+ * @return SPI number
+ */
+SpiNumber getSpiNumberFromHandle(SPI_HandleTypeDef* spiHandle) {
+  if (spiHandle == &spi3Handle) {
+    return SPI_HAL_SPI3;
+  }
+  return SPI_HAL_SPI1;
+}
+// ********************** HAL SPI callbacks and IRQs **********************
 /**
  * @brief Initalize SPI HAL driver
  * @param spiHandle Handle of SPI
@@ -313,6 +630,9 @@ void HAL_SPI_MspInit(SPI_HandleTypeDef *spiHandle) {
     HAL_GPIO_Init(SPI3_CS_PORT, &gpioInitialization);
     HAL_GPIO_WritePin(SPI3_CS_PORT, SPI3_CS_PIN, GPIO_PIN_SET);
 
+    HAL_NVIC_SetPriority(SPI3_IRQn, SPI_IRQ_PRIORITY, 0);
+    HAL_NVIC_EnableIRQ(SPI3_IRQn);
+
   } else if (spiHandle == &spi1Handle) {
     SPI1_SCK_GPIO_CLK_ENABLE();
     SPI1_MISO_GPIO_CLK_ENABLE();
@@ -341,6 +661,9 @@ void HAL_SPI_MspInit(SPI_HandleTypeDef *spiHandle) {
     gpioInitialization.Pull   = GPIO_NOPULL;
     HAL_GPIO_Init(SPI1_CS_PORT, &gpioInitialization);
     HAL_GPIO_WritePin(SPI1_CS_PORT, SPI1_CS_PIN, GPIO_PIN_SET);
+
+    HAL_NVIC_SetPriority(SPI1_IRQn, SPI_IRQ_PRIORITY, 0);
+    HAL_NVIC_EnableIRQ(SPI1_IRQn);
   }
 
 }
@@ -365,6 +688,44 @@ void HAL_SPI_MspDeInit(SPI_HandleTypeDef *spiHandle) {
     HAL_GPIO_DeInit(SPI1_CS_PORT, SPI1_CS_PIN);
   }
 }
+/**
+ * @brief Transfer completed callback
+ * @param spiHandle SPI handle
+ */
+void HAL_SPI_TxRxCpltCallback(SPI_HandleTypeDef *spiHandle) {
+  SpiNumber spi = getSpiNumberFromHandle(spiHandle);
+  if (transferCompleteCallback[spi] != NULL) {
+    transferCompleteCallback[spi](spi);
+  }
+}
+/**
+ * @brief Transmission completed callback
+ * @param spiHandle SPI handle
+ */
+void HAL_SPI_TxCpltCallback(SPI_HandleTypeDef *spiHandle) {
+  HAL_SPI_TxRxCpltCallback(spiHandle);
+}
+/**
+ * @brief SPI error callback
+ * @param spiHandle SPI handle
+ */
+void HAL_SPI_ErrorCallback(SPI_HandleTypeDef *spiHandle) {
+  CommonHal_errorHandler();
+}
+/**
+ * @brief IRQ handler of SPI1
+ */
+void SPI1_IRQHandler(void) {
+  PROFILER_ZONE(spi1Irq);
+  HAL_SPI_IRQHandler(&spi1Handle);
+}
+/**
+ * @brief IRQ handler of SPI3
+ */
+void SPI3_IRQHandler(void) {
+  PROFILER_ZONE(spi3Irq);
+  HAL_SPI_IRQHandler(&spi3Handle);
+}
 /**
  * @}
  */
@@ -38,6 +38,66 @@ typedef enum {
   SPI_HAL_SPI3,//!< SPI_HAL_SPI3
 } SpiNumber;
 
+/**
+ * @brief Divider of the peripheral clock giving the SPI clock
+ */
+typedef enum {
+  SPI_HAL_PRESCALER_2,  //!< SPI_HAL_PRESCALER_2
+  SPI_HAL_PRESCALER_4,  //!< SPI_HAL_PRESCALER_4
+  SPI_HAL_PRESCALER_8,  //!< SPI_HAL_PRESCALER_8
+  SPI_HAL_PRESCALER_16, //!< SPI_HAL_PRESCALER_16
+  SPI_HAL_PRESCALER_32, //!< SPI_HAL_PRESCALER_32
+  SPI_HAL_PRESCALER_64, //!< SPI_HAL_PRESCALER_64
+  SPI_HAL_PRESCALER_128,//!< SPI_HAL_PRESCALER_128
+  SPI_HAL_PRESCALER_256,//!< SPI_HAL_PRESCALER_256
+} SpiPrescaler;
+
+/**
+ * @brief Clock polarity and phase
+ */
+typedef enum {
+  SPI_HAL_MODE0,//!< CPOL = 0, CPHA = 0
+  SPI_HAL_MODE1,//!< CPOL = 0, CPHA = 1
+  SPI_HAL_MODE2,//!< CPOL = 1, CPHA = 0
+  SPI_HAL_MODE3,//!< CPOL = 1, CPHA = 1
+} SpiMode;
+
+/**
+ * @brief Size of one SPI frame
+ */
+typedef enum {
+  SPI_HAL_FRAME_8BIT, //!< 8 bit frames
+  SPI_HAL_FRAME_16BIT,//!< 16 bit frames (buffer lengths are given in frames)
+} SpiFrameSize;
+
+/**
+ * @brief GPIO port of a chip select pin
+ */
+typedef enum {
+  SPI_HAL_PORT_A,//!< SPI_HAL_PORT_A
+  SPI_HAL_PORT_B,//!< SPI_HAL_PORT_B
+  SPI_HAL_PORT_C,//!< SPI_HAL_PORT_C
+  SPI_HAL_PORT_D,//!< SPI_HAL_PORT_D
+  SPI_HAL_PORT_E,//!< SPI_HAL_PORT_E
+} SpiChipSelectPort;
+
+/**
+ * @brief Chip select pin of a slave device (active low)
+ */
+typedef struct {
+  SpiChipSelectPort port; ///< GPIO port
+  uint8_t pin;            ///< Pin number (0 - 15)
+} SpiChipSelect;
+
+/**
+ * @brief Settings of the SPI bus required by a slave device
+ */
+typedef struct {
+  SpiPrescaler prescaler;     ///< Clock divider
+  SpiMode mode;               ///< Clock polarity and phase
+  SpiFrameSize frameSize;     ///< Frame size
+} SpiConfiguration;
+
 void    SpiHal_initialize    (SpiNumber spi);
 void    SpiHal_select        (SpiNumber spi);
 void    SpiHal_deselect      (SpiNumber spi);
@@ -46,6 +106,12 @@ void    SpiHal_readBuffer    (SpiNumber spi, uint8_t* receiveBuffer, int length)
 void    SpiHal_sendBuffer    (SpiNumber spi, uint8_t* transmitBuffer, int length);
 void    SpiHal_transmitBuffer(SpiNumber spi, uint8_t* receiveBuffer,
         uint8_t* transmitBuffer, int length);
+void    SpiHal_configure     (SpiNumber spi, const SpiConfiguration* configuration);
+void    SpiHal_initializeChipSelect(const SpiChipSelect* chipSelect);
+void    SpiHal_selectChip    (const SpiChipSelect* chipSelect);
+void    SpiHal_deselectChip  (const SpiChipSelect* chipSelect);
+void    SpiHal_transmitBufferIrq(SpiNumber spi, uint8_t* receiveBuffer,
+        uint8_t* transmitBuffer, int length, void (*transferComplete)(SpiNumber spi));
 
 /**
  * @}
@@ -17,6 +17,9 @@
 
 #include "usart.h"
 #include "common_hal.h"
+#include "dma_buffer.h"
+#include "profiler.h"
+#include "irq_monitor.h"
 #ifdef BOARD_STM32F4_DISCOVERY
   #include "usart_f4_discovery_defs.h"
 #endif
@@ -37,6 +40,12 @@
  * more than enough time to pack up the previous byte in some receive buffer
  */
 #define RECEIVE_BUFFER_LENGTH       1
+/**
+ * @brief Length of the circular DMA receive buffer
+ * @details Data is passed up every half buffer (or earlier when the line goes idle),
+ * so the upper layer has the time of 32 bytes (2.7ms at 115200) to take it.
+ */
+#define DMA_RECEIVE_BUFFER_LENGTH   64
 #define NUMBER_OF_AVAILABLE_USARTS  2 ///< Number of available USARTs
 
 /**
@@ -45,19 +54,35 @@
 typedef struct {
   UsartNumber usartNumber;                              ///< USART number
   UART_HandleTypeDef * handle;                          ///< USART handle
-  void (*sendDataToUpperLayer)(char receivedCharacter); ///< Function for sending received data to upper layer
-  UsartTransmission (*getMoreDataToTransmit)(void);     ///< Function for getting more data to transmit (fills up buffer with data to send)
-  char receiveBuffer[RECEIVE_BUFFER_LENGTH];            ///< Receive buffer
+  UsartReceiveMode receiveMode;                         ///< Receive mode
+  void* context;                                        ///< Upper layer object passed to the callbacks
+  void (*sendDataToUpperLayer)(void* context, const char* data, int length); ///< Function for sending received data to upper layer
+  UsartTransmission (*getMoreDataToTransmit)(void* context);     ///< Function for getting more data to transmit (fills up buffer with data to send)
+  void (*transmissionComplete)(void* context, int transmittedLength); ///< Function for releasing transmitted data
+  int transmittedLength;                                ///< Length of the running DMA transmission
+  char receiveBuffer[DMA_RECEIVE_BUFFER_LENGTH] DMA_BUFFER_ALIGNED; ///< Receive buffer (cache line aligned)
+  int receivePosition;                                  ///< Position in circular buffer up to which data was passed up
   Boolean isSendingData;                                ///< Flag saying if UART is currently sending any data
   Boolean isInitialized;
 } UsartControl;
 
 static UART_HandleTypeDef usart2Handle;     ///< Handle for UART peripheral
 static UART_HandleTypeDef usart6Handle;     ///< Handle for UART peripheral
+static DMA_HandleTypeDef usart2TransmitDma; ///< Handle for UART transmit DMA stream
+static DMA_HandleTypeDef usart6TransmitDma; ///< Handle for UART transmit DMA stream
+static DMA_HandleTypeDef usart2ReceiveDma;  ///< Handle for UART receive DMA stream
+static DMA_HandleTypeDef usart6ReceiveDma;  ///< Handle for UART receive DMA stream
 
 static UsartControl usartControl[NUMBER_OF_AVAILABLE_USARTS]; ///< The USARTs
 
 static UsartNumber getUsartNumberFromHandle(UART_HandleTypeDef * usartHandle);
+static void initializeTransmitDma(DMA_HandleTypeDef * dmaHandle, DMA_Stream_TypeDef * stream,
+    uint32_t channel);
+static void initializeReceiveDma(DMA_HandleTypeDef * dmaHandle, DMA_Stream_TypeDef * stream,
+    uint32_t channel);
+static void startReception(UsartNumber usart);
+static void passReceivedDataUp(UsartNumber usart);
+static void checkIdleLine(UsartNumber usart);
 
 /**
  * @brief Initialize UART
@@ -83,8 +108,12 @@ void Usart_initialize(UsartNumber usart, UsartHalInitialization * usartInitializ
   }
   usartControl[usart].usartNumber = usart;
   usartControl[usart].isInitialized = TRUE;
+  usartControl[usart].receiveMode = usartInitialization->receiveMode;
+  usartControl[usart].context = usartInitialization->context;
   usartControl[usart].sendDataToUpperLayer = usartInitialization->sendDataToUpperLayer;
   usartControl[usart].getMoreDataToTransmit = usartInitialization->getMoreDataToTransmit;
+  usartControl[usart].transmissionComplete = usartInitialization->transmissionComplete;
+  usartControl[usart].transmittedLength = 0;
   usartControl[usart].isSendingData = FALSE;
 
   usartControl[usart].handle->Init.BaudRate   = usartInitialization->baudRate;
@@ -97,10 +126,7 @@ void Usart_initialize(UsartNumber usart, UsartHalInitialization * usartInitializ
   if (HAL_UART_Init(usartControl[usart].handle) != HAL_OK) {
     CommonHal_errorHandler();
   }
-  if (HAL_UART_Receive_IT(usartControl[usart].handle,
-      (uint8_t*)usartControl[usart].receiveBuffer, RECEIVE_BUFFER_LENGTH) != HAL_OK) {
-    CommonHal_errorHandler();
-  }
+  startReception(usart);
 }
 /**
  * @brief Enables UART IRQ
@@ -142,10 +168,10 @@ Boolean Usart_isSendingData(UsartNumber usart) {
   return usartControl[usart].isSendingData;
 }
 /**
- * @brief Sends data using the UART IRQ
- * @details This function is called automatically when the TX IRQ is running.
- * However if the IRQ is not running this function has to be called manually to
- * enable the IRQ.
+ * @brief Sends data using the UART transmit DMA
+ * @details This function is called automatically from the transfer complete IRQ,
+ * so consecutive buffers are chained. However if no transfer is running this
+ * function has to be called manually to start the DMA.
  */
 void Usart_sendDataIrq(UsartNumber usart) {
   if (usart >= NUMBER_OF_AVAILABLE_USARTS) {
@@ -155,16 +181,20 @@ void Usart_sendDataIrq(UsartNumber usart) {
     return;
   }
 
-  UsartTransmission transmission = usartControl[usart].getMoreDataToTransmit();
+  UsartTransmission transmission = usartControl[usart].getMoreDataToTransmit(usartControl[usart].context);
   // if there is any data in the FIFO
   if (transmission.bufferLength > 0) {
+    // DMA reads memory directly - write back data still sitting in the D-cache
+    DmaBuffer_cleanBeforeTransmit(transmission.transmitBuffer, transmission.bufferLength);
+    usartControl[usart].transmittedLength = transmission.bufferLength;
+    usartControl[usart].isSendingData = TRUE;
     // send it to PC
-    if (HAL_UART_Transmit_IT(usartControl[usart].handle,
+    if (HAL_UART_Transmit_DMA(usartControl[usart].handle,
         (uint8_t*)transmission.transmitBuffer, transmission.bufferLength) != HAL_OK) {
       CommonHal_errorHandler();
     }
-    usartControl[usart].isSendingData = TRUE;
   } else {
+    usartControl[usart].transmittedLength = 0;
     usartControl[usart].isSendingData = FALSE;
   }
 }
@@ -182,9 +212,128 @@ UsartNumber getUsartNumberFromHandle(UART_HandleTypeDef * usartHandle) {
   }
   return USART_HAL_EMPTY;
 }
+/**
+ * @brief Initializes a transmit DMA stream (memory to peripheral, bytes)
+ * @param dmaHandle DMA handle
+ * @param stream DMA stream
+ * @param channel DMA channel of the USART request
+ */
+void initializeTransmitDma(DMA_HandleTypeDef * dmaHandle, DMA_Stream_TypeDef * stream,
+    uint32_t channel) {
+  dmaHandle->Instance                 = stream;
+  dmaHandle->Init.Channel             = channel;
+  dmaHandle->Init.Direction           = DMA_MEMORY_TO_PERIPH;
+  dmaHandle->Init.PeriphInc           = DMA_PINC_DISABLE;
+  dmaHandle->Init.MemInc              = DMA_MINC_ENABLE;
+  dmaHandle->Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+  dmaHandle->Init.MemDataAlignment    = DMA_MDATAALIGN_BYTE;
+  dmaHandle->Init.Mode                = DMA_NORMAL;
+  dmaHandle->Init.Priority            = DMA_PRIORITY_LOW;
+  dmaHandle->Init.FIFOMode            = DMA_FIFOMODE_DISABLE;
+  dmaHandle->Init.FIFOThreshold       = DMA_FIFO_THRESHOLD_FULL;
+  dmaHandle->Init.MemBurst            = DMA_MBURST_SINGLE;
+  dmaHandle->Init.PeriphBurst         = DMA_PBURST_SINGLE;
+  if (HAL_DMA_Init(dmaHandle) != HAL_OK) {
+    CommonHal_errorHandler();
+  }
+}
+/**
+ * @brief Initializes a receive DMA stream (peripheral to memory, bytes, circular)
+ * @param dmaHandle DMA handle
+ * @param stream DMA stream
+ * @param channel DMA channel of the USART request
+ */
+void initializeReceiveDma(DMA_HandleTypeDef * dmaHandle, DMA_Stream_TypeDef * stream,
+    uint32_t channel) {
+  dmaHandle->Instance                 = stream;
+  dmaHandle->Init.Channel             = channel;
+  dmaHandle->Init.Direction           = DMA_PERIPH_TO_MEMORY;
+  dmaHandle->Init.PeriphInc           = DMA_PINC_DISABLE;
+  dmaHandle->Init.MemInc              = DMA_MINC_ENABLE;
+  dmaHandle->Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+  dmaHandle->Init.MemDataAlignment    = DMA_MDATAALIGN_BYTE;
+  dmaHandle->Init.Mode                = DMA_CIRCULAR;
+  dmaHandle->Init.Priority            = DMA_PRIORITY_HIGH;
+  dmaHandle->Init.FIFOMode            = DMA_FIFOMODE_DISABLE;
+  dmaHandle->Init.FIFOThreshold       = DMA_FIFO_THRESHOLD_FULL;
+  dmaHandle->Init.MemBurst            = DMA_MBURST_SINGLE;
+  dmaHandle->Init.PeriphBurst         = DMA_PBURST_SINGLE;
+  if (HAL_DMA_Init(dmaHandle) != HAL_OK) {
+    CommonHal_errorHandler();
+  }
+}
+/**
+ * @brief Starts receiving data in the configured mode
+ * @param usart USART number
+ */
+void startReception(UsartNumber usart) {
+  UsartControl * control = &usartControl[usart];
+  if (control->receiveMode == USART_HAL_RECEIVE_DMA) {
+    control->receivePosition = 0;
+    DmaBuffer_invalidateBeforeReceive(control->receiveBuffer, DMA_RECEIVE_BUFFER_LENGTH);
+    if (HAL_UART_Receive_DMA(control->handle,
+        (uint8_t*)control->receiveBuffer, DMA_RECEIVE_BUFFER_LENGTH) != HAL_OK) {
+      CommonHal_errorHandler();
+    }
+    __HAL_UART_CLEAR_IDLEFLAG(control->handle);
+    __HAL_UART_ENABLE_IT(control->handle, UART_IT_IDLE);
+  } else {
+    if (HAL_UART_Receive_IT(control->handle,
+        (uint8_t*)control->receiveBuffer, RECEIVE_BUFFER_LENGTH) != HAL_OK) {
+      CommonHal_errorHandler();
+    }
+  }
+}
+/**
+ * @brief Passes data written by the receive DMA since the last call to upper layer
+ * @details The write position is taken from the DMA counter. When the data wraps
+ * around the end of the circular buffer it is passed up in two parts.
+ * @param usart USART number
+ */
+void passReceivedDataUp(UsartNumber usart) {
+  UsartControl * control = &usartControl[usart];
+  int position = DMA_RECEIVE_BUFFER_LENGTH -
+      (int)__HAL_DMA_GET_COUNTER(control->handle->hdmarx);
+  if (position == DMA_RECEIVE_BUFFER_LENGTH) {
+    position = 0;
+  }
+  if (position == control->receivePosition || control->sendDataToUpperLayer == NULL) {
+    control->receivePosition = position;
+    return;
+  }
+  // drop stale cache lines - DMA wrote the memory behind the cache
+  DmaBuffer_invalidateAfterReceive(control->receiveBuffer, DMA_RECEIVE_BUFFER_LENGTH);
+  if (position > control->receivePosition) {
+    control->sendDataToUpperLayer(control->context, control->receiveBuffer + control->receivePosition,
+        position - control->receivePosition);
+  } else {
+    control->sendDataToUpperLayer(control->context, control->receiveBuffer + control->receivePosition,
+        DMA_RECEIVE_BUFFER_LENGTH - control->receivePosition);
+    if (position > 0) {
+      control->sendDataToUpperLayer(control->context, control->receiveBuffer, position);
+    }
+  }
+  control->receivePosition = position;
+}
+/**
+ * @brief Passes received data up when the line goes idle (end of a burst)
+ * @param usart USART number
+ */
+void checkIdleLine(UsartNumber usart) {
+  UART_HandleTypeDef * handle = usartControl[usart].handle;
+  if (handle == NULL || usartControl[usart].receiveMode != USART_HAL_RECEIVE_DMA) {
+    return;
+  }
+  if (__HAL_UART_GET_FLAG(handle, UART_FLAG_IDLE) != RESET &&
+      __HAL_UART_GET_IT_SOURCE(handle, UART_IT_IDLE) != RESET) {
+    __HAL_UART_CLEAR_IDLEFLAG(handle);
+    passReceivedDataUp(usart);
+  }
+}
 // ********************** HAL UART callbacks and IRQs **********************
 /**
   * @brief  Transfer completed callback
+  * @details In DMA mode called when the circular buffer is full (DMA keeps running).
   * @param  usartHandle UART handle
   */
 void HAL_UART_RxCpltCallback(UART_HandleTypeDef * usartHandle) {
@@ -192,19 +341,54 @@ void HAL_UART_RxCpltCallback(UART_HandleTypeDef * usartHandle) {
   if (usart == USART_HAL_EMPTY) {
     return;
   }
+  if (usartControl[usart].receiveMode == USART_HAL_RECEIVE_DMA) {
+    passReceivedDataUp(usart);
+    return;
+  }
   if (usartControl[usart].sendDataToUpperLayer == NULL) {
     return;
   }
   // send the received char to upper layer
-  usartControl[usart].sendDataToUpperLayer(*usartControl[usart].receiveBuffer);
+  usartControl[usart].sendDataToUpperLayer(usartControl[usart].context,
+      usartControl[usart].receiveBuffer,
+      RECEIVE_BUFFER_LENGTH);
   // start another reception
-  if (HAL_UART_Receive_IT(usartControl[usart].handle,
-      (uint8_t*)usartControl[usart].receiveBuffer, RECEIVE_BUFFER_LENGTH) != HAL_OK) {
-    CommonHal_errorHandler();
+  startReception(usart);
+}
+/**
+  * @brief  Half of circular receive buffer filled callback
+  * @param  usartHandle UART handle
+  */
+void HAL_UART_RxHalfCpltCallback(UART_HandleTypeDef * usartHandle) {
+  UsartNumber usart = getUsartNumberFromHandle(usartHandle);
+  if (usart == USART_HAL_EMPTY) {
+    return;
+  }
+  passReceivedDataUp(usart);
+}
+/**
+  * @brief  Error callback
+  * @details An overrun (or any error in DMA mode) stops the reception - pass up
+  * what was received and start again.
+  * @param  usartHandle UART handle
+  */
+void HAL_UART_ErrorCallback(UART_HandleTypeDef * usartHandle) {
+  UsartNumber usart = getUsartNumberFromHandle(usartHandle);
+  if (usart == USART_HAL_EMPTY) {
+    return;
+  }
+  if (usartHandle->RxState != HAL_UART_STATE_READY) {
+    return; // reception still running
+  }
+  if (usartControl[usart].receiveMode == USART_HAL_RECEIVE_DMA) {
+    passReceivedDataUp(usart);
   }
+  startReception(usart);
 }
 /**
- * @brief Transfer completed callback (called whenever IRQ sends the whole buffer)
+ * @brief Transfer completed callback (called whenever DMA sends the whole buffer)
+ * @details Releases the sent buffer and chains the next one (e.g. the part of the
+ * upper layer ring buffer that wrapped around).
  * @param uart UART handle
  */
 void HAL_UART_TxCpltCallback(UART_HandleTypeDef * usartHandle) {
@@ -212,6 +396,11 @@ void HAL_UART_TxCpltCallback(UART_HandleTypeDef * usartHandle) {
   if (usart == USART_HAL_EMPTY) {
     return;
   }
+  if (usartControl[usart].transmissionComplete != NULL &&
+      usartControl[usart].transmittedLength > 0) {
+    usartControl[usart].transmissionComplete(usartControl[usart].context,
+        usartControl[usart].transmittedLength);
+  }
   Usart_sendDataIrq(usart);
 }
 /**
@@ -233,6 +422,15 @@ void HAL_UART_MspInit(UART_HandleTypeDef * usartHandle) {
     gpioInitalization.Pin       = USART2_RX_PIN;
     gpioInitalization.Alternate = USART2_RX_AF;
     HAL_GPIO_Init(USART2_RX_GPIO_PORT, &gpioInitalization);
+    USART2_TX_DMA_CLK_ENABLE();
+    initializeTransmitDma(&usart2TransmitDma, USART2_TX_DMA_STREAM, USART2_TX_DMA_CHANNEL);
+    __HAL_LINKDMA(usartHandle, hdmatx, usart2TransmitDma);
+    HAL_NVIC_SetPriority(USART2_TX_DMA_IRQ_NUMBER, USART2_IRQ_PRIORITY, 0);
+    HAL_NVIC_EnableIRQ(USART2_TX_DMA_IRQ_NUMBER);
+    initializeReceiveDma(&usart2ReceiveDma, USART2_RX_DMA_STREAM, USART2_RX_DMA_CHANNEL);
+    __HAL_LINKDMA(usartHandle, hdmarx, usart2ReceiveDma);
+    HAL_NVIC_SetPriority(USART2_RX_DMA_IRQ_NUMBER, USART2_IRQ_PRIORITY, 0);
+    HAL_NVIC_EnableIRQ(USART2_RX_DMA_IRQ_NUMBER);
     HAL_NVIC_SetPriority(USART2_IRQ_NUMBER, USART2_IRQ_PRIORITY, 0);
     HAL_NVIC_EnableIRQ(USART2_IRQ_NUMBER);
   } else if (usartHandle == &usart6Handle) {
@@ -249,6 +447,15 @@ void HAL_UART_MspInit(UART_HandleTypeDef * usartHandle) {
     gpioInitalization.Pin       = USART6_RX_PIN;
     gpioInitalization.Alternate = USART6_RX_AF;
     HAL_GPIO_Init(USART6_RX_GPIO_PORT, &gpioInitalization);
+    USART6_TX_DMA_CLK_ENABLE();
+    initializeTransmitDma(&usart6TransmitDma, USART6_TX_DMA_STREAM, USART6_TX_DMA_CHANNEL);
+    __HAL_LINKDMA(usartHandle, hdmatx, usart6TransmitDma);
+    HAL_NVIC_SetPriority(USART6_TX_DMA_IRQ_NUMBER, USART6_IRQ_PRIORITY, 0);
+    HAL_NVIC_EnableIRQ(USART6_TX_DMA_IRQ_NUMBER);
+    initializeReceiveDma(&usart6ReceiveDma, USART6_RX_DMA_STREAM, USART6_RX_DMA_CHANNEL);
+    __HAL_LINKDMA(usartHandle, hdmarx, usart6ReceiveDma);
+    HAL_NVIC_SetPriority(USART6_RX_DMA_IRQ_NUMBER, USART6_IRQ_PRIORITY, 0);
+    HAL_NVIC_EnableIRQ(USART6_RX_DMA_IRQ_NUMBER);
     HAL_NVIC_SetPriority(USART6_IRQ_NUMBER, USART6_IRQ_PRIORITY, 0);
     HAL_NVIC_EnableIRQ(USART6_IRQ_NUMBER);
   }
@@ -263,12 +470,20 @@ void HAL_UART_MspDeInit(UART_HandleTypeDef * usartHandle) {
     USART2_RELEASE_RESET();
     HAL_GPIO_DeInit(USART2_TX_GPIO_PORT, USART2_TX_PIN);
     HAL_GPIO_DeInit(USART2_RX_GPIO_PORT, USART2_RX_PIN);
+    HAL_DMA_DeInit(&usart2TransmitDma);
+    HAL_NVIC_DisableIRQ(USART2_TX_DMA_IRQ_NUMBER);
+    HAL_DMA_DeInit(&usart2ReceiveDma);
+    HAL_NVIC_DisableIRQ(USART2_RX_DMA_IRQ_NUMBER);
     HAL_NVIC_DisableIRQ(USART2_IRQ_NUMBER);
   } else if (usartHandle == &usart6Handle) {
     USART6_FORCE_RESET();
     USART6_RELEASE_RESET();
     HAL_GPIO_DeInit(USART6_TX_GPIO_PORT, USART6_TX_PIN);
     HAL_GPIO_DeInit(USART6_RX_GPIO_PORT, USART6_RX_PIN);
+    HAL_DMA_DeInit(&usart6TransmitDma);
+    HAL_NVIC_DisableIRQ(USART6_TX_DMA_IRQ_NUMBER);
+    HAL_DMA_DeInit(&usart6ReceiveDma);
+    HAL_NVIC_DisableIRQ(USART6_RX_DMA_IRQ_NUMBER);
     HAL_NVIC_DisableIRQ(USART6_IRQ_NUMBER);
   }
 }
@@ -276,14 +491,48 @@ void HAL_UART_MspDeInit(UART_HandleTypeDef * usartHandle) {
  * @brief This function handles UART interrupt request.
  */
 void USART2_IRQHandler(void) {
+  IRQ_MONITOR(usart2);
+  PROFILER_ZONE(usart2Irq);
+  checkIdleLine(USART_HAL_USART2);
   HAL_UART_IRQHandler(&usart2Handle);
 }
 /**
  * @brief This function handles UART interrupt request.
  */
 void USART6_IRQHandler(void) {
+  IRQ_MONITOR(usart6);
+  PROFILER_ZONE(usart6Irq);
+  checkIdleLine(USART_HAL_USART6);
   HAL_UART_IRQHandler(&usart6Handle);
 }
+/**
+ * @brief This function handles USART2 transmit DMA interrupt request.
+ */
+void DMA1_Stream6_IRQHandler(void) {
+  PROFILER_ZONE(usart2TransmitDmaIrq);
+  HAL_DMA_IRQHandler(&usart2TransmitDma);
+}
+/**
+ * @brief This function handles USART6 transmit DMA interrupt request.
+ */
+void DMA2_Stream6_IRQHandler(void) {
+  PROFILER_ZONE(usart6TransmitDmaIrq);
+  HAL_DMA_IRQHandler(&usart6TransmitDma);
+}
+/**
+ * @brief This function handles USART2 receive DMA interrupt request.
+ */
+void DMA1_Stream5_IRQHandler(void) {
+  PROFILER_ZONE(usart2ReceiveDmaIrq);
+  HAL_DMA_IRQHandler(&usart2ReceiveDma);
+}
+/**
+ * @brief This function handles USART6 receive DMA interrupt request.
+ */
+void DMA2_Stream1_IRQHandler(void) {
+  PROFILER_ZONE(usart6ReceiveDmaIrq);
+  HAL_DMA_IRQHandler(&usart6ReceiveDma);
+}
 /**
  * @}
  */
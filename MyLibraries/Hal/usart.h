@@ -48,8 +48,17 @@ typedef enum {
   #define DEBUG_CONSOLE_USART USART_HAL_USART6
 #endif
 
+/**
+ * @brief Usart receive mode
+ */
+typedef enum {
+  USART_HAL_RECEIVE_IRQ, //!< One interrupt per received byte
+  USART_HAL_RECEIVE_DMA, //!< Circular DMA, data passed up on half/full buffer and idle line
+} UsartReceiveMode;
 /**
  * @brief Single USART transmission
+ * @details The buffer is sent by DMA, so it has to stay untouched until
+ * transmissionComplete is called for it.
  */
 typedef struct {
   char * transmitBuffer;
@@ -60,8 +69,11 @@ typedef struct {
  */
 typedef struct {
   int baudRate;                                         ///< The requested baud rate
-  void (*sendDataToUpperLayer)(char receivedCharacter); ///< Function for sending received data to upper layer
-  UsartTransmission (*getMoreDataToTransmit)(void);     ///< Function for getting more data to transmit
+  UsartReceiveMode receiveMode;                         ///< How received data is collected
+  void* context;                                        ///< Upper layer object passed to the callbacks
+  void (*sendDataToUpperLayer)(void* context, const char* data, int length); ///< Function for sending received data to upper layer
+  UsartTransmission (*getMoreDataToTransmit)(void* context);     ///< Function for getting more data to transmit
+  void (*transmissionComplete)(void* context, int transmittedLength); ///< Function for releasing transmitted data (may be NULL)
 } UsartHalInitialization;
 
 void    Usart_initialize   (UsartNumber usart, UsartHalInitialization * usartInitialization);
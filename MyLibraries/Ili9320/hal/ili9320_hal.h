@@ -68,6 +68,16 @@ static inline void ILI9320_HAL_WriteDataBuffer(uint16_t* dataToWrite, int length
     ILI9320_DATA = dataToWrite[i];
   }
 }
+/**
+ * @brief Sends the same data to display several times
+ * @param data Data to write
+ * @param length Number of writes
+ */
+static inline void ILI9320_HAL_WriteDataRepeated(uint16_t data, int length) {
+  for (int i = 0; i < length; i++) {
+    ILI9320_DATA = data;
+  }
+}
 /**
  * @brief Reads data from the display
  * @param readData Read data buffer
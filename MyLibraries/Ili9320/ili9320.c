@@ -220,6 +220,26 @@ void ILI9320_DrawPixel(int x, int y, unsigned int rgbColor) {
 void ILI9320_DrawNextPixel(unsigned int rgbColor) {
   ILI9320_HAL_WriteReg(ILI9320_WRITE_TO_GRAM, rgbColor);
 }
+/**
+ * @brief Draws pixels of one color in the next addresses of the GRAM
+ * @details The GRAM register is selected once, then only data is written.
+ * @param rgbColor Color value.
+ * @param count Number of pixels.
+ */
+void ILI9320_FillNextPixels(unsigned int rgbColor, int count) {
+  ILI9320_HAL_WriteAddress(ILI9320_WRITE_TO_GRAM);
+  ILI9320_HAL_WriteDataRepeated(rgbColor, count);
+}
+/**
+ * @brief Draws pixels in the next addresses of the GRAM
+ * @details The GRAM register is selected once, then only data is written.
+ * @param pixels Color values.
+ * @param count Number of pixels.
+ */
+void ILI9320_WriteNextPixels(const uint16_t* pixels, int count) {
+  ILI9320_HAL_WriteAddress(ILI9320_WRITE_TO_GRAM);
+  ILI9320_HAL_WriteDataBuffer((uint16_t*)pixels, count); // pixels are only read
+}
 /**
  * @brief Set work window to draw data.
  * @param x X coordinate of start point.
@@ -38,6 +38,8 @@ void          ILI9320_SetWindow     (int x, int y, int width, int height);
 void          ILI9320_DrawPixel     (int x, int y, unsigned int color);
 void          ILI9320_SetCursor     (int x, int y);
 void          ILI9320_DrawNextPixel (unsigned int rgbColor);
+void          ILI9320_FillNextPixels(unsigned int rgbColor, int count);
+void          ILI9320_WriteNextPixels(const uint16_t* pixels, int count);
 unsigned int  ILI9320_RGBDecode     (unsigned int rgbColor);
 void ILI9320_SetHorizontalGramUpdateDirection(void);
 void ILI9320_SetVerticalGramUpdateDirection(void);
@@ -18,11 +18,16 @@
 
 #include "ir_codes_hal.h"
 #include "common_hal.h"
+#include "irq_monitor.h"
 
 static void (*readDataCallback)(int pulseWidthMicros, IrPulseState edge); ///< Callback for sending received pulses to higher layer
 static void (*resetFrameCallback)(void); ///< Callback for resetting frame if timeout occurs.
 static TIM_HandleTypeDef timer4Handle;   ///< Timer 4 handle
 
+#ifdef IRQ_MONITOR_ENABLE
+static uint32_t getMicrosSinceEvent(void);
+#endif
+
 /**
  * @brief Initialize hardware for decoding IR codes.
  * @param readDataCb Read data callback
@@ -101,6 +106,8 @@ void IrCodesHal_initialize(
  * @details Used for decoding RC4 frames using PWMI (input capture) measurement.
  */
 void TIM4_IRQHandler(void) {
+  IRQ_MONITOR(tim4);
+  IRQ_MONITOR_LATENCY_MICROS(tim4, getMicrosSinceEvent());
   static int periodBetweenTwoFallingEdgesMicros = 0;
   static int lowPulseLengthMicros = 0;
   if (__HAL_TIM_GET_FLAG(&timer4Handle, TIM_FLAG_CC1) != RESET) {
@@ -127,3 +134,19 @@ void TIM4_IRQHandler(void) {
     }
   }
 }
+#ifdef IRQ_MONITOR_ENABLE
+/**
+ * @brief Calculates the time since the event of the timer IRQ (entry latency)
+ * @details The counter restarts at the falling edge and the timeout, the
+ * rising edge is captured in channel 1.
+ * @return Microseconds since the event
+ */
+uint32_t getMicrosSinceEvent(void) {
+  uint16_t ticks = __HAL_TIM_GET_COUNTER(&timer4Handle);
+  if (__HAL_TIM_GET_FLAG(&timer4Handle, TIM_FLAG_CC2) == RESET &&
+      __HAL_TIM_GET_FLAG(&timer4Handle, TIM_FLAG_UPDATE) == RESET) {
+    ticks -= HAL_TIM_ReadCapturedValue(&timer4Handle, TIM_CHANNEL_1);
+  }
+  return ticks;
+}
+#endif
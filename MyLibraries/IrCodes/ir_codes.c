@@ -72,6 +72,7 @@ static Boolean frameToggleBit;      ///< Toggle bit
 static int pulseCount;              ///< Counts the number of half bits
 static int bitCount;                ///< Counts the number of bits received
 static int numberOfReceivedFrames;  ///< Received frames counter
+static IrCodesFrameCallback frameCallback; ///< Called for every received frame
 /**
  * @brief RC5 commands
  */
@@ -109,6 +110,15 @@ typedef enum {
 void IrCodes_initialize(void) {
   IrCodesHal_initialize(receiveDataCb, resetFrameCb, RC5_FRAME_TIMEOUT_MICROS);
 }
+/**
+ * @brief Sets the function called for every received frame
+ * @details The callback runs in the capture IRQ, so it should only pass the
+ * frame on (e.g. Scheduler_post).
+ * @param frameCb Frame callback (NULL - frames are only printed)
+ */
+void IrCodes_setFrameCallback(IrCodesFrameCallback frameCb) {
+  frameCallback = frameCb;
+}
 /**
  * @brief Decode RC5 data
  * @details This function is called by the lower layer every time
@@ -188,6 +198,9 @@ void receiveDataCb(int pulseWidthMicros, IrPulseState pulse) {
       frameCommand = (receivedFrame>>RC5_COMMAND_POSITION) & (RC5_COMMAND_MASK);
       println("Frame received: %04x. Toggle = %d Command = %d Address = %d",
           receivedFrame, frameToggleBit, frameCommand, frameAddress);
+      if (frameCallback) {
+        frameCallback(frameAddress, frameCommand, frameToggleBit);
+      }
       return;
     }
     pulseCount++;
@@ -30,7 +30,16 @@
  * @{
  */
 
+/**
+ * @brief Callback for a received frame (called from IRQ)
+ * @param address Remote address
+ * @param command Remote command
+ * @param toggleBit Toggles every key press (same for a held key)
+ */
+typedef void (*IrCodesFrameCallback)(uint8_t address, uint8_t command, Boolean toggleBit);
+
 void IrCodes_initialize(void);
+void IrCodes_setFrameCallback(IrCodesFrameCallback frameCb);
 
 /**
  * @}
@@ -0,0 +1,248 @@
+/**
+ * @file    irq_monitor.c
+ * @brief   Interrupt latency and load monitor.
+ * @date    19.10.2026
+ * @author  Michal Ksiezopolski
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#include "irq_monitor.h"
+#include "cycle_counter.h"
+#include "boards.h"
+#include <stdio.h>
+#include <string.h>
+
+#ifndef IRQ_MONITOR_DEBUG
+  #define IRQ_MONITOR_DEBUG
+#endif
+
+#ifdef IRQ_MONITOR_DEBUG
+  #define println(str, args...) printf("IRQ--> "str"%s",##args,"\r\n")
+#else
+  #define println(str, args...) (void)0
+#endif
+
+/**
+ * @addtogroup IRQ_MONITOR
+ * @{
+ */
+
+static IrqMonitor* monitorList;       ///< Registered handlers
+static unsigned int nestingDepth;     ///< Number of active monitored handlers
+static uint32_t busyStartCycles;      ///< Entry of the outermost active handler
+static uint64_t busyCycles;           ///< Time spent in monitored handlers
+static uint64_t statisticsStartCycles;///< Start of measurement
+
+static void addTime(IrqMonitorTimes* times, uint32_t cycles);
+static void printHistogram(const char* name, const char* kind, const IrqMonitorTimes* times);
+
+/**
+ * @brief Initializes the monitor (starts the cycle counter)
+ */
+void IrqMonitor_initialize(void) {
+  CycleCounter_initialize();
+  IrqMonitor_resetStatistics();
+}
+/**
+ * @brief Enters a handler (use IRQ_MONITOR instead)
+ * @param monitor Handler monitor
+ * @return Time stamp of entry
+ */
+uint32_t IrqMonitor_enter(IrqMonitor* monitor) {
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+  uint32_t cycles = CycleCounter_getCycles();
+  if (!monitor->isRegistered) {
+    monitor->isRegistered = TRUE;
+    monitor->next = monitorList;
+    monitorList = monitor;
+  }
+  if (nestingDepth++ == 0) {
+    busyStartCycles = cycles;
+  }
+  __set_PRIMASK(primask);
+  return cycles;
+}
+/**
+ * @brief Leaves a handler (use IRQ_MONITOR instead)
+ * @param monitor Handler monitor
+ * @param enterCycles Time stamp of entry
+ */
+void IrqMonitor_exit(IrqMonitor* monitor, uint32_t enterCycles) {
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+  uint32_t cycles = CycleCounter_getCycles();
+  addTime(&monitor->execution, cycles - enterCycles);
+  if (--nestingDepth == 0) {
+    busyCycles += cycles - busyStartCycles;
+  }
+  __set_PRIMASK(primask);
+}
+/**
+ * @brief Leaves a handler entered by IRQ_MONITOR (called at end of handler)
+ * @param scope Handler entry
+ */
+void IrqMonitor_exitScope(IrqMonitorScope* scope) {
+  IrqMonitor_exit(scope->monitor, scope->enterCycles);
+}
+/**
+ * @brief Records the entry latency of a handler (use IRQ_MONITOR_LATENCY instead)
+ * @param monitor Handler monitor
+ * @param latencyCycles Cycles from the hardware event to handler entry
+ */
+void IrqMonitor_recordLatency(IrqMonitor* monitor, uint32_t latencyCycles) {
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+  addTime(&monitor->latency, latencyCycles);
+  __set_PRIMASK(primask);
+}
+/**
+ * @brief Records the entry latency of a handler (use IRQ_MONITOR_LATENCY_MICROS instead)
+ * @param monitor Handler monitor
+ * @param latencyMicros Microseconds from the hardware event to handler entry
+ */
+void IrqMonitor_recordLatencyMicros(IrqMonitor* monitor, uint32_t latencyMicros) {
+  const uint32_t CYCLES_PER_MICROSECOND = CycleCounter_getFrequencyHz() / 1000000;
+  IrqMonitor_recordLatency(monitor, latencyMicros * CYCLES_PER_MICROSECOND);
+}
+/**
+ * @brief Finds a handler monitor
+ * @param name Handler name (argument of IRQ_MONITOR)
+ * @return Handler monitor or NULL if the handler hasn't run yet
+ */
+const IrqMonitor* IrqMonitor_find(const char* name) {
+  for (IrqMonitor* monitor = monitorList; monitor != NULL; monitor = monitor->next) {
+    if (!strcmp(monitor->name, name)) {
+      return monitor;
+    }
+  }
+  return NULL;
+}
+/**
+ * @brief Gets the total IRQ load
+ * @return Share of time spent in monitored handlers since last reset of
+ * statistics in tenths of percent
+ */
+unsigned int IrqMonitor_getLoadPermille(void) {
+  const int PERMILLE = 1000;
+  __disable_irq();
+  uint64_t busy = busyCycles;
+  __enable_irq();
+  uint64_t elapsedCycles = CycleCounter_getCycles64() - statisticsStartCycles;
+  if (elapsedCycles == 0) {
+    return 0;
+  }
+  return (unsigned int)(busy * PERMILLE / elapsedCycles);
+}
+/**
+ * @brief Zeroes statistics of all handlers
+ */
+void IrqMonitor_resetStatistics(void) {
+  __disable_irq();
+  for (IrqMonitor* monitor = monitorList; monitor != NULL; monitor = monitor->next) {
+    memset(&monitor->execution, 0, sizeof(IrqMonitorTimes));
+    memset(&monitor->latency, 0, sizeof(IrqMonitorTimes));
+  }
+  busyCycles = 0;
+  statisticsStartCycles = CycleCounter_getCycles64();
+  __enable_irq();
+}
+/**
+ * @brief Prints statistics of all handlers and the total IRQ load
+ * @details Times are in cycles, load in tenths of percent. Handlers without
+ * latency measurement print a latency of 0.
+ */
+void IrqMonitor_printStatistics(void) {
+  const int PERMILLE = 1000;
+  uint64_t elapsedCycles = CycleCounter_getCycles64() - statisticsStartCycles;
+  if (elapsedCycles == 0) {
+    return;
+  }
+  println("%-10s %10s %8s %8s %8s %8s %8s %5s", "irq", "count", "rate/s", "avg cyc",
+      "max cyc", "lat avg", "lat max", "load");
+  for (IrqMonitor* monitor = monitorList; monitor != NULL; monitor = monitor->next) {
+    __disable_irq();
+    IrqMonitorTimes execution = monitor->execution;
+    IrqMonitorTimes latency = monitor->latency;
+    __enable_irq();
+    println("%-10s %10u %8u %8u %8u %8u %8u %5u", monitor->name, execution.count,
+        (unsigned int)((uint64_t)execution.count * CycleCounter_getFrequencyHz() / elapsedCycles),
+        execution.count ? (unsigned int)(execution.totalCycles / execution.count) : 0,
+        (unsigned int)execution.maximumCycles,
+        latency.count ? (unsigned int)(latency.totalCycles / latency.count) : 0,
+        (unsigned int)latency.maximumCycles,
+        (unsigned int)(execution.totalCycles * PERMILLE / elapsedCycles));
+  }
+  println("%-10s %10s %8s %8s %8s %8s %8s %5u", "total", "", "", "", "", "", "",
+      IrqMonitor_getLoadPermille());
+}
+/**
+ * @brief Prints histograms of execution times and latencies of all handlers
+ * @details Every bin is printed as <upper limit in cycles>:<count>, empty
+ * bins are skipped.
+ */
+void IrqMonitor_printHistograms(void) {
+  for (IrqMonitor* monitor = monitorList; monitor != NULL; monitor = monitor->next) {
+    printHistogram(monitor->name, "execution", &monitor->execution);
+    printHistogram(monitor->name, "latency", &monitor->latency);
+  }
+}
+/**
+ * @brief Adds a measured time to statistics (called with IRQs disabled)
+ * @param times Statistics
+ * @param cycles Measured time
+ */
+void addTime(IrqMonitorTimes* times, uint32_t cycles) {
+  const int BITS_IN_WORD = 32;
+  const int FIRST_BIN_SHIFT = __builtin_ctz(IRQ_MONITOR_HISTOGRAM_FIRST_BIN);
+  uint32_t scaledCycles = cycles >> FIRST_BIN_SHIFT;
+  int bin = scaledCycles ? BITS_IN_WORD - __builtin_clz(scaledCycles) : 0;
+  if (bin >= IRQ_MONITOR_HISTOGRAM_BINS) {
+    bin = IRQ_MONITOR_HISTOGRAM_BINS - 1;
+  }
+  times->histogram[bin]++;
+  times->count++;
+  times->totalCycles += cycles;
+  if (cycles > times->maximumCycles) {
+    times->maximumCycles = cycles;
+  }
+}
+/**
+ * @brief Prints one histogram
+ * @param name Handler name
+ * @param kind Measured time
+ * @param times Statistics
+ */
+void printHistogram(const char* name, const char* kind, const IrqMonitorTimes* times) {
+  __disable_irq();
+  IrqMonitorTimes copy = *times;
+  __enable_irq();
+  if (copy.count == 0) {
+    return;
+  }
+  printf("IRQ--> %s %s:", name, kind);
+  for (int i = 0; i < IRQ_MONITOR_HISTOGRAM_BINS; i++) {
+    if (copy.histogram[i] == 0) {
+      continue;
+    }
+    if (i == IRQ_MONITOR_HISTOGRAM_BINS - 1) {
+      printf(" >=%u:%u", (unsigned int)IRQ_MONITOR_HISTOGRAM_FIRST_BIN << (i - 1),
+          copy.histogram[i]);
+    } else {
+      printf(" <%u:%u", (unsigned int)IRQ_MONITOR_HISTOGRAM_FIRST_BIN << i, copy.histogram[i]);
+    }
+  }
+  printf("\r\n");
+}
+/**
+ * @}
+ */
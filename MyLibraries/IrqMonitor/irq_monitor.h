@@ -0,0 +1,123 @@
+/**
+ * @file    irq_monitor.h
+ * @brief   Interrupt latency and load monitor.
+ * @details Every monitored IRQ handler counts its runs and measures its
+ * execution time with the core cycle counter. Handlers of peripherals which
+ * latch the time of their event (timers, SysTick) also record the entry
+ * latency - the time from the hardware event to the handler. Execution
+ * times and latencies are kept in histograms with logarithmic bins.
+ * The time spent in all monitored handlers (nested handlers counted once)
+ * gives the total IRQ load, so IRQ storms show up as a high rate and load.
+ * @code
+ * void TIM4_IRQHandler(void) {
+ *   IRQ_MONITOR(tim4); // measured until the handler returns
+ *   IRQ_MONITOR_LATENCY_MICROS(tim4, TIM4->CNT); // counter restarted at the event
+ *   ...
+ * }
+ * @endcode
+ * The macros generate code only when IRQ_MONITOR_ENABLE is defined for the
+ * whole project.
+ * @date    19.10.2026
+ * @author  Michal Ksiezopolski
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#ifndef IRQ_MONITOR_H_
+#define IRQ_MONITOR_H_
+
+#include "utils.h"
+#include <inttypes.h>
+
+/**
+ * @defgroup  IRQ_MONITOR IRQ_MONITOR
+ * @brief     Interrupt latency and load monitor
+ */
+
+/**
+ * @addtogroup IRQ_MONITOR
+ * @{
+ */
+
+#define IRQ_MONITOR_HISTOGRAM_BINS        16  ///< Number of histogram bins
+#define IRQ_MONITOR_HISTOGRAM_FIRST_BIN   64  ///< Upper limit of first bin in cycles (next bins double)
+
+/**
+ * @brief Statistics of measured times
+ */
+typedef struct {
+  unsigned int count;       ///< Number of measurements
+  uint32_t maximumCycles;   ///< Longest time
+  uint64_t totalCycles;     ///< Sum of times
+  unsigned int histogram[IRQ_MONITOR_HISTOGRAM_BINS]; ///< Number of times in every bin
+} IrqMonitorTimes;
+/**
+ * @brief Monitored IRQ handler
+ * @details Defined by IRQ_MONITOR as a static variable - registered on
+ * first entry.
+ */
+typedef struct IrqMonitor {
+  const char* name;           ///< Handler name
+  Boolean isRegistered;       ///< Is in the list of handlers
+  struct IrqMonitor* next;    ///< Next registered handler
+  IrqMonitorTimes execution;  ///< Execution times (preemption by other IRQs included)
+  IrqMonitorTimes latency;    ///< Entry latencies (only for handlers recording them)
+} IrqMonitor;
+/**
+ * @brief Handler entry of IRQ_MONITOR (left when the handler returns)
+ */
+typedef struct {
+  IrqMonitor* monitor;  ///< Entered handler
+  uint32_t enterCycles; ///< Time stamp of entry
+} IrqMonitorScope;
+
+void              IrqMonitor_initialize           (void);
+uint32_t          IrqMonitor_enter                (IrqMonitor* monitor);
+void              IrqMonitor_exit                 (IrqMonitor* monitor, uint32_t enterCycles);
+void              IrqMonitor_exitScope            (IrqMonitorScope* scope);
+void              IrqMonitor_recordLatency        (IrqMonitor* monitor, uint32_t latencyCycles);
+void              IrqMonitor_recordLatencyMicros  (IrqMonitor* monitor, uint32_t latencyMicros);
+const IrqMonitor* IrqMonitor_find                 (const char* name);
+unsigned int      IrqMonitor_getLoadPermille      (void);
+void              IrqMonitor_resetStatistics      (void);
+void              IrqMonitor_printStatistics      (void);
+void              IrqMonitor_printHistograms      (void);
+
+#ifdef IRQ_MONITOR_ENABLE
+  /**
+   * @brief Monitors the IRQ handler from here to its end
+   * @details Should be the first statement of the handler. The monitor
+   * variable is irqIrqMonitor, its name is irq.
+   */
+  #define IRQ_MONITOR(irq) \
+    static IrqMonitor irq##IrqMonitor = {.name = #irq}; \
+    IrqMonitorScope irq##IrqMonitorScope __attribute__((cleanup(IrqMonitor_exitScope))) = \
+        {&irq##IrqMonitor, IrqMonitor_enter(&irq##IrqMonitor)}
+  /**
+   * @brief Records the entry latency of the handler in cycles
+   */
+  #define IRQ_MONITOR_LATENCY(irq, latencyCycles) \
+    IrqMonitor_recordLatency(&irq##IrqMonitor, latencyCycles)
+  /**
+   * @brief Records the entry latency of the handler in microseconds
+   */
+  #define IRQ_MONITOR_LATENCY_MICROS(irq, latencyMicros) \
+    IrqMonitor_recordLatencyMicros(&irq##IrqMonitor, latencyMicros)
+#else
+  #define IRQ_MONITOR(irq)                                (void)0
+  #define IRQ_MONITOR_LATENCY(irq, latencyCycles)         (void)0
+  #define IRQ_MONITOR_LATENCY_MICROS(irq, latencyMicros)  (void)0
+#endif
+/**
+ * @}
+ */
+
+#endif /* IRQ_MONITOR_H_ */
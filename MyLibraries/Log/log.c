@@ -0,0 +1,144 @@
+/**
+ * @file    log.c
+ * @brief   Deferred binary logging.
+ * @date    19.10.2026
+ * @author  Michal Ksiezopolski
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#include "log.h"
+#include "fifo.h"
+#include "timers.h"
+#include "utils.h"
+#include "boards.h"
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * @addtogroup LOG
+ * @{
+ */
+
+#ifndef LOG_BUFFER_LENGTH
+  #define LOG_BUFFER_LENGTH   1024  ///< Length of the record ring buffer (power of two)
+#endif
+
+#define LOG_RECORD_MARKER     0xa5  ///< First byte of every binary record
+#define LOG_HEADER_LENGTH     10    ///< Marker, level/count, format address, time stamp
+#define LOG_MAXIMUM_RECORD_LENGTH (LOG_HEADER_LENGTH + 4 * LOG_MAXIMUM_ARGUMENTS)
+
+/*
+ * Binary record layout (little endian):
+ * [0]    LOG_RECORD_MARKER
+ * [1]    level << 4 | number of arguments
+ * [2-5]  address of the format string (in .log_strings)
+ * [6-9]  time stamp in milliseconds
+ * [10-]  arguments, 4 bytes each
+ */
+
+static char logBuffer[LOG_BUFFER_LENGTH];     ///< Buffer for log records
+static Fifo logFifo FAST_BSS;                 ///< Log record FIFO
+static Boolean isInitialized;                 ///< Records are dropped until the FIFO is ready
+static LogOutput binaryOutput;                ///< Output for binary records (NULL - print text)
+static volatile unsigned int droppedCount;    ///< Number of records dropped due to full buffer
+
+/**
+ * @brief Initializes logging
+ * @param output Function for writing binary records or NULL to print
+ * the records as text with printf
+ */
+void Log_initialize(LogOutput output) {
+  binaryOutput = output;
+  droppedCount = 0;
+  Fifo_addNewFifo(&logFifo, logBuffer, LOG_BUFFER_LENGTH);
+  isInitialized = TRUE;
+}
+/**
+ * @brief Stores a log record (use the LOG_xxx macros instead)
+ * @details Can be called from IRQs. The record is pushed with IRQs disabled,
+ * so records from different priorities don't interleave - this takes only a
+ * copy of a few words. No formatting is done here.
+ * @param level Log level
+ * @param format Format string
+ * @param argumentCount Number of arguments
+ * @param arguments Arguments
+ */
+void Log_write(int level, const char* format, int argumentCount, const uint32_t* arguments) {
+  if (!isInitialized) {
+    return;
+  }
+  if (argumentCount > LOG_MAXIMUM_ARGUMENTS) {
+    argumentCount = LOG_MAXIMUM_ARGUMENTS;
+  }
+
+  char record[LOG_MAXIMUM_RECORD_LENGTH];
+  uint32_t formatAddress = (uint32_t)(uintptr_t)format;
+  uint32_t timeStamp = Timer_getTimeMillis();
+  record[0] = (char)LOG_RECORD_MARKER;
+  record[1] = (char)((level << 4) | argumentCount);
+  memcpy(record + 2, &formatAddress, sizeof(formatAddress));
+  memcpy(record + 6, &timeStamp, sizeof(timeStamp));
+  memcpy(record + LOG_HEADER_LENGTH, arguments, 4 * argumentCount);
+  int length = LOG_HEADER_LENGTH + 4 * argumentCount;
+
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+  if (Fifo_getFreeSpace(&logFifo) >= length) {
+    Fifo_pushMultiple(&logFifo, record, length);
+  } else {
+    droppedCount++;
+  }
+  __set_PRIMASK(primask);
+}
+/**
+ * @brief Outputs stored records
+ * @details Call from the main loop (or a low priority task) - the records
+ * are formatted or sent here, outside of the code that logged them.
+ * @return Number of processed records
+ */
+int Log_process(void) {
+  if (!isInitialized) {
+    return 0;
+  }
+  int processed = 0;
+  char record[LOG_MAXIMUM_RECORD_LENGTH];
+  // records are pushed whole, so a header means the whole record is there
+  while (Fifo_popMultiple(&logFifo, record, LOG_HEADER_LENGTH) == LOG_HEADER_LENGTH) {
+    int argumentCount = record[1] & 0x0f;
+    Fifo_popMultiple(&logFifo, record + LOG_HEADER_LENGTH, 4 * argumentCount);
+    processed++;
+
+    if (binaryOutput != NULL) {
+      binaryOutput(record, LOG_HEADER_LENGTH + 4 * argumentCount);
+      continue;
+    }
+    uint32_t formatAddress;
+    uint32_t arguments[LOG_MAXIMUM_ARGUMENTS] = {0};
+    memcpy(&formatAddress, record + 2, sizeof(formatAddress));
+    memcpy(arguments, record + LOG_HEADER_LENGTH, 4 * argumentCount);
+    // unused arguments are ignored by printf
+    printf((const char*)(uintptr_t)formatAddress, arguments[0], arguments[1],
+        arguments[2], arguments[3], arguments[4], arguments[5], arguments[6], arguments[7]);
+    printf("\r\n");
+  }
+  return processed;
+}
+/**
+ * @brief Gets number of records dropped due to full buffer
+ * @return Number of dropped records
+ */
+unsigned int Log_getDroppedCount(void) {
+  return droppedCount;
+}
+/**
+ * @}
+ */
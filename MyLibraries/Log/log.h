@@ -0,0 +1,131 @@
+/**
+ * @file    log.h
+ * @brief   Deferred binary logging.
+ * @details A log call only stores a record (format string address, time
+ * stamp and raw 32 bit arguments) in a RAM ring buffer. Log_process, called
+ * from the main loop, prints the records or sends them as binary for
+ * log_decoder.py, which looks up the format strings in the ELF file.
+ *
+ * Usage in a module:
+ * @code
+ * #ifndef MODULE_LOG_LEVEL
+ *   #define MODULE_LOG_LEVEL LOG_LEVEL_DEBUG
+ * #endif
+ * #define LOG_MODULE_LEVEL MODULE_LOG_LEVEL
+ * #include "log.h"
+ *
+ * LOG_INFO("Read sector %u", sector);
+ * @endcode
+ * Calls above LOG_MODULE_LEVEL are removed by the preprocessor. Arguments
+ * are stored as 32 bit integers (up to LOG_MAXIMUM_ARGUMENTS), so floating
+ * point values are not supported and %s may only point to strings that
+ * outlive the record (e.g. string literals).
+ * @date    19.10.2026
+ * @author  Michal Ksiezopolski
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#ifndef LOG_H_
+#define LOG_H_
+
+#include <inttypes.h>
+#include <stdint.h>
+
+/**
+ * @defgroup  LOG LOG
+ * @brief     Deferred binary logging
+ */
+
+/**
+ * @addtogroup LOG
+ * @{
+ */
+
+#define LOG_LEVEL_NONE        0 ///< Logging disabled
+#define LOG_LEVEL_ERROR       1 ///< Errors only
+#define LOG_LEVEL_WARNING     2 ///< Errors and warnings
+#define LOG_LEVEL_INFO        3 ///< Normal messages
+#define LOG_LEVEL_DEBUG       4 ///< Everything
+
+#define LOG_MAXIMUM_ARGUMENTS 8 ///< Maximum number of arguments of a log call
+
+#ifndef LOG_MODULE_LEVEL
+  #define LOG_MODULE_LEVEL LOG_LEVEL_INFO ///< Log level of the module including this header
+#endif
+
+/**
+ * @brief Function writing binary records (e.g. a wrapper of SerialPort_write)
+ */
+typedef int (*LogOutput)(const char* data, int length);
+
+void         Log_initialize      (LogOutput binaryOutput);
+void         Log_write           (int level, const char* format, int argumentCount,
+                                  const uint32_t* arguments);
+int          Log_process         (void);
+unsigned int Log_getDroppedCount (void);
+
+/*
+ * Argument counting and conversion - every argument is stored as
+ * a 32 bit integer.
+ */
+#define LOG_CONCATENATE(a, b)   LOG_CONCATENATE_(a, b)
+#define LOG_CONCATENATE_(a, b)  a##b
+#define LOG_COUNT(args...)      LOG_COUNT_(0, ##args, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define LOG_COUNT_(_0, _1, _2, _3, _4, _5, _6, _7, _8, count, ...) count
+#define LOG_ARGUMENT(a)         (uint32_t)(uintptr_t)(a),
+#define LOG_ARGUMENTS_0()
+#define LOG_ARGUMENTS_1(a)                LOG_ARGUMENT(a)
+#define LOG_ARGUMENTS_2(a, b)             LOG_ARGUMENT(a) LOG_ARGUMENTS_1(b)
+#define LOG_ARGUMENTS_3(a, b, c)          LOG_ARGUMENT(a) LOG_ARGUMENTS_2(b, c)
+#define LOG_ARGUMENTS_4(a, b, c, d)       LOG_ARGUMENT(a) LOG_ARGUMENTS_3(b, c, d)
+#define LOG_ARGUMENTS_5(a, b, c, d, e)    LOG_ARGUMENT(a) LOG_ARGUMENTS_4(b, c, d, e)
+#define LOG_ARGUMENTS_6(a, b, c, d, e, f) LOG_ARGUMENT(a) LOG_ARGUMENTS_5(b, c, d, e, f)
+#define LOG_ARGUMENTS_7(a, b, c, d, e, f, g)    LOG_ARGUMENT(a) LOG_ARGUMENTS_6(b, c, d, e, f, g)
+#define LOG_ARGUMENTS_8(a, b, c, d, e, f, g, h) LOG_ARGUMENT(a) LOG_ARGUMENTS_7(b, c, d, e, f, g, h)
+
+/**
+ * @brief Stores a log record
+ * @details The format string is placed in the .log_strings section and its
+ * address is the ID of the record.
+ */
+#define LOG_RECORD(level, format, args...) do { \
+    static const char logFormat[] __attribute__((section(".log_strings"))) = format; \
+    const uint32_t logArguments[] = { LOG_CONCATENATE(LOG_ARGUMENTS_, LOG_COUNT(args))(args) 0 }; \
+    Log_write(level, logFormat, LOG_COUNT(args), logArguments); \
+  } while (0)
+
+#if LOG_MODULE_LEVEL >= LOG_LEVEL_ERROR
+  #define LOG_ERROR(format, args...) LOG_RECORD(LOG_LEVEL_ERROR, format, ##args)
+#else
+  #define LOG_ERROR(format, args...) (void)0
+#endif
+#if LOG_MODULE_LEVEL >= LOG_LEVEL_WARNING
+  #define LOG_WARNING(format, args...) LOG_RECORD(LOG_LEVEL_WARNING, format, ##args)
+#else
+  #define LOG_WARNING(format, args...) (void)0
+#endif
+#if LOG_MODULE_LEVEL >= LOG_LEVEL_INFO
+  #define LOG_INFO(format, args...) LOG_RECORD(LOG_LEVEL_INFO, format, ##args)
+#else
+  #define LOG_INFO(format, args...) (void)0
+#endif
+#if LOG_MODULE_LEVEL >= LOG_LEVEL_DEBUG
+  #define LOG_DEBUG(format, args...) LOG_RECORD(LOG_LEVEL_DEBUG, format, ##args)
+#else
+  #define LOG_DEBUG(format, args...) (void)0
+#endif
+
+/**
+ * @}
+ */
+
+#endif /* LOG_H_ */
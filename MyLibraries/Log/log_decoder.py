@@ -0,0 +1,124 @@
+#!/usr/bin/env python3
+#
+# @file    log_decoder.py
+# @brief   Decodes binary log records sent by the LOG module.
+# @details Format strings are not sent by the target - every record holds
+# the address of its format string, which is read from the ELF file.
+#
+#          log_decoder.py firmware.elf [capture.bin]
+#
+# Reads the capture from stdin when no file is given (e.g. piped from a
+# serial port). Only the Python standard library is needed.
+# @date    19.10.2026
+# @author  Michal Ksiezopolski
+#
+# Copyright (c) 2026 Michal Ksiezopolski.
+# All rights reserved. This program and the
+# accompanying materials are made available
+# under the terms of the GNU Public License
+# v3.0 which accompanies this distribution,
+# and is available at
+# http://www.gnu.org/licenses/gpl.html
+#
+
+import re
+import struct
+import sys
+
+RECORD_MARKER = 0xa5
+HEADER_LENGTH = 10
+MAXIMUM_ARGUMENTS = 8
+LEVEL_NAMES = {1: "ERROR", 2: "WARNING", 3: "INFO", 4: "DEBUG"}
+SHF_ALLOC = 0x2
+SHT_NOBITS = 8
+# printf conversion: flags, width, precision, length modifier, conversion
+CONVERSION = re.compile(r"%([-+ #0]*)(\d*)(\.\d+)?(hh|h|ll|l|z|j|t)?([diouxXcsp%])")
+
+
+class ElfImage:
+    """Contents of the allocated sections of a 32 bit little endian ELF file"""
+
+    def __init__(self, fileName):
+        with open(fileName, "rb") as elfFile:
+            data = elfFile.read()
+        if data[:4] != b"\x7fELF" or data[4] != 1 or data[5] != 1:
+            raise ValueError("not a 32 bit little endian ELF file")
+        sectionOffset, = struct.unpack_from("<I", data, 0x20)
+        sectionSize, sectionCount = struct.unpack_from("<HH", data, 0x2e)
+        self.sections = []
+        for i in range(sectionCount):
+            (_, sectionType, flags, address, offset, size) = struct.unpack_from(
+                "<IIIIII", data, sectionOffset + i * sectionSize)
+            if flags & SHF_ALLOC and sectionType != SHT_NOBITS and size > 0:
+                self.sections.append((address, data[offset:offset + size]))
+
+    def readString(self, address):
+        for start, contents in self.sections:
+            if start <= address < start + len(contents):
+                end = contents.find(b"\0", address - start)
+                return contents[address - start:end].decode("ascii", "replace")
+        return None
+
+
+def formatRecord(elf, formatAddress, arguments):
+    format = elf.readString(formatAddress)
+    if format is None:
+        return "<unknown format 0x%08x> %s" % (formatAddress,
+            " ".join("0x%08x" % argument for argument in arguments))
+    remaining = list(arguments)
+
+    def convert(match):
+        flags, width, precision, _, conversion = match.groups()
+        if conversion == "%":
+            return "%"
+        value = remaining.pop(0) if remaining else 0
+        specification = "%" + flags + width + (precision or "")
+        if conversion in "di":
+            return (specification + "d") % (value - (1 << 32) if value & 0x80000000 else value)
+        if conversion == "u":
+            return (specification + "d") % value
+        if conversion == "c":
+            return (specification + "c") % chr(value & 0xff)
+        if conversion == "p":
+            return "0x%08x" % value
+        if conversion == "s":
+            string = elf.readString(value)
+            return (specification + "s") % (string if string is not None else "<0x%08x>" % value)
+        return (specification + conversion) % value
+
+    return CONVERSION.sub(convert, format)
+
+
+def decode(elf, stream):
+    data = stream.read()
+    position = 0
+    while position + HEADER_LENGTH <= len(data):
+        if data[position] != RECORD_MARKER:
+            position += 1 # resynchronize
+            continue
+        level = data[position + 1] >> 4
+        argumentCount = data[position + 1] & 0x0f
+        length = HEADER_LENGTH + 4 * argumentCount
+        if argumentCount > MAXIMUM_ARGUMENTS or position + length > len(data):
+            position += 1
+            continue
+        formatAddress, timeStamp = struct.unpack_from("<II", data, position + 2)
+        arguments = struct.unpack_from("<%dI" % argumentCount, data, position + HEADER_LENGTH)
+        print("%10u %-7s %s" % (timeStamp, LEVEL_NAMES.get(level, "?"),
+            formatRecord(elf, formatAddress, arguments)))
+        position += length
+
+
+def main():
+    if len(sys.argv) < 2:
+        sys.exit("usage: log_decoder.py firmware.elf [capture.bin]")
+    elf = ElfImage(sys.argv[1])
+    if len(sys.argv) > 2:
+        with open(sys.argv[2], "rb") as capture:
+            decode(elf, capture)
+    else:
+        decode(elf, sys.stdin.buffer)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,354 @@
+/**
+ * @file    memory_pool.c
+ * @brief   Fixed size block pool allocator.
+ * @date    19.10.2026
+ * @author  Michal Ksiezopolski
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#include "memory_pool.h"
+#include "boards.h"
+#include <stdio.h>
+#include <string.h>
+#ifdef MEMORY_POOL_NEWLIB_MALLOC
+  #include <errno.h>
+  #include <reent.h>
+#endif
+
+#ifndef MEMORY_POOL_DEBUG
+  #define MEMORY_POOL_DEBUG
+#endif
+
+#ifdef MEMORY_POOL_DEBUG
+  #define println(str, args...) printf("POOL--> "str"%s",##args,"\r\n")
+#else
+  #define println(str, args...) (void)0
+#endif
+
+/**
+ * @addtogroup MEMORY_POOL
+ * @{
+ */
+
+#define FREE_BLOCK_MAGIC 0xf4eeb10cu ///< Marks blocks in the free list
+
+/**
+ * @brief Free block (the link is stored in the block itself)
+ * @details The magic makes a double free cheap to detect - only a freed
+ * block carrying it is looked up in the free list. It fits in the
+ * smallest (aligned) block.
+ */
+typedef struct FreeBlock {
+  struct FreeBlock* next; ///< Next free block
+  uint32_t magic;         ///< FREE_BLOCK_MAGIC while the block is free
+} FreeBlock;
+
+static MemoryPool* poolList; ///< Initialized pools sorted by block size
+
+static void addToPoolList(MemoryPool* pool);
+static Boolean isInFreeList(MemoryPool* pool, FreeBlock* block);
+
+/**
+ * @brief Initializes a pool
+ * @details Blocks are aligned to MEMORY_POOL_ALIGNMENT - define the buffer
+ * with MEMORY_POOL_BUFFER.
+ * @param pool Pool
+ * @param name Pool name
+ * @param buffer Buffer for blocks
+ * @param blockSize Size of block (rounded up to the alignment)
+ * @param blockCount Number of blocks
+ * @retval MEMORY_POOL_OK Pool initialized
+ * @retval MEMORY_POOL_INVALID_BUFFER Buffer not aligned or no blocks
+ */
+MemoryPoolResultCode MemoryPool_initialize(MemoryPool* pool, const char* name,
+    void* buffer, size_t blockSize, unsigned int blockCount) {
+  if (((uintptr_t)buffer & (MEMORY_POOL_ALIGNMENT - 1)) != 0 || blockSize == 0 ||
+      MEMORY_POOL_ALIGNED_BLOCK_SIZE(blockSize) < sizeof(FreeBlock) || blockCount == 0) {
+    return MEMORY_POOL_INVALID_BUFFER;
+  }
+  pool->name = name;
+  pool->blockSize = MEMORY_POOL_ALIGNED_BLOCK_SIZE(blockSize);
+  pool->blockCount = blockCount;
+  pool->start = buffer;
+  pool->end = pool->start + pool->blockSize * blockCount;
+  pool->isHeapPool = FALSE;
+  // link all blocks, first block at the head
+  FreeBlock* block = NULL;
+  for (unsigned int i = blockCount; i > 0; i--) {
+    FreeBlock* previous = (FreeBlock*)(pool->start + (i - 1) * pool->blockSize);
+    previous->next = block;
+    previous->magic = FREE_BLOCK_MAGIC;
+    block = previous;
+  }
+  pool->freeBlocks = block;
+  pool->usedBlocks = 0;
+  MemoryPool_resetStatistics(pool);
+  addToPoolList(pool);
+  return MEMORY_POOL_OK;
+}
+/**
+ * @brief Allocates a block (constant time, can be called from IRQs)
+ * @param pool Pool
+ * @return Block or NULL if the pool is empty
+ */
+void* MemoryPool_allocate(MemoryPool* pool) {
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+  FreeBlock* block = pool->freeBlocks;
+  if (block == NULL) {
+    pool->failedAllocations++;
+  } else {
+    pool->freeBlocks = block->next;
+    block->magic = 0;
+    pool->usedBlocks++;
+    if (pool->usedBlocks > pool->maximumUsedBlocks) {
+      pool->maximumUsedBlocks = pool->usedBlocks;
+    }
+  }
+  __set_PRIMASK(primask);
+  return block;
+}
+/**
+ * @brief Frees a block (constant time, can be called from IRQs)
+ * @details Rejected frees are counted in the pool statistics. A block
+ * already free is found in the free list only if it still carries the free
+ * block magic (user data equal to the magic costs a walk of the list).
+ * @param pool Pool of the block
+ * @param block Block returned by MemoryPool_allocate
+ * @retval MEMORY_POOL_OK Block freed
+ * @retval MEMORY_POOL_INVALID_BLOCK Block is not from this pool (nothing done)
+ * @retval MEMORY_POOL_DOUBLE_FREE Block is already free (nothing done)
+ */
+MemoryPoolResultCode MemoryPool_free(MemoryPool* pool, void* block) {
+  uint8_t* address = block;
+  MemoryPoolResultCode result = MEMORY_POOL_OK;
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+  if (address < pool->start || address >= pool->end ||
+      (size_t)(address - pool->start) % pool->blockSize != 0) {
+    result = MEMORY_POOL_INVALID_BLOCK;
+  } else {
+    FreeBlock* freeBlock = block;
+    if (pool->usedBlocks == 0 ||
+        (freeBlock->magic == FREE_BLOCK_MAGIC && isInFreeList(pool, freeBlock))) {
+      result = MEMORY_POOL_DOUBLE_FREE;
+    } else {
+      freeBlock->next = pool->freeBlocks;
+      freeBlock->magic = FREE_BLOCK_MAGIC;
+      pool->freeBlocks = freeBlock;
+      pool->usedBlocks--;
+    }
+  }
+  if (result != MEMORY_POOL_OK) {
+    pool->invalidFrees++;
+  }
+  __set_PRIMASK(primask);
+  return result;
+}
+/**
+ * @brief Zeroes the failure counter and sets the high-water mark to current use
+ * @param pool Pool
+ */
+void MemoryPool_resetStatistics(MemoryPool* pool) {
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+  pool->maximumUsedBlocks = pool->usedBlocks;
+  pool->failedAllocations = 0;
+  pool->invalidFrees = 0;
+  __set_PRIMASK(primask);
+}
+/**
+ * @brief Lets the pool serve MemoryPool_heapAllocate
+ * @param pool Initialized pool
+ */
+void MemoryPool_addToHeap(MemoryPool* pool) {
+  pool->isHeapPool = TRUE;
+}
+/**
+ * @brief Allocates a block from the heap pools
+ * @details Takes a block from the smallest heap pool with big enough blocks.
+ * If that pool is empty the next larger pools are tried, so the time is
+ * bounded by the number of pools.
+ * @param size Requested size
+ * @return Block or NULL if all fitting pools are empty
+ */
+void* MemoryPool_heapAllocate(size_t size) {
+  for (MemoryPool* pool = poolList; pool != NULL; pool = pool->next) {
+    if (!pool->isHeapPool || pool->blockSize < size) {
+      continue;
+    }
+    void* block = MemoryPool_allocate(pool);
+    if (block != NULL) {
+      return block;
+    }
+  }
+  return NULL;
+}
+/**
+ * @brief Frees a block from the heap pools
+ * @param block Block returned by MemoryPool_heapAllocate
+ * @retval MEMORY_POOL_OK Block freed
+ * @retval MEMORY_POOL_INVALID_BLOCK Block is not from a heap pool (nothing done)
+ * @retval MEMORY_POOL_DOUBLE_FREE Block is already free (nothing done)
+ */
+MemoryPoolResultCode MemoryPool_heapFree(void* block) {
+  MemoryPool* pool = MemoryPool_findPool(block);
+  if (pool == NULL || !pool->isHeapPool) {
+    return MEMORY_POOL_INVALID_BLOCK;
+  }
+  return MemoryPool_free(pool, block);
+}
+/**
+ * @brief Finds the pool of a block
+ * @param block Block
+ * @return Pool containing the address or NULL
+ */
+MemoryPool* MemoryPool_findPool(void* block) {
+  uint8_t* address = block;
+  for (MemoryPool* pool = poolList; pool != NULL; pool = pool->next) {
+    if (address >= pool->start && address < pool->end) {
+      return pool;
+    }
+  }
+  return NULL;
+}
+/**
+ * @brief Prints statistics of all pools (heap pools marked with *)
+ */
+void MemoryPool_printStatistics(void) {
+  println("%-12s %6s %6s %6s %6s %6s %7s", "pool", "size", "blocks", "used", "max", "failed",
+      "invalid");
+  for (MemoryPool* pool = poolList; pool != NULL; pool = pool->next) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    MemoryPool copy = *pool;
+    __set_PRIMASK(primask);
+    println("%-11s%c %6u %6u %6u %6u %6u %7u", copy.name, copy.isHeapPool ? '*' : ' ',
+        (unsigned int)copy.blockSize, copy.blockCount, copy.usedBlocks,
+        copy.maximumUsedBlocks, copy.failedAllocations, copy.invalidFrees);
+  }
+}
+/**
+ * @brief Inserts a pool into the list sorted by block size
+ * @param pool Pool
+ */
+void addToPoolList(MemoryPool* pool) {
+  MemoryPool** link = &poolList;
+  while (*link != NULL && *link != pool) {
+    link = &(*link)->next;
+  }
+  if (*link == pool) { // initialized again
+    *link = pool->next;
+  }
+  link = &poolList;
+  while (*link != NULL && (*link)->blockSize <= pool->blockSize) {
+    link = &(*link)->next;
+  }
+  pool->next = *link;
+  *link = pool;
+}
+/**
+ * @brief Checks if a block is in the free list of its pool
+ * @details Walks the whole list - called with IRQs disabled, only for blocks
+ * carrying the free block magic.
+ * @param pool Pool
+ * @param block Block of the pool
+ * @return TRUE if the block is free
+ */
+Boolean isInFreeList(MemoryPool* pool, FreeBlock* block) {
+  for (FreeBlock* freeBlock = pool->freeBlocks; freeBlock != NULL; freeBlock = freeBlock->next) {
+    if (freeBlock == block) {
+      return TRUE;
+    }
+  }
+  return FALSE;
+}
+
+#ifdef MEMORY_POOL_NEWLIB_MALLOC
+// ******************* newlib malloc family on heap pools *******************
+/**
+ * @brief Allocates memory (newlib malloc)
+ * @param reent Reentrancy structure
+ * @param size Requested size
+ * @return Block or NULL (errno ENOMEM)
+ */
+void* _malloc_r(struct _reent* reent, size_t size) {
+  void* block = MemoryPool_heapAllocate(size);
+  if (block == NULL) {
+    reent->_errno = ENOMEM;
+  }
+  return block;
+}
+/**
+ * @brief Frees memory (newlib free)
+ * @param reent Reentrancy structure
+ * @param block Block or NULL
+ */
+void _free_r(struct _reent* reent, void* block) {
+  if (block != NULL) {
+    MemoryPool_heapFree(block);
+  }
+}
+/**
+ * @brief Allocates zeroed memory (newlib calloc)
+ * @param reent Reentrancy structure
+ * @param count Number of elements
+ * @param size Size of element
+ * @return Block or NULL (errno ENOMEM)
+ */
+void* _calloc_r(struct _reent* reent, size_t count, size_t size) {
+  if (size != 0 && count > SIZE_MAX / size) {
+    reent->_errno = ENOMEM;
+    return NULL;
+  }
+  void* block = _malloc_r(reent, count * size);
+  if (block != NULL) {
+    memset(block, 0, count * size);
+  }
+  return block;
+}
+/**
+ * @brief Resizes memory (newlib realloc)
+ * @details The block is kept if it is big enough, otherwise the data is
+ * moved to a block of a larger pool.
+ * @param reent Reentrancy structure
+ * @param block Block or NULL
+ * @param size New size
+ * @return Block or NULL (errno ENOMEM, old block is kept)
+ */
+void* _realloc_r(struct _reent* reent, void* block, size_t size) {
+  if (block == NULL) {
+    return _malloc_r(reent, size);
+  }
+  if (size == 0) {
+    _free_r(reent, block);
+    return NULL;
+  }
+  MemoryPool* pool = MemoryPool_findPool(block);
+  if (pool == NULL) {
+    reent->_errno = ENOMEM;
+    return NULL;
+  }
+  if (size <= pool->blockSize) {
+    return block;
+  }
+  void* newBlock = _malloc_r(reent, size);
+  if (newBlock != NULL) {
+    memcpy(newBlock, block, pool->blockSize);
+    MemoryPool_free(pool, block);
+  }
+  return newBlock;
+}
+#endif
+/**
+ * @}
+ */
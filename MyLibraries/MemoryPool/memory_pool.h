@@ -0,0 +1,111 @@
+/**
+ * @file    memory_pool.h
+ * @brief   Fixed size block pool allocator.
+ * @details A pool is a static buffer divided into blocks of one size. Free
+ * blocks are linked in a list, so allocation and freeing take constant time
+ * and there is no fragmentation. Every pool counts its used blocks, keeps
+ * the high-water mark and counts allocations which found it empty, so the
+ * memory use is known. Frees of foreign pointers and of blocks already free
+ * are rejected and counted.
+ * @code
+ * static MEMORY_POOL_BUFFER(frameBuffer, FRAME_LENGTH, 8);
+ * static MemoryPool framePool;
+ *
+ * MemoryPool_initialize(&framePool, "frames", frameBuffer, FRAME_LENGTH, 8);
+ * uint8_t* frame = MemoryPool_allocate(&framePool);
+ * ...
+ * MemoryPool_free(&framePool, frame);
+ * @endcode
+ * Pools added with MemoryPool_addToHeap serve MemoryPool_heapAllocate
+ * (smallest fitting block). With MEMORY_POOL_NEWLIB_MALLOC defined the
+ * newlib malloc family (used by stdio for its buffers) is routed to the
+ * heap pools and _sbrk refuses to grow the heap.
+ * @date    19.10.2026
+ * @author  Michal Ksiezopolski
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#ifndef MEMORY_POOL_H_
+#define MEMORY_POOL_H_
+
+#include "utils.h"
+#include <inttypes.h>
+#include <stddef.h>
+
+/**
+ * @defgroup  MEMORY_POOL MEMORY_POOL
+ * @brief     Fixed size block pool allocator
+ */
+
+/**
+ * @addtogroup MEMORY_POOL
+ * @{
+ */
+
+#define MEMORY_POOL_ALIGNMENT 8 ///< Alignment of blocks (as malloc)
+
+/**
+ * @brief Block size rounded up to the alignment
+ */
+#define MEMORY_POOL_ALIGNED_BLOCK_SIZE(blockSize) \
+  (((blockSize) + MEMORY_POOL_ALIGNMENT - 1) & ~(MEMORY_POOL_ALIGNMENT - 1))
+/**
+ * @brief Defines an aligned pool buffer for the given blocks
+ */
+#define MEMORY_POOL_BUFFER(buffer, blockSize, blockCount) \
+  uint64_t buffer[MEMORY_POOL_ALIGNED_BLOCK_SIZE(blockSize) * (blockCount) / sizeof(uint64_t)]
+
+/**
+ * @brief Memory pool result codes
+ */
+typedef enum {
+  MEMORY_POOL_OK,                 //!< MEMORY_POOL_OK
+  MEMORY_POOL_INVALID_BUFFER,     //!< MEMORY_POOL_INVALID_BUFFER Buffer not aligned or no blocks
+  MEMORY_POOL_INVALID_BLOCK,      //!< MEMORY_POOL_INVALID_BLOCK Not a block of the pool
+  MEMORY_POOL_DOUBLE_FREE,        //!< MEMORY_POOL_DOUBLE_FREE Block is already free
+} MemoryPoolResultCode;
+/**
+ * @brief Pool of blocks
+ * @details Allocated by the user, the fields are private to MEMORY_POOL.
+ */
+typedef struct MemoryPool {
+  const char* name;                 ///< Name used in statistics
+  uint8_t* start;                   ///< First block
+  uint8_t* end;                     ///< End of the buffer
+  size_t blockSize;                 ///< Size of block (aligned)
+  unsigned int blockCount;          ///< Number of blocks
+  void* freeBlocks;                 ///< List of free blocks
+  unsigned int usedBlocks;          ///< Number of allocated blocks
+  unsigned int maximumUsedBlocks;   ///< High-water mark of usedBlocks
+  unsigned int failedAllocations;   ///< Allocations which found the pool empty
+  unsigned int invalidFrees;        ///< Rejected frees (foreign pointer or block already free)
+  Boolean isHeapPool;               ///< Serves MemoryPool_heapAllocate
+  struct MemoryPool* next;          ///< Next pool (same or larger blocks)
+} MemoryPool;
+
+MemoryPoolResultCode  MemoryPool_initialize       (MemoryPool* pool, const char* name,
+                                                   void* buffer, size_t blockSize,
+                                                   unsigned int blockCount);
+void*                 MemoryPool_allocate         (MemoryPool* pool);
+MemoryPoolResultCode  MemoryPool_free             (MemoryPool* pool, void* block);
+void                  MemoryPool_resetStatistics  (MemoryPool* pool);
+// heap
+void                  MemoryPool_addToHeap        (MemoryPool* pool);
+void*                 MemoryPool_heapAllocate     (size_t size);
+MemoryPoolResultCode  MemoryPool_heapFree         (void* block);
+MemoryPool*           MemoryPool_findPool         (void* block);
+void                  MemoryPool_printStatistics  (void);
+/**
+ * @}
+ */
+
+#endif /* MEMORY_POOL_H_ */
@@ -17,7 +17,7 @@
  */
 
 #include "mfrc522.h"
-#include "spi_hal.h"
+#include "spi_bus.h"
 #include <stdio.h>
 
 #define DEBUG
@@ -105,18 +105,40 @@ typedef enum {
   CMD_SOFT_RESET          = 15,//!< CMD_SOFT_RESET
 } Mfrc522Commands;
 
+#define MFRC522_SPI         SPI_HAL_SPI1 ///< SPI the reader is connected to
+#define MFRC522_READ_FLAG   0x80 ///< MSB of address byte is 1 for read
+
+/**
+ * @brief The reader on the SPI bus (clock up to 10 MHz)
+ */
+static SpiDevice mfrc522Device = {
+  .spi            = MFRC522_SPI,
+  .chipSelect     = {SPI_HAL_PORT_A, 4},
+  .configuration  = {
+    .prescaler          = SPI_HAL_PRESCALER_16,
+    .mode               = SPI_HAL_MODE0,
+    .frameSize          = SPI_HAL_FRAME_8BIT,
+  },
+};
+
 static uint8_t readRegister(uint8_t address);
 static void writeRegister(uint8_t address, uint8_t data);
+static void writeBuffer(uint8_t address, uint8_t* data, uint8_t length);
 static void softReset(void);
 
 /**
  * @brief Initialize communication with RFID reader
  */
 void Mfrc522_initialize(void) {
-  SpiHal_initialize(SPI_HAL_SPI1);
+  SpiBus_addDevice(&mfrc522Device);
+  // synchronization clocks with the bus settings of the reader, but the
+  // reader not selected (they are not a command)
+  SpiBus_acquire(&mfrc522Device);
+  SpiHal_deselectChip(&mfrc522Device.chipSelect);
   for (int i = 0; i < 20; i++) {
-    SpiHal_transmitByte(SPI_HAL_SPI1, 0x00);
+    SpiHal_transmitByte(MFRC522_SPI, 0x00);
   }
+  SpiBus_release(&mfrc522Device);
   softReset();
   uint8_t registerValue;
   registerValue = readRegister(MFRC522_COMMAND_REG);
@@ -133,11 +155,7 @@ void Mfrc522_initialize(void) {
  * @param data
  */
 void writeRegister(uint8_t address, uint8_t data) {
-  SpiHal_select(SPI_HAL_SPI1);
-  // MSB = 0 for write
-  SpiHal_transmitByte(SPI_HAL_SPI1, (address << 1) & 0x7f);
-  SpiHal_transmitByte(SPI_HAL_SPI1, data);
-  SpiHal_deselect(SPI_HAL_SPI1);
+  writeBuffer(address, &data, 1);
 }
 /**
  * @brief Write buffer to a register
@@ -146,14 +164,16 @@ void writeRegister(uint8_t address, uint8_t data) {
  * @param len
  */
 void writeBuffer(uint8_t address, uint8_t* data, uint8_t length) {
-  SpiHal_select(SPI_HAL_SPI1);
   // MSB = 0 for write
-  // send register address
-  SpiHal_transmitByte(SPI_HAL_SPI1,(address << 1) & 0x7f);
-  for (int i = 0; i < length; i++) {
-    SpiHal_transmitByte(SPI_HAL_SPI1, data[i]);
-  }
-  SpiHal_deselect(SPI_HAL_SPI1);
+  uint8_t addressByte = (address << 1) & 0x7f;
+  SpiTransaction transaction = {
+    .device         = &mfrc522Device,
+    .commandBuffer  = &addressByte,
+    .commandLength  = 1,
+    .transmitBuffer = data,
+    .dataLength     = length,
+  };
+  SpiBus_transfer(&transaction);
 }
 /**
  * @brief Read a register
@@ -161,11 +181,19 @@ void writeBuffer(uint8_t address, uint8_t* data, uint8_t length) {
  * @return
  */
 uint8_t readRegister(uint8_t address) {
-  SpiHal_select(SPI_HAL_SPI1);
   // MSB = 1 for read
-  SpiHal_transmitByte(SPI_HAL_SPI1, ((address << 1) & 0x7f) | 0x80);
-  uint8_t registerValue = SpiHal_transmitByte(SPI_HAL_SPI1, 0x00);
-  SpiHal_deselect(SPI_HAL_SPI1);
+  uint8_t addressByte = ((address << 1) & 0x7f) | MFRC522_READ_FLAG;
+  uint8_t dummyByte = 0x00;
+  uint8_t registerValue;
+  SpiTransaction transaction = {
+    .device         = &mfrc522Device,
+    .commandBuffer  = &addressByte,
+    .commandLength  = 1,
+    .transmitBuffer = &dummyByte,
+    .receiveBuffer  = &registerValue,
+    .dataLength     = 1,
+  };
+  SpiBus_transfer(&transaction);
   return registerValue;
 }
 /**
@@ -50,6 +50,8 @@ void MK_GUI_Initialize(void) {
   lcdDriver.setWindow = ILI9320_SetWindow;
   lcdDriver.drawPixel = ILI9320_DrawPixel;
   lcdDriver.drawNextPixel = ILI9320_DrawNextPixel;
+  lcdDriver.fillRect = ILI9320_FillNextPixels;
+  lcdDriver.writePixels = ILI9320_WriteNextPixels;
   lcdDriver.setGramAddress = ILI9320_SetCursor;
   lcdDriver.width = 320;
   lcdDriver.height = 240;
@@ -0,0 +1,208 @@
+/**
+ * @file    profiler.c
+ * @brief   Function level cycle profiler.
+ * @date    19.10.2026
+ * @author  Michal Ksiezopolski
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#include "profiler.h"
+#include "cycle_counter.h"
+#include "boards.h"
+#include <stdio.h>
+
+#ifndef PROFILER_DEBUG
+  #define PROFILER_DEBUG
+#endif
+
+#ifdef PROFILER_DEBUG
+  #define println(str, args...) printf("PROFILER--> "str"%s",##args,"\r\n")
+#else
+  #define println(str, args...) (void)0
+#endif
+
+/**
+ * @addtogroup PROFILER
+ * @{
+ */
+
+#ifndef PROFILER_TRACE_LENGTH
+  #define PROFILER_TRACE_LENGTH 1024  ///< Number of events in trace ring buffer (power of two)
+#endif
+
+#define EXIT_EVENT_FLAG       0x8000  ///< Set in context of zone exit events
+#define EXCEPTION_NUMBER_MASK 0x01ff  ///< Active exception number in IPSR (0 - thread mode)
+
+/**
+ * @brief Trace event
+ */
+typedef struct {
+  uint32_t cycles;  ///< Time stamp
+  uint16_t zoneId;  ///< Zone ID
+  uint16_t context; ///< Exception number and EXIT_EVENT_FLAG
+} ProfilerEvent;
+
+static ProfilerEvent trace[PROFILER_TRACE_LENGTH] FAST_BSS; ///< Ring buffer of events (oldest overwritten)
+static unsigned int traceHead;        ///< Number of events written
+static Boolean isTracingEnabled;      ///< Are events stored
+static ProfilerZone* zoneList;        ///< Registered zones
+static uint16_t zoneCount;            ///< Number of registered zones
+
+static void storeEvent(uint32_t cycles, uint16_t zoneId, uint16_t context);
+
+/**
+ * @brief Initializes the profiler (starts the cycle counter and tracing)
+ */
+void Profiler_initialize(void) {
+  CycleCounter_initialize();
+  traceHead = 0;
+  isTracingEnabled = TRUE;
+}
+/**
+ * @brief Starts or stops storing events (statistics are always updated)
+ * @param isTracing TRUE to store events
+ */
+void Profiler_setTracing(Boolean isTracing) {
+  isTracingEnabled = isTracing;
+}
+/**
+ * @brief Enters a zone (use the zone macros instead)
+ * @param zone Zone
+ * @return Time stamp of entry
+ */
+uint32_t Profiler_enterZone(ProfilerZone* zone) {
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+  if (zone->id == 0) {
+    zone->id = ++zoneCount;
+    zone->minimumCycles = UINT32_MAX;
+    zone->next = zoneList;
+    zoneList = zone;
+  }
+  uint32_t cycles = CycleCounter_getCycles();
+  storeEvent(cycles, zone->id, __get_IPSR() & EXCEPTION_NUMBER_MASK);
+  __set_PRIMASK(primask);
+  return cycles;
+}
+/**
+ * @brief Leaves a zone (use the zone macros instead)
+ * @param zone Zone
+ * @param enterCycles Time stamp of entry
+ */
+void Profiler_exitZone(ProfilerZone* zone, uint32_t enterCycles) {
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+  uint32_t cycles = CycleCounter_getCycles();
+  uint32_t zoneCycles = cycles - enterCycles;
+  zone->count++;
+  zone->totalCycles += zoneCycles;
+  if (zoneCycles < zone->minimumCycles) {
+    zone->minimumCycles = zoneCycles;
+  }
+  if (zoneCycles > zone->maximumCycles) {
+    zone->maximumCycles = zoneCycles;
+  }
+  storeEvent(cycles, zone->id, (__get_IPSR() & EXCEPTION_NUMBER_MASK) | EXIT_EVENT_FLAG);
+  __set_PRIMASK(primask);
+}
+/**
+ * @brief Leaves a zone entered by PROFILER_ZONE (called at end of scope)
+ * @param scope Zone entry
+ */
+void Profiler_exitScope(ProfilerScope* scope) {
+  Profiler_exitZone(scope->zone, scope->enterCycles);
+}
+/**
+ * @brief Zeroes statistics of all zones
+ */
+void Profiler_resetStatistics(void) {
+  __disable_irq();
+  for (ProfilerZone* zone = zoneList; zone != NULL; zone = zone->next) {
+    zone->count = 0;
+    zone->minimumCycles = UINT32_MAX;
+    zone->maximumCycles = 0;
+    zone->totalCycles = 0;
+  }
+  __enable_irq();
+}
+/**
+ * @brief Prints statistics of all zones in microseconds
+ * @details Times include the nested zones and IRQs.
+ */
+void Profiler_printStatistics(void) {
+  const uint32_t CYCLES_PER_MICROSECOND = CycleCounter_getFrequencyHz() / 1000000;
+  println("%-24s %8s %10s %10s %10s %12s", "zone", "count", "min us", "avg us",
+      "max us", "total us");
+  for (ProfilerZone* zone = zoneList; zone != NULL; zone = zone->next) {
+    __disable_irq();
+    ProfilerZone copy = *zone;
+    __enable_irq();
+    if (copy.count == 0) {
+      println("%-24s %8u", copy.name, 0u);
+      continue;
+    }
+    uint64_t totalMicros = copy.totalCycles / CYCLES_PER_MICROSECOND;
+    println("%-24s %8u %10u %10u %10u %12u", copy.name, copy.count,
+        (unsigned int)(copy.minimumCycles / CYCLES_PER_MICROSECOND),
+        (unsigned int)(totalMicros / copy.count),
+        (unsigned int)(copy.maximumCycles / CYCLES_PER_MICROSECOND),
+        (unsigned int)totalMicros);
+  }
+}
+/**
+ * @brief Prints the trace for profiler_trace.py
+ * @details Text lines (oldest event first):
+ * @verbatim
+ * PROFILER TRACE <cycle counter frequency> <number of events>
+ * Z <zone ID> <zone name>
+ * E <cycles> <zone ID> <exception number>   (zone entry)
+ * X <cycles> <zone ID> <exception number>   (zone exit)
+ * PROFILER END
+ * @endverbatim
+ */
+void Profiler_printTrace(void) {
+  // printing goes through the instrumented serial port IRQs
+  Boolean wasTracingEnabled = isTracingEnabled;
+  isTracingEnabled = FALSE;
+  unsigned int head = traceHead;
+  unsigned int count = head < PROFILER_TRACE_LENGTH ? head : PROFILER_TRACE_LENGTH;
+  printf("PROFILER TRACE %u %u\r\n", (unsigned int)CycleCounter_getFrequencyHz(), count);
+  for (ProfilerZone* zone = zoneList; zone != NULL; zone = zone->next) {
+    printf("Z %u %s\r\n", zone->id, zone->name);
+  }
+  for (unsigned int i = head - count; i != head; i++) {
+    ProfilerEvent* event = &trace[i & (PROFILER_TRACE_LENGTH - 1)];
+    printf("%c %u %u %u\r\n", (event->context & EXIT_EVENT_FLAG) ? 'X' : 'E',
+        (unsigned int)event->cycles, event->zoneId, event->context & EXCEPTION_NUMBER_MASK);
+  }
+  printf("PROFILER END\r\n");
+  isTracingEnabled = wasTracingEnabled;
+}
+/**
+ * @brief Stores an event in the ring buffer (called with IRQs disabled)
+ * @param cycles Time stamp
+ * @param zoneId Zone ID
+ * @param context Exception number and EXIT_EVENT_FLAG
+ */
+void storeEvent(uint32_t cycles, uint16_t zoneId, uint16_t context) {
+  if (!isTracingEnabled) {
+    return;
+  }
+  ProfilerEvent* event = &trace[traceHead & (PROFILER_TRACE_LENGTH - 1)];
+  event->cycles = cycles;
+  event->zoneId = zoneId;
+  event->context = context;
+  traceHead++;
+}
+/**
+ * @}
+ */
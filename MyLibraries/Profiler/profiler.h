@@ -0,0 +1,107 @@
+/**
+ * @file    profiler.h
+ * @brief   Function level cycle profiler.
+ * @details Zones mark pieces of code to measure. Entering and leaving a zone
+ * takes a time stamp from the core cycle counter - the zone statistics (count,
+ * minimum, maximum, total) are updated and the events are stored in a RAM
+ * ring buffer. Profiler_printStatistics prints the statistics,
+ * Profiler_printTrace dumps the ring buffer for profiler_trace.py, which
+ * converts it to Chrome trace event JSON (chrome://tracing, Perfetto).
+ * @code
+ * void SD_ReadSectors(...) {
+ *   PROFILER_ZONE(sdReadSectors); // measured until the function returns
+ *   ...
+ * }
+ * @endcode
+ * Zones work in IRQ handlers - events are tagged with the active exception,
+ * so every IRQ gets its own track in the trace. The zone macros generate code
+ * only when PROFILER_ENABLE is defined for the whole project.
+ * @date    19.10.2026
+ * @author  Michal Ksiezopolski
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#ifndef PROFILER_H_
+#define PROFILER_H_
+
+#include "utils.h"
+#include <inttypes.h>
+
+/**
+ * @defgroup  PROFILER PROFILER
+ * @brief     Function level cycle profiler
+ */
+
+/**
+ * @addtogroup PROFILER
+ * @{
+ */
+
+/**
+ * @brief Measured piece of code
+ * @details Defined by the zone macros as a static variable - registered
+ * on first entry.
+ */
+typedef struct ProfilerZone {
+  const char* name;           ///< Zone name
+  uint16_t id;                ///< Zone ID in trace (0 - not registered yet)
+  struct ProfilerZone* next;  ///< Next registered zone
+  unsigned int count;         ///< Number of exits
+  uint32_t minimumCycles;     ///< Shortest run
+  uint32_t maximumCycles;     ///< Longest run
+  uint64_t totalCycles;       ///< Sum of runs
+} ProfilerZone;
+/**
+ * @brief Zone entry of PROFILER_ZONE (left when the scope ends)
+ */
+typedef struct {
+  ProfilerZone* zone;   ///< Entered zone
+  uint32_t enterCycles; ///< Time stamp of entry
+} ProfilerScope;
+
+void     Profiler_initialize       (void);
+void     Profiler_setTracing       (Boolean isTracing);
+uint32_t Profiler_enterZone        (ProfilerZone* zone);
+void     Profiler_exitZone         (ProfilerZone* zone, uint32_t enterCycles);
+void     Profiler_exitScope        (ProfilerScope* scope);
+void     Profiler_resetStatistics  (void);
+void     Profiler_printStatistics  (void);
+void     Profiler_printTrace       (void);
+
+#ifdef PROFILER_ENABLE
+  /**
+   * @brief Measures from here to the end of the enclosing block (any return included)
+   */
+  #define PROFILER_ZONE(zone) \
+    static ProfilerZone zone = {.name = #zone}; \
+    ProfilerScope zone##Scope __attribute__((cleanup(Profiler_exitScope))) = \
+        {&zone, Profiler_enterZone(&zone)}
+  /**
+   * @brief Measures from here to PROFILER_ZONE_EXIT with the same zone
+   */
+  #define PROFILER_ZONE_ENTER(zone) \
+    static ProfilerZone zone = {.name = #zone}; \
+    uint32_t zone##EnterCycles = Profiler_enterZone(&zone)
+  /**
+   * @brief Ends zone started by PROFILER_ZONE_ENTER
+   */
+  #define PROFILER_ZONE_EXIT(zone) Profiler_exitZone(&zone, zone##EnterCycles)
+#else
+  #define PROFILER_ZONE(zone)       (void)0
+  #define PROFILER_ZONE_ENTER(zone) (void)0
+  #define PROFILER_ZONE_EXIT(zone)  (void)0
+#endif
+/**
+ * @}
+ */
+
+#endif /* PROFILER_H_ */
@@ -0,0 +1,115 @@
+#!/usr/bin/env python3
+#
+# @file    profiler_trace.py
+# @brief   Converts a PROFILER trace dump to Chrome trace event JSON.
+# @details The dump is the text printed by Profiler_printTrace (other lines
+# of the console output are skipped). The JSON opens in chrome://tracing or
+# ui.perfetto.dev - thread mode and every exception get their own track.
+#
+#          profiler_trace.py [console.txt] > trace.json
+#
+# Reads the console output from stdin when no file is given. Only the Python
+# standard library is needed.
+# @date    19.10.2026
+# @author  Michal Ksiezopolski
+#
+# Copyright (c) 2026 Michal Ksiezopolski.
+# All rights reserved. This program and the
+# accompanying materials are made available
+# under the terms of the GNU Public License
+# v3.0 which accompanies this distribution,
+# and is available at
+# http://www.gnu.org/licenses/gpl.html
+#
+
+import json
+import sys
+
+CYCLES_WRAP = 1 << 32
+FIRST_IRQ_EXCEPTION = 16
+EXCEPTION_NAMES = {0: "main", 2: "NMI", 3: "HardFault", 4: "MemManage", 5: "BusFault",
+    6: "UsageFault", 11: "SVCall", 12: "DebugMonitor", 14: "PendSV", 15: "SysTick"}
+
+
+def contextName(exception):
+    if exception in EXCEPTION_NAMES:
+        return EXCEPTION_NAMES[exception]
+    if exception >= FIRST_IRQ_EXCEPTION:
+        return "IRQ %d" % (exception - FIRST_IRQ_EXCEPTION)
+    return "exception %d" % exception
+
+
+def readTrace(stream):
+    """Returns frequency, zone names and (kind, cycles, zone, exception) events of last dump"""
+    frequency = None
+    zones = {}
+    events = []
+    for line in stream:
+        fields = line.split()
+        if len(fields) == 4 and fields[:2] == ["PROFILER", "TRACE"]:
+            frequency = int(fields[2])
+            zones = {}
+            events = []
+        elif frequency is None:
+            continue
+        elif len(fields) >= 3 and fields[0] == "Z":
+            zones[int(fields[1])] = " ".join(fields[2:])
+        elif len(fields) == 4 and fields[0] in ("E", "X"):
+            events.append((fields[0], int(fields[1]), int(fields[2]), int(fields[3])))
+        elif fields == ["PROFILER", "END"]:
+            return frequency, zones, events
+    if frequency is None:
+        sys.exit("no PROFILER TRACE found")
+    return frequency, zones, events # dump cut off - use what arrived
+
+
+def convert(frequency, zones, events):
+    traceEvents = []
+    contexts = set()
+    openZones = {} # exception -> stack of entered zones
+    cycles = 0
+    previousCycles = None
+    for kind, eventCycles, zone, exception in events:
+        # unwrap the 32 bit counter (events are in time order), first event at 0
+        if previousCycles is not None:
+            cycles += (eventCycles - previousCycles) % CYCLES_WRAP
+        previousCycles = eventCycles
+        stack = openZones.setdefault(exception, [])
+        if kind == "E":
+            stack.append(zone)
+        elif zone in stack:
+            # close zones left without exit (e.g. by longjmp) first
+            while stack.pop() != zone:
+                pass
+        else:
+            continue # entered before the oldest event in the ring buffer
+        contexts.add(exception)
+        traceEvents.append({
+            "name": zones.get(zone, "zone %d" % zone),
+            "ph": "B" if kind == "E" else "E",
+            "ts": cycles * 1e6 / frequency,
+            "pid": 0,
+            "tid": exception,
+        })
+    for exception in sorted(contexts):
+        traceEvents.append({"name": "thread_name", "ph": "M", "pid": 0, "tid": exception,
+            "args": {"name": contextName(exception)}})
+        traceEvents.append({"name": "thread_sort_index", "ph": "M", "pid": 0, "tid": exception,
+            "args": {"sort_index": exception}})
+    return {"traceEvents": traceEvents, "displayTimeUnit": "ns"}
+
+
+def main():
+    if len(sys.argv) > 2:
+        sys.exit("usage: profiler_trace.py [console.txt]")
+    if len(sys.argv) == 2:
+        with open(sys.argv[1], "r", errors="replace") as console:
+            trace = readTrace(console)
+    else:
+        trace = readTrace(sys.stdin)
+    json.dump(convert(*trace), sys.stdout, indent=1)
+    print()
+
+
+if __name__ == "__main__":
+    main()
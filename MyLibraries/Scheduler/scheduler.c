@@ -0,0 +1,280 @@
+/**
+ * @file    scheduler.c
+ * @brief   Cooperative event driven task scheduler.
+ * @date    19.10.2026
+ * @author  Michal Ksiezopolski
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#include "scheduler.h"
+#include "cycle_counter.h"
+#include "common_hal.h"
+#include "boards.h"
+#include <stdio.h>
+#include <string.h>
+
+#ifndef SCHEDULER_DEBUG
+  #define SCHEDULER_DEBUG
+#endif
+
+#ifdef SCHEDULER_DEBUG
+  #define println(str, args...) printf("SCHEDULER--> "str"%s",##args,"\r\n")
+#else
+  #define println(str, args...) (void)0
+#endif
+
+/**
+ * @addtogroup SCHEDULER
+ * @{
+ */
+
+static SchedulerTask* tasks[SCHEDULER_PRIORITIES] FAST_BSS; ///< Tasks indexed by priority
+static volatile uint32_t readyTasks FAST_BSS; ///< Bit set for every task with pending events
+static uint64_t idleMicros;           ///< Time spent sleeping
+static uint64_t statisticsStartMicros;///< Start of run time accounting
+
+static void postFromTimer(void* context);
+static Boolean hasPendingWork(void);
+
+/**
+ * @brief Initializes the scheduler (no tasks)
+ */
+void Scheduler_initialize(void) {
+  memset(tasks, 0, sizeof(tasks));
+  readyTasks = 0;
+  CycleCounter_initialize();
+  Scheduler_resetStatistics();
+}
+/**
+ * @brief Adds a task
+ * @param task Task to add
+ * @param name Task name
+ * @param priority Task priority (0 to SCHEDULER_PRIORITIES - 1, higher runs first)
+ * @param handler Event handler
+ * @param context User pointer
+ * @param queue Buffer for the event queue
+ * @param queueLength Number of events in buffer (power of two)
+ * @retval SCHEDULER_OK Task added
+ * @retval SCHEDULER_INVALID_PRIORITY Priority out of range
+ * @retval SCHEDULER_PRIORITY_TAKEN Another task has this priority
+ * @retval SCHEDULER_INVALID_QUEUE_LENGTH Queue length is not a power of two
+ */
+SchedulerResultCode Scheduler_addTask(SchedulerTask* task, const char* name,
+    int priority, SchedulerHandler handler, void* context, SchedulerEvent* queue,
+    int queueLength) {
+  if (priority < 0 || priority >= SCHEDULER_PRIORITIES) {
+    return SCHEDULER_INVALID_PRIORITY;
+  }
+  if (tasks[priority] != NULL) {
+    println("Priority %d taken by %s", priority, tasks[priority]->name);
+    return SCHEDULER_PRIORITY_TAKEN;
+  }
+  if (queueLength <= 0 || (queueLength & (queueLength - 1)) != 0) {
+    return SCHEDULER_INVALID_QUEUE_LENGTH;
+  }
+  memset(task, 0, sizeof(SchedulerTask));
+  task->name = name;
+  task->handler = handler;
+  task->context = context;
+  task->queue = queue;
+  task->queueMask = queueLength - 1;
+  task->priority = priority;
+  tasks[priority] = task;
+  return SCHEDULER_OK;
+}
+/**
+ * @brief Posts an event to a task
+ * @details Can be called from IRQs of any priority and from tasks. The queue
+ * is accessed with IRQs disabled for the copy of one event.
+ * @param task Task receiving the event
+ * @param signal Event signal
+ * @param parameter Event data
+ * @retval SCHEDULER_OK Event queued
+ * @retval SCHEDULER_QUEUE_FULL Event lost (counted in task statistics)
+ */
+SchedulerResultCode Scheduler_post(SchedulerTask* task, uint16_t signal, uint32_t parameter) {
+  SchedulerResultCode result = SCHEDULER_OK;
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+  if (task->head - task->tail > task->queueMask) {
+    task->statistics.lostEvents++;
+    result = SCHEDULER_QUEUE_FULL;
+  } else {
+    SchedulerEvent* event = &task->queue[task->head & task->queueMask];
+    event->signal = signal;
+    event->parameter = parameter;
+    task->head++;
+    readyTasks |= 1u << task->priority;
+  }
+  __set_PRIMASK(primask);
+  return result;
+}
+/**
+ * @brief Handles one event of the highest priority ready task
+ * @details Also processes the soft timers. Use instead of Scheduler_run when
+ * the main loop has other (polled) work.
+ * @retval TRUE An event was handled
+ * @retval FALSE No task had pending events
+ */
+Boolean Scheduler_runOnce(void) {
+  Timer_softwareTimersUpdate();
+  uint32_t ready = readyTasks;
+  if (ready == 0) {
+    return FALSE;
+  }
+  const int BITS_IN_WORD = 32;
+  SchedulerTask* task = tasks[BITS_IN_WORD - 1 - __builtin_clz(ready)];
+
+  // copy the event - the slot can be reused by a post during the handler
+  SchedulerEvent event;
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+  event = task->queue[task->tail & task->queueMask];
+  task->tail++;
+  if (task->tail == task->head) {
+    readyTasks &= ~(1u << task->priority);
+  }
+  __set_PRIMASK(primask);
+
+  uint32_t startCycles = CycleCounter_getCycles();
+  task->handler(task, &event);
+  uint32_t runCycles = CycleCounter_getCycles() - startCycles;
+  task->statistics.runCount++;
+  task->statistics.runCycles += runCycles;
+  if (runCycles > task->statistics.maximumRunCycles) {
+    task->statistics.maximumRunCycles = runCycles;
+  }
+  return TRUE;
+}
+/**
+ * @brief Runs the tasks forever
+ * @details Sleeps (WFI) whenever no task has pending events and no soft timer
+ * has expired.
+ */
+void Scheduler_run(void) {
+  while (TRUE) {
+    if (Scheduler_runOnce()) {
+      continue;
+    }
+    uint64_t sleepStartMicros = Timer_getTimeMicros64();
+    CommonHal_sleepUntilInterrupt(hasPendingWork);
+    idleMicros += Timer_getTimeMicros64() - sleepStartMicros;
+  }
+}
+/**
+ * @brief Initializes a timer posting events to a task
+ * @param timer Timer
+ * @param task Task receiving the events
+ * @param signal Signal of the events
+ */
+void Scheduler_initializeTimer(SchedulerTimer* timer, SchedulerTask* task, uint16_t signal) {
+  timer->task = task;
+  timer->signal = signal;
+  Timer_initializeSoftTimer(&timer->timer, postFromTimer, timer);
+}
+/**
+ * @brief Starts (or restarts) a timer
+ * @param timer Timer
+ * @param timeoutMillis Time to first event
+ * @param periodMillis Time between next events, 0 for a one-shot timer
+ */
+void Scheduler_startTimer(SchedulerTimer* timer, unsigned int timeoutMillis,
+    unsigned int periodMillis) {
+  Timer_startSoftTimer(&timer->timer, timeoutMillis, periodMillis);
+}
+/**
+ * @brief Stops a timer
+ * @param timer Timer
+ */
+void Scheduler_cancelTimer(SchedulerTimer* timer) {
+  Timer_cancelSoftTimer(&timer->timer);
+}
+/**
+ * @brief Gets run time accounting of a task
+ * @param task Task
+ * @param statistics Copy of the statistics
+ */
+void Scheduler_getTaskStatistics(SchedulerTask* task, SchedulerTaskStatistics* statistics) {
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq(); // lostEvents is written by IRQs
+  *statistics = task->statistics;
+  __set_PRIMASK(primask);
+}
+/**
+ * @brief Gets time spent sleeping in Scheduler_run
+ * @return Idle time in us since last reset of statistics
+ */
+uint64_t Scheduler_getIdleMicros(void) {
+  return idleMicros;
+}
+/**
+ * @brief Zeroes run time accounting of all tasks
+ */
+void Scheduler_resetStatistics(void) {
+  for (int i = 0; i < SCHEDULER_PRIORITIES; i++) {
+    if (tasks[i] != NULL) {
+      uint32_t primask = __get_PRIMASK();
+      __disable_irq();
+      memset(&tasks[i]->statistics, 0, sizeof(SchedulerTaskStatistics));
+      __set_PRIMASK(primask);
+    }
+  }
+  idleMicros = 0;
+  statisticsStartMicros = Timer_getTimeMicros64();
+}
+/**
+ * @brief Prints run time accounting of all tasks (highest priority first)
+ * @details Load is the share of time since the last reset of statistics
+ * in tenths of percent.
+ */
+void Scheduler_printStatistics(void) {
+  const uint32_t CYCLES_PER_MICROSECOND = CycleCounter_getFrequencyHz() / 1000000;
+  const int PERMILLE = 1000;
+  uint64_t elapsedMicros = Timer_getTimeMicros64() - statisticsStartMicros;
+  if (elapsedMicros == 0) {
+    return;
+  }
+  println("%-12s %3s %10s %10s %8s %6s %5s", "task", "pri", "runs", "total us",
+      "max us", "lost", "load");
+  for (int i = SCHEDULER_PRIORITIES - 1; i >= 0; i--) {
+    if (tasks[i] == NULL) {
+      continue;
+    }
+    SchedulerTaskStatistics statistics;
+    Scheduler_getTaskStatistics(tasks[i], &statistics);
+    uint64_t runMicros = statistics.runCycles / CYCLES_PER_MICROSECOND;
+    println("%-12s %3d %10u %10u %8u %6u %5u", tasks[i]->name, i, statistics.runCount,
+        (unsigned int)runMicros,
+        (unsigned int)(statistics.maximumRunCycles / CYCLES_PER_MICROSECOND),
+        statistics.lostEvents, (unsigned int)(runMicros * PERMILLE / elapsedMicros));
+  }
+  println("%-12s %3s %10s %10u %8s %6s %5u", "idle", "", "", (unsigned int)idleMicros,
+      "", "", (unsigned int)(idleMicros * PERMILLE / elapsedMicros));
+}
+/**
+ * @brief Soft timer callback posting the timer event
+ * @param context Scheduler timer
+ */
+void postFromTimer(void* context) {
+  SchedulerTimer* timer = context;
+  Scheduler_post(timer->task, timer->signal, 0);
+}
+/**
+ * @brief Checks if the core can't sleep (called with IRQs disabled)
+ * @return TRUE if a task or the soft timers have work
+ */
+Boolean hasPendingWork(void) {
+  return (readyTasks != 0 || Timer_hasPendingWork()) ? TRUE : FALSE;
+}
+/**
+ * @}
+ */
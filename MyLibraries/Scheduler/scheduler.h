@@ -0,0 +1,145 @@
+/**
+ * @file    scheduler.h
+ * @brief   Cooperative event driven task scheduler.
+ * @details Tasks run to completion - a task handler gets one event, does its
+ * work and returns. Every task has its own event queue and a unique priority,
+ * the highest priority task with a pending event runs first. Events are
+ * posted from IRQs (Scheduler_post is IRQ safe), other tasks or soft timers
+ * (SchedulerTimer). When no task has work the core sleeps until the next IRQ
+ * or timer deadline, so CPU time is spent only on pending work.
+ * @code
+ * static SchedulerEvent keyEvents[8];
+ * static SchedulerTask keyTask;
+ *
+ * static void keyHandler(SchedulerTask* task, const SchedulerEvent* event) {
+ *   ...
+ * }
+ *
+ * Scheduler_initialize();
+ * Scheduler_addTask(&keyTask, "keys", 2, keyHandler, NULL, keyEvents,
+ *     SCHEDULER_QUEUE_LENGTH(keyEvents));
+ * Scheduler_run(); // never returns
+ * @endcode
+ * @date    19.10.2026
+ * @author  Michal Ksiezopolski
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#ifndef SCHEDULER_H_
+#define SCHEDULER_H_
+
+#include "utils.h"
+#include "timers.h"
+#include <inttypes.h>
+
+/**
+ * @defgroup  SCHEDULER SCHEDULER
+ * @brief     Cooperative event driven task scheduler
+ */
+
+/**
+ * @addtogroup SCHEDULER
+ * @{
+ */
+
+#define SCHEDULER_PRIORITIES 32 ///< Number of priorities (0 - lowest) and maximum number of tasks
+
+/**
+ * @brief Number of events in a queue buffer array
+ */
+#define SCHEDULER_QUEUE_LENGTH(queue) ((int)(sizeof(queue) / sizeof((queue)[0])))
+
+/**
+ * @brief Scheduler result codes
+ */
+typedef enum {
+  SCHEDULER_OK,                   //!< SCHEDULER_OK
+  SCHEDULER_INVALID_PRIORITY,     //!< SCHEDULER_INVALID_PRIORITY Priority out of range
+  SCHEDULER_PRIORITY_TAKEN,       //!< SCHEDULER_PRIORITY_TAKEN Another task has this priority
+  SCHEDULER_INVALID_QUEUE_LENGTH, //!< SCHEDULER_INVALID_QUEUE_LENGTH Not a power of two
+  SCHEDULER_QUEUE_FULL,           //!< SCHEDULER_QUEUE_FULL Event was lost
+} SchedulerResultCode;
+/**
+ * @brief Event sent to a task
+ */
+typedef struct {
+  uint16_t signal;    ///< What happened (defined by the application)
+  uint32_t parameter; ///< Data of the event (e.g. received key code)
+} SchedulerEvent;
+/**
+ * @brief Run time accounting of a task
+ */
+typedef struct {
+  unsigned int runCount;      ///< Number of handled events
+  uint64_t runCycles;         ///< Core cycles spent in the handler
+  uint32_t maximumRunCycles;  ///< Longest handler run
+  unsigned int lostEvents;    ///< Events dropped due to full queue
+} SchedulerTaskStatistics;
+
+struct SchedulerTask;
+/**
+ * @brief Task handler - runs to completion for every event
+ * @param task The task (its context is in task->context)
+ * @param event Event to handle
+ */
+typedef void (*SchedulerHandler)(struct SchedulerTask* task, const SchedulerEvent* event);
+/**
+ * @brief Task
+ * @details Allocated by the user together with its event queue. The fields
+ * except context are private to SCHEDULER.
+ */
+typedef struct SchedulerTask {
+  const char* name;                   ///< Name used in statistics
+  SchedulerHandler handler;           ///< Event handler
+  void* context;                      ///< User pointer
+  SchedulerEvent* queue;              ///< Event queue buffer
+  unsigned int queueMask;             ///< Queue length - 1
+  volatile unsigned int head;         ///< Write index of queue
+  volatile unsigned int tail;         ///< Read index of queue
+  uint8_t priority;                   ///< Priority (unique)
+  SchedulerTaskStatistics statistics; ///< Run time accounting
+} SchedulerTask;
+/**
+ * @brief Soft timer posting an event to a task on expiry
+ */
+typedef struct {
+  SoftTimer timer;      ///< The soft timer
+  SchedulerTask* task;  ///< Task receiving the event
+  uint16_t signal;      ///< Signal of the event (parameter is 0)
+} SchedulerTimer;
+
+void                Scheduler_initialize        (void);
+SchedulerResultCode Scheduler_addTask           (SchedulerTask* task, const char* name,
+                                                 int priority, SchedulerHandler handler,
+                                                 void* context, SchedulerEvent* queue,
+                                                 int queueLength);
+SchedulerResultCode Scheduler_post              (SchedulerTask* task, uint16_t signal,
+                                                 uint32_t parameter);
+Boolean             Scheduler_runOnce           (void);
+void                Scheduler_run               (void);
+// timers
+void                Scheduler_initializeTimer   (SchedulerTimer* timer, SchedulerTask* task,
+                                                 uint16_t signal);
+void                Scheduler_startTimer        (SchedulerTimer* timer, unsigned int timeoutMillis,
+                                                 unsigned int periodMillis);
+void                Scheduler_cancelTimer       (SchedulerTimer* timer);
+// run time accounting
+void                Scheduler_getTaskStatistics (SchedulerTask* task,
+                                                 SchedulerTaskStatistics* statistics);
+uint64_t            Scheduler_getIdleMicros     (void);
+void                Scheduler_resetStatistics   (void);
+void                Scheduler_printStatistics   (void);
+/**
+ * @}
+ */
+
+#endif /* SCHEDULER_H_ */
@@ -16,9 +16,11 @@
  */
 
 #include "sdcard.h"
-#include "spi_hal.h"
+#include "spi_bus.h"
 #include "timers.h"
 #include "utils.h"
+#include "crc.h"
+#include "profiler.h"
 #include <stdio.h>
 
 /**
@@ -26,17 +28,13 @@
  * @{
  */
 
-#ifndef DEBUG
-  #define DEBUG
+#ifndef SD_CARD_LOG_LEVEL
+  #define SD_CARD_LOG_LEVEL LOG_LEVEL_DEBUG ///< Log level of this module
 #endif
+#define LOG_MODULE_LEVEL SD_CARD_LOG_LEVEL
+#include "log.h"
 
-#ifdef DEBUG
-  #define print(str, args...) printf(""str"%s",##args,"")
-  #define println(str, args...) printf("SD--> "str"%s",##args,"\r\n")
-#else
-  #define print(str, args...) (void)0
-  #define println(str, args...) (void)0
-#endif
+#define println(str, args...) LOG_DEBUG("SD--> "str, ##args)
 
 /**
  * @brief SD commands (SPI command subset) as per SanDisk Secure Digital Card
@@ -90,11 +88,31 @@ typedef enum {
 #define SD_TOKEN_DATA_ACCEPTED  0x05 ///< Data accepted
 #define SD_TOKEN_DATA_CRC       0x0b ///< Data rejected due to CRC error
 #define SD_TOKEN_DATA_WRITE_ERR 0x0d ///< Data rejected due to write error
+#define SD_TOKEN_DATA_RESPONSE_MASK 0x1f ///< Mask for status bits of data response token
 
 static Boolean isSDHC;            ///< Is the card SDHC?
 static uint64_t cardCapacity;     ///< Capacity of SD card in bytes
 static Boolean isCardInIdleState; ///< Is card in IDLE state
 static Boolean isCardInitalized;  ///< Is the card initalized
+static Boolean isCrcEnabled;      ///< Are data blocks protected by CRC (CMD59)
+static Boolean isCrcRequested;    ///< Should SD_Initialize turn CRC on (SD_EnableCrc)
+
+#define SD_SPI                      SPI_HAL_SPI1               ///< SPI the card is connected to
+#define SD_INITIALIZATION_PRESCALER SPI_HAL_PRESCALER_256      ///< Clock below 400 kHz for initialization
+#define SD_TRANSFER_PRESCALER       SPI_HAL_PRESCALER_8        ///< Clock after initialization (below 25 MHz)
+
+/**
+ * @brief The card on the SPI bus
+ */
+static SpiDevice sdCardDevice = {
+  .spi            = SD_SPI,
+  .chipSelect     = {SPI_HAL_PORT_A, 4},
+  .configuration  = {
+    .prescaler          = SD_INITIALIZATION_PRESCALER,
+    .mode               = SPI_HAL_MODE0,
+    .frameSize          = SPI_HAL_FRAME_8BIT,
+  },
+};
 
 /**
  * @brief SD Card R1 response structure
@@ -240,6 +258,28 @@ static void getResponseR3orR7(uint8_t* responseBuffer);
 static SD_CardErrorsTypedef readOcr(SD_OCR* asUint32);
 static SD_CardErrorsTypedef readCid(SD_CID* cid);
 static SD_CardErrorsTypedef readCsd(SD_CSD* csd);
+static SD_CardErrorsTypedef receiveDataBlock(uint8_t* buffer, int length);
+static SD_CardErrorsTypedef sendDataBlock(uint8_t token, uint8_t* buffer, int length);
+static int initializeBlockDevice(void* driverContext);
+static int readBlocks(void* driverContext, uint8_t* buffer, uint32_t block,
+    uint32_t count);
+static int writeBlocks(void* driverContext, uint8_t* buffer, uint32_t block,
+    uint32_t count);
+static int trimBlocks(void* driverContext, uint32_t block, uint32_t count);
+static int getGeometry(void* driverContext, BlockDeviceGeometry* geometry);
+
+/**
+ * @brief SD card block device operations
+ */
+static const BlockDeviceOperations sdBlockDeviceOperations = {
+  .initialize   = initializeBlockDevice,
+  .readBlocks   = readBlocks,
+  .writeBlocks  = writeBlocks,
+  .sync         = NULL,
+  .trim         = trimBlocks,
+  .getGeometry  = getGeometry,
+  .submit       = NULL,
+};
 
 #define DUMMY_BYTE 0xff ///< Dummy byte for reading data
 #define NO_ERRORS_IN_IDLE_STATE   0x01
@@ -256,13 +296,17 @@ int SD_Initialize(void) {
   uint8_t sdCommandsBuffer[BUFFER_LENGTH];
   SD_CardErrorsTypedef result;
 
-  SpiHal_initialize(SPI_HAL_SPI1);
-  SpiHal_select(SPI_HAL_SPI1);
+  // a card which rejected CMD59 before doesn't turn CRC off for the next one
+  isCrcEnabled = isCrcRequested;
+
+  sdCardDevice.configuration.prescaler = SD_INITIALIZATION_PRESCALER;
+  SpiBus_addDevice(&sdCardDevice);
+  SpiBus_acquire(&sdCardDevice);
 
   // Synchronize card with SPI
   const int SYNCHRONIZATION_BYTES = 20;
   for (int i = 0; i < SYNCHRONIZATION_BYTES; i++) {
-    SpiHal_transmitByte(SPI_HAL_SPI1, DUMMY_BYTE);
+    SpiHal_transmitByte(SD_SPI, DUMMY_BYTE);
   }
 
   isCardInIdleState = TRUE;
@@ -278,12 +322,19 @@ int SD_Initialize(void) {
   // Check if card supports given voltage range
   if ((sdCommandsBuffer[3] != SD_IF_COND_CHECK) ||
       (sdCommandsBuffer[2] != (SD_IF_COND_VOLT>>8))) {
-    println("SEND_IF_COND error");
-    for (int i=0; i<4; i++) {
-      print("%02x ", sdCommandsBuffer[i]);
-    }
-    print("\r\n");
+    println("SEND_IF_COND error: %02x %02x %02x %02x", sdCommandsBuffer[0],
+        sdCommandsBuffer[1], sdCommandsBuffer[2], sdCommandsBuffer[3]);
+
+  }
 
+  // CMD59 - CRC is off by default in SPI mode
+  if (isCrcEnabled) {
+    const uint32_t CRC_ON = 0x01;
+    if (sendCommand(SD_CRC_ON_OFF, CRC_ON) != SD_NO_ERROR) {
+      // card stays in its default mode - don't check CRC of data blocks
+      println("CRC_ON_OFF error - CRC disabled");
+      isCrcEnabled = FALSE;
+    }
   }
 
   // CMD58
@@ -307,6 +358,7 @@ int SD_Initialize(void) {
 
     if (i == MAXIMUM_ACMD41_TRIES - 1) {
       println("Failed to initialize SD card");
+      SpiBus_release(&sdCardDevice);
       return SD_INIT_FAILED;
     }
   }
@@ -327,7 +379,9 @@ int SD_Initialize(void) {
     isSDHC = FALSE;
   }
 
-  SpiHal_deselect(SPI_HAL_SPI1);
+  SpiBus_release(&sdCardDevice);
+  // card is in transfer mode - switch to full speed
+  sdCardDevice.configuration.prescaler = SD_TRANSFER_PRESCALER;
   isCardInitalized = TRUE;
   return SD_NO_ERROR;
 
@@ -339,6 +393,26 @@ int SD_Initialize(void) {
 uint64_t SD_ReadCapacity(void) {
   return cardCapacity;
 }
+/**
+ * @brief Enables or disables CRC protection of the transfers.
+ * @details When enabled, the card checks the CRC of every command
+ * and data block sent to it (CMD59) and the driver verifies the CRC16
+ * of every data block read. This has to be called before SD_Initialize.
+ * @param isEnabled TRUE to enable CRC checking
+ */
+void SD_EnableCrc(Boolean isEnabled) {
+  isCrcRequested = isEnabled;
+}
+/**
+ * @brief Checks if CRC protection of the transfers is on.
+ * @details After SD_Initialize this is FALSE if the card
+ * rejected CMD59, even when SD_EnableCrc(TRUE) was called. Every
+ * SD_Initialize tries CMD59 again.
+ * @return TRUE if CRC checking is enabled
+ */
+Boolean SD_IsCrcEnabled(void) {
+  return isCrcEnabled;
+}
 /**
  * @brief Read sectors from SD card
  * @param readDataBuffer Data buffer
@@ -346,10 +420,13 @@ uint64_t SD_ReadCapacity(void) {
  * @param sectorsToRead Number of sectors to read
  * @retval SD_NO_ERROR Read was successful
  * @retval SD_BLOCK_READ_ERROR Error occurred
+ * @retval SD_BLOCK_CRC_ERROR Data CRC error (only in CRC mode)
  */
 int SD_ReadSectors(uint8_t* readDataBuffer, uint32_t startSector,
     uint32_t sectorsToRead) {
 
+  PROFILER_ZONE(sdReadSectors);
+
   if (!isCardInitalized) {
     return SD_CARD_NOT_INITALIZED;
   }
@@ -362,22 +439,22 @@ int SD_ReadSectors(uint8_t* readDataBuffer, uint32_t startSector,
     startSector *= NUMBER_OF_BYTES_IN_SECTOR;
   }
 
-  SpiHal_select(SPI_HAL_SPI1);
+  SpiBus_acquire(&sdCardDevice);
 
   result = sendCommand(SD_READ_MULTIPLE_BLOCK, startSector);
 
   if (result != SD_NO_ERROR) {
     println("SD_READ_MULTIPLE_BLOCK error");
-    SpiHal_deselect(SPI_HAL_SPI1);
+    SpiBus_release(&sdCardDevice);
     return SD_BLOCK_READ_ERROR;
   }
 
   while (sectorsToRead) {
-    // wait for data token
-    while (SpiHal_transmitByte(SPI_HAL_SPI1, DUMMY_BYTE) != SD_TOKEN_SBR_MBR_SBW);
-    SpiHal_readBuffer(SPI_HAL_SPI1, readDataBuffer, NUMBER_OF_BYTES_IN_SECTOR);
-    SpiHal_transmitByte(SPI_HAL_SPI1, DUMMY_BYTE);
-    SpiHal_transmitByte(SPI_HAL_SPI1, DUMMY_BYTE); // two bytes CRC
+    result = receiveDataBlock(readDataBuffer, NUMBER_OF_BYTES_IN_SECTOR);
+    if (result != SD_NO_ERROR) {
+      println("SD_READ_MULTIPLE_BLOCK CRC error");
+      break;
+    }
     sectorsToRead--;
     readDataBuffer += NUMBER_OF_BYTES_IN_SECTOR; // move buffer pointer forward
   }
@@ -385,11 +462,11 @@ int SD_ReadSectors(uint8_t* readDataBuffer, uint32_t startSector,
   sendCommand(SD_STOP_TRANSMISSION, 0);
 
   // R1b response - check busy flag
-  while(!SpiHal_transmitByte(SPI_HAL_SPI1, DUMMY_BYTE));
+  while(!SpiHal_transmitByte(SD_SPI, DUMMY_BYTE));
 
-  SpiHal_deselect(SPI_HAL_SPI1);
+  SpiBus_release(&sdCardDevice);
 
-  return SD_NO_ERROR;
+  return result;
 }
 /**
  * @brief Write sectors to SD card
@@ -398,6 +475,7 @@ int SD_ReadSectors(uint8_t* readDataBuffer, uint32_t startSector,
  * @param count Number of sectors to write
  * @retval 0 Read was successful
  * @retval 1 Error occurred
+ * @retval SD_BLOCK_CRC_ERROR Card rejected data due to CRC error (only in CRC mode)
  */
 int SD_WriteSectors(uint8_t* writeDataBuffer, uint32_t startSector,
     uint32_t sectorsToWrite) {
@@ -416,36 +494,123 @@ int SD_WriteSectors(uint8_t* writeDataBuffer, uint32_t startSector,
     startSector *= NUMBER_OF_BYTES_IN_SECTOR;
   }
 
-  SpiHal_select(SPI_HAL_SPI1);
+  SpiBus_acquire(&sdCardDevice);
 
   result = sendCommand(SD_WRITE_MULTIPLE_BLOCK, startSector);
 
   if (result != SD_NO_ERROR) {
     println("SD_WRITE_MULTIPLE_BLOCK error");
-    SpiHal_deselect(SPI_HAL_SPI1);
+    SpiBus_release(&sdCardDevice);
     return SD_BLOCK_WRITE_ERROR;
   }
 
   while (sectorsToWrite) {
-    SpiHal_transmitByte(SPI_HAL_SPI1, START_BLOCK_TOKEN);
-    SpiHal_sendBuffer(SPI_HAL_SPI1, writeDataBuffer, NUMBER_OF_BYTES_IN_SECTOR);
-    SpiHal_transmitByte(SPI_HAL_SPI1, DUMMY_BYTE);
-    SpiHal_transmitByte(SPI_HAL_SPI1, DUMMY_BYTE); // two bytes CRC
+    result = sendDataBlock(START_BLOCK_TOKEN, writeDataBuffer,
+        NUMBER_OF_BYTES_IN_SECTOR);
+    if (result != SD_NO_ERROR) {
+      println("SD_WRITE_MULTIPLE_BLOCK data rejected");
+      break;
+    }
     sectorsToWrite--;
     writeDataBuffer += NUMBER_OF_BYTES_IN_SECTOR; // move buffer pointer forward
-    // data response
-    SpiHal_transmitByte(SPI_HAL_SPI1, DUMMY_BYTE);
-    while(!SpiHal_transmitByte(SPI_HAL_SPI1, DUMMY_BYTE)); // wait while card is busy
   }
 
-  SpiHal_transmitByte(SPI_HAL_SPI1, STOP_TRANSMISSION_TOKEN); // stop transmission token
-  SpiHal_transmitByte(SPI_HAL_SPI1, DUMMY_BYTE);
-  while(!SpiHal_transmitByte(SPI_HAL_SPI1, DUMMY_BYTE)); // wait while card is busy
+  SpiHal_transmitByte(SD_SPI, STOP_TRANSMISSION_TOKEN); // stop transmission token
+  SpiHal_transmitByte(SD_SPI, DUMMY_BYTE);
+  while(!SpiHal_transmitByte(SD_SPI, DUMMY_BYTE)); // wait while card is busy
+
+  SpiBus_release(&sdCardDevice);
+
+  return result;
+}
+/**
+ * @brief Erases sectors of the SD card.
+ * @details Erased sectors read as all zeros or all ones,
+ * depending on the card.
+ * @param startSector First sector to erase
+ * @param sectorsToErase Number of sectors to erase
+ * @retval SD_NO_ERROR Erase was successful
+ * @retval SD_ERASE_ERROR Error occurred
+ */
+int SD_EraseSectors(uint32_t startSector, uint32_t sectorsToErase) {
+
+  if (!isCardInitalized) {
+    return SD_CARD_NOT_INITALIZED;
+  }
+  if (sectorsToErase == 0) {
+    return SD_NO_ERROR;
+  }
+
+  const int NUMBER_OF_BYTES_IN_SECTOR = 512;
+  uint32_t endSector = startSector + sectorsToErase - 1;
+
+  // SDSC cards use byte addressing, SDHC use block addressing
+  if (!isSDHC) {
+    startSector *= NUMBER_OF_BYTES_IN_SECTOR;
+    endSector *= NUMBER_OF_BYTES_IN_SECTOR;
+  }
+
+  SpiBus_acquire(&sdCardDevice);
+
+  if ((sendCommand(SD_ERASE_WR_BLK_START_ADDR, startSector) != SD_NO_ERROR) ||
+      (sendCommand(SD_ERASE_WR_BLK_END_ADDR, endSector) != SD_NO_ERROR) ||
+      (sendCommand(SD_ERASE, 0) != SD_NO_ERROR)) {
+    println("SD_ERASE error");
+    SpiBus_release(&sdCardDevice);
+    return SD_ERASE_ERROR;
+  }
+
+  // R1b response - check busy flag
+  while(!SpiHal_transmitByte(SD_SPI, DUMMY_BYTE));
 
-  SpiHal_deselect(SPI_HAL_SPI1);
+  SpiBus_release(&sdCardDevice);
 
   return SD_NO_ERROR;
 }
+/**
+ * @brief Initializes a block device for the SD card.
+ * @details Initializes the card as well.
+ * @param device Block device structure
+ * @return Result of block device initialization
+ */
+BlockDeviceResultCode SD_InitializeBlockDevice(BlockDevice* device) {
+  return BlockDevice_initialize(device, &sdBlockDeviceOperations, NULL);
+}
+/**
+ * @brief Block device initialization function.
+ */
+int initializeBlockDevice(void* driverContext) {
+  return SD_Initialize();
+}
+/**
+ * @brief Block device read function.
+ */
+int readBlocks(void* driverContext, uint8_t* buffer, uint32_t block,
+    uint32_t count) {
+  return SD_ReadSectors(buffer, block, count);
+}
+/**
+ * @brief Block device write function.
+ */
+int writeBlocks(void* driverContext, uint8_t* buffer, uint32_t block,
+    uint32_t count) {
+  return SD_WriteSectors(buffer, block, count);
+}
+/**
+ * @brief Block device trim function - erases unused sectors.
+ */
+int trimBlocks(void* driverContext, uint32_t block, uint32_t count) {
+  return SD_EraseSectors(block, count);
+}
+/**
+ * @brief Block device geometry function.
+ */
+int getGeometry(void* driverContext, BlockDeviceGeometry* geometry) {
+  const int NUMBER_OF_BYTES_IN_SECTOR = 512;
+  geometry->blockSize = NUMBER_OF_BYTES_IN_SECTOR;
+  geometry->blockCount = cardCapacity / NUMBER_OF_BYTES_IN_SECTOR;
+  return SD_NO_ERROR;
+}
 /**
  * @brief Reads OCR register
  *
@@ -470,11 +635,8 @@ SD_CardErrorsTypedef readOcr(SD_OCR* ocr) {
   *ptr = Utils_convertUnsignedIntToHostEndianness(*ptrBuf);
 
   // Send OCR to terminal
-  print("OCR value: ");
-  for (int i = 0; i < OCR_LENGTH; i++) {
-    print("%02x ", ocrBuffer[i]);
-  }
-  print("\r\n");
+  println("OCR value: %02x %02x %02x %02x", ocrBuffer[0], ocrBuffer[1],
+      ocrBuffer[2], ocrBuffer[3]);
 
   return SD_NO_ERROR;
 }
@@ -491,11 +653,9 @@ SD_CardErrorsTypedef readCid(SD_CID* cid) {
 
   // Read CID implemented as read block
   // So do the same as for read block
-  // wait for data token
-  while (SpiHal_transmitByte(SPI_HAL_SPI1, DUMMY_BYTE) != SD_TOKEN_SBR_MBR_SBW);
-  SpiHal_readBuffer(SPI_HAL_SPI1, cidBuffer, CID_LENGTH);
-  SpiHal_transmitByte(SPI_HAL_SPI1, DUMMY_BYTE);
-  SpiHal_transmitByte(SPI_HAL_SPI1, DUMMY_BYTE); // two bytes CRC
+  if (receiveDataBlock(cidBuffer, CID_LENGTH) != SD_NO_ERROR) {
+    println("CID CRC error");
+  }
 
   uint8_t* ptr = (uint8_t*)cid;
   for (int i = 0; i < CID_LENGTH; i++) {
@@ -505,7 +665,7 @@ SD_CardErrorsTypedef readCid(SD_CID* cid) {
 //  UTILS_HexdumpWithCharacters(cidBuffer, CID_LENGTH);
 
   // R1b response - check busy flag
-  while(!SpiHal_transmitByte(SPI_HAL_SPI1, DUMMY_BYTE));
+  while(!SpiHal_transmitByte(SD_SPI, DUMMY_BYTE));
 
   return SD_NO_ERROR;
 }
@@ -527,11 +687,9 @@ SD_CardErrorsTypedef readCsd(SD_CSD* csd) {
 
   // Read CID implemented as read block
   // So do the same as for read block
-  // wait for data token
-  while (SpiHal_transmitByte(SPI_HAL_SPI1, DUMMY_BYTE) != SD_TOKEN_SBR_MBR_SBW);
-  SpiHal_readBuffer(SPI_HAL_SPI1, csdBuffer, CSD_LENGTH);
-  SpiHal_transmitByte(SPI_HAL_SPI1, DUMMY_BYTE);
-  SpiHal_transmitByte(SPI_HAL_SPI1, DUMMY_BYTE); // two bytes CRC
+  if (receiveDataBlock(csdBuffer, CSD_LENGTH) != SD_NO_ERROR) {
+    println("CSD CRC error");
+  }
 
   uint32_t* ptr = (uint32_t*)csd;
   uint32_t* ptrBuf = (uint32_t*)csdBuffer;
@@ -546,11 +704,12 @@ SD_CardErrorsTypedef readCsd(SD_CSD* csd) {
   println("CSD device size: %u", (unsigned int) csd->deviceSize);
 
   // size counted in blocks of 512K
-  cardCapacity = csd->deviceSize * BLOCK_SIZE;
-  println("Card capacity: %u", (unsigned int)cardCapacity);
+  cardCapacity = (uint64_t)(csd->deviceSize + 1) * BLOCK_SIZE;
+  const uint64_t BYTES_IN_MEGABYTE = 1024 * 1024;
+  println("Card capacity: %u MB", (unsigned int)(cardCapacity / BYTES_IN_MEGABYTE));
 
   // R1b response - check busy flag
-  while(!SpiHal_transmitByte(SPI_HAL_SPI1, DUMMY_BYTE));
+  while(!SpiHal_transmitByte(SD_SPI, DUMMY_BYTE));
   return SD_NO_ERROR;
 }
 /**
@@ -565,29 +724,25 @@ SD_CardErrorsTypedef readCsd(SD_CSD* csd) {
  */
 SD_CardErrorsTypedef sendCommand(uint8_t cmd, uint32_t args) {
 
-  SpiHal_transmitByte(SPI_HAL_SPI1, 0x40 | cmd);
-  SpiHal_transmitByte(SPI_HAL_SPI1, args >> 24); // MSB first
-  SpiHal_transmitByte(SPI_HAL_SPI1, args >> 16);
-  SpiHal_transmitByte(SPI_HAL_SPI1, args >> 8);
-  SpiHal_transmitByte(SPI_HAL_SPI1, args);
-
-  // CRC is irrelevant while using SPI interface - only checked for some commands.
-  switch (cmd) {
-  case SD_GO_IDLE_STATE:
-    SpiHal_transmitByte(SPI_HAL_SPI1, 0x95);
-    break;
-  case SD_SEND_IF_COND:
-    SpiHal_transmitByte(SPI_HAL_SPI1, 0x87);
-    break;
-  default:
-    SpiHal_transmitByte(SPI_HAL_SPI1, DUMMY_BYTE);
-  }
+  const int COMMAND_LENGTH_WITHOUT_CRC = 5;
+  uint8_t commandBuffer[COMMAND_LENGTH_WITHOUT_CRC + 1];
+
+  commandBuffer[0] = 0x40 | cmd;
+  commandBuffer[1] = args >> 24; // MSB first
+  commandBuffer[2] = args >> 16;
+  commandBuffer[3] = args >> 8;
+  commandBuffer[4] = args;
+  // CRC is only checked for CMD0 and CMD8 unless CRC mode is enabled
+  // with CMD59, but it is cheap enough to always send the valid one.
+  commandBuffer[COMMAND_LENGTH_WITHOUT_CRC] = Crc_calculateCrc7(commandBuffer,
+      COMMAND_LENGTH_WITHOUT_CRC);
+  SpiHal_sendBuffer(SD_SPI, commandBuffer, COMMAND_LENGTH_WITHOUT_CRC + 1);
   // Practice has shown that a valid response token
   // is sent as the second byte by the card.
   // So, we send a dummy byte first.
-  SpiHal_transmitByte(SPI_HAL_SPI1, DUMMY_BYTE);
+  SpiHal_transmitByte(SD_SPI, DUMMY_BYTE);
   SD_ResponseR1 commandResponse;
-  commandResponse.asUint8 = SpiHal_transmitByte(SPI_HAL_SPI1, DUMMY_BYTE);
+  commandResponse.asUint8 = SpiHal_transmitByte(SD_SPI, DUMMY_BYTE);
 //  println("Response to cmd %d is %02x", cmd, commandResponse.asUint8);
 
   // Check response errors
@@ -605,6 +760,66 @@ SD_CardErrorsTypedef sendCommand(uint8_t cmd, uint32_t args) {
 
   return SD_NO_ERROR;
 }
+/**
+ * @brief Receives a data block from the card.
+ * @details Waits for the start block token, reads the data and the two
+ * CRC bytes following it. The CRC is verified only if CRC mode is enabled.
+ * @param buffer Buffer for received data
+ * @param length Length of the data block
+ * @retval SD_NO_ERROR Block received
+ * @retval SD_BLOCK_CRC_ERROR CRC of received data is invalid
+ */
+SD_CardErrorsTypedef receiveDataBlock(uint8_t* buffer, int length) {
+  // wait for data token
+  while (SpiHal_transmitByte(SD_SPI, DUMMY_BYTE) != SD_TOKEN_SBR_MBR_SBW);
+  SpiHal_readBuffer(SD_SPI, buffer, length);
+  // two bytes CRC - MSB first
+  uint16_t receivedCrc = SpiHal_transmitByte(SD_SPI, DUMMY_BYTE) << 8;
+  receivedCrc |= SpiHal_transmitByte(SD_SPI, DUMMY_BYTE);
+
+  if (isCrcEnabled && (receivedCrc != Crc_calculateCrc16Ccitt(buffer, length))) {
+    return SD_BLOCK_CRC_ERROR;
+  }
+  return SD_NO_ERROR;
+}
+/**
+ * @brief Sends a data block to the card.
+ * @details Sends the start block token, the data and its CRC, then waits
+ * until the card finishes programming. The data response token is
+ * checked only if CRC mode is enabled.
+ * @param token Start block token
+ * @param buffer Data to send
+ * @param length Length of the data block
+ * @retval SD_NO_ERROR Block accepted by the card
+ * @retval SD_BLOCK_CRC_ERROR Card rejected block due to CRC error
+ * @retval SD_BLOCK_WRITE_ERROR Card rejected block due to write error
+ */
+SD_CardErrorsTypedef sendDataBlock(uint8_t token, uint8_t* buffer, int length) {
+  uint16_t crc = DUMMY_BYTE << 8 | DUMMY_BYTE;
+  if (isCrcEnabled) {
+    crc = Crc_calculateCrc16Ccitt(buffer, length);
+  }
+  SpiHal_transmitByte(SD_SPI, token);
+  SpiHal_sendBuffer(SD_SPI, buffer, length);
+  SpiHal_transmitByte(SD_SPI, crc >> 8); // two bytes CRC - MSB first
+  SpiHal_transmitByte(SD_SPI, crc);
+  // data response
+  uint8_t dataResponse = SpiHal_transmitByte(SD_SPI, DUMMY_BYTE) &
+      SD_TOKEN_DATA_RESPONSE_MASK;
+  while(!SpiHal_transmitByte(SD_SPI, DUMMY_BYTE)); // wait while card is busy
+
+  if (!isCrcEnabled) {
+    return SD_NO_ERROR;
+  }
+  switch (dataResponse) {
+  case SD_TOKEN_DATA_ACCEPTED:
+    return SD_NO_ERROR;
+  case SD_TOKEN_DATA_CRC:
+    return SD_BLOCK_CRC_ERROR;
+  default:
+    return SD_BLOCK_WRITE_ERROR;
+  }
+}
 /**
  * @brief Get R3 or R7 response from card
  * @details R3 response is for READ_OCR command (it is actually five bytes R1
@@ -615,7 +830,7 @@ SD_CardErrorsTypedef sendCommand(uint8_t cmd, uint32_t args) {
 void getResponseR3orR7(uint8_t* responseBuffer) {
   const int RESPONSE_R3_OR_R7_LENGTH = 4;
   for (int i = 0; i < RESPONSE_R3_OR_R7_LENGTH; i++) {
-    responseBuffer[i] = SpiHal_transmitByte(SPI_HAL_SPI1, DUMMY_BYTE);
+    responseBuffer[i] = SpiHal_transmitByte(SD_SPI, DUMMY_BYTE);
   }
 }
 /**
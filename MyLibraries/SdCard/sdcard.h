@@ -19,6 +19,8 @@
 #define SDCARD_H_
 
 #include <inttypes.h>
+#include "utils.h"
+#include "block_device.h"
 
 /**
  * @defgroup  SD_CARD SD CARD
@@ -38,12 +40,18 @@ typedef enum {
   SD_BLOCK_READ_ERROR,
   SD_BLOCK_WRITE_ERROR,
   SD_CARD_NOT_INITALIZED,
+  SD_BLOCK_CRC_ERROR,
+  SD_ERASE_ERROR,
 } SD_CardErrorsTypedef;
 
 int SD_Initialize   (void);
 int SD_ReadSectors  (uint8_t* buf, uint32_t sector, uint32_t count);
 int SD_WriteSectors (uint8_t* buf, uint32_t sector, uint32_t count);
+int SD_EraseSectors (uint32_t sector, uint32_t count);
 uint64_t SD_ReadCapacity(void);
+void SD_EnableCrc   (Boolean isEnabled);
+Boolean SD_IsCrcEnabled(void);
+BlockDeviceResultCode SD_InitializeBlockDevice(BlockDevice* device);
 
 /**
  * @}
@@ -0,0 +1,223 @@
+#!/usr/bin/env python3
+#
+# @file    serial_packet_peer.py
+# @brief   Host side of the SerialPort binary packet protocol.
+# @details Packets are [sequence][payload][CRC16-CCITT, MSB first], COBS
+# encoded and delimited with zero bytes - see SerialPort_sendPacket.
+#
+#          serial_packet_peer.py --self-test
+#          serial_packet_peer.py /dev/ttyACM0 --listen
+#          serial_packet_peer.py /dev/ttyACM0 --send 01 02 03
+#          serial_packet_peer.py /dev/ttyACM0 --echo 1000
+#
+# --echo needs firmware that sends every received packet back. Only the
+# Python standard library is needed (termios - Linux/macOS).
+# @date    19.10.2026
+# @author  Michal Ksiezopolski
+#
+# Copyright (c) 2026 Michal Ksiezopolski.
+# All rights reserved. This program and the
+# accompanying materials are made available
+# under the terms of the GNU Public License
+# v3.0 which accompanies this distribution,
+# and is available at
+# http://www.gnu.org/licenses/gpl.html
+#
+
+import argparse
+import os
+import random
+import select
+import time
+
+DELIMITER = 0
+MAXIMUM_PAYLOAD = 250
+
+
+def crc16Ccitt(data, crc=0):
+    """CRC16-CCITT (polynomial 0x1021, initial value 0) - same as Crc_calculateCrc16Ccitt"""
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xffff
+    return crc
+
+
+def cobsEncode(data):
+    output = bytearray([0])
+    codeIndex = 0
+    code = 1
+    for i, byte in enumerate(data):
+        if byte == 0:
+            output[codeIndex] = code
+            codeIndex = len(output)
+            output.append(0)
+            code = 1
+            continue
+        output.append(byte)
+        code += 1
+        if code == 0xff and i + 1 < len(data):
+            output[codeIndex] = code
+            codeIndex = len(output)
+            output.append(0)
+            code = 1
+    output[codeIndex] = code
+    return bytes(output)
+
+
+def cobsDecode(data):
+    output = bytearray()
+    index = 0
+    while index < len(data):
+        code = data[index]
+        index += 1
+        if code == 0 or index + code - 1 > len(data):
+            return None
+        block = data[index:index + code - 1]
+        if 0 in block:
+            return None
+        output += block
+        index += code - 1
+        if code != 0xff and index < len(data):
+            output.append(0)
+    return bytes(output)
+
+
+def encodePacket(sequence, payload):
+    if len(payload) > MAXIMUM_PAYLOAD:
+        raise ValueError("payload too long")
+    packet = bytes([sequence & 0xff]) + bytes(payload)
+    crc = crc16Ccitt(packet)
+    return bytes([DELIMITER]) + cobsEncode(packet + bytes([crc >> 8, crc & 0xff])) + bytes([DELIMITER])
+
+
+class PacketDecoder:
+    """Splits a byte stream into packets - feed() returns (sequence, payload) tuples"""
+
+    def __init__(self):
+        self.buffer = bytearray()
+        self.expectedSequence = None
+        self.receivedPackets = 0
+        self.crcErrors = 0
+        self.framingErrors = 0
+        self.lostPackets = 0
+
+    def feed(self, data):
+        self.buffer += data
+        packets = []
+        while DELIMITER in self.buffer:
+            end = self.buffer.index(DELIMITER)
+            frame = bytes(self.buffer[:end])
+            del self.buffer[:end + 1]
+            if not frame:
+                continue
+            packet = cobsDecode(frame)
+            if packet is None or len(packet) < 3:
+                self.framingErrors += 1
+                continue
+            if crc16Ccitt(packet[:-2]) != (packet[-2] << 8 | packet[-1]):
+                self.crcErrors += 1
+                continue
+            sequence = packet[0]
+            if self.expectedSequence is not None and sequence != self.expectedSequence:
+                self.lostPackets += (sequence - self.expectedSequence) & 0xff
+            self.expectedSequence = (sequence + 1) & 0xff
+            self.receivedPackets += 1
+            packets.append((sequence, packet[1:-2]))
+        return packets
+
+
+def selfTest():
+    random.seed(1)
+    decoder = PacketDecoder()
+    stream = bytearray(b"some text from printf\r\n")
+    payloads = []
+    for sequence in range(2000):
+        payload = bytes(random.choice([0, random.randrange(256)])
+                        for _ in range(random.randrange(MAXIMUM_PAYLOAD + 1)))
+        payloads.append(payload)
+        stream += encodePacket(sequence, payload)
+    received = []
+    for start in range(0, len(stream), 37): # arbitrary chunks like a serial port
+        received += decoder.feed(stream[start:start + 37])
+    assert [payload for _, payload in received] == payloads, "round trip failed"
+    assert decoder.framingErrors + decoder.crcErrors == 1, "text not rejected"
+    corrupted = bytearray(encodePacket(0, b"abc"))
+    corrupted[2] ^= 0x10
+    assert decoder.feed(bytes(corrupted)) == [] and decoder.crcErrors + decoder.framingErrors == 2
+    print("self test passed: %d packets" % len(received))
+
+
+def openSerialPort(name, baudRate):
+    import termios
+    fileDescriptor = os.open(name, os.O_RDWR | os.O_NOCTTY)
+    attributes = termios.tcgetattr(fileDescriptor)
+    attributes[0] = 0                                          # iflag
+    attributes[1] = 0                                          # oflag
+    attributes[2] = termios.CS8 | termios.CREAD | termios.CLOCAL # cflag
+    attributes[3] = 0                                          # lflag
+    speed = getattr(termios, "B%d" % baudRate)
+    attributes[4] = attributes[5] = speed
+    termios.tcsetattr(fileDescriptor, termios.TCSANOW, attributes)
+    return fileDescriptor
+
+
+def readAvailable(fileDescriptor, timeout):
+    ready, _, _ = select.select([fileDescriptor], [], [], timeout)
+    return os.read(fileDescriptor, 4096) if ready else b""
+
+
+def listen(fileDescriptor):
+    decoder = PacketDecoder()
+    while True:
+        for sequence, payload in decoder.feed(readAvailable(fileDescriptor, 1.0)):
+            print("%3d: %s" % (sequence, payload.hex(" ")))
+
+
+def echo(fileDescriptor, count):
+    decoder = PacketDecoder()
+    start = time.time()
+    payloadBytes = 0
+    for sequence in range(count):
+        payload = os.urandom(random.randrange(1, MAXIMUM_PAYLOAD + 1))
+        os.write(fileDescriptor, encodePacket(sequence, payload))
+        deadline = time.time() + 1.0
+        replies = []
+        while not replies and time.time() < deadline:
+            replies = decoder.feed(readAvailable(fileDescriptor, 0.1))
+        if not replies or replies[0][1] != payload:
+            print("packet %d: no valid echo" % sequence)
+        payloadBytes += len(payload)
+    elapsed = time.time() - start
+    print("%d packets, %d payload bytes each way in %.2f s (%.0f B/s), "
+          "crc errors %d, framing errors %d, lost %d" % (count, payloadBytes, elapsed,
+          payloadBytes / elapsed, decoder.crcErrors, decoder.framingErrors, decoder.lostPackets))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="SerialPort binary packet peer")
+    parser.add_argument("port", nargs="?", help="serial port, e.g. /dev/ttyACM0")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--self-test", action="store_true", help="test encoder and decoder")
+    parser.add_argument("--listen", action="store_true", help="print received packets")
+    parser.add_argument("--send", nargs="+", metavar="BYTE", help="send one packet (hex bytes)")
+    parser.add_argument("--echo", type=int, metavar="COUNT", help="send packets and check echoes")
+    arguments = parser.parse_args()
+
+    if arguments.self_test:
+        selfTest()
+        return
+    if arguments.port is None:
+        parser.error("port is required")
+    fileDescriptor = openSerialPort(arguments.port, arguments.baud)
+    if arguments.send:
+        os.write(fileDescriptor, encodePacket(0, bytes(int(byte, 16) for byte in arguments.send)))
+    elif arguments.echo:
+        echo(fileDescriptor, arguments.echo)
+    else:
+        listen(fileDescriptor)
+
+
+if __name__ == "__main__":
+    main()
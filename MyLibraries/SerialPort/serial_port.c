@@ -18,6 +18,12 @@
 #include "serial_port.h"
 #include "fifo.h"
 #include "usart.h"
+#include "cobs.h"
+#include "crc.h"
+#include "common_hal.h"
+#ifdef USE_USB_DEVICE
+  #include "usb_virtual_com_port.h"
+#endif
 #include <string.h>
 #include <stdio.h>
 
@@ -38,156 +44,573 @@
  * @{
  */
 
-#define TRANSMIT_BUFFER_LENGTH  512   ///< Transmit buffer length
-#define RECEIVE_BUFFER_LENGTH   32    ///< Receive buffer length
+/*
+ * Define SERIAL_PORT_USE_USB_CDC to send the debug console over the USB virtual
+ * COM port instead of the debug console USART. Requires USE_USB_DEVICE.
+ */
+#ifdef SERIAL_PORT_USE_USB_CDC
+  #define DEBUG_CONSOLE_TRANSPORT               SERIAL_PORT_TRANSPORT_USB_CDC
+  #define DEBUG_CONSOLE_TRANSMIT_BUFFER_LENGTH  2048  ///< Transmit buffer length
+  #define DEBUG_CONSOLE_RECEIVE_BUFFER_LENGTH   512   ///< Receive buffer length (fits two binary packets)
+#else
+  #define DEBUG_CONSOLE_TRANSPORT               SERIAL_PORT_TRANSPORT_USART
+  #define DEBUG_CONSOLE_TRANSMIT_BUFFER_LENGTH  512   ///< Transmit buffer length
+  #define DEBUG_CONSOLE_RECEIVE_BUFFER_LENGTH   512   ///< Receive buffer length (fits two binary packets)
+#endif
 
-static char receiveBuffer[RECEIVE_BUFFER_LENGTH];   ///< Buffer for received data FIFO.
-static char transmitBuffer[TRANSMIT_BUFFER_LENGTH]; ///< Buffer for transmitted data FIFO.
-static Fifo receiveFifo;                            ///< RX FIFO
-static Fifo transmitFifo;                           ///< TX FIFO
+static char debugConsoleReceiveBuffer[DEBUG_CONSOLE_RECEIVE_BUFFER_LENGTH];   ///< Buffer for data received by debug console
+static char debugConsoleTransmitBuffer[DEBUG_CONSOLE_TRANSMIT_BUFFER_LENGTH]; ///< Buffer for data sent by debug console
+static SerialPort debugConsole FAST_BSS;            ///< Port used by printf (FIFO indices in fast RAM)
 static const char TERMINATOR_CHARACTER = '\r';      ///< Frame terminator character
-static int frameCounter;                            ///< Nonzero signals a new frame (number of received frames)
 
-static UsartTransmission getMoreDataToTransmit(void);
-static void receiveNewDataFromHal(char receivedCharacter);
+/*
+ * Binary packets: [sequence][payload][CRC16-CCITT of sequence and payload, MSB first]
+ * COBS encoded and surrounded by zero delimiters. Text frames and binary packets
+ * shouldn't be mixed on one port - SerialPort_getFrame takes everything up to '\r'.
+ */
+
+static UsartTransmission getMoreDataToTransmit(void* context);
+static void transmissionComplete(void* context, int transmittedLength);
+static void receiveNewDataFromHal(void* context, const char* data, int length);
+static void startTransmitter(SerialPort* port);
+static void dropOldestData(SerialPort* port, int length);
+static void enableTransportIrq(SerialPort* port);
+static void disableTransportIrq(SerialPort* port);
+static Boolean isTransportSendingData(SerialPort* port);
+static Boolean isCalledFromIrq(void);
+static uint32_t enterCritical(void);
+static void exitCritical(uint32_t primask);
 
 /**
- * @brief Initialize communication terminal interface.
- * @param baudRate Required baud rate
+ * @brief Initialize the debug console (the port used by printf).
+ * @details Uses DEBUG_CONSOLE_USART, or the USB virtual COM port if
+ * SERIAL_PORT_USE_USB_CDC is defined.
+ * @param baudRate Required baud rate (ignored by the USB transport)
  */
 void SerialPort_initialize(int baudRate) {
+  SerialPortInitialization initialization;
+  initialization.transport = DEBUG_CONSOLE_TRANSPORT;
+  initialization.usart = DEBUG_CONSOLE_USART;
+  initialization.baudRate = baudRate;
+  initialization.receiveBuffer = debugConsoleReceiveBuffer;
+  initialization.receiveBufferLength = DEBUG_CONSOLE_RECEIVE_BUFFER_LENGTH;
+  initialization.transmitBuffer = debugConsoleTransmitBuffer;
+  initialization.transmitBufferLength = DEBUG_CONSOLE_TRANSMIT_BUFFER_LENGTH;
+  if (SerialPort_addNewPort(&debugConsole, &initialization) != SERIAL_PORT_OK) {
+    CommonHal_errorHandler();
+  }
+}
+/**
+ * @brief Gets the debug console
+ * @return Port used by printf
+ */
+SerialPort* SerialPort_getDebugConsole(void) {
+  return &debugConsole;
+}
+/**
+ * @brief Initialize a serial port.
+ * @details Every port has its own buffers and lower layer, so ports on
+ * different USARTs work independently (each USART has its own DMA streams).
+ * @param port Port to initialize
+ * @param initialization Port configuration
+ * @retval SERIAL_PORT_OK Port initialized
+ * @retval SERIAL_PORT_INVALID_CONFIGURATION Buffer length is not a power of two
+ * or the transport is not available
+ */
+SerialPortResultCode SerialPort_addNewPort(SerialPort* port,
+    const SerialPortInitialization* initialization) {
+  memset(port, 0, sizeof(SerialPort));
+  port->transport = initialization->transport;
+  port->usart = initialization->usart;
+  port->overflowPolicy = SERIAL_PORT_DROP_NEWEST;
+  // Initialize RX FIFO for receiving data from PC
+  if (Fifo_addNewFifo(&port->receiveFifo, initialization->receiveBuffer,
+      initialization->receiveBufferLength) != FIFO_OK) {
+    return SERIAL_PORT_INVALID_CONFIGURATION;
+  }
+  // Initialize TX FIFO for transferring data to PC
+  if (Fifo_addNewFifo(&port->transmitFifo, initialization->transmitBuffer,
+      initialization->transmitBufferLength) != FIFO_OK) {
+    return SERIAL_PORT_INVALID_CONFIGURATION;
+  }
+  if (port->transport == SERIAL_PORT_TRANSPORT_USB_CDC) {
+#ifdef USE_USB_DEVICE
+    UsbVirtualComPortInitialization usbInitialization;
+    usbInitialization.context = port;
+    usbInitialization.getMoreDataToTransmit = getMoreDataToTransmit;
+    usbInitialization.transmissionComplete = transmissionComplete;
+    usbInitialization.sendDataToUpperLayer = receiveNewDataFromHal;
+    UsbVirtualComPort_initialize(&usbInitialization);
+    return SERIAL_PORT_OK;
+#else
+    return SERIAL_PORT_INVALID_CONFIGURATION;
+#endif
+  }
   UsartHalInitialization usartInitialization;
-  usartInitialization.baudRate = baudRate;
+  usartInitialization.baudRate = initialization->baudRate;
+  usartInitialization.receiveMode = USART_HAL_RECEIVE_DMA;
+  usartInitialization.context = port;
   usartInitialization.getMoreDataToTransmit = getMoreDataToTransmit;
+  usartInitialization.transmissionComplete = transmissionComplete;
   usartInitialization.sendDataToUpperLayer = receiveNewDataFromHal;
-  Usart_initialize(DEBUG_CONSOLE_USART, &usartInitialization);
-  // Initialize RX FIFO for receiving data from PC
-  Fifo_addNewFifo(&receiveFifo, receiveBuffer, RECEIVE_BUFFER_LENGTH);
-  // Initialize TX FIFO for transferring data to PC
-  Fifo_addNewFifo(&transmitFifo, transmitBuffer, TRANSMIT_BUFFER_LENGTH);
+  Usart_initialize(port->usart, &usartInitialization);
+  return SERIAL_PORT_OK;
+}
+/**
+ * @brief Sets what happens when transmitted data doesn't fit in the TX buffer
+ * @param port Serial port
+ * @param policy Overflow policy
+ */
+void SerialPort_setOverflowPolicy(SerialPort* port, SerialPortOverflowPolicy policy) {
+  port->overflowPolicy = policy;
+}
+/**
+ * @brief Sets the function called when a frame or packet is received
+ * @details The callback runs in the transport IRQ, after the terminator or
+ * delimiter is in the RX FIFO - it should only wake up the code reading the
+ * port (e.g. Scheduler_post), which then doesn't have to poll.
+ * @param port Serial port
+ * @param receiveCb Receive callback (NULL - none)
+ * @param context User pointer passed to callback
+ */
+void SerialPort_setReceiveCallback(SerialPort* port, SerialPortReceiveCallback receiveCb,
+    void* context) {
+  disableTransportIrq(port);
+  port->receiveCallback = receiveCb;
+  port->receiveCallbackContext = context;
+  enableTransportIrq(port);
+}
+/**
+ * @brief Gets number of transmitted bytes dropped due to full TX buffer
+ * @param port Serial port
+ * @return Number of dropped bytes
+ */
+unsigned int SerialPort_getDroppedCount(SerialPort* port) {
+  return port->droppedCount;
+}
+/**
+ * @brief Send data to PC.
+ * @details This function is called in _write for printf to work. The data
+ * is copied into the TX FIFO in bulk and the transmitter is started once.
+ * When the FIFO is full the overflow policy is applied - except in an IRQ,
+ * which can't wait for the transmitter, so there the data which doesn't fit
+ * is always dropped.
+ *
+ * The TX FIFO has one producer side, but the main loop and IRQs may all
+ * write, so every push is done with IRQs disabled.
+ * @param port Serial port
+ * @param data Data to send
+ * @param length Number of bytes to send
+ * @return Number of bytes queued for transmission
+ */
+int SerialPort_write(SerialPort* port, const char* data, int length) {
+  Boolean isInIrq = isCalledFromIrq();
+  int written = 0;
+  while (TRUE) {
+    uint32_t primask = enterCritical();
+    written += Fifo_pushMultiple(&port->transmitFifo, data + written, length - written);
+    exitCritical(primask);
+    startTransmitter(port);
+    if (written == length) {
+      return written;
+    }
+    // FIFO is full
+    if (port->overflowPolicy == SERIAL_PORT_DROP_NEWEST || isInIrq) {
+      port->droppedCount += length - written;
+      return written;
+    }
+    if (port->overflowPolicy == SERIAL_PORT_DROP_OLDEST) {
+      int missing = length - written;
+      int bufferLength = port->transmitFifo.length;
+      primask = enterCritical();
+      dropOldestData(port, missing < bufferLength ? missing : bufferLength);
+      exitCritical(primask);
+    }
+    // wait until the transmitter frees some space
+    while (Fifo_getFreeSpace(&port->transmitFifo) == 0) {
+    }
+  }
 }
 /**
  * @brief Send a char to PC.
- * @details This function can be called in _write for printf to work
+ * @param port Serial port
  * @param characterToSend Character to send.
  */
-void SerialPort_putCharacter(char characterToSend) {
-  // disable IRQ so it doesn't screw up FIFO count - leads to errors in transmission
-  // basically this function should be called from a lesser priority IRQ or main
-  // to work correctly
-  Usart_disableIrq(DEBUG_CONSOLE_USART);
-  Fifo_push(&transmitFifo, characterToSend);
-  // enable transmitter if inactive
-  if (!Usart_isSendingData(DEBUG_CONSOLE_USART)) {
-    Usart_sendDataIrq(DEBUG_CONSOLE_USART);
-  }
-  // enable IRQ again
-  Usart_enableIrq(DEBUG_CONSOLE_USART);
+void SerialPort_putCharacter(SerialPort* port, char characterToSend) {
+  SerialPort_write(port, &characterToSend, 1);
 }
 /**
  * @brief Send string to PC with newline
+ * @param port Serial port
  * @param line Line to send
  */
-void SerialPort_printLine(char * line) {
-  for (unsigned int i = 0; i < strlen(line); i++) {
-    SerialPort_putCharacter(line[i]);
-  }
-  SerialPort_putCharacter('\r');
-  SerialPort_putCharacter('\n');
+void SerialPort_printLine(SerialPort* port, char * line) {
+  SerialPort_write(port, line, strlen(line));
+  SerialPort_write(port, "\r\n", 2);
 }
 /**
  * @brief Get a char from PC
+ * @param port Serial port
  * @return Received character
  * @warning Blocking function! Waits until char is received.
  */
-char SerialPort_getCharacter(void) {
+char SerialPort_getCharacter(SerialPort* port) {
   char receivedCharacter;
-  while (Fifo_isEmpty(&receiveFifo)); // wait until buffer is not empty
-  Fifo_pop(&receiveFifo, &receivedCharacter); // Get data from RX buffer
+  while (Fifo_isEmpty(&port->receiveFifo)); // wait until buffer is not empty
+  Fifo_pop(&port->receiveFifo, &receivedCharacter); // Get data from RX buffer
   return (char)receivedCharacter;
 }
 /**
  * @brief Get a complete frame from PC (nonblocking)
+ * @param port Serial port
  * @param buf Buffer for data (data will be null terminated for easier string manipulation)
  * @param len Length not including terminator character of frame
  * @retval COMM_GOT_FRAME Received frame
  * @retval COMM_NO_FRAME_READY No frame in buffer
  * @retval COMM_FRAME_ERROR Frame error
  */
-SerialPortResultCode SerialPort_getFrame(char* frameBuffer, int* length, int maximumLength) {
+SerialPortResultCode SerialPort_getFrame(SerialPort* port, char* frameBuffer, int* length,
+    int maximumLength) {
   *length = 0;
-  if (frameCounter) {
-    Usart_disableIrq(DEBUG_CONSOLE_USART);
-    while (TRUE) {
-      // no more data and terminator wasn't reached => error
-      if (Fifo_isEmpty(&receiveFifo)) {
-        frameCounter = 0;
-        *length = 0;
-        println("Invalid frame");
-        Fifo_flush(&receiveFifo);
-        Usart_enableIrq(DEBUG_CONSOLE_USART);
-        return SERIAL_PORT_FRAME_ERROR;
-      }
+  if (port->framesReceived == port->framesProcessed) {
+    return SERIAL_PORT_NO_FRAME_READY;
+  }
+  int terminatorPosition = Fifo_find(&port->receiveFifo, TERMINATOR_CHARACTER);
+  // terminator was counted but isn't there => error
+  if (terminatorPosition < 0) {
+    port->framesProcessed = port->framesReceived;
+    println("Invalid frame");
+    Fifo_flush(&port->receiveFifo);
+    return SERIAL_PORT_FRAME_ERROR;
+  }
+  if (terminatorPosition + 1 >= maximumLength) {
+    port->framesProcessed = port->framesReceived;
+    println("Frame too long");
+    Fifo_flush(&port->receiveFifo);
+    return SERIAL_PORT_FRAME_TOO_LARGE;
+  }
+  // take the whole frame at one go
+  Fifo_popMultiple(&port->receiveFifo, frameBuffer, terminatorPosition + 1);
+  *length = terminatorPosition; // length without terminator character
+  frameBuffer[*length] = 0; // terminator character converted to NULL terminator
+  port->framesProcessed++;
+  return SERIAL_PORT_GOT_FRAME;
+}
+/**
+ * @brief Send a binary packet to PC
+ * @details The packet is written to the TX buffer whole or not at all (unless
+ * the overflow policy is SERIAL_PORT_BLOCK and the function is not called
+ * from an IRQ).
+ * @param port Serial port
+ * @param payload Packet payload
+ * @param length Payload length
+ * @retval SERIAL_PORT_OK Packet queued for transmission
+ * @retval SERIAL_PORT_FRAME_TOO_LARGE Payload longer than SERIAL_PORT_MAXIMUM_PACKET_LENGTH
+ * @retval SERIAL_PORT_BUFFER_FULL No space in TX buffer
+ */
+SerialPortResultCode SerialPort_sendPacket(SerialPort* port, const uint8_t* payload, int length) {
+  if (length > SERIAL_PORT_MAXIMUM_PACKET_LENGTH) {
+    return SERIAL_PORT_FRAME_TOO_LARGE;
+  }
+  uint8_t packet[SERIAL_PORT_MAXIMUM_PACKET_LENGTH + SERIAL_PORT_PACKET_OVERHEAD];
+  packet[0] = port->transmitSequence;
+  memcpy(packet + 1, payload, length);
+  uint16_t crc = Crc_calculateCrc16Ccitt(packet, length + 1);
+  packet[length + 1] = crc >> 8;
+  packet[length + 2] = crc & 0xff;
 
-      char receivedByte;
-      Fifo_pop(&receiveFifo, &receivedByte);
-      frameBuffer[(*length)++] = receivedByte;
+  // leading delimiter ends any garbage the receiver got before the packet
+  uint8_t frame[SERIAL_PORT_MAXIMUM_ENCODED_PACKET + 2];
+  frame[0] = COBS_FRAME_DELIMITER;
+  int frameLength = Cobs_encode(packet, length + SERIAL_PORT_PACKET_OVERHEAD, frame + 1) + 1;
+  frame[frameLength++] = COBS_FRAME_DELIMITER;
 
-      if (*length >= maximumLength) {
-        frameCounter = 0;
-        *length = 0;
-        println("Frame too long");
-        Fifo_flush(&receiveFifo);
-        Usart_enableIrq(DEBUG_CONSOLE_USART);
-        return SERIAL_PORT_FRAME_TOO_LARGE;
-      }
+  if (port->overflowPolicy == SERIAL_PORT_BLOCK && !isCalledFromIrq()) {
+    port->transmitSequence++;
+    SerialPort_write(port, (const char*)frame, frameLength);
+    return SERIAL_PORT_OK;
+  }
+  // no other writer may take the space between the check and the write
+  uint32_t primask = enterCritical();
+  if (Fifo_getFreeSpace(&port->transmitFifo) < frameLength) {
+    exitCritical(primask);
+    port->droppedCount += frameLength;
+    return SERIAL_PORT_BUFFER_FULL;
+  }
+  port->transmitSequence++;
+  SerialPort_write(port, (const char*)frame, frameLength);
+  exitCritical(primask);
+  return SERIAL_PORT_OK;
+}
+/**
+ * @brief Get a binary packet from PC (nonblocking, zero-copy)
+ * @details The packet is decoded in place in the RX buffer - the payload stays
+ * valid until SerialPort_releasePacket (or the next call of this function).
+ * Only a packet wrapping around the end of the RX buffer is copied. A bad
+ * packet is dropped alone, the following data is kept.
+ * @param port Serial port
+ * @param packet Received packet
+ * @retval SERIAL_PORT_GOT_FRAME Received packet
+ * @retval SERIAL_PORT_NO_FRAME_READY No packet in buffer
+ * @retval SERIAL_PORT_FRAME_ERROR Packet with invalid encoding or CRC was dropped
+ * @retval SERIAL_PORT_FRAME_TOO_LARGE Packet too long was dropped
+ */
+SerialPortResultCode SerialPort_getPacket(SerialPort* port, SerialPortPacket* packet) {
+  SerialPort_releasePacket(port);
+  while (port->packetsReceived != port->packetsProcessed) {
+    port->packetsProcessed++;
+    int encodedLength = Fifo_find(&port->receiveFifo, COBS_FRAME_DELIMITER);
+    if (encodedLength < 0) {
+      // delimiter was counted but isn't there
+      port->packetsProcessed = port->packetsReceived;
+      Fifo_flush(&port->receiveFifo);
+      port->packetStatistics.framingErrors++;
+      return SERIAL_PORT_FRAME_ERROR;
+    }
+    if (encodedLength == 0) {
+      Fifo_consume(&port->receiveFifo, 1); // empty frame between delimiters
+      continue;
+    }
+    if (encodedLength > SERIAL_PORT_MAXIMUM_ENCODED_PACKET) {
+      Fifo_consume(&port->receiveFifo, encodedLength + 1);
+      port->packetStatistics.framingErrors++;
+      return SERIAL_PORT_FRAME_TOO_LARGE;
+    }
 
-      // if end of frame
-      if (receivedByte == TERMINATOR_CHARACTER) {
-        (*length)--; // length without terminator character
-        frameBuffer[*length] = 0; // terminator character converted to NULL terminator
-        frameCounter--;
-        Usart_enableIrq(DEBUG_CONSOLE_USART);
-        return SERIAL_PORT_GOT_FRAME;
-      }
+    uint8_t* data;
+    FifoSpan span = Fifo_getReadableSpan(&port->receiveFifo);
+    if (span.length >= encodedLength) {
+      data = (uint8_t*)span.data;
+      port->heldPacketLength = encodedLength + 1;
+    } else {
+      Fifo_popMultiple(&port->receiveFifo, (char*)port->wrappedPacket, encodedLength);
+      Fifo_consume(&port->receiveFifo, 1);
+      data = port->wrappedPacket;
     }
-  } else {
-    return SERIAL_PORT_NO_FRAME_READY;
+
+    int length = Cobs_decode(data, encodedLength, data);
+    if (length < SERIAL_PORT_PACKET_OVERHEAD) {
+      SerialPort_releasePacket(port);
+      port->packetStatistics.framingErrors++;
+      return SERIAL_PORT_FRAME_ERROR;
+    }
+    uint16_t crc = (data[length - 2] << 8) | data[length - 1];
+    if (Crc_calculateCrc16Ccitt(data, length - 2) != crc) {
+      SerialPort_releasePacket(port);
+      port->packetStatistics.crcErrors++;
+      return SERIAL_PORT_FRAME_ERROR;
+    }
+
+    if (port->packetStatistics.receivedPackets > 0 && data[0] != port->expectedSequence) {
+      port->packetStatistics.lostPackets += (uint8_t)(data[0] - port->expectedSequence);
+    }
+    port->expectedSequence = data[0] + 1;
+    port->packetStatistics.receivedPackets++;
+
+    packet->sequence = data[0];
+    packet->payload = data + 1;
+    packet->length = length - SERIAL_PORT_PACKET_OVERHEAD;
+    return SERIAL_PORT_GOT_FRAME;
   }
+  return SERIAL_PORT_NO_FRAME_READY;
+}
+/**
+ * @brief Frees the RX buffer space held by the last received packet
+ * @param port Serial port
+ */
+void SerialPort_releasePacket(SerialPort* port) {
+  if (port->heldPacketLength > 0) {
+    Fifo_consume(&port->receiveFifo, port->heldPacketLength);
+    port->heldPacketLength = 0;
+  }
+}
+/**
+ * @brief Gets binary packet reception statistics
+ * @param port Serial port
+ * @param statistics Statistics
+ */
+void SerialPort_getPacketStatistics(SerialPort* port, SerialPortPacketStatistics* statistics) {
+  *statistics = port->packetStatistics;
 }
 /**
  * @brief Callback for receiving data from PC.
- * @param receivedCharacter Data sent from lower layer software.
+ * @details Called with a whole USB packet or with a part of the USART DMA buffer.
+ * @param context Serial port
+ * @param data Data sent from lower layer software.
+ * @param length Number of received bytes
  */
-void receiveNewDataFromHal(char receivedCharacter) {
-  Fifo_push(&receiveFifo, receivedCharacter);
-  // Checking result to ensure no buffer overflow occurred
-  if (receivedCharacter == TERMINATOR_CHARACTER) {
-    frameCounter++;
+void receiveNewDataFromHal(void* context, const char* data, int length) {
+  SerialPort* port = context;
+  unsigned int previousFrames = port->framesReceived;
+  unsigned int previousPackets = port->packetsReceived;
+  // count only frames which fit in the FIFO
+  int pushed = Fifo_pushMultiple(&port->receiveFifo, data, length);
+  const char* end = data + pushed;
+  const char* terminator = memchr(data, TERMINATOR_CHARACTER, pushed);
+  while (terminator != NULL) {
+    port->framesReceived++;
+    terminator++;
+    terminator = memchr(terminator, TERMINATOR_CHARACTER, end - terminator);
+  }
+  const char* delimiter = memchr(data, COBS_FRAME_DELIMITER, pushed);
+  while (delimiter != NULL) {
+    port->packetsReceived++;
+    delimiter++;
+    delimiter = memchr(delimiter, COBS_FRAME_DELIMITER, end - delimiter);
+  }
+  if (port->receiveCallback != NULL && (port->framesReceived != previousFrames ||
+      port->packetsReceived != previousPackets)) {
+    port->receiveCallback(port->receiveCallbackContext);
   }
 }
 /**
- * @brief Callback for transmitting data to lower layer
- * @param dataToTransmit Transmitted data
- * @return Number of bytes to be transmitted
+ * @brief Enables transmitter if inactive
+ * @details The transport IRQ is disabled only to check the transmitter state,
+ * the consumer side of the FIFO doesn't need a lock.
+ * @param port Serial port
  */
-UsartTransmission getMoreDataToTransmit(void) {
-  // Buffer for transmitted data for HAL module (double buffering)
-  static char transmitBufferHal[TRANSMIT_BUFFER_LENGTH];
-  UsartTransmission transmission = {0};
-
-  if (Fifo_isEmpty(&transmitFifo)) {
-    return transmission;
+void startTransmitter(SerialPort* port) {
+  disableTransportIrq(port);
+  if (!isTransportSendingData(port)) {
+#ifdef USE_USB_DEVICE
+    if (port->transport == SERIAL_PORT_TRANSPORT_USB_CDC) {
+      UsbVirtualComPort_sendDataIrq();
+    } else
+#endif
+    {
+      Usart_sendDataIrq(port->usart);
+    }
+  }
+  enableTransportIrq(port);
+}
+/**
+ * @brief Discards oldest TX data to make room for new data
+ * @details Data handed to the lower layer can't be dropped (DMA reads it), so
+ * while transmitting the drop is done by the consumer when the running
+ * transmission completes. With the IRQ disabled the consumer can't run, so an
+ * idle transmitter lets the producer drop the data itself.
+ * @param port Serial port
+ * @param length Number of bytes needed
+ */
+void dropOldestData(SerialPort* port, int length) {
+  disableTransportIrq(port);
+  int count = Fifo_getCount(&port->transmitFifo);
+  int missing = length - Fifo_getFreeSpace(&port->transmitFifo);
+  if (!isTransportSendingData(port)) {
+    // a request left by an aborted transmission (e.g. USB disconnected) never ran
+    port->droppedCount -= port->transmitDropLength;
+    port->transmitDropLength = 0;
+    if (missing > count) {
+      missing = count;
+    }
+    if (missing > 0) {
+      Fifo_consume(&port->transmitFifo, missing);
+      port->droppedCount += missing;
+    }
+  } else {
+    int droppable = count - port->transmittingLength - port->transmitDropLength;
+    missing -= port->transmitDropLength;
+    if (missing > droppable) {
+      missing = droppable;
+    }
+    if (missing > 0) {
+      port->transmitDropLength += missing;
+      port->droppedCount += missing;
+    }
+  }
+  enableTransportIrq(port);
+}
+/**
+ * @brief Enables the lower layer IRQ of the port
+ * @param port Serial port
+ */
+void enableTransportIrq(SerialPort* port) {
+#ifdef USE_USB_DEVICE
+  if (port->transport == SERIAL_PORT_TRANSPORT_USB_CDC) {
+    UsbVirtualComPort_enableIrq();
+    return;
   }
-  // get all the data at one go
-  int i = 0;
-  while (Fifo_pop(&transmitFifo, transmitBufferHal + i) == FIFO_OK) {
-    i++;
+#endif
+  Usart_enableIrq(port->usart);
+}
+/**
+ * @brief Disables the lower layer IRQ of the port
+ * @param port Serial port
+ */
+void disableTransportIrq(SerialPort* port) {
+#ifdef USE_USB_DEVICE
+  if (port->transport == SERIAL_PORT_TRANSPORT_USB_CDC) {
+    UsbVirtualComPort_disableIrq();
+    return;
   }
-  transmission.transmitBuffer = transmitBufferHal;
-  transmission.bufferLength = i;
+#endif
+  Usart_disableIrq(port->usart);
+}
+/**
+ * @brief Checks if the lower layer of the port is sending data
+ * @param port Serial port
+ * @return TRUE if a transmission is running
+ */
+Boolean isTransportSendingData(SerialPort* port) {
+#ifdef USE_USB_DEVICE
+  if (port->transport == SERIAL_PORT_TRANSPORT_USB_CDC) {
+    return UsbVirtualComPort_isSendingData();
+  }
+#endif
+  return Usart_isSendingData(port->usart);
+}
+/**
+ * @brief Checks if the caller runs in an IRQ (handler mode)
+ * @return TRUE if called from an IRQ
+ */
+Boolean isCalledFromIrq(void) {
+  return (__get_IPSR() != 0) ? TRUE : FALSE;
+}
+/**
+ * @brief Disables interrupts
+ * @return Previous interrupt mask
+ */
+uint32_t enterCritical(void) {
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+  return primask;
+}
+/**
+ * @brief Restores interrupts
+ * @param primask Interrupt mask returned by enterCritical
+ */
+void exitCritical(uint32_t primask) {
+  __set_PRIMASK(primask);
+}
+/**
+ * @brief Callback for transmitting data to lower layer
+ * @details The lower layer sends straight from the TX FIFO (no copy). Only the
+ * contiguous part is returned - the wrapped remainder is sent in the next
+ * transmission.
+ * @param context Serial port
+ * @return Data to be transmitted
+ */
+UsartTransmission getMoreDataToTransmit(void* context) {
+  SerialPort* port = context;
+  FifoSpan span = Fifo_getReadableSpan(&port->transmitFifo);
+  port->transmittingLength = span.length;
+  UsartTransmission transmission;
+  transmission.transmitBuffer = span.data;
+  transmission.bufferLength = span.length;
   return transmission;
 }
+/**
+ * @brief Callback for releasing data sent by lower layer
+ * @param context Serial port
+ * @param transmittedLength Number of bytes sent
+ */
+void transmissionComplete(void* context, int transmittedLength) {
+  SerialPort* port = context;
+  // drop old data requested by SerialPort_write too
+  Fifo_consume(&port->transmitFifo, transmittedLength + port->transmitDropLength);
+  port->transmitDropLength = 0;
+  port->transmittingLength = 0;
+}
 /**
  * @}
  */
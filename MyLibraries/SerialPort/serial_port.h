@@ -19,10 +19,41 @@
 #define COMM_H_
 
 #include "utils.h"
+#include "fifo.h"
+#include "usart.h"
+#include "cobs.h"
+#include <inttypes.h>
 
 /**
  * @defgroup  SERIAL_PORT SERIAL_PORT
  * @brief     Communication with PC functions.
+ * @details Every serial port is an instance with its own buffers, so the
+ * debug console and other links can run at the same time. The debug console
+ * (used by printf) is set up by SerialPort_initialize. Another port is added
+ * with SerialPort_addNewPort:
+ * @code
+ * static char sensorReceiveBuffer[1024];
+ * static char sensorTransmitBuffer[256];
+ * static SerialPort sensorLink;
+ *
+ * SerialPortInitialization initialization = {
+ *   .transport = SERIAL_PORT_TRANSPORT_USART,
+ *   .usart = USART_HAL_USART6,
+ *   .baudRate = 921600,
+ *   .receiveBuffer = sensorReceiveBuffer,
+ *   .receiveBufferLength = sizeof(sensorReceiveBuffer),
+ *   .transmitBuffer = sensorTransmitBuffer,
+ *   .transmitBufferLength = sizeof(sensorTransmitBuffer),
+ * };
+ * SerialPort_addNewPort(&sensorLink, &initialization);
+ * SerialPort_sendPacket(&sensorLink, data, length);
+ * @endcode
+ * Writing (SerialPort_write, printf on the debug console, packets) is
+ * allowed from the main loop and from IRQs of any priority - the writes are
+ * serialized by disabling IRQs while the data is copied into the TX buffer.
+ * Only the main loop waits for space with SERIAL_PORT_BLOCK, in an IRQ data
+ * which doesn't fit is dropped and counted by SerialPort_getDroppedCount.
+ * Reading is done by one context only (usually the main loop).
  */
 
 /**
@@ -37,13 +68,111 @@ typedef enum {
   SERIAL_PORT_NO_FRAME_READY, //!< SERIAL_PORT_NO_FRAME_READY
   SERIAL_PORT_FRAME_ERROR,    //!< SERIAL_PORT_FRAME_ERROR
   SERIAL_PORT_FRAME_TOO_LARGE,//!< SERIAL_PORT_FRAME_TOO_LARGE
+  SERIAL_PORT_OK,             //!< SERIAL_PORT_OK
+  SERIAL_PORT_BUFFER_FULL,    //!< SERIAL_PORT_BUFFER_FULL
+  SERIAL_PORT_INVALID_CONFIGURATION, //!< SERIAL_PORT_INVALID_CONFIGURATION
 } SerialPortResultCode;
 
+#define SERIAL_PORT_MAXIMUM_PACKET_LENGTH 250 ///< Maximum payload of a binary packet
+#define SERIAL_PORT_PACKET_OVERHEAD       3   ///< Sequence number and CRC of a binary packet
+/**
+ * @brief Maximum length of a COBS encoded binary packet (without delimiters)
+ */
+#define SERIAL_PORT_MAXIMUM_ENCODED_PACKET \
+  COBS_MAXIMUM_ENCODED_LENGTH(SERIAL_PORT_MAXIMUM_PACKET_LENGTH + SERIAL_PORT_PACKET_OVERHEAD)
+/**
+ * @brief Received binary packet
+ * @details The payload points into the RX buffer and is valid until
+ * SerialPort_releasePacket is called.
+ */
+typedef struct {
+  const uint8_t* payload; ///< Packet payload
+  int length;             ///< Payload length
+  uint8_t sequence;       ///< Sequence number set by sender
+} SerialPortPacket;
+/**
+ * @brief Binary packet reception statistics
+ */
+typedef struct {
+  unsigned int receivedPackets; ///< Number of valid packets
+  unsigned int framingErrors;   ///< Number of frames with invalid COBS or length
+  unsigned int crcErrors;       ///< Number of frames with wrong CRC
+  unsigned int lostPackets;     ///< Number of packets missing in sequence
+} SerialPortPacketStatistics;
+/**
+ * @brief What to do with transmitted data when the TX buffer is full
+ */
+typedef enum {
+  SERIAL_PORT_DROP_NEWEST, //!< Data which doesn't fit is discarded (default)
+  SERIAL_PORT_DROP_OLDEST, //!< Oldest data not yet being sent is discarded
+  SERIAL_PORT_BLOCK,       //!< Wait until the data fits (in IRQs data which doesn't fit is dropped)
+} SerialPortOverflowPolicy;
+/**
+ * @brief Lower layer carrying the serial port data
+ */
+typedef enum {
+  SERIAL_PORT_TRANSPORT_USART,   //!< USART with DMA
+  SERIAL_PORT_TRANSPORT_USB_CDC, //!< USB virtual COM port (one port only, requires USE_USB_DEVICE)
+} SerialPortTransport;
+/**
+ * @brief Callback for received frames or packets (called from IRQ)
+ * @param context User pointer given to SerialPort_setReceiveCallback
+ */
+typedef void (*SerialPortReceiveCallback)(void* context);
+/**
+ * @brief Serial port initialization structure
+ */
+typedef struct {
+  SerialPortTransport transport; ///< Lower layer
+  UsartNumber usart;             ///< USART used by SERIAL_PORT_TRANSPORT_USART
+  int baudRate;                  ///< Baud rate (ignored by the USB transport)
+  char* receiveBuffer;           ///< Buffer for received data
+  int receiveBufferLength;       ///< Length of receive buffer (power of two)
+  char* transmitBuffer;          ///< Buffer for transmitted data
+  int transmitBufferLength;      ///< Length of transmit buffer (power of two)
+} SerialPortInitialization;
+/**
+ * @brief Serial port instance
+ * @details Allocated by the user, the fields are private to SERIAL_PORT.
+ */
+typedef struct {
+  SerialPortTransport transport;           ///< Lower layer
+  UsartNumber usart;                       ///< USART number
+  Fifo receiveFifo;                        ///< RX FIFO
+  Fifo transmitFifo;                       ///< TX FIFO
+  volatile unsigned int framesReceived;    ///< Number of received terminators (written by IRQ only)
+  unsigned int framesProcessed;            ///< Number of frames taken by SerialPort_getFrame (written by main only)
+  SerialPortOverflowPolicy overflowPolicy; ///< TX buffer full policy
+  volatile unsigned int droppedCount;      ///< Number of transmitted bytes dropped due to full TX buffer
+  volatile int transmittingLength;         ///< Length of TX data handed to lower layer (written by IRQ only)
+  volatile int transmitDropLength;         ///< Old TX data to drop when the running transmission completes
+  volatile unsigned int packetsReceived;   ///< Number of received delimiters (written by IRQ only)
+  unsigned int packetsProcessed;           ///< Number of delimiters handled by SerialPort_getPacket
+  int heldPacketLength;                    ///< Bytes of the RX FIFO held by the last returned packet
+  uint8_t transmitSequence;                ///< Sequence number of next sent packet
+  uint8_t expectedSequence;                ///< Sequence number of next received packet
+  SerialPortPacketStatistics packetStatistics; ///< Reception statistics
+  SerialPortReceiveCallback receiveCallback; ///< Called when a frame or packet is received
+  void* receiveCallbackContext;            ///< User pointer passed to receive callback
+  uint8_t wrappedPacket[SERIAL_PORT_MAXIMUM_ENCODED_PACKET]; ///< Packet wrapping around the end of RX FIFO
+} SerialPort;
+
 void                 SerialPort_initialize   (int baudRate);
-void                 SerialPort_putCharacter (char characterToSend);
-char                 SerialPort_getCharacter (void);
-SerialPortResultCode SerialPort_getFrame     (char* frameBuffer, int* length, int maximumLength);
-void                 SerialPort_printLine    (char* line);
+SerialPort*          SerialPort_getDebugConsole   (void);
+SerialPortResultCode SerialPort_addNewPort   (SerialPort* port, const SerialPortInitialization* initialization);
+void                 SerialPort_setOverflowPolicy (SerialPort* port, SerialPortOverflowPolicy policy);
+void                 SerialPort_setReceiveCallback (SerialPort* port,
+                                                    SerialPortReceiveCallback receiveCb, void* context);
+unsigned int         SerialPort_getDroppedCount   (SerialPort* port);
+int                  SerialPort_write        (SerialPort* port, const char* data, int length);
+void                 SerialPort_putCharacter (SerialPort* port, char characterToSend);
+char                 SerialPort_getCharacter (SerialPort* port);
+SerialPortResultCode SerialPort_getFrame     (SerialPort* port, char* frameBuffer, int* length, int maximumLength);
+void                 SerialPort_printLine    (SerialPort* port, char* line);
+SerialPortResultCode SerialPort_sendPacket   (SerialPort* port, const uint8_t* payload, int length);
+SerialPortResultCode SerialPort_getPacket    (SerialPort* port, SerialPortPacket* packet);
+void                 SerialPort_releasePacket(SerialPort* port);
+void                 SerialPort_getPacketStatistics (SerialPort* port, SerialPortPacketStatistics* statistics);
 /**
  * @}
  */
@@ -22,12 +22,14 @@
 
 extern int __io_getchar(void) __attribute__((weak));
 
-#ifndef FreeRTOS
-  register char * stack_ptr asm("sp");
-#endif
-
 caddr_t _sbrk(int incr) {
+#ifdef MEMORY_POOL_NEWLIB_MALLOC
+	// malloc is served by the memory pools - the heap must not grow
+	errno = ENOMEM;
+	return (caddr_t) -1;
+#else
 	extern char end asm("end");
+	extern char __heap_limit asm("__heap_limit"); // end of RAM (the stack is in FASTRAM)
 	static char *heap_end;
 	char *prev_heap_end;
 
@@ -45,7 +47,7 @@ caddr_t _sbrk(int incr) {
 
 	if (heap_end + incr > min_stack_ptr)
 #else
-	if (heap_end + incr > stack_ptr)
+	if (heap_end + incr > &__heap_limit)
 #endif
 	{
 //		write(1, "Heap and stack collision\n", 25);
@@ -57,6 +59,7 @@ caddr_t _sbrk(int incr) {
 	heap_end += incr;
 
 	return (caddr_t) prev_heap_end;
+#endif
 }
 
 /*
@@ -91,9 +94,8 @@ void _exit (int status) {
 
 int _write(int file, char *ptr, int len) {
 
-  for (int i = 0; i < len; i++) {
-    SerialPort_putCharacter(*ptr++);
-  }
+  // data that was dropped is reported as written, otherwise newlib keeps retrying
+  SerialPort_write(SerialPort_getDebugConsole(), ptr, len);
 	return len;
 }
 
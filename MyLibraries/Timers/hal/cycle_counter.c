@@ -0,0 +1,83 @@
+/**
+ * @file    cycle_counter.c
+ * @brief   Core clock cycle counter (DWT CYCCNT).
+ * @details The 32 bit counter runs at the core clock without any
+ * interrupts and wraps every 25.5 s at 168 MHz (19.9 s at 216 MHz).
+ * CycleCounter_getCycles64 extends it to 64 bits by counting the wraps,
+ * so it has to be called at least once per wrap period - the TIMER module
+ * does it from the SysTick.
+ * @date    19.10.2026
+ * @author  Michal Ksiezopolski
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#include "cycle_counter.h"
+#include "common_hal.h"
+
+/**
+ * @addtogroup CYCLE_COUNTER
+ * @{
+ */
+
+#define DWT_LOCK_ACCESS_KEY 0xc5acce55 ///< Unlocks DWT registers on Cortex-M7
+
+static uint32_t previousCycles;   ///< Counter value at last 64 bit read
+static uint32_t counterWraps;     ///< Number of counter wraps (upper 32 bits)
+
+/**
+ * @brief Starts the cycle counter
+ * @details The counter is part of the debug unit, so the trace block
+ * has to be enabled. The count is not reset, so a running counter (e.g.
+ * started by a debugger) keeps its time.
+ */
+void CycleCounter_initialize(void) {
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+#ifdef BOARD_STM32F7_DISCOVERY
+  DWT->LAR = DWT_LOCK_ACCESS_KEY;
+#endif
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+/**
+ * @brief Gets the 32 bit cycle count
+ * @return Number of core clock cycles (wraps around)
+ */
+uint32_t CycleCounter_getCycles(void) {
+  return DWT->CYCCNT;
+}
+/**
+ * @brief Gets the 64 bit cycle count (monotonic)
+ * @details Can be called from IRQs - the wrap detection is done with IRQs
+ * disabled.
+ * @return Number of core clock cycles since the counter was started
+ */
+uint64_t CycleCounter_getCycles64(void) {
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+  uint32_t cycles = DWT->CYCCNT;
+  if (cycles < previousCycles) {
+    counterWraps++;
+  }
+  previousCycles = cycles;
+  uint64_t result = ((uint64_t)counterWraps << 32) | cycles;
+  __set_PRIMASK(primask);
+  return result;
+}
+/**
+ * @brief Gets the counter frequency
+ * @return Core clock frequency in Hz
+ */
+uint32_t CycleCounter_getFrequencyHz(void) {
+  return SystemCoreClock;
+}
+/**
+ * @}
+ */
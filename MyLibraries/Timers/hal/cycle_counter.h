@@ -0,0 +1,40 @@
+/**
+ * @file    cycle_counter.h
+ * @brief   Core clock cycle counter (DWT CYCCNT).
+ * @date    19.10.2026
+ * @author  Michal Ksiezopolski
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#ifndef CYCLE_COUNTER_H_
+#define CYCLE_COUNTER_H_
+
+#include <inttypes.h>
+
+/**
+ * @defgroup  CYCLE_COUNTER CYCLE_COUNTER
+ * @brief     Core clock cycle counter.
+ */
+
+/**
+ * @addtogroup CYCLE_COUNTER
+ * @{
+ */
+void     CycleCounter_initialize       (void);
+uint32_t CycleCounter_getCycles        (void);
+uint64_t CycleCounter_getCycles64      (void);
+uint32_t CycleCounter_getFrequencyHz   (void);
+/**
+ * @}
+ */
+
+#endif /* CYCLE_COUNTER_H_ */
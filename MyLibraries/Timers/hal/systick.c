@@ -17,6 +17,7 @@
 
 #include "systick.h"
 #include "common_hal.h"
+#include "irq_monitor.h"
 
 /**
  * @defgroup  SYSTICK SYSTICK
@@ -42,6 +43,9 @@ void SysTick_initialize(void (*tickCb)(void)) {
  * @brief Interrupt handler for SysTick.
  */
 void SysTick_Handler(void) {
+  IRQ_MONITOR(sysTick);
+  // SysTick counts core cycles down from LOAD - the count since reload is the latency
+  IRQ_MONITOR_LATENCY(sysTick, SysTick->LOAD - SysTick->VAL);
   HAL_IncTick();
   if (tickHandler) {
     tickHandler();
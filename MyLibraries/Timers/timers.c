@@ -20,7 +20,9 @@
 
 #include "timers.h"
 #include "systick.h"
+#include "cycle_counter.h"
 #include "hardware_timers.h"
+#include "common_hal.h"
 #include <stdio.h>
 
 #ifndef DEBUG_TIMERS
@@ -40,50 +42,104 @@
  * @{
  */
 
-#define MAXIMUM_SOFT_TIMERS   10        ///< Maximum number of soft timers.
+#define MAXIMUM_SOFT_TIMERS   10        ///< Maximum number of soft timers identified by ID.
 #define ID_TO_ARRAY_INDEX(x)  ((x) - 1) ///< Converts timer ID to array index
 
+/*
+ * Hierarchical timing wheel. Level 0 has one slot per microsecond, every next
+ * level has slots 64 times longer. A timer is put in the lowest level that
+ * reaches its expiry and moves down (cascades) when the lower level wraps
+ * around, so every timer is moved at most WHEEL_LEVELS - 1 times. Six levels
+ * reach 2^36 us (19 hours) - longer timers wait in the last level and are put
+ * back there until they come into range.
+ *
+ * The wheel isn't stepped every microsecond - a bitmap of occupied slots per
+ * level gives the next time anything has to be done, the hardware timer
+ * compare is set to it and the wheel jumps straight there (tickless).
+ */
+#define WHEEL_LEVELS          6   ///< Number of wheel levels
+#define WHEEL_SLOT_BITS       6   ///< log2 of number of slots in a level
+#define WHEEL_SLOTS           (1 << WHEEL_SLOT_BITS) ///< Number of slots in a level
+#define WHEEL_SLOT_MASK       (WHEEL_SLOTS - 1)      ///< Mask for slot index
+#define WHEEL_RANGE_MICROS    (1ull << (WHEEL_LEVELS * WHEEL_SLOT_BITS)) ///< Range of the wheel
+
+#define TIME_BASE_TIMER       HARDWARE_TIMERS_TIMER5 ///< 32 bit timer counting microseconds
+#define TIME_BASE_FREQUENCY   1000000                ///< Time base counts microseconds
 /**
- * @brief Soft timer structure.
+ * Longest time between two compare events. The time base is read at least
+ * this often, so its 64 bit extension catches every wrap (71 minutes).
+ */
+#define MAXIMUM_DEADLINE_MICROS (1ull << 30)
+
+/**
+ * @brief Soft timer identified by ID
  */
 typedef struct {
-  int id;                           ///< Timer ID
-  unsigned int currentCountMillis;  ///< Current count value
-  unsigned int timeoutMillis;       ///< Overflow value
-  Boolean isActive;                 ///< Is timer active?
+  SoftTimer timer;                  ///< The timer
   void (*overflowCb)(void);         ///< Function called on overflow event
-} SoftTimer;
+  unsigned int timeoutMillis;       ///< Overflow value
+  unsigned int pausedRemainingMillis; ///< Time left to overflow when paused
+  Boolean isUsed;                   ///< Is the ID taken?
+} SoftTimerSlot;
+
+static SoftTimer* timerWheel[WHEEL_LEVELS][WHEEL_SLOTS] FAST_BSS; ///< Lists of timers
+static uint64_t wheelOccupancy[WHEEL_LEVELS] FAST_BSS;  ///< Bit set for every nonempty slot
+static uint64_t wheelTimeMicros FAST_BSS;           ///< Next microsecond to process by the wheel
+static int activeTimerCount FAST_BSS;               ///< Number of timers in wheel
+static SoftTimerSlot softTimerSlots[MAXIMUM_SOFT_TIMERS] FAST_BSS; ///< Timers identified by ID
+static uint64_t programmedDeadlineMicros FAST_BSS;  ///< Time set in the hardware compare
+static volatile Boolean isDeadlineReached = TRUE;   ///< Set by compare IRQ - wheel has work
 
-static SoftTimer softTimers[MAXIMUM_SOFT_TIMERS];   ///< Array of soft timers
-static int softTimerCount;                          ///< Count number of soft timers
-static volatile unsigned int systemClockMillis;     ///< System clock timer.
-static volatile unsigned int systemClockMicros;     ///< Microsecond counter
-static Boolean isMicrosCounterInitialized = FALSE;  ///< Is us counter initialized
+static void startSoftTimer(SoftTimer* timer, uint64_t timeoutMicros, uint64_t periodMicros);
+static void addToWheel(SoftTimer* timer);
+static uint64_t getNextWheelEvent(void);
+static void processWheelMicrosecond(void);
+static void programDeadline(uint64_t deadlineMicros);
+static void deadlineCallback(void);
+static void callOverflowCallback(void* context);
 
 /**
- * @brief Updates the system time in ms
+ * @brief SysTick callback
  */
 static void updateMillisCounter(void) {
-  systemClockMillis++;
+  CycleCounter_getCycles64(); // catches every wrap of the 32 bit cycle counter
 }
 /**
- * @brief Updates the us counter
- */
-static void updateMicrosCounter(void) {
-  systemClockMicros++;
-}
-/**
- * @brief Initialize the timer module (SysTick)
+ * @brief Initialize the timer module (time base, SysTick and cycle counter)
+ * @details Has to be called once in main, after CommonHal_initialize and
+ * before any other TIMER function. The time is read from IRQs too (e.g. by
+ * LOG), so the hardware isn't initialized lazily on first use, which could
+ * happen inside an IRQ.
  */
 void Timer_initialize(void) {
+  CycleCounter_initialize();
+  HardwareTimers_configureTimerAsFreeRunningWithCompare(TIME_BASE_TIMER,
+      TIME_BASE_FREQUENCY, deadlineCallback);
   SysTick_initialize(updateMillisCounter);
 }
 /**
  * @brief Returns the system time.
- * @return System time
+ * @return System time in ms
  */
 unsigned int Timer_getTimeMillis(void) {
-  return systemClockMillis;
+  return (unsigned int)(Timer_getTimeMicros64() / 1000);
+}
+/**
+ * @brief Returns the time in microseconds.
+ * @return Time in us (wraps around after 71 minutes)
+ */
+unsigned int Timer_getTimeMicros(void) {
+  return (unsigned int)Timer_getTimeMicros64();
+}
+/**
+ * @brief Returns the monotonic time in microseconds.
+ * @details Taken from a 32 bit hardware timer (which, unlike the core cycle
+ * counter, keeps counting in sleep mode) extended to 64 bits. The soft timer
+ * compare keeps the extension alive, so the time doesn't wrap around.
+ * @return Time in us since the time base was started
+ */
+uint64_t Timer_getTimeMicros64(void) {
+  return HardwareTimers_getCounter64(TIME_BASE_TIMER);
 }
 /**
  * @brief Blocking delay function.
@@ -91,47 +147,29 @@ unsigned int Timer_getTimeMillis(void) {
  * @warning This is a blocking function. Use with care!
  */
 void Timer_delayMillis(unsigned int millis) {
-  unsigned int startTimeMillis = Timer_getTimeMillis();
-  unsigned int currentTimeMillis;
-
-  while (TRUE) {
-    currentTimeMillis = Timer_getTimeMillis();
-    if ((currentTimeMillis >= startTimeMillis) &&
-        (currentTimeMillis - startTimeMillis >= millis)) {
-      break;
-    }
-    // account for system timer overflow
-    if ((currentTimeMillis < startTimeMillis) &&
-        (UINT32_MAX - startTimeMillis + currentTimeMillis >= millis)) {
-      break;
-    }
+  uint64_t startTimeMicros = Timer_getTimeMicros64();
+  while (Timer_getTimeMicros64() - startTimeMicros < (uint64_t)millis * 1000) {
   }
 }
 /**
  * @brief Blocking delay function.
+ * @details Counts core clock cycles, so the delay is accurate to a fraction of
+ * a microsecond (interrupts can only make it longer).
  * @param micros Microseconds to delay
  */
 void Timer_delayMicros(unsigned int micros) {
-  if (!isMicrosCounterInitialized) {
-    const int TIMER_FREQUENCY_HZ = 1000000;
-    HardwareTimers_configureTimerAsIrqWithCallback(HARDWARE_TIMERS_TIMER5, TIMER_FREQUENCY_HZ,
-        updateMicrosCounter);
-    isMicrosCounterInitialized = TRUE;
-  }
+  const uint32_t CYCLES_PER_MICROSECOND = CycleCounter_getFrequencyHz() / 1000000;
+  // longer delays are split, so the cycle count of a part fits the 32 bit counter
+  const unsigned int MAXIMUM_PART_MICROS = UINT32_MAX / 2 / CYCLES_PER_MICROSECOND;
 
-  unsigned int startTimeMicros = systemClockMicros;
-  unsigned int currentTimeMicros;
-  while (TRUE) {
-    currentTimeMicros = systemClockMicros;
-    if ((currentTimeMicros >= startTimeMicros) &&
-        (currentTimeMicros - startTimeMicros >= micros)) {
-      break;
-    }
-    // account for system timer overflow
-    if ((currentTimeMicros < startTimeMicros) &&
-        (UINT32_MAX - startTimeMicros + currentTimeMicros >= micros)) {
-      break;
+  while (micros > 0) {
+    unsigned int partMicros = micros < MAXIMUM_PART_MICROS ? micros : MAXIMUM_PART_MICROS;
+    uint32_t partCycles = partMicros * CYCLES_PER_MICROSECOND;
+    uint32_t startCycles = CycleCounter_getCycles();
+    // unsigned difference works across the counter wrap
+    while (CycleCounter_getCycles() - startCycles < partCycles) {
     }
+    micros -= partMicros;
   }
 }
 /**
@@ -154,6 +192,86 @@ Boolean Timer_delayTimer(unsigned int millis, unsigned int startTimeMillis) {
     return FALSE;
   }
 }
+/**
+ * @brief Initializes a soft timer (inactive)
+ * @param timer Timer
+ * @param callback Function called on expiry (from Timer_softwareTimersUpdate)
+ * @param context User pointer passed to callback
+ */
+void Timer_initializeSoftTimer(SoftTimer* timer, SoftTimerCallback callback, void* context) {
+  timer->next = NULL;
+  timer->link = NULL;
+  timer->expiryMicros = 0;
+  timer->periodMicros = 0;
+  timer->callback = callback;
+  timer->context = context;
+  timer->level = 0;
+  timer->slot = 0;
+}
+/**
+ * @brief Starts (or restarts) a soft timer
+ * @details O(1). Can be called from the timer callbacks, but not from IRQs.
+ * @param timer Timer
+ * @param timeoutMillis Time to first expiry
+ * @param periodMillis Time between next expiries, 0 for a one-shot timer
+ */
+void Timer_startSoftTimer(SoftTimer* timer, unsigned int timeoutMillis,
+    unsigned int periodMillis) {
+  startSoftTimer(timer, (uint64_t)timeoutMillis * 1000, (uint64_t)periodMillis * 1000);
+}
+/**
+ * @brief Starts (or restarts) a soft timer with microsecond resolution
+ * @details Like Timer_startSoftTimer. The callback is called from the main
+ * loop, so its latency depends on the other work done there.
+ * @param timer Timer
+ * @param timeoutMicros Time to first expiry
+ * @param periodMicros Time between next expiries, 0 for a one-shot timer
+ */
+void Timer_startSoftTimerMicros(SoftTimer* timer, uint32_t timeoutMicros,
+    uint32_t periodMicros) {
+  startSoftTimer(timer, timeoutMicros, periodMicros);
+}
+/**
+ * @brief Stops a soft timer
+ * @details O(1). Does nothing for an inactive timer. The timer memory can be
+ * reused after cancelling.
+ * @param timer Timer
+ */
+void Timer_cancelSoftTimer(SoftTimer* timer) {
+  if (timer->link == NULL) {
+    return;
+  }
+  *timer->link = timer->next;
+  if (timer->next != NULL) {
+    timer->next->link = timer->link;
+  }
+  if (timerWheel[timer->level][timer->slot] == NULL) {
+    wheelOccupancy[timer->level] &= ~(1ull << timer->slot);
+  }
+  timer->next = NULL;
+  timer->link = NULL;
+  activeTimerCount--;
+}
+/**
+ * @brief Checks if timer is running
+ * @param timer Timer
+ * @return TRUE if timer is started and has not expired (periodic timers stay active)
+ */
+Boolean Timer_isSoftTimerActive(SoftTimer* timer) {
+  return timer->link != NULL ? TRUE : FALSE;
+}
+/**
+ * @brief Gets time left to expiry
+ * @param timer Timer
+ * @return Time to expiry in ms rounded up (0 for inactive or overdue timer)
+ */
+unsigned int Timer_getSoftTimerRemaining(SoftTimer* timer) {
+  uint64_t currentTimeMicros = Timer_getTimeMicros64();
+  if (timer->link == NULL || timer->expiryMicros <= currentTimeMicros) {
+    return 0;
+  }
+  return (unsigned int)((timer->expiryMicros - currentTimeMicros + 999) / 1000);
+}
 /**
  * @brief Adds a soft timer
  * @param timeoutMillis Overflow value of timer in ms
@@ -162,75 +280,254 @@ Boolean Timer_delayTimer(unsigned int millis, unsigned int startTimeMillis) {
  * @retval TIMER_TOO_MANY_TIMERS Too many timers
  */
 int Timer_addSoftwareTimer(unsigned int timeoutMillis, void (*overflowCb)(void)) {
-  if (softTimerCount > MAXIMUM_SOFT_TIMERS) {
-    println("Reached maximum number of timers!");
-    return TIMER_TOO_MANY_TIMERS;
+  for (int i = 0; i < MAXIMUM_SOFT_TIMERS; i++) {
+    if (softTimerSlots[i].isUsed) {
+      continue;
+    }
+    softTimerSlots[i].isUsed                = TRUE;
+    softTimerSlots[i].overflowCb            = overflowCb;
+    softTimerSlots[i].timeoutMillis         = timeoutMillis;
+    softTimerSlots[i].pausedRemainingMillis = timeoutMillis;
+    // inactive on startup
+    Timer_initializeSoftTimer(&softTimerSlots[i].timer, callOverflowCallback, &softTimerSlots[i]);
+    return i + 1;
   }
-  softTimerCount++;
-
-  softTimers[ID_TO_ARRAY_INDEX(softTimerCount)].id                  = softTimerCount;
-  softTimers[ID_TO_ARRAY_INDEX(softTimerCount)].overflowCb          = overflowCb;
-  softTimers[ID_TO_ARRAY_INDEX(softTimerCount)].timeoutMillis       = timeoutMillis;
-  softTimers[ID_TO_ARRAY_INDEX(softTimerCount)].currentCountMillis  = 0;
-  softTimers[ID_TO_ARRAY_INDEX(softTimerCount)].isActive            = FALSE; // inactive on startup
-  return softTimerCount;
+  println("Reached maximum number of timers!");
+  return TIMER_TOO_MANY_TIMERS;
+}
+/**
+ * @brief Deletes a timer (its ID can be given to a new timer)
+ * @param id Timer ID
+ */
+void Timer_deleteSoftwareTimer(int id) {
+  Timer_cancelSoftTimer(&softTimerSlots[ID_TO_ARRAY_INDEX(id)].timer);
+  softTimerSlots[ID_TO_ARRAY_INDEX(id)].isUsed = FALSE;
 }
 /**
  * @brief Starts the timer (zeroes out current count value).
  * @param id Timer ID
  */
 void Timer_startSoftwareTimer(int id) {
-  softTimers[ID_TO_ARRAY_INDEX(id)].currentCountMillis = 0;
-  softTimers[ID_TO_ARRAY_INDEX(id)].isActive = TRUE;
+  SoftTimerSlot* slot = &softTimerSlots[ID_TO_ARRAY_INDEX(id)];
+  Timer_startSoftTimer(&slot->timer, slot->timeoutMillis, slot->timeoutMillis);
 }
 /**
  * @brief Pauses given timer (current count value unchanged)
  * @param id Timer ID
  */
 void Timer_pauseSoftwareTimer(int id) {
-  softTimers[ID_TO_ARRAY_INDEX(id)].isActive = FALSE;
+  SoftTimerSlot* slot = &softTimerSlots[ID_TO_ARRAY_INDEX(id)];
+  if (Timer_isSoftTimerActive(&slot->timer)) {
+    slot->pausedRemainingMillis = Timer_getSoftTimerRemaining(&slot->timer);
+    Timer_cancelSoftTimer(&slot->timer);
+  }
 }
 /**
  * @brief Resumes a timer (starts counting from last value).
  * @param id Timer ID
  */
 void Timer_resumeSoftwareTimer(int id) {
-  softTimers[ID_TO_ARRAY_INDEX(id)].isActive = TRUE;
+  SoftTimerSlot* slot = &softTimerSlots[ID_TO_ARRAY_INDEX(id)];
+  if (!Timer_isSoftTimerActive(&slot->timer)) {
+    Timer_startSoftTimer(&slot->timer, slot->pausedRemainingMillis, slot->timeoutMillis);
+  }
 }
 /**
- * @brief Updates all the timers and calls the overflow functions as
- * necessary
- * @details This function can be called periodically in the main
- * loop of the program
+ * @brief Calls the expired timers
+ * @details This function has to be called in the main loop of the program.
+ * It returns at once unless the hardware compare set for the nearest wheel
+ * event has fired. Then the wheel jumps over the empty time up to now, so a
+ * late call doesn't skip any expiry, and the compare is set again.
  */
 void Timer_softwareTimersUpdate(void) {
-
-  static unsigned int previousTimeMillis;
-  unsigned int deltaMillis;
-  unsigned int currentTimeMillis = Timer_getTimeMillis();
-
-  if (currentTimeMillis >= previousTimeMillis) {
-    // How much time passed from previous run
-    deltaMillis = currentTimeMillis - previousTimeMillis;
-  } else {
-    // if overflow occurs
-    // the difference is the value that previousTimeMillis
-    // has to UINT32_MAX + the new number of currentTimeMillis
-    deltaMillis = UINT32_MAX - previousTimeMillis + currentTimeMillis;
+  if (!isDeadlineReached) {
+    return;
   }
-
-  previousTimeMillis += deltaMillis; // update time for the function
-
-  for (int i = 0; i < softTimerCount; i++) {
-    if (softTimers[i].isActive == TRUE) {
-      softTimers[i].currentCountMillis += deltaMillis;
-      if (softTimers[i].currentCountMillis >= softTimers[i].timeoutMillis) {
-        softTimers[i].currentCountMillis = 0; // zero out timer
-        if (softTimers[i].overflowCb != NULL) {
-          softTimers[i].overflowCb();
-        }
-      }
+  isDeadlineReached = FALSE;
+  uint64_t currentTimeMicros = Timer_getTimeMicros64();
+  uint64_t nextEventMicros;
+  while ((nextEventMicros = getNextWheelEvent()) <= currentTimeMicros) {
+    wheelTimeMicros = nextEventMicros;
+    processWheelMicrosecond();
+  }
+  // nothing happens in the wheel until the next event - catch up at once
+  wheelTimeMicros = currentTimeMicros + 1;
+  programDeadline(getNextWheelEvent());
+}
+/**
+ * @brief Sleeps (WFI) until there is work for the soft timers or another IRQ comes
+ * @details Call at the end of the main loop. Any IRQ (e.g. received data) wakes
+ * the core up, so the rest of the main loop still gets its events. The HAL
+ * SysTick keeps running, so the core wakes up at least every millisecond.
+ */
+void Timer_sleepUntilEvent(void) {
+  CommonHal_sleepUntilInterrupt(Timer_hasPendingWork);
+}
+/**
+ * @brief Checks if Timer_softwareTimersUpdate has work
+ * @details For main loops sleeping on their own conditions.
+ * @return TRUE if the compare set for the nearest wheel event has fired
+ */
+Boolean Timer_hasPendingWork(void) {
+  return isDeadlineReached;
+}
+/**
+ * @brief Starts (or restarts) a soft timer
+ * @param timer Timer
+ * @param timeoutMicros Time to first expiry
+ * @param periodMicros Time between next expiries, 0 for a one-shot timer
+ */
+void startSoftTimer(SoftTimer* timer, uint64_t timeoutMicros, uint64_t periodMicros) {
+  Timer_cancelSoftTimer(timer);
+  timer->expiryMicros = Timer_getTimeMicros64() + timeoutMicros;
+  timer->periodMicros = periodMicros;
+  addToWheel(timer);
+  // the whole wheel up to the expiry is processed when the compare fires
+  if (timer->expiryMicros < programmedDeadlineMicros) {
+    programDeadline(timer->expiryMicros);
+  }
+}
+/**
+ * @brief Puts active timer in the wheel slot of its expiry
+ * @param timer Timer
+ */
+void addToWheel(SoftTimer* timer) {
+  // overdue timers expire in the next processed microsecond
+  if (timer->expiryMicros < wheelTimeMicros) {
+    timer->expiryMicros = wheelTimeMicros;
+  }
+  uint64_t deltaMicros = timer->expiryMicros - wheelTimeMicros;
+  uint64_t expiryMicros = timer->expiryMicros;
+  if (deltaMicros >= WHEEL_RANGE_MICROS) {
+    // out of range - wait in the last level slot farthest from now
+    expiryMicros = wheelTimeMicros + WHEEL_RANGE_MICROS - 1;
+    deltaMicros = WHEEL_RANGE_MICROS - 1;
+  }
+  int level = 0;
+  while (deltaMicros >= WHEEL_SLOTS) {
+    deltaMicros >>= WHEEL_SLOT_BITS;
+    level++;
+  }
+  int slot = (expiryMicros >> (level * WHEEL_SLOT_BITS)) & WHEEL_SLOT_MASK;
+  SoftTimer** head = &timerWheel[level][slot];
+  timer->next = *head;
+  if (timer->next != NULL) {
+    timer->next->link = &timer->next;
+  }
+  *head = timer;
+  timer->link = head;
+  timer->level = level;
+  timer->slot = slot;
+  wheelOccupancy[level] |= 1ull << slot;
+  activeTimerCount++;
+}
+/**
+ * @brief Finds the next time the wheel has work (expiry or cascade)
+ * @details A level slot is processed at the first time from wheelTimeMicros
+ * on, at which the lower levels wrap around and the level index equals the
+ * slot. The nearest occupied slot is found by rotating the bitmap, so empty
+ * slots cost nothing.
+ * @return Time of the next event or UINT64_MAX if there are no timers
+ */
+uint64_t getNextWheelEvent(void) {
+  uint64_t nextEventMicros = UINT64_MAX;
+  if (activeTimerCount == 0) {
+    return nextEventMicros;
+  }
+  for (int level = 0; level < WHEEL_LEVELS; level++) {
+    if (wheelOccupancy[level] == 0) {
+      continue;
+    }
+    const int SHIFT = level * WHEEL_SLOT_BITS;
+    const uint64_t SLOT_LENGTH = 1ull << SHIFT;
+    // first time from now on when this level is processed
+    uint64_t startMicros = (wheelTimeMicros + SLOT_LENGTH - 1) & ~(SLOT_LENGTH - 1);
+    int index = (startMicros >> SHIFT) & WHEEL_SLOT_MASK;
+    uint64_t rotated = wheelOccupancy[level] >> index;
+    if (index != 0) {
+      rotated |= wheelOccupancy[level] << (WHEEL_SLOTS - index);
+    }
+    uint64_t eventMicros = startMicros + ((uint64_t)__builtin_ctzll(rotated) << SHIFT);
+    if (eventMicros < nextEventMicros) {
+      nextEventMicros = eventMicros;
+    }
+  }
+  return nextEventMicros;
+}
+/**
+ * @brief Processes one microsecond of the wheel (wheelTimeMicros)
+ * @details Moves timers from higher levels when a lower level wraps around
+ * and calls the timers expiring in this microsecond.
+ */
+void processWheelMicrosecond(void) {
+  uint64_t timeMicros = wheelTimeMicros;
+  // cascade - the timers are put back relative to timeMicros, so they land in lower levels
+  for (int level = 1; level < WHEEL_LEVELS; level++) {
+    if (((timeMicros >> ((level - 1) * WHEEL_SLOT_BITS)) & WHEEL_SLOT_MASK) != 0) {
+      break;
     }
+    int slot = (timeMicros >> (level * WHEEL_SLOT_BITS)) & WHEEL_SLOT_MASK;
+    SoftTimer* timer = timerWheel[level][slot];
+    timerWheel[level][slot] = NULL;
+    wheelOccupancy[level] &= ~(1ull << slot);
+    while (timer != NULL) {
+      SoftTimer* next = timer->next;
+      activeTimerCount--;
+      addToWheel(timer);
+      timer = next;
+    }
+  }
+  // take the expiring list out of the wheel - restarted timers can land in the same slot
+  wheelTimeMicros = timeMicros + 1;
+  int slot = timeMicros & WHEEL_SLOT_MASK;
+  SoftTimer* expired = timerWheel[0][slot];
+  timerWheel[0][slot] = NULL;
+  wheelOccupancy[0] &= ~(1ull << slot);
+  if (expired != NULL) {
+    expired->link = &expired; // callbacks can still cancel timers in the list
+  }
+  while (expired != NULL) {
+    SoftTimer* timer = expired;
+    Timer_cancelSoftTimer(timer);
+    if (timer->periodMicros != 0) {
+      // no drift - next expiry is counted from this one
+      timer->expiryMicros += timer->periodMicros;
+      addToWheel(timer);
+    }
+    if (timer->callback != NULL) {
+      timer->callback(timer->context);
+    }
+  }
+}
+/**
+ * @brief Sets the hardware compare to the given time
+ * @details The time is limited to MAXIMUM_DEADLINE_MICROS from now - the
+ * compare is always running, even without timers.
+ * @param deadlineMicros Time of the next wheel event
+ */
+void programDeadline(uint64_t deadlineMicros) {
+  uint64_t maximumDeadlineMicros = Timer_getTimeMicros64() + MAXIMUM_DEADLINE_MICROS;
+  if (deadlineMicros > maximumDeadlineMicros) {
+    deadlineMicros = maximumDeadlineMicros;
+  }
+  programmedDeadlineMicros = deadlineMicros;
+  // an overdue deadline fires at once
+  HardwareTimers_setCompare(TIME_BASE_TIMER, (uint32_t)deadlineMicros);
+}
+/**
+ * @brief Hardware compare callback (IRQ)
+ */
+void deadlineCallback(void) {
+  isDeadlineReached = TRUE;
+}
+/**
+ * @brief Calls the callback of a timer identified by ID
+ * @param context Timer slot
+ */
+void callOverflowCallback(void* context) {
+  SoftTimerSlot* slot = context;
+  if (slot->overflowCb != NULL) {
+    slot->overflowCb();
   }
 }
 /**
@@ -40,15 +40,55 @@ typedef enum {
   TIMER_OK = 0,                 //!< TIMER_OK
   TIMER_TOO_MANY_TIMERS = -1,   //!< TIMER_TOO_MANY_TIMERS
 } TimerResultCode;
+/**
+ * @brief Soft timer callback
+ * @param context User pointer given to Timer_initializeSoftTimer
+ */
+typedef void (*SoftTimerCallback)(void* context);
+/**
+ * @brief Soft timer
+ * @details Allocated by the user (e.g. inside a protocol state structure), so
+ * any number of timers can be used. The fields are private to TIMER. Timers
+ * are kept in a hierarchical timing wheel with microsecond resolution -
+ * starting and cancelling is O(1) and Timer_softwareTimersUpdate touches only
+ * the timers which expire.
+ */
+typedef struct SoftTimer {
+  struct SoftTimer* next;     ///< Next timer in wheel slot
+  struct SoftTimer** link;    ///< Pointer pointing to this timer (NULL if inactive)
+  uint64_t expiryMicros;      ///< System time of expiry
+  uint64_t periodMicros;      ///< Period (0 - one-shot timer)
+  SoftTimerCallback callback; ///< Function called on expiry
+  void* context;              ///< User pointer passed to callback
+  uint8_t level;              ///< Wheel level holding the timer
+  uint8_t slot;               ///< Wheel slot holding the timer
+} SoftTimer;
 
 void         Timer_initialize           (void);
 void         Timer_delayMicros          (unsigned int micros);
 void         Timer_delayMillis          (unsigned int millis);
-void         Timer_startSoftwareTimer   (int id);
 void         Timer_softwareTimersUpdate (void);
+void         Timer_sleepUntilEvent      (void);
+Boolean      Timer_hasPendingWork       (void);
 Boolean      Timer_delayTimer           (unsigned int millis, unsigned int startTimeMillis);
 unsigned int Timer_getTimeMillis        (void);
+unsigned int Timer_getTimeMicros        (void);
+uint64_t     Timer_getTimeMicros64      (void);
+// soft timers
+void         Timer_initializeSoftTimer  (SoftTimer* timer, SoftTimerCallback callback, void* context);
+void         Timer_startSoftTimer       (SoftTimer* timer, unsigned int timeoutMillis,
+                                         unsigned int periodMillis);
+void         Timer_startSoftTimerMicros (SoftTimer* timer, uint32_t timeoutMicros,
+                                         uint32_t periodMicros);
+void         Timer_cancelSoftTimer      (SoftTimer* timer);
+Boolean      Timer_isSoftTimerActive    (SoftTimer* timer);
+unsigned int Timer_getSoftTimerRemaining(SoftTimer* timer);
+// soft timers identified by ID (taken from a small pool)
 int          Timer_addSoftwareTimer     (unsigned int overflowValue, void (*overflowCb)(void));
+void         Timer_deleteSoftwareTimer  (int id);
+void         Timer_startSoftwareTimer   (int id);
+void         Timer_pauseSoftwareTimer   (int id);
+void         Timer_resumeSoftwareTimer  (int id);
 /**
  * @}
  */
@@ -18,6 +18,7 @@
 
 #include "tsc2046_hal.h"
 #include "common_hal.h"
+#include "irq_monitor.h"
 
 static void (*penirqCallback)(void); ///< PENIRQ interrupt callback function
 
@@ -70,6 +71,7 @@ void TSC2046_HAL_DisablePenirq(void) {
  * @brief Handler for PENIRQ interrupt.
  */
 void EXTI2_IRQHandler(void) {
+  IRQ_MONITOR(exti2);
   HAL_GPIO_EXTI_IRQHandler(PENIRQ_PIN);
 }
 /**
@@ -15,21 +15,19 @@
  * @endverbatim
  */
 #include "tsc2046.h"
-#include "spi_hal.h"
+#include "spi_bus.h"
 #include "tsc2046_hal.h"
 #include "utils.h"
-#include "timers.h"
+#include "coroutine.h"
 #include <stdio.h>
 
-#define DEBUG
-
-#ifdef DEBUG
-#define print(str, args...) printf(""str"%s",##args,"")
-#define println(str, args...) printf("TSC--> "str"%s",##args,"\r\n")
-#else
-#define print(str, args...) (void)0
-#define println(str, args...) (void)0
+#ifndef TSC2046_LOG_LEVEL
+  #define TSC2046_LOG_LEVEL LOG_LEVEL_DEBUG ///< Log level of this module
 #endif
+#define LOG_MODULE_LEVEL TSC2046_LOG_LEVEL
+#include "log.h"
+
+#define println(str, args...) LOG_DEBUG("TSC--> "str, ##args)
 
 /**
  * @addtogroup TSC2046
@@ -91,11 +89,27 @@ typedef struct {
   uint16_t height;  ///< Height of event region
 } TSC2046_EventTypedef;
 
+/**
+ * @brief The touchscreen controller on the SPI bus (clock up to 2.5 MHz)
+ */
+static SpiDevice tsc2046Device = {
+  .spi            = TSC2046_SPI,
+  .chipSelect     = {SPI_HAL_PORT_A, 15},
+  .configuration  = {
+    .prescaler          = SPI_HAL_PRESCALER_64,
+    .mode               = SPI_HAL_MODE0,
+    .frameSize          = SPI_HAL_FRAME_8BIT,
+  },
+};
+
 static TSC2046_EventTypedef registeredEvents[MAX_EVENTS]; ///< Registered events
 static int numberOfRegisteredEvents;      ///< Number of registered events
 static volatile Boolean wasTouchDetected; ///< Was touch detected in IRQ
+static void (*touchCallback)(void);       ///< Called from PENIRQ IRQ
+static Coroutine touchCoroutine;          ///< State of touch handling
 
 static void touchInterruptCallback(void);
+static CoroutineState handleTouch(Coroutine* coroutine);
 static void readTouchPosition(int *x, int *y);
 
 /**
@@ -108,7 +122,7 @@ void TSC2046_Initialize(void) {
   const int POSITION_HIGH_BYTE = 1;
   const int POSITION_LOW_BYTE = 2;
 
-  SpiHal_initialize(SPI_HAL_SPI3);
+  SpiBus_addDevice(&tsc2046Device);
   TSC2046_HAL_PenirqInit(touchInterruptCallback);
 
   // send first commands
@@ -125,9 +139,12 @@ void TSC2046_Initialize(void) {
   txBuffer[POSITION_HIGH_BYTE] = 0;
   txBuffer[POSITION_LOW_BYTE] = 0;
 
-  SpiHal_select(SPI_HAL_SPI3);
-  SpiHal_sendBuffer(SPI_HAL_SPI3, txBuffer, TOUCHSCREEN_COMMAND_LENGTH);
-  SpiHal_deselect(SPI_HAL_SPI3);
+  SpiTransaction transaction = {
+    .device         = &tsc2046Device,
+    .transmitBuffer = txBuffer,
+    .dataLength     = TOUCHSCREEN_COMMAND_LENGTH,
+  };
+  SpiBus_transfer(&transaction);
 }
 /**
  * @brief Registers a given region of the touch screen
@@ -158,70 +175,59 @@ int TSC2046_RegisterEvent(int x, int y, int width, int height,
   numberOfRegisteredEvents++;
   return numberOfRegisteredEvents;
 }
+/**
+ * @brief Sets the function called when the screen is touched
+ * @details The callback runs in the PENIRQ IRQ - it can wake up the code
+ * calling TSC2046_Update (e.g. Scheduler_post), so it doesn't have to poll
+ * while the screen isn't touched.
+ * @param touchCb Touch callback (NULL - none)
+ */
+void TSC2046_SetTouchCallback(void (*touchCb)(void)) {
+  touchCallback = touchCb;
+}
 /**
  * @brief Handler for touch screen actions.
  * @details Call this function regularly in main to handle
- * touch screen events.
+ * touch screen events. With a touch callback it only has to be called
+ * after the callback and then as long as it returns TRUE (every few ms).
+ * @retval TRUE Touch is being handled (debouncing) - call again
+ * @retval FALSE Waiting for touch
  */
-void TSC2046_Update(void) {
-
-  const int DEBOUNCE_TIME = 20;
-  const int WAIT_TIME = 100;
-
-  typedef enum {
-    WAITING_FOR_IRQ,
-    IRQ_RECEIVED,
-    WAIT_FOR_DEBOUNCE,
-    WAIT_FOR_NEXT_TOUCH,
-  } TouchStateTypedef;
-
-  static int debounce;
-  static TouchStateTypedef touchState = WAITING_FOR_IRQ;
-
-  switch (touchState) {
-
-  case WAITING_FOR_IRQ:
-    if (wasTouchDetected) {
-      touchState = IRQ_RECEIVED;
-    }
-    break;
-
-  case IRQ_RECEIVED:
-    debounce = Timer_getTimeMillis();
-    touchState = WAIT_FOR_DEBOUNCE;
-    break;
-
-  case WAIT_FOR_DEBOUNCE:
-    if (Timer_delayTimer(DEBOUNCE_TIME, debounce)) {
-      int x, y;
-      touchState = WAIT_FOR_NEXT_TOUCH;
-      debounce = Timer_getTimeMillis();
-      // still down?
-      if (!TSC2046_HAL_ReadPenirq()) {
-
-        readTouchPosition(&x, &y);
-
-        for (int i = 0; i < numberOfRegisteredEvents; i++) {
-          if ((x > registeredEvents[i].x) && (x <= registeredEvents[i].width +
-              registeredEvents[i].x) && (y > registeredEvents[i].y) &&
-              (y <= registeredEvents[i].height + registeredEvents[i].y)) {
-            if (registeredEvents[i].eventCb) {
-              registeredEvents[i].eventCb(x, y);
-            }
-          }
+Boolean TSC2046_Update(void) {
+  if (!wasTouchDetected) {
+    return FALSE;
+  }
+  return handleTouch(&touchCoroutine) == COROUTINE_RUNNING ? TRUE : FALSE;
+}
+/**
+ * @brief Debounces a touch and calls the events of the touched region
+ * @param coroutine Coroutine state
+ * @return COROUTINE_FINISHED when ready for next touch
+ */
+CoroutineState handleTouch(Coroutine* coroutine) {
+  const int DEBOUNCE_TIME_MILLIS = 20;
+  const int WAIT_TIME_MILLIS = 100;
+
+  COROUTINE_BEGIN(coroutine);
+  COROUTINE_AWAIT_DELAY(coroutine, DEBOUNCE_TIME_MILLIS);
+  // still down?
+  if (!TSC2046_HAL_ReadPenirq()) {
+    int x, y;
+    readTouchPosition(&x, &y);
+
+    for (int i = 0; i < numberOfRegisteredEvents; i++) {
+      if ((x > registeredEvents[i].x) && (x <= registeredEvents[i].width +
+          registeredEvents[i].x) && (y > registeredEvents[i].y) &&
+          (y <= registeredEvents[i].height + registeredEvents[i].y)) {
+        if (registeredEvents[i].eventCb) {
+          registeredEvents[i].eventCb(x, y);
         }
       }
     }
-    break;
-
-  case WAIT_FOR_NEXT_TOUCH:
-    if (Timer_delayTimer(WAIT_TIME, debounce)) {
-      touchState = WAITING_FOR_IRQ;
-      wasTouchDetected = FALSE;
-    }
-    break;
   }
-
+  COROUTINE_AWAIT_DELAY(coroutine, WAIT_TIME_MILLIS);
+  wasTouchDetected = FALSE;
+  COROUTINE_END(coroutine);
 }
 /**
  * @brief Read X and Y position on touch screen.
@@ -230,14 +236,12 @@ void TSC2046_Update(void) {
  */
 void readTouchPosition(int *x, int *y) {
 
-  const int TOUCHSCREEN_COMMAND_LENGTH = 3;
-  const int POSITION_COMMAND = 0;
-  const int POSITION_HIGH_BYTE = 1;
-  const int POSITION_LOW_BYTE = 2;
+  const int RESULT_LENGTH = 2;
+  const int POSITION_HIGH_BYTE = 0;
+  const int POSITION_LOW_BYTE = 1;
   const int TOUCH_BIT_SHIFT = 3;
 
   TSC2046_HAL_DisablePenirq(); // disable IRQ during read
-  SpiHal_select(SPI_HAL_SPI3);
 
   // control byte
   ControlByteTypedef ctrl;
@@ -246,24 +250,28 @@ void readTouchPosition(int *x, int *y) {
   ctrl.bits.mode          = MODE_12BIT;
   ctrl.bits.powerDown     = PD_POWER_DOWN;
 
+  // control byte is the command phase, the result is clocked out with zeros
+  uint8_t rxBuffer[RESULT_LENGTH];
+  uint8_t txBuffer[] = {0, 0};
+  SpiTransaction transaction = {
+    .device         = &tsc2046Device,
+    .commandBuffer  = &ctrl.byte,
+    .commandLength  = 1,
+    .transmitBuffer = txBuffer,
+    .receiveBuffer  = rxBuffer,
+    .dataLength     = RESULT_LENGTH,
+  };
+
   // read Y
   ctrl.bits.channelSelect = MEASURE_Y;
-  uint8_t rxBuffer[TOUCHSCREEN_COMMAND_LENGTH];
-  uint8_t txBuffer[TOUCHSCREEN_COMMAND_LENGTH];
-  txBuffer[POSITION_COMMAND] = ctrl.byte;
-  txBuffer[POSITION_HIGH_BYTE] = 0;
-  txBuffer[POSITION_LOW_BYTE] = 0;
-  SpiHal_transmitBuffer(SPI_HAL_SPI3, rxBuffer, txBuffer,
-      TOUCHSCREEN_COMMAND_LENGTH);
+  SpiBus_transfer(&transaction);
 
   int tmpY = ((int)rxBuffer[POSITION_HIGH_BYTE])<<8;
   tmpY |= rxBuffer[POSITION_LOW_BYTE];
 
   // read X
   ctrl.bits.channelSelect = MEASURE_X;
-  txBuffer[POSITION_COMMAND] = ctrl.byte;
-  SpiHal_transmitBuffer(SPI_HAL_SPI3, rxBuffer, txBuffer,
-      TOUCHSCREEN_COMMAND_LENGTH);
+  SpiBus_transfer(&transaction);
 
   int tmpX = ((int)rxBuffer[POSITION_HIGH_BYTE])<<8;
   tmpX |= rxBuffer[POSITION_LOW_BYTE];
@@ -273,7 +281,6 @@ void readTouchPosition(int *x, int *y) {
 
   println("Touch position: x = %d y = %d", *x, *y);
 
-  SpiHal_deselect(SPI_HAL_SPI3);
   TSC2046_HAL_EnablePenirq();
 }
 /**
@@ -283,6 +290,9 @@ void readTouchPosition(int *x, int *y) {
  */
 void touchInterruptCallback(void) {
   wasTouchDetected = TRUE;
+  if (touchCallback) {
+    touchCallback();
+  }
 }
 /**
  * @}
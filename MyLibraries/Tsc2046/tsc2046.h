@@ -18,6 +18,7 @@
 #define INC_TSC2046_H_
 
 #include <inttypes.h>
+#include "utils.h"
 
 /**
  * @defgroup  TSC2046 TSC2046
@@ -28,10 +29,11 @@
  * @addtogroup TSC2046
  * @{
  */
-void  TSC2046_Initialize    (void);
-void  TSC2046_Update        (void);
-int   TSC2046_RegisterEvent (int x, int y, int width, int height,
-        void (*eventCb)(int x, int y));
+void    TSC2046_Initialize        (void);
+Boolean TSC2046_Update            (void);
+int     TSC2046_RegisterEvent     (int x, int y, int width, int height,
+          void (*eventCb)(int x, int y));
+void    TSC2046_SetTouchCallback  (void (*touchCb)(void));
 /**
  * @}
  */
@@ -0,0 +1,180 @@
+/**
+ * @file    usb_mass_storage.c
+ * @brief   USB mass storage device backed by a block device
+ * @details The MSC class splits every SCSI READ(10)/WRITE(10) into chunks
+ * of MSC_MEDIA_PACKET bytes and passes each chunk to the storage functions
+ * below. A chunk is forwarded to the block device as one request, so for the
+ * SD card it becomes one multi block read (CMD18) or write (CMD25) instead of
+ * a single block command per sector.
+ *
+ * The library calls the storage functions from the USB IRQ, but the SD
+ * card waits for the shared SPI bus, which must not happen in an IRQ. So the
+ * USB IRQ is deferred to UsbMassStorage_process and the whole SCSI handling
+ * runs in the main loop.
+ * @date    19.10.2026
+ * @author  Michal Ksiezopolski
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#ifdef USE_USB_DEVICE
+
+#include "usb_mass_storage.h"
+#include "usbd_core.h"
+#include "usbd_desc.h"
+#include "usbd_msc.h"
+
+/**
+ * @addtogroup USB_DEVICE
+ * @{
+ */
+
+#define NUMBER_OF_LOGICAL_UNITS   1 ///< One block device per USB device
+
+static int8_t initializeStorage   (uint8_t lun);
+static int8_t getCapacity         (uint8_t lun, uint32_t* blockCount, uint16_t* blockSize);
+static int8_t isReady             (uint8_t lun);
+static int8_t isWriteProtected    (uint8_t lun);
+static int8_t readStorage         (uint8_t lun, uint8_t* buffer, uint32_t block, uint16_t count);
+static int8_t writeStorage        (uint8_t lun, uint8_t* buffer, uint32_t block, uint16_t count);
+static int8_t getMaxLogicalUnit   (void);
+
+/**
+ * @brief Standard inquiry data of the logical unit
+ */
+static int8_t inquiryData[STANDARD_INQUIRY_DATA_LEN] = {
+  0x00,                                   // direct access device
+  0x80,                                   // removable medium
+  0x02,                                   // SPC-2
+  0x02,                                   // response data format
+  (STANDARD_INQUIRY_DATA_LEN - 5),        // additional length
+  0x00,
+  0x00,
+  0x00,
+  'S', 'T', 'M', '3', '2', ' ', ' ', ' ', // vendor: 8 bytes
+  'S', 'D', ' ', 'C', 'a', 'r', 'd', ' ', // product: 16 bytes
+  ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ',
+  '1', '.', '0', '0',                     // revision: 4 bytes
+};
+
+static USBD_StorageTypeDef storageOperations = {
+  initializeStorage,
+  getCapacity,
+  isReady,
+  isWriteProtected,
+  readStorage,
+  writeStorage,
+  getMaxLogicalUnit,
+  inquiryData,
+};
+
+static USBD_HandleTypeDef usbDevice;        ///< USB device handle
+static BlockDevice* storageDevice;          ///< Device exposed to the host
+static Boolean isStorageWriteProtected;     ///< Is the host allowed to write
+static volatile Boolean isTransferActive;   ///< Is the host accessing the storage
+
+/**
+ * @brief Starts the USB mass storage device
+ * @param device Initialized block device to expose to the host
+ */
+void UsbMassStorage_initialize(BlockDevice* device) {
+  storageDevice = device;
+
+  UsbDevice_deferIrq(TRUE);
+  USBD_Init(&usbDevice, UsbDescriptors_initialize(USB_DEVICE_PRODUCT_ID_MASS_STORAGE,
+      "STM32 Mass Storage"), 0);
+  USBD_RegisterClass(&usbDevice, USBD_MSC_CLASS);
+  USBD_MSC_RegisterStorage(&usbDevice, &storageOperations);
+  USBD_Start(&usbDevice);
+}
+/**
+ * @brief Handles USB events and host requests, including the storage access
+ * @details Call from the main loop, not from an IRQ. The host waits until
+ * the next call, so call it often - long gaps only slow the transfers down.
+ */
+void UsbMassStorage_process(void) {
+  UsbDevice_processDeferredIrq();
+}
+/**
+ * @brief Sets write protection of the storage seen by the host
+ * @param isWriteProtected TRUE if the host may only read the storage
+ */
+void UsbMassStorage_setWriteProtect(Boolean isWriteProtected) {
+  isStorageWriteProtected = isWriteProtected;
+}
+/**
+ * @brief Checks if the host is currently reading or writing the storage
+ * @details The block device must not be used by the firmware (e.g. FAT)
+ * while the host owns it.
+ * @retval TRUE Transfer in progress
+ * @retval FALSE Storage idle
+ */
+Boolean UsbMassStorage_isBusy(void) {
+  return isTransferActive;
+}
+/**
+ * @brief Initializes the storage - the block device is initialized by the caller
+ */
+int8_t initializeStorage(uint8_t lun) {
+  return (storageDevice == NULL) ? -1 : 0;
+}
+/**
+ * @brief Returns the capacity of the storage
+ */
+int8_t getCapacity(uint8_t lun, uint32_t* blockCount, uint16_t* blockSize) {
+  BlockDeviceGeometry geometry;
+  BlockDevice_getGeometry(storageDevice, &geometry);
+  *blockCount = geometry.blockCount;
+  *blockSize = geometry.blockSize;
+  return 0;
+}
+/**
+ * @brief Checks if the storage is ready
+ */
+int8_t isReady(uint8_t lun) {
+  return (storageDevice == NULL) ? -1 : 0;
+}
+/**
+ * @brief Checks if the storage is write protected
+ */
+int8_t isWriteProtected(uint8_t lun) {
+  return isStorageWriteProtected ? -1 : 0;
+}
+/**
+ * @brief Reads a chunk of a SCSI READ(10) with a single block device request
+ */
+int8_t readStorage(uint8_t lun, uint8_t* buffer, uint32_t block, uint16_t count) {
+  isTransferActive = TRUE;
+  BlockDeviceResultCode result = BlockDevice_readBlocks(storageDevice, buffer, block, count);
+  isTransferActive = FALSE;
+  return (result == BLOCK_DEVICE_OK) ? 0 : -1;
+}
+/**
+ * @brief Writes a chunk of a SCSI WRITE(10) with a single block device request
+ */
+int8_t writeStorage(uint8_t lun, uint8_t* buffer, uint32_t block, uint16_t count) {
+  isTransferActive = TRUE;
+  BlockDeviceResultCode result = BlockDevice_writeBlocks(storageDevice, buffer, block, count);
+  isTransferActive = FALSE;
+  return (result == BLOCK_DEVICE_OK) ? 0 : -1;
+}
+/**
+ * @brief Returns the highest logical unit number
+ */
+int8_t getMaxLogicalUnit(void) {
+  return NUMBER_OF_LOGICAL_UNITS - 1;
+}
+
+/**
+ * @}
+ */
+
+#endif /* USE_USB_DEVICE */
@@ -0,0 +1,37 @@
+/**
+ * @file    usb_mass_storage.h
+ * @brief   USB mass storage device backed by a block device
+ * @date    19.10.2026
+ * @author  Michal Ksiezopolski
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#ifndef USB_MASS_STORAGE_H_
+#define USB_MASS_STORAGE_H_
+
+#include "block_device.h"
+
+/**
+ * @addtogroup USB_DEVICE
+ * @{
+ */
+
+void    UsbMassStorage_initialize     (BlockDevice* device);
+void    UsbMassStorage_process        (void);
+void    UsbMassStorage_setWriteProtect(Boolean isWriteProtected);
+Boolean UsbMassStorage_isBusy         (void);
+
+/**
+ * @}
+ */
+
+#endif /* USB_MASS_STORAGE_H_ */
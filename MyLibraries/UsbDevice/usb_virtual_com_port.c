@@ -0,0 +1,198 @@
+/**
+ * @file    usb_virtual_com_port.c
+ * @brief   USB CDC virtual COM port transport
+ * @details Works like the USART HAL: when the IN endpoint finishes a
+ * transfer the upper layer is asked for more data, and every OUT packet is
+ * passed up as a whole. Transfers are split into 64 byte bulk packets by
+ * the USB core, so the stream runs at USB full speed instead of the UART
+ * baud rate.
+ * @date    19.10.2026
+ * @author  Michal Ksiezopolski
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#ifdef USE_USB_DEVICE
+
+#include "usb_virtual_com_port.h"
+#include "usbd_core.h"
+#include "usbd_desc.h"
+#include "usbd_cdc.h"
+
+/**
+ * @addtogroup USB_DEVICE
+ * @{
+ */
+
+#define LINE_CODING_LENGTH  7 ///< Length of the CDC line coding structure
+
+static int8_t   initializeInterface   (void);
+static int8_t   deinitializeInterface (void);
+static int8_t   controlRequest        (uint8_t command, uint8_t* buffer, uint16_t length);
+static int8_t   receivePacket         (uint8_t* buffer, uint32_t* length);
+static uint8_t  dataInStage           (USBD_HandleTypeDef* pdev, uint8_t epnum);
+
+static USBD_CDC_ItfTypeDef interfaceOperations = {
+  initializeInterface,
+  deinitializeInterface,
+  controlRequest,
+  receivePacket,
+};
+
+static USBD_HandleTypeDef usbDevice;          ///< USB device handle
+static USBD_ClassTypeDef virtualComPortClass; ///< CDC class with transmit complete notification
+static uint8_t receiveBuffer[CDC_DATA_FS_OUT_PACKET_SIZE] __ALIGN_END; ///< OUT packet buffer
+/**
+ * @brief Line coding reported to the host (115200 8N1 - only informative)
+ */
+static uint8_t lineCoding[LINE_CODING_LENGTH] = {0x00, 0xc2, 0x01, 0x00, 0x00, 0x00, 0x08};
+static void* upperLayerContext;                                   ///< Upper layer object passed to the callbacks
+static void (*sendDataToUpperLayer)(void* context, const char* data, int length); ///< Receive callback
+static UsartTransmission (*getMoreDataToTransmit)(void* context); ///< Transmit callback
+static void (*transmissionComplete)(void* context, int transmittedLength); ///< Transmitted data release callback
+static volatile Boolean isSendingData;  ///< Is an IN transfer in progress
+static int lastTransferLength;          ///< Length of the last IN transfer
+
+/**
+ * @brief Starts the USB virtual COM port
+ * @param initialization Upper layer callbacks
+ */
+void UsbVirtualComPort_initialize(UsbVirtualComPortInitialization* initialization) {
+  upperLayerContext = initialization->context;
+  sendDataToUpperLayer = initialization->sendDataToUpperLayer;
+  getMoreDataToTransmit = initialization->getMoreDataToTransmit;
+  transmissionComplete = initialization->transmissionComplete;
+  isSendingData = FALSE;
+
+  // the stock class does not report finished IN transfers
+  virtualComPortClass = USBD_CDC;
+  virtualComPortClass.DataIn = dataInStage;
+
+  USBD_Init(&usbDevice, UsbDescriptors_initialize(USB_DEVICE_PRODUCT_ID_COM_PORT,
+      "STM32 Virtual COM Port"), 0);
+  USBD_RegisterClass(&usbDevice, &virtualComPortClass);
+  USBD_CDC_RegisterInterface(&usbDevice, &interfaceOperations);
+  USBD_Start(&usbDevice);
+}
+/**
+ * @brief Enables the USB IRQ
+ */
+void UsbVirtualComPort_enableIrq(void) {
+  HAL_NVIC_EnableIRQ(OTG_FS_IRQn);
+}
+/**
+ * @brief Disables the USB IRQ
+ */
+void UsbVirtualComPort_disableIrq(void) {
+  HAL_NVIC_DisableIRQ(OTG_FS_IRQn);
+}
+/**
+ * @brief Checks if an IN transfer is in progress
+ * @retval TRUE Transfer in progress, the IRQ will get new data by itself
+ * @retval FALSE No transfer, UsbVirtualComPort_sendDataIrq has to be called
+ */
+Boolean UsbVirtualComPort_isSendingData(void) {
+  return isSendingData;
+}
+/**
+ * @brief Sends data from the upper layer
+ * @details Called from the IN transfer complete IRQ and by the upper layer to
+ * start transmission. Data stays in the upper layer buffer until the host
+ * configures the device.
+ */
+void UsbVirtualComPort_sendDataIrq(void) {
+  if (usbDevice.dev_state != USBD_STATE_CONFIGURED || getMoreDataToTransmit == NULL) {
+    isSendingData = FALSE;
+    return;
+  }
+  UsartTransmission transmission = getMoreDataToTransmit(upperLayerContext);
+  if (transmission.bufferLength > 0) {
+    isSendingData = TRUE;
+    lastTransferLength = transmission.bufferLength;
+    USBD_CDC_SetTxBuffer(&usbDevice, (uint8_t*)transmission.transmitBuffer,
+        transmission.bufferLength);
+    USBD_CDC_TransmitPacket(&usbDevice);
+  } else {
+    isSendingData = FALSE;
+  }
+}
+/**
+ * @brief IN transfer complete
+ * @details A transfer which is a multiple of the packet size has to be
+ * terminated with a zero length packet, otherwise the host keeps waiting
+ * for the rest of it.
+ */
+uint8_t dataInStage(USBD_HandleTypeDef* pdev, uint8_t epnum) {
+  USBD_CDC.DataIn(pdev, epnum);
+
+  // the data was read by the USB core - the upper layer may reuse the buffer
+  if (lastTransferLength > 0 && transmissionComplete != NULL) {
+    transmissionComplete(upperLayerContext, lastTransferLength);
+  }
+
+  if (lastTransferLength > 0 && (lastTransferLength % CDC_DATA_FS_IN_PACKET_SIZE) == 0) {
+    lastTransferLength = 0;
+    USBD_CDC_SetTxBuffer(pdev, NULL, 0);
+    USBD_CDC_TransmitPacket(pdev);
+    return USBD_OK;
+  }
+  UsbVirtualComPort_sendDataIrq();
+  return USBD_OK;
+}
+/**
+ * @brief Class initialized - host configured the device
+ */
+int8_t initializeInterface(void) {
+  USBD_CDC_SetRxBuffer(&usbDevice, receiveBuffer);
+  isSendingData = FALSE;
+  return USBD_OK;
+}
+/**
+ * @brief Class deinitialized - device disconnected or reset
+ */
+int8_t deinitializeInterface(void) {
+  isSendingData = FALSE;
+  return USBD_OK;
+}
+/**
+ * @brief Handles CDC class requests
+ * @details The line coding has no effect on USB, it is only stored so that
+ * terminal programs can read it back.
+ */
+int8_t controlRequest(uint8_t command, uint8_t* buffer, uint16_t length) {
+  switch (command) {
+  case CDC_SET_LINE_CODING:
+    memcpy(lineCoding, buffer, LINE_CODING_LENGTH);
+    break;
+  case CDC_GET_LINE_CODING:
+    memcpy(buffer, lineCoding, LINE_CODING_LENGTH);
+    break;
+  default:
+    break;
+  }
+  return USBD_OK;
+}
+/**
+ * @brief OUT packet received - passes all of it up and rearms the endpoint
+ */
+int8_t receivePacket(uint8_t* buffer, uint32_t* length) {
+  if (sendDataToUpperLayer != NULL) {
+    sendDataToUpperLayer(upperLayerContext, (const char*)buffer, (int)*length);
+  }
+  USBD_CDC_ReceivePacket(&usbDevice);
+  return USBD_OK;
+}
+
+/**
+ * @}
+ */
+
+#endif /* USE_USB_DEVICE */
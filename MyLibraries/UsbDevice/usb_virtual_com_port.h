@@ -0,0 +1,51 @@
+/**
+ * @file    usb_virtual_com_port.h
+ * @brief   USB CDC virtual COM port transport
+ * @date    19.10.2026
+ * @author  Michal Ksiezopolski
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#ifndef USB_VIRTUAL_COM_PORT_H_
+#define USB_VIRTUAL_COM_PORT_H_
+
+#include "usart.h"
+#include "utils.h"
+
+/**
+ * @addtogroup USB_DEVICE
+ * @{
+ */
+
+/**
+ * @brief Virtual COM port initialization structure
+ * @details The transmit side uses the same callback as the USART HAL so the
+ * serial port can use both transports.
+ */
+typedef struct {
+  void* context;                                             ///< Upper layer object passed to the callbacks
+  void (*sendDataToUpperLayer)(void* context, const char* data, int length); ///< Function for sending a received packet to upper layer
+  UsartTransmission (*getMoreDataToTransmit)(void* context); ///< Function for getting more data to transmit
+  void (*transmissionComplete)(void* context, int transmittedLength); ///< Function for releasing transmitted data (may be NULL)
+} UsbVirtualComPortInitialization;
+
+void    UsbVirtualComPort_initialize    (UsbVirtualComPortInitialization* initialization);
+void    UsbVirtualComPort_enableIrq     (void);
+void    UsbVirtualComPort_disableIrq    (void);
+Boolean UsbVirtualComPort_isSendingData (void);
+void    UsbVirtualComPort_sendDataIrq   (void);
+
+/**
+ * @}
+ */
+
+#endif /* USB_VIRTUAL_COM_PORT_H_ */
@@ -0,0 +1,273 @@
+/**
+ * @file    usbd_conf.c
+ * @brief   Low level driver of the STM32 USB device library (USB OTG FS)
+ * @date    19.10.2026
+ * @author  Michal Ksiezopolski
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#ifdef USE_USB_DEVICE
+
+#include "usbd_core.h"
+#include "usbd_msc.h"
+#include "usbd_cdc.h"
+#include "common_hal.h"
+#include "utils.h"
+
+/**
+ * @defgroup USB_DEVICE USB device
+ * @brief Low level glue between the STM32 USB device library and the HAL PCD driver
+ * @{
+ */
+
+#define USB_OTG_FS_IRQ_PRIORITY   6 ///< Above the USARTs
+
+/**
+ * @brief Data of the supported classes
+ */
+typedef union {
+  USBD_MSC_BOT_HandleTypeDef massStorage;
+  USBD_CDC_HandleTypeDef virtualComPort;
+} ClassData;
+
+/**
+ * @brief Memory for the class data
+ * @details The device library allocates the data of the active class on
+ * configuration. Only one class is active at a time so one static block sized
+ * for the biggest class replaces the heap.
+ */
+static uint32_t classDataMemory[(sizeof(ClassData) / sizeof(uint32_t)) + 1];
+static Boolean isClassDataAllocated; ///< Is the class data block in use
+
+static PCD_HandleTypeDef pcdHandle;  ///< Handle of the USB OTG FS peripheral
+static Boolean isIrqDeferred;        ///< Is the IRQ handled in UsbDevice_processDeferredIrq
+static volatile Boolean isIrqPending; ///< Did the IRQ occur since the last processing
+
+/**
+ * @brief Allocates the class data block
+ * @param size Requested size
+ * @return Class data block or NULL if too small or taken
+ */
+void* UsbDevice_staticMalloc(size_t size) {
+  if (size > sizeof(classDataMemory) || isClassDataAllocated) {
+    return NULL;
+  }
+  isClassDataAllocated = TRUE;
+  return classDataMemory;
+}
+/**
+ * @brief Frees the class data block
+ * @param memory Block returned by UsbDevice_staticMalloc
+ */
+void UsbDevice_staticFree(void* memory) {
+  if (memory == classDataMemory) {
+    isClassDataAllocated = FALSE;
+  }
+}
+/**
+ * @brief Moves handling of the USB IRQ to UsbDevice_processDeferredIrq
+ * @details The IRQ only masks itself, so all class callbacks (e.g. the
+ * storage access of the MSC class) run in the main loop, where they can
+ * wait for a shared bus. The host is answered with NAKs meanwhile.
+ * @param isDeferred TRUE to defer the IRQ, FALSE to handle it immediately
+ */
+void UsbDevice_deferIrq(Boolean isDeferred) {
+  isIrqDeferred = isDeferred;
+}
+/**
+ * @brief Handles the USB IRQ deferred by UsbDevice_deferIrq
+ * @details Call from the main loop. The IRQ flags stay set until handled,
+ * so events which occurred meanwhile trigger the IRQ again after unmasking.
+ */
+void UsbDevice_processDeferredIrq(void) {
+  if (!isIrqPending) {
+    return;
+  }
+  isIrqPending = FALSE;
+  HAL_PCD_IRQHandler(&pcdHandle);
+  HAL_NVIC_EnableIRQ(OTG_FS_IRQn);
+}
+// ********************** HAL PCD callbacks and IRQs **********************
+/**
+ * @brief Initializes pins and clock of USB OTG FS
+ * @param hpcd PCD handle
+ */
+void HAL_PCD_MspInit(PCD_HandleTypeDef* hpcd) {
+  GPIO_InitTypeDef gpioInitialization;
+
+  __HAL_RCC_GPIOA_CLK_ENABLE();
+  // D- and D+
+  gpioInitialization.Pin        = GPIO_PIN_11 | GPIO_PIN_12;
+  gpioInitialization.Mode       = GPIO_MODE_AF_PP;
+  gpioInitialization.Pull       = GPIO_NOPULL;
+  gpioInitialization.Speed      = GPIO_SPEED_FREQ_VERY_HIGH;
+  gpioInitialization.Alternate  = GPIO_AF10_OTG_FS;
+  HAL_GPIO_Init(GPIOA, &gpioInitialization);
+
+  __HAL_RCC_USB_OTG_FS_CLK_ENABLE();
+
+  HAL_NVIC_SetPriority(OTG_FS_IRQn, USB_OTG_FS_IRQ_PRIORITY, 0);
+  HAL_NVIC_EnableIRQ(OTG_FS_IRQn);
+}
+/**
+ * @brief Deinitializes USB OTG FS
+ * @param hpcd PCD handle
+ */
+void HAL_PCD_MspDeInit(PCD_HandleTypeDef* hpcd) {
+  __HAL_RCC_USB_OTG_FS_CLK_DISABLE();
+  HAL_GPIO_DeInit(GPIOA, GPIO_PIN_11 | GPIO_PIN_12);
+  HAL_NVIC_DisableIRQ(OTG_FS_IRQn);
+}
+void HAL_PCD_SetupStageCallback(PCD_HandleTypeDef* hpcd) {
+  USBD_LL_SetupStage(hpcd->pData, (uint8_t*)hpcd->Setup);
+}
+void HAL_PCD_DataOutStageCallback(PCD_HandleTypeDef* hpcd, uint8_t epnum) {
+  USBD_LL_DataOutStage(hpcd->pData, epnum, hpcd->OUT_ep[epnum].xfer_buff);
+}
+void HAL_PCD_DataInStageCallback(PCD_HandleTypeDef* hpcd, uint8_t epnum) {
+  USBD_LL_DataInStage(hpcd->pData, epnum, hpcd->IN_ep[epnum].xfer_buff);
+}
+void HAL_PCD_SOFCallback(PCD_HandleTypeDef* hpcd) {
+  USBD_LL_SOF(hpcd->pData);
+}
+void HAL_PCD_ResetCallback(PCD_HandleTypeDef* hpcd) {
+  USBD_LL_SetSpeed(hpcd->pData, USBD_SPEED_FULL);
+  USBD_LL_Reset(hpcd->pData);
+}
+void HAL_PCD_SuspendCallback(PCD_HandleTypeDef* hpcd) {
+  USBD_LL_Suspend(hpcd->pData);
+}
+void HAL_PCD_ResumeCallback(PCD_HandleTypeDef* hpcd) {
+  USBD_LL_Resume(hpcd->pData);
+}
+void HAL_PCD_ISOOUTIncompleteCallback(PCD_HandleTypeDef* hpcd, uint8_t epnum) {
+  USBD_LL_IsoOUTIncomplete(hpcd->pData, epnum);
+}
+void HAL_PCD_ISOINIncompleteCallback(PCD_HandleTypeDef* hpcd, uint8_t epnum) {
+  USBD_LL_IsoINIncomplete(hpcd->pData, epnum);
+}
+void HAL_PCD_ConnectCallback(PCD_HandleTypeDef* hpcd) {
+  USBD_LL_DevConnected(hpcd->pData);
+}
+void HAL_PCD_DisconnectCallback(PCD_HandleTypeDef* hpcd) {
+  USBD_LL_DevDisconnected(hpcd->pData);
+}
+/**
+ * @brief IRQ handler of USB OTG FS
+ */
+void OTG_FS_IRQHandler(void) {
+  if (isIrqDeferred) {
+    HAL_NVIC_DisableIRQ(OTG_FS_IRQn);
+    isIrqPending = TRUE;
+    return;
+  }
+  HAL_PCD_IRQHandler(&pcdHandle);
+}
+// ********************** USB device library low level driver **********************
+/**
+ * @brief Initializes the low level driver
+ * @param pdev Device handle
+ * @return USBD_OK
+ */
+USBD_StatusTypeDef USBD_LL_Init(USBD_HandleTypeDef* pdev) {
+  pcdHandle.Instance                  = USB_OTG_FS;
+  pcdHandle.Init.dev_endpoints        = 4;
+  pcdHandle.Init.speed                = PCD_SPEED_FULL;
+  pcdHandle.Init.dma_enable           = DISABLE;
+  pcdHandle.Init.ep0_mps              = DEP0CTL_MPS_64;
+  pcdHandle.Init.phy_itface           = PCD_PHY_EMBEDDED;
+  pcdHandle.Init.Sof_enable           = DISABLE;
+  pcdHandle.Init.low_power_enable     = DISABLE;
+  pcdHandle.Init.lpm_enable           = DISABLE;
+  pcdHandle.Init.vbus_sensing_enable  = DISABLE;
+  pcdHandle.Init.use_dedicated_ep1    = DISABLE;
+
+  pcdHandle.pData = pdev;
+  pdev->pData = &pcdHandle;
+
+  if (HAL_PCD_Init(&pcdHandle) != HAL_OK) {
+    CommonHal_errorHandler();
+  }
+  // 1.25 kB FIFO in words: RX, EP0 TX and two TX FIFOs for the class endpoints
+  HAL_PCDEx_SetRxFiFo(&pcdHandle, 0x80);
+  HAL_PCDEx_SetTxFiFo(&pcdHandle, 0, 0x40);
+  HAL_PCDEx_SetTxFiFo(&pcdHandle, 1, 0x80);
+  HAL_PCDEx_SetTxFiFo(&pcdHandle, 2, 0x20);
+
+  return USBD_OK;
+}
+USBD_StatusTypeDef USBD_LL_DeInit(USBD_HandleTypeDef* pdev) {
+  HAL_PCD_DeInit(pdev->pData);
+  return USBD_OK;
+}
+USBD_StatusTypeDef USBD_LL_Start(USBD_HandleTypeDef* pdev) {
+  HAL_PCD_Start(pdev->pData);
+  return USBD_OK;
+}
+USBD_StatusTypeDef USBD_LL_Stop(USBD_HandleTypeDef* pdev) {
+  HAL_PCD_Stop(pdev->pData);
+  return USBD_OK;
+}
+USBD_StatusTypeDef USBD_LL_OpenEP(USBD_HandleTypeDef* pdev, uint8_t ep_addr,
+    uint8_t ep_type, uint16_t ep_mps) {
+  HAL_PCD_EP_Open(pdev->pData, ep_addr, ep_mps, ep_type);
+  return USBD_OK;
+}
+USBD_StatusTypeDef USBD_LL_CloseEP(USBD_HandleTypeDef* pdev, uint8_t ep_addr) {
+  HAL_PCD_EP_Close(pdev->pData, ep_addr);
+  return USBD_OK;
+}
+USBD_StatusTypeDef USBD_LL_FlushEP(USBD_HandleTypeDef* pdev, uint8_t ep_addr) {
+  HAL_PCD_EP_Flush(pdev->pData, ep_addr);
+  return USBD_OK;
+}
+USBD_StatusTypeDef USBD_LL_StallEP(USBD_HandleTypeDef* pdev, uint8_t ep_addr) {
+  HAL_PCD_EP_SetStall(pdev->pData, ep_addr);
+  return USBD_OK;
+}
+USBD_StatusTypeDef USBD_LL_ClearStallEP(USBD_HandleTypeDef* pdev, uint8_t ep_addr) {
+  HAL_PCD_EP_ClrStall(pdev->pData, ep_addr);
+  return USBD_OK;
+}
+uint8_t USBD_LL_IsStallEP(USBD_HandleTypeDef* pdev, uint8_t ep_addr) {
+  PCD_HandleTypeDef* hpcd = pdev->pData;
+  if ((ep_addr & 0x80) == 0x80) {
+    return hpcd->IN_ep[ep_addr & 0x7f].is_stall;
+  }
+  return hpcd->OUT_ep[ep_addr & 0x7f].is_stall;
+}
+USBD_StatusTypeDef USBD_LL_SetUSBAddress(USBD_HandleTypeDef* pdev, uint8_t dev_addr) {
+  HAL_PCD_SetAddress(pdev->pData, dev_addr);
+  return USBD_OK;
+}
+USBD_StatusTypeDef USBD_LL_Transmit(USBD_HandleTypeDef* pdev, uint8_t ep_addr,
+    uint8_t* pbuf, uint16_t size) {
+  HAL_PCD_EP_Transmit(pdev->pData, ep_addr, pbuf, size);
+  return USBD_OK;
+}
+USBD_StatusTypeDef USBD_LL_PrepareReceive(USBD_HandleTypeDef* pdev, uint8_t ep_addr,
+    uint8_t* pbuf, uint16_t size) {
+  HAL_PCD_EP_Receive(pdev->pData, ep_addr, pbuf, size);
+  return USBD_OK;
+}
+uint32_t USBD_LL_GetRxDataSize(USBD_HandleTypeDef* pdev, uint8_t ep_addr) {
+  return HAL_PCD_EP_GetRxCount(pdev->pData, ep_addr);
+}
+void USBD_LL_Delay(uint32_t delay) {
+  HAL_Delay(delay);
+}
+
+/**
+ * @}
+ */
+
+#endif /* USE_USB_DEVICE */
@@ -0,0 +1,66 @@
+/**
+ * @file    usbd_conf.h
+ * @brief   Configuration of the STM32 USB device library
+ * @date    19.10.2026
+ * @author  Michal Ksiezopolski
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#ifndef USBD_CONF_H_
+#define USBD_CONF_H_
+
+#include <stdlib.h>
+#include <string.h>
+#include "boards.h"
+#include "utils.h"
+
+/**
+ * @addtogroup USB_DEVICE
+ * @{
+ */
+
+#define USBD_MAX_NUM_INTERFACES       1
+#define USBD_MAX_NUM_CONFIGURATION    1
+#define USBD_MAX_STR_DESC_SIZ         0x100
+#define USBD_SUPPORT_USER_STRING      0
+#define USBD_SELF_POWERED             1
+#define USBD_DEBUG_LEVEL              0
+
+/**
+ * @brief Size of the mass storage media packet in bytes
+ * @details The MSC class hands the storage driver at most this many bytes
+ * of a SCSI READ(10)/WRITE(10) per call. With 16 kB one call carries up to 32
+ * sectors, so the SD card sees a single multi block command (CMD18/CMD25)
+ * instead of one command per 512 byte sector.
+ */
+#define MSC_MEDIA_PACKET              16384
+
+#define USBD_malloc                   UsbDevice_staticMalloc
+#define USBD_free                     UsbDevice_staticFree
+#define USBD_memset                   memset
+#define USBD_memcpy                   memcpy
+#define USBD_Delay                    HAL_Delay
+
+#define USBD_UsrLog(...)              (void)0
+#define USBD_ErrLog(...)              (void)0
+#define USBD_DbgLog(...)              (void)0
+
+void* UsbDevice_staticMalloc        (size_t size);
+void  UsbDevice_staticFree          (void* memory);
+void  UsbDevice_deferIrq            (Boolean isDeferred);
+void  UsbDevice_processDeferredIrq  (void);
+
+/**
+ * @}
+ */
+
+#endif /* USBD_CONF_H_ */
@@ -0,0 +1,165 @@
+/**
+ * @file    usbd_desc.c
+ * @brief   USB device descriptors
+ * @date    19.10.2026
+ * @author  Michal Ksiezopolski
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#ifdef USE_USB_DEVICE
+
+#include "usbd_desc.h"
+#include "usbd_core.h"
+
+/**
+ * @addtogroup USB_DEVICE
+ * @{
+ */
+
+#define LANGUAGE_ID_STRING        0x0409 ///< English (United States)
+#define MANUFACTURER_STRING       "Michal Ksiezopolski"
+#define CONFIGURATION_STRING      "Configuration"
+#define INTERFACE_STRING          "Interface"
+#define SERIAL_NUMBER_LENGTH      24     ///< Unique ID (96 bits) as hex string
+
+#ifdef BOARD_STM32F4_DISCOVERY
+  #define UNIQUE_ID_ADDRESS       0x1fff7a10 ///< Unique device ID register
+#endif
+#ifdef BOARD_STM32F7_DISCOVERY
+  #define UNIQUE_ID_ADDRESS       0x1ff0f420 ///< Unique device ID register
+#endif
+
+static uint8_t* getDeviceDescriptor         (USBD_SpeedTypeDef speed, uint16_t* length);
+static uint8_t* getLanguageIdDescriptor     (USBD_SpeedTypeDef speed, uint16_t* length);
+static uint8_t* getManufacturerDescriptor   (USBD_SpeedTypeDef speed, uint16_t* length);
+static uint8_t* getProductDescriptor        (USBD_SpeedTypeDef speed, uint16_t* length);
+static uint8_t* getSerialNumberDescriptor   (USBD_SpeedTypeDef speed, uint16_t* length);
+static uint8_t* getConfigurationDescriptor  (USBD_SpeedTypeDef speed, uint16_t* length);
+static uint8_t* getInterfaceDescriptor      (USBD_SpeedTypeDef speed, uint16_t* length);
+
+static USBD_DescriptorsTypeDef descriptors = {
+  getDeviceDescriptor,
+  getLanguageIdDescriptor,
+  getManufacturerDescriptor,
+  getProductDescriptor,
+  getSerialNumberDescriptor,
+  getConfigurationDescriptor,
+  getInterfaceDescriptor,
+};
+
+static uint8_t deviceDescriptor[USB_LEN_DEV_DESC] __ALIGN_END = {
+  USB_LEN_DEV_DESC,               // bLength
+  USB_DESC_TYPE_DEVICE,           // bDescriptorType
+  0x00, 0x02,                     // bcdUSB 2.00
+  0x00,                           // bDeviceClass (defined by interface)
+  0x00,                           // bDeviceSubClass
+  0x00,                           // bDeviceProtocol
+  USB_MAX_EP0_SIZE,               // bMaxPacketSize
+  LOBYTE(USB_DEVICE_VENDOR_ID),   // idVendor
+  HIBYTE(USB_DEVICE_VENDOR_ID),
+  0x00, 0x00,                     // idProduct (set on initialization)
+  0x00, 0x02,                     // bcdDevice 2.00
+  USBD_IDX_MFC_STR,               // iManufacturer
+  USBD_IDX_PRODUCT_STR,           // iProduct
+  USBD_IDX_SERIAL_STR,            // iSerialNumber
+  USBD_MAX_NUM_CONFIGURATION      // bNumConfigurations
+};
+
+static uint8_t languageIdDescriptor[USB_LEN_LANGID_STR_DESC] __ALIGN_END = {
+  USB_LEN_LANGID_STR_DESC,
+  USB_DESC_TYPE_STRING,
+  LOBYTE(LANGUAGE_ID_STRING),
+  HIBYTE(LANGUAGE_ID_STRING),
+};
+
+static uint8_t stringDescriptor[USBD_MAX_STR_DESC_SIZ] __ALIGN_END; ///< Buffer for string descriptors
+static const char* productString; ///< Name of the product
+
+/**
+ * @brief Initializes the device descriptors
+ * @param productId Product ID reported to the host
+ * @param productName Product name reported to the host
+ * @return Descriptors for USBD_Init
+ */
+USBD_DescriptorsTypeDef* UsbDescriptors_initialize(uint16_t productId,
+    const char* productName) {
+  const int PRODUCT_ID_OFFSET = 10;
+  deviceDescriptor[PRODUCT_ID_OFFSET]     = LOBYTE(productId);
+  deviceDescriptor[PRODUCT_ID_OFFSET + 1] = HIBYTE(productId);
+  productString = productName;
+  return &descriptors;
+}
+/**
+ * @brief Returns the device descriptor
+ */
+uint8_t* getDeviceDescriptor(USBD_SpeedTypeDef speed, uint16_t* length) {
+  *length = sizeof(deviceDescriptor);
+  return deviceDescriptor;
+}
+/**
+ * @brief Returns the language ID descriptor
+ */
+uint8_t* getLanguageIdDescriptor(USBD_SpeedTypeDef speed, uint16_t* length) {
+  *length = sizeof(languageIdDescriptor);
+  return languageIdDescriptor;
+}
+/**
+ * @brief Returns the manufacturer string descriptor
+ */
+uint8_t* getManufacturerDescriptor(USBD_SpeedTypeDef speed, uint16_t* length) {
+  USBD_GetString((uint8_t*)MANUFACTURER_STRING, stringDescriptor, length);
+  return stringDescriptor;
+}
+/**
+ * @brief Returns the product string descriptor
+ */
+uint8_t* getProductDescriptor(USBD_SpeedTypeDef speed, uint16_t* length) {
+  USBD_GetString((uint8_t*)productString, stringDescriptor, length);
+  return stringDescriptor;
+}
+/**
+ * @brief Returns the serial number string descriptor
+ * @details The serial number is the unique device ID of the microcontroller.
+ */
+uint8_t* getSerialNumberDescriptor(USBD_SpeedTypeDef speed, uint16_t* length) {
+  const char HEX_DIGITS[] = "0123456789ABCDEF";
+  const uint8_t* uniqueId = (const uint8_t*)UNIQUE_ID_ADDRESS;
+  char serialNumber[SERIAL_NUMBER_LENGTH + 1];
+
+  for (int i = 0; i < SERIAL_NUMBER_LENGTH / 2; i++) {
+    serialNumber[2 * i]     = HEX_DIGITS[uniqueId[i] >> 4];
+    serialNumber[2 * i + 1] = HEX_DIGITS[uniqueId[i] & 0x0f];
+  }
+  serialNumber[SERIAL_NUMBER_LENGTH] = '\0';
+  USBD_GetString((uint8_t*)serialNumber, stringDescriptor, length);
+  return stringDescriptor;
+}
+/**
+ * @brief Returns the configuration string descriptor
+ */
+uint8_t* getConfigurationDescriptor(USBD_SpeedTypeDef speed, uint16_t* length) {
+  USBD_GetString((uint8_t*)CONFIGURATION_STRING, stringDescriptor, length);
+  return stringDescriptor;
+}
+/**
+ * @brief Returns the interface string descriptor
+ */
+uint8_t* getInterfaceDescriptor(USBD_SpeedTypeDef speed, uint16_t* length) {
+  USBD_GetString((uint8_t*)INTERFACE_STRING, stringDescriptor, length);
+  return stringDescriptor;
+}
+
+/**
+ * @}
+ */
+
+#endif /* USE_USB_DEVICE */
@@ -0,0 +1,39 @@
+/**
+ * @file    usbd_desc.h
+ * @brief   USB device descriptors
+ * @date    19.10.2026
+ * @author  Michal Ksiezopolski
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#ifndef USBD_DESC_H_
+#define USBD_DESC_H_
+
+#include "usbd_def.h"
+
+/**
+ * @addtogroup USB_DEVICE
+ * @{
+ */
+
+#define USB_DEVICE_VENDOR_ID                0x0483 ///< STMicroelectronics
+#define USB_DEVICE_PRODUCT_ID_MASS_STORAGE  0x5720
+#define USB_DEVICE_PRODUCT_ID_COM_PORT      0x5740
+
+USBD_DescriptorsTypeDef* UsbDescriptors_initialize(uint16_t productId,
+    const char* productName);
+
+/**
+ * @}
+ */
+
+#endif /* USBD_DESC_H_ */
@@ -34,6 +34,18 @@
 #define NUMBER_OF_BITS_IN_BYTE 8
 #define IS_EVEN(x) ((x) % 2 == 0)
 
+/**
+ * @brief Places a variable without initializer in the core coupled RAM
+ * @details The core coupled RAM (F4 CCM, F7 DTCM) has no wait states and
+ * no bus contention with DMA - use it for data touched often by the core.
+ * DMA can't reach the F4 CCM, so never place DMA buffers there.
+ */
+#define FAST_BSS  __attribute__((section(".fast_bss")))
+/**
+ * @brief Places an initialized variable in the core coupled RAM
+ */
+#define FAST_DATA __attribute__((section(".fast_data")))
+
 /**
  * @brief Boolean type for flags
  */
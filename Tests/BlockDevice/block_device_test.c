@@ -0,0 +1,146 @@
+/**
+ * @file    block_device_test.c
+ * @brief   Host test of the block device layer with an image file.
+ * @details Runs BlockDevice on a sparse 5 GiB image (larger than a 32 bit
+ * long can address), checks the written blocks directly in the file, the
+ * range checks, partitions and the cache, and that an image which is
+ * opened but has no size (a FIFO) is closed again.
+ *
+ * Built and run by the host test Makefile:
+ *
+ *          make -C Tests run
+ *
+ * @date    19.10.2026
+ * @author  Michal Ksiezopolski
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#define _FILE_OFFSET_BITS 64
+
+#include "block_device.h"
+#include "file_block_device.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#define BLOCK_SIZE        512
+#define IMAGE_SIZE        (5ull << 30)  ///< Sparse image size
+#define HIGH_BLOCK        9000000       ///< Block above 4 GiB
+#define PARTITION_START   (1u << 23)    ///< Partition starting at 4 GiB
+
+static int failures;
+
+static void check(int condition, const char* message) {
+  if (!condition) {
+    printf("block_device: %s\n", message);
+    failures++;
+  }
+}
+static void fillBlock(uint8_t* buffer, uint32_t block) {
+  for (int i = 0; i < BLOCK_SIZE; i++) {
+    buffer[i] = (uint8_t)(block * 7 + i);
+  }
+}
+/**
+ * @brief Reads and writes blocks of a large image
+ */
+static void testImage(const char* path) {
+  BlockDevice device;
+  FileBlockDevice fileDevice;
+  BlockDeviceGeometry geometry;
+  uint8_t written[BLOCK_SIZE];
+  uint8_t read[BLOCK_SIZE];
+
+  check(FileBlockDevice_initialize(&device, &fileDevice, path, BLOCK_SIZE) == BLOCK_DEVICE_OK,
+      "image not opened");
+  BlockDevice_getGeometry(&device, &geometry);
+  check(geometry.blockSize == BLOCK_SIZE && geometry.blockCount == IMAGE_SIZE / BLOCK_SIZE,
+      "wrong geometry");
+
+  const uint32_t BLOCKS[] = {0, 1, HIGH_BLOCK, IMAGE_SIZE / BLOCK_SIZE - 1};
+  for (int i = 0; i < sizeof(BLOCKS) / sizeof(BLOCKS[0]); i++) {
+    fillBlock(written, BLOCKS[i]);
+    check(BlockDevice_writeBlocks(&device, written, BLOCKS[i], 1) == BLOCK_DEVICE_OK,
+        "write failed");
+  }
+  check(BlockDevice_sync(&device) == BLOCK_DEVICE_OK, "sync failed");
+  for (int i = 0; i < sizeof(BLOCKS) / sizeof(BLOCKS[0]); i++) {
+    fillBlock(written, BLOCKS[i]);
+    check(BlockDevice_readBlocks(&device, read, BLOCKS[i], 1) == BLOCK_DEVICE_OK &&
+        memcmp(read, written, BLOCK_SIZE) == 0, "read data differs");
+  }
+  // the block above 4 GiB has to be at its offset in the file, not wrapped around
+  int fd = open(path, O_RDONLY);
+  memset(read, 0, BLOCK_SIZE);
+  check(pread(fd, read, BLOCK_SIZE, (off_t)HIGH_BLOCK * BLOCK_SIZE) == BLOCK_SIZE, "pread failed");
+  close(fd);
+  fillBlock(written, HIGH_BLOCK);
+  check(memcmp(read, written, BLOCK_SIZE) == 0, "block above 4 GiB written at wrong offset");
+
+  check(BlockDevice_readBlocks(&device, read, geometry.blockCount, 1) == BLOCK_DEVICE_OUT_OF_RANGE,
+      "read beyond end accepted");
+  check(BlockDevice_readBlocks(&device, read, geometry.blockCount - 1, 2) ==
+      BLOCK_DEVICE_OUT_OF_RANGE, "read across end accepted");
+
+  BlockDevice partition;
+  check(BlockDevice_initializePartition(&partition, &device, PARTITION_START,
+      geometry.blockCount) == BLOCK_DEVICE_OUT_OF_RANGE, "too large partition accepted");
+  check(BlockDevice_initializePartition(&partition, &device, PARTITION_START,
+      geometry.blockCount - PARTITION_START) == BLOCK_DEVICE_OK, "partition rejected");
+
+  uint8_t cache[BLOCK_SIZE];
+  BlockDevice_attachCache(&partition, cache);
+  fillBlock(written, HIGH_BLOCK);
+  check(BlockDevice_readCachedBlock(&partition, HIGH_BLOCK - PARTITION_START) == BLOCK_DEVICE_OK &&
+      memcmp(cache, written, BLOCK_SIZE) == 0, "partition block differs");
+  check(BlockDevice_readCachedBlock(&partition, HIGH_BLOCK - PARTITION_START) == BLOCK_DEVICE_OK &&
+      partition.statistics.cacheHits == 1 && partition.statistics.blocksRead == 1,
+      "cached block read again");
+
+  FileBlockDevice_close(&fileDevice);
+  check(fileDevice.file == NULL, "image not closed");
+}
+/**
+ * @brief An image that opens, but has no size, is closed again
+ */
+static void testGeometryError(const char* path) {
+  BlockDevice device;
+  FileBlockDevice fileDevice;
+  check(mkfifo(path, 0600) == 0, "mkfifo failed");
+  check(FileBlockDevice_initialize(&device, &fileDevice, path, BLOCK_SIZE) == BLOCK_DEVICE_ERROR,
+      "FIFO accepted as image");
+  check(fileDevice.file == NULL, "image left open after failed initialization");
+  FileBlockDevice_close(&fileDevice);
+}
+
+int main(void) {
+  char imagePath[] = "/tmp/block_device_test_XXXXXX";
+  int fd = mkstemp(imagePath);
+  if (fd < 0 || ftruncate(fd, IMAGE_SIZE) != 0) {
+    printf("block_device: can't create image\n");
+    return 1;
+  }
+  close(fd);
+  testImage(imagePath);
+  unlink(imagePath);
+
+  char fifoPath[sizeof(imagePath) + 5];
+  snprintf(fifoPath, sizeof(fifoPath), "%s.fifo", imagePath);
+  testGeometryError(fifoPath);
+  unlink(fifoPath);
+
+  printf("block_device_test: %s\n", failures ? "FAILED" : "OK");
+  return failures ? 1 : 0;
+}
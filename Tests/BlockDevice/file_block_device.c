@@ -0,0 +1,150 @@
+/**
+ * @file    file_block_device.c
+ * @brief   Block device driver backed by a disk image file.
+ * @date    19.10.2026
+ * @author  Michal Ksiezopolski
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#define _FILE_OFFSET_BITS 64 // off_t of fseeko is 64 bits on 32 bit hosts too
+
+#include "file_block_device.h"
+#include <sys/types.h>
+
+/**
+ * @addtogroup BLOCK_DEVICE
+ * @{
+ */
+
+static int openImage(void* driverContext);
+static int readBlocks(void* driverContext, uint8_t* buffer, uint32_t block,
+    uint32_t count);
+static int writeBlocks(void* driverContext, uint8_t* buffer, uint32_t block,
+    uint32_t count);
+static int syncImage(void* driverContext);
+static int getGeometry(void* driverContext, BlockDeviceGeometry* geometry);
+static int seekBlock(FileBlockDevice* fileDevice, uint32_t block);
+
+/**
+ * @brief Image file operations
+ */
+static const BlockDeviceOperations fileOperations = {
+  .initialize   = openImage,
+  .readBlocks   = readBlocks,
+  .writeBlocks  = writeBlocks,
+  .sync         = syncImage,
+  .trim         = NULL,
+  .getGeometry  = getGeometry,
+  .submit       = NULL,
+};
+
+/**
+ * @brief Initializes a block device backed by an image file.
+ * @details The image is closed again if the initialization fails.
+ * @param device Block device structure
+ * @param fileDevice Image file driver data
+ * @param path Path to existing image file
+ * @param blockSize Size of one block in bytes
+ * @return Result of block device initialization
+ */
+BlockDeviceResultCode FileBlockDevice_initialize(BlockDevice* device,
+    FileBlockDevice* fileDevice, const char* path, uint32_t blockSize) {
+  fileDevice->path = path;
+  fileDevice->file = NULL;
+  fileDevice->blockSize = blockSize;
+  BlockDeviceResultCode result = BlockDevice_initialize(device, &fileOperations, fileDevice);
+  if (result != BLOCK_DEVICE_OK) {
+    FileBlockDevice_close(fileDevice); // e.g. opened, but the size can't be read
+  }
+  return result;
+}
+/**
+ * @brief Closes the image file.
+ * @param fileDevice Image file driver data
+ */
+void FileBlockDevice_close(FileBlockDevice* fileDevice) {
+  if (fileDevice->file != NULL) {
+    fclose(fileDevice->file);
+    fileDevice->file = NULL;
+  }
+}
+/**
+ * @brief Opens the image file for reading and writing
+ */
+int openImage(void* driverContext) {
+  FileBlockDevice* fileDevice = driverContext;
+  fileDevice->file = fopen(fileDevice->path, "r+b");
+  return fileDevice->file == NULL ? -1 : 0;
+}
+/**
+ * @brief Reads blocks from image file
+ */
+int readBlocks(void* driverContext, uint8_t* buffer, uint32_t block,
+    uint32_t count) {
+  FileBlockDevice* fileDevice = driverContext;
+  if (seekBlock(fileDevice, block) != 0) {
+    return -1;
+  }
+  if (fread(buffer, fileDevice->blockSize, count, fileDevice->file) != count) {
+    return -1;
+  }
+  return 0;
+}
+/**
+ * @brief Writes blocks to image file
+ */
+int writeBlocks(void* driverContext, uint8_t* buffer, uint32_t block,
+    uint32_t count) {
+  FileBlockDevice* fileDevice = driverContext;
+  if (seekBlock(fileDevice, block) != 0) {
+    return -1;
+  }
+  if (fwrite(buffer, fileDevice->blockSize, count, fileDevice->file) != count) {
+    return -1;
+  }
+  return 0;
+}
+/**
+ * @brief Flushes buffered writes to the image file
+ */
+int syncImage(void* driverContext) {
+  FileBlockDevice* fileDevice = driverContext;
+  return fflush(fileDevice->file) == 0 ? 0 : -1;
+}
+/**
+ * @brief Returns geometry based on image file size
+ */
+int getGeometry(void* driverContext, BlockDeviceGeometry* geometry) {
+  FileBlockDevice* fileDevice = driverContext;
+  if (fseeko(fileDevice->file, 0, SEEK_END) != 0) {
+    return -1;
+  }
+  off_t fileSize = ftello(fileDevice->file);
+  if (fileSize < 0) {
+    return -1;
+  }
+  geometry->blockSize = fileDevice->blockSize;
+  geometry->blockCount = fileSize / fileDevice->blockSize;
+  return 0;
+}
+/**
+ * @brief Moves the file position to a block
+ * @details The offset is calculated in 64 bits - a long overflows at 2 GiB
+ * on 32 bit hosts, and SD card images are larger.
+ */
+int seekBlock(FileBlockDevice* fileDevice, uint32_t block) {
+  off_t offset = (off_t)block * fileDevice->blockSize;
+  return fseeko(fileDevice->file, offset, SEEK_SET) == 0 ? 0 : -1;
+}
+/**
+ * @}
+ */
@@ -0,0 +1,50 @@
+/**
+ * @file    file_block_device.h
+ * @brief   Block device driver backed by a disk image file.
+ * @date    19.10.2026
+ * @author  Michal Ksiezopolski
+ *
+ * @details Used for running the file system code on a PC
+ * with an image of an SD card. Host only (stdio), so it lives with the host
+ * tests and not in MyLibraries, which every example compiles.
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#ifndef FILE_BLOCK_DEVICE_H_
+#define FILE_BLOCK_DEVICE_H_
+
+#include "block_device.h"
+#include <stdio.h>
+
+/**
+ * @addtogroup BLOCK_DEVICE
+ * @{
+ */
+
+/**
+ * @brief Image file driver data
+ */
+typedef struct {
+  const char* path;     ///< Path to image file
+  FILE* file;           ///< Opened image file
+  uint32_t blockSize;   ///< Size of one block in bytes
+} FileBlockDevice;
+
+BlockDeviceResultCode FileBlockDevice_initialize(BlockDevice* device,
+    FileBlockDevice* fileDevice, const char* path, uint32_t blockSize);
+void                  FileBlockDevice_close     (FileBlockDevice* fileDevice);
+
+/**
+ * @}
+ */
+
+#endif /* FILE_BLOCK_DEVICE_H_ */
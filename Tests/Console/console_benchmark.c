@@ -0,0 +1,185 @@
+/**
+ * @file    console_benchmark.c
+ * @brief   Host test and benchmark of the console command dispatch.
+ * @details Runs the same command lines through Console_execute and through
+ * a strcmp chain like the one the examples used before (one strcmp per
+ * accepted command line, every one evaluated), checks that both executed the
+ * same commands and compares the time per command line.
+ *
+ * Built and run by the host test Makefile:
+ *
+ *          make -C Tests run
+ *
+ * @date    19.10.2026
+ * @author  Michal Ksiezopolski
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#include "console.h"
+#include "serial_port.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define NUMBER_OF_COMMANDS  16        ///< Commands in the table
+#define NUMBER_OF_LINES     (NUMBER_OF_COMMANDS * 4) ///< Every command with <0|1> <ON|OFF>
+#define ITERATIONS          10000000u ///< Command lines executed by every benchmark
+
+static int counts[NUMBER_OF_COMMANDS][2][2]; ///< Executions per command, number and state
+static char lines[NUMBER_OF_LINES][CONSOLE_LINE_LENGTH];
+static int failures;
+
+/**
+ * @brief Handler of one command (<0|1> <ON|OFF>), like the LED command of the examples
+ */
+static ConsoleResultCode handleCommand(int command, int argumentCount, char* arguments[]) {
+  int number;
+  if (argumentCount != 3 || !Console_parseInteger(arguments[1], &number) ||
+      number < 0 || number > 1) {
+    return CONSOLE_INVALID_ARGUMENTS;
+  }
+  if (strcmp(arguments[2], "ON") == 0) {
+    counts[command][number][1]++;
+  } else if (strcmp(arguments[2], "OFF") == 0) {
+    counts[command][number][0]++;
+  } else {
+    return CONSOLE_INVALID_ARGUMENTS;
+  }
+  return CONSOLE_OK;
+}
+
+#define HANDLER(n) \
+  static ConsoleResultCode handler##n(int argumentCount, char* arguments[]) { \
+    return handleCommand(n, argumentCount, arguments); \
+  }
+HANDLER(0)  HANDLER(1)  HANDLER(2)  HANDLER(3)  HANDLER(4)  HANDLER(5)  HANDLER(6)  HANDLER(7)
+HANDLER(8)  HANDLER(9)  HANDLER(10) HANDLER(11) HANDLER(12) HANDLER(13) HANDLER(14) HANDLER(15)
+
+/**
+ * @brief Commands sorted by name
+ */
+static const ConsoleCommand COMMANDS[NUMBER_OF_COMMANDS] = {
+  {":ACC",   handler0,  ":ACC <0|1> <ON|OFF>"},
+  {":ADC",   handler1,  ":ADC <0|1> <ON|OFF>"},
+  {":BMP",   handler2,  ":BMP <0|1> <ON|OFF>"},
+  {":DAC",   handler3,  ":DAC <0|1> <ON|OFF>"},
+  {":DHT",   handler4,  ":DHT <0|1> <ON|OFF>"},
+  {":FAN",   handler5,  ":FAN <0|1> <ON|OFF>"},
+  {":GYRO",  handler6,  ":GYRO <0|1> <ON|OFF>"},
+  {":IR",    handler7,  ":IR <0|1> <ON|OFF>"},
+  {":LCD",   handler8,  ":LCD <0|1> <ON|OFF>"},
+  {":LED",   handler9,  ":LED <0|1> <ON|OFF>"},
+  {":MAG",   handler10, ":MAG <0|1> <ON|OFF>"},
+  {":PWM",   handler11, ":PWM <0|1> <ON|OFF>"},
+  {":RFID",  handler12, ":RFID <0|1> <ON|OFF>"},
+  {":SD",    handler13, ":SD <0|1> <ON|OFF>"},
+  {":TEMP",  handler14, ":TEMP <0|1> <ON|OFF>"},
+  {":TOUCH", handler15, ":TOUCH <0|1> <ON|OFF>"},
+};
+
+/**
+ * @brief The dispatch before the console: one strcmp per accepted line
+ */
+static void executeWithStrcmpChain(const char* line) {
+  for (int i = 0; i < NUMBER_OF_LINES; i++) {
+    if (!strcmp(line, lines[i])) {
+      counts[i / 4][(i / 2) % 2][i % 2 == 0]++;
+    }
+  }
+}
+
+SerialPort* SerialPort_getDebugConsole(void) {
+  return NULL;
+}
+SerialPortResultCode SerialPort_getFrame(SerialPort* port, char* frameBuffer, int* length,
+    int maximumLength) {
+  return SERIAL_PORT_NO_FRAME_READY;
+}
+
+static double getSeconds(void) {
+  struct timespec time;
+  clock_gettime(CLOCK_MONOTONIC, &time);
+  return time.tv_sec + time.tv_nsec * 1e-9;
+}
+static void check(int condition, const char* message) {
+  if (!condition) {
+    printf("console: %s\n", message);
+    failures++;
+  }
+}
+/**
+ * @brief Checks the error paths of the console
+ */
+static void testErrors(void) {
+  const ConsoleCommand UNSORTED[] = {
+    {":LED", handler0, NULL},
+    {":ACC", handler1, NULL},
+  };
+  check(Console_initialize(UNSORTED, 2) == CONSOLE_TABLE_NOT_SORTED, "unsorted table accepted");
+  check(Console_initialize(COMMANDS, NUMBER_OF_COMMANDS) == CONSOLE_OK, "table rejected");
+
+  char line[CONSOLE_LINE_LENGTH];
+  strcpy(line, ":NONE 1 ON");
+  check(Console_execute(line) == CONSOLE_UNKNOWN_COMMAND, "unknown command executed");
+  strcpy(line, ":LED 2 ON");
+  check(Console_execute(line) == CONSOLE_INVALID_ARGUMENTS, "invalid argument accepted");
+  strcpy(line, ":LED 1 2 3 4 5 6 7 8");
+  check(Console_execute(line) == CONSOLE_TOO_MANY_ARGUMENTS, "too many arguments accepted");
+  strcpy(line, "   ");
+  check(Console_execute(line) == CONSOLE_NO_COMMAND, "empty line executed");
+  strcpy(line, "\t:LED  0x1\tOFF ");
+  check(Console_execute(line) == CONSOLE_OK && counts[9][1][0] == 1, "separators not handled");
+  for (int i = 0; i < NUMBER_OF_COMMANDS; i++) {
+    check(Console_findCommand(COMMANDS[i].name) == &COMMANDS[i], "command not found");
+  }
+  memset(counts, 0, sizeof(counts));
+}
+/**
+ * @brief Executes all lines ITERATIONS times in turn
+ * @param useConsole TRUE - Console_execute, FALSE - strcmp chain
+ * @return Time per command line in ns
+ */
+static double benchmark(Boolean useConsole) {
+  char line[CONSOLE_LINE_LENGTH];
+  double start = getSeconds();
+  for (unsigned int i = 0; i < ITERATIONS; i++) {
+    // the line is copied out of the RX buffer in both cases (SerialPort_getFrame)
+    strcpy(line, lines[i % NUMBER_OF_LINES]);
+    if (useConsole) {
+      Console_execute(line);
+    } else {
+      executeWithStrcmpChain(line);
+    }
+  }
+  return (getSeconds() - start) * 1e9 / ITERATIONS;
+}
+
+int main(void) {
+  for (int i = 0; i < NUMBER_OF_LINES; i++) {
+    snprintf(lines[i], CONSOLE_LINE_LENGTH, "%s %d %s", COMMANDS[i / 4].name,
+        (i / 2) % 2, (i % 2 == 0) ? "ON" : "OFF");
+  }
+  testErrors();
+
+  double strcmpChain = benchmark(FALSE);
+  int strcmpCounts[NUMBER_OF_COMMANDS][2][2];
+  memcpy(strcmpCounts, counts, sizeof(counts));
+  memset(counts, 0, sizeof(counts));
+  double console = benchmark(TRUE);
+  check(memcmp(strcmpCounts, counts, sizeof(counts)) == 0, "console executed other commands");
+
+  printf("%d commands, %d command lines of 3 tokens\n", NUMBER_OF_COMMANDS, NUMBER_OF_LINES);
+  printf("%-36s %6.1f ns/line\n", "strcmp chain", strcmpChain);
+  printf("%-36s %6.1f ns/line\n", "Console_execute (tokens + search)", console);
+  printf("console_benchmark: %s\n", failures ? "FAILED" : "OK");
+  return failures ? 1 : 0;
+}
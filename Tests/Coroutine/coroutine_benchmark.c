@@ -0,0 +1,217 @@
+/**
+ * @file    coroutine_benchmark.c
+ * @brief   Host test and benchmark of the stackless coroutines.
+ * @details Checks the waits of coroutine.h (yield, condition, event, delay,
+ * SPI transfer, child, exit) with a fake time base and a fake SPI bus, and
+ * compares the cost of a switch between a coroutine and its caller with the
+ * hand-written switch state machine the drivers used before.
+ *
+ * Built and run by the host test Makefile:
+ *
+ *          make -C Tests run
+ *
+ * @date    19.10.2026
+ * @author  Michal Ksiezopolski
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#include "coroutine.h"
+#include "spi_bus.h"
+#include <stdio.h>
+#include <time.h>
+
+#define ITERATIONS 200000000u ///< Calls in every benchmark
+#define STEPS      4          ///< Steps of the benchmarked machines
+
+static uint32_t nowMicros;          ///< Fake time base
+static Boolean isSubmitAccepted;    ///< Result of the fake SpiBus_submit
+static int submits;                 ///< Calls of SpiBus_submit
+static volatile Boolean eventFlag;  ///< Set by the test like an IRQ
+static volatile unsigned int work;  ///< Work done in the benchmarked steps
+static int failures;
+
+unsigned int Timer_getTimeMicros(void) {
+  return nowMicros;
+}
+Boolean SpiBus_submit(SpiTransaction* transaction) {
+  submits++;
+  if (isSubmitAccepted) {
+    transaction->state = SPI_TRANSACTION_QUEUED;
+  }
+  return isSubmitAccepted;
+}
+
+static double getSeconds(void) {
+  struct timespec time;
+  clock_gettime(CLOCK_MONOTONIC, &time);
+  return time.tv_sec + time.tv_nsec * 1e-9;
+}
+static void check(int condition, const char* message) {
+  if (!condition) {
+    printf("coroutine: %s\n", message);
+    failures++;
+  }
+}
+
+static int childSteps; ///< Steps made by child
+static CoroutineState child(Coroutine* coroutine) {
+  COROUTINE_BEGIN(coroutine);
+  childSteps++;
+  COROUTINE_YIELD(coroutine);
+  childSteps++;
+  COROUTINE_END(coroutine);
+}
+static int parentStep;             ///< Last step reached by parent
+static Coroutine childCoroutine;
+static SpiTransaction transaction; ///< Transaction of parent
+/**
+ * @brief Goes through all the waits, parentStep tells how far it got
+ */
+static CoroutineState parent(Coroutine* coroutine) {
+  COROUTINE_BEGIN(coroutine);
+  parentStep = 1;
+  COROUTINE_YIELD(coroutine);
+  parentStep = 2;
+  COROUTINE_AWAIT_EVENT(coroutine, eventFlag);
+  parentStep = 3;
+  COROUTINE_AWAIT_DELAY_MICROS(coroutine, 100);
+  parentStep = 4;
+  COROUTINE_AWAIT_TRANSFER(coroutine, &transaction);
+  parentStep = 5;
+  COROUTINE_INITIALIZE(&childCoroutine);
+  COROUTINE_AWAIT_CHILD(coroutine, child(&childCoroutine));
+  parentStep = 6;
+  if (transaction.state != SPI_TRANSACTION_DONE) {
+    COROUTINE_EXIT(coroutine);
+  }
+  parentStep = 7;
+  COROUTINE_END(coroutine);
+}
+/**
+ * @brief Runs parent through its waits
+ * @param isAccepted Result of SpiBus_submit
+ */
+static void testWaits(Boolean isAccepted) {
+  Coroutine coroutine;
+  COROUTINE_INITIALIZE(&coroutine);
+  isSubmitAccepted = isAccepted;
+  submits = 0;
+  childSteps = 0;
+  transaction.state = SPI_TRANSACTION_IDLE;
+
+  check(parent(&coroutine) == COROUTINE_RUNNING && parentStep == 1, "yield didn't return");
+  check(parent(&coroutine) == COROUTINE_RUNNING && parentStep == 2, "event not awaited");
+  check(parent(&coroutine) == COROUTINE_RUNNING && parentStep == 2, "event not awaited");
+  eventFlag = TRUE;
+  check(parent(&coroutine) == COROUTINE_RUNNING && parentStep == 3, "delay not awaited");
+  check(!eventFlag, "event flag not cleared");
+  nowMicros += 99;
+  check(parent(&coroutine) == COROUTINE_RUNNING && parentStep == 3, "delay too short");
+  nowMicros += 1;
+  CoroutineState state = parent(&coroutine);
+  check(submits == 1, "transaction not submitted once");
+  if (isAccepted) {
+    check(state == COROUTINE_RUNNING && parentStep == 4, "transfer not awaited");
+    check(parent(&coroutine) == COROUTINE_RUNNING && parentStep == 4, "transfer not awaited");
+    transaction.state = SPI_TRANSACTION_DONE;
+    state = parent(&coroutine);
+    check(submits == 1, "transaction submitted again");
+  }
+  // the child yields once
+  check(state == COROUTINE_RUNNING && parentStep == 5 && childSteps == 1,
+      "rejected transfer awaited or child not run");
+  state = parent(&coroutine);
+  check(childSteps == 2, "child not awaited");
+  if (isAccepted) {
+    check(state == COROUTINE_FINISHED && parentStep == 7, "parent didn't finish");
+  } else {
+    check(state == COROUTINE_FINISHED && parentStep == 6, "parent didn't exit");
+  }
+  check(coroutine.resumePoint == 0, "finished coroutine doesn't start over");
+}
+
+/**
+ * @brief Benchmarked coroutine - STEPS steps, one per call
+ */
+__attribute__((noinline)) static CoroutineState stepCoroutine(Coroutine* coroutine) {
+  COROUTINE_BEGIN(coroutine);
+  while (TRUE) {
+    work++;
+    COROUTINE_YIELD(coroutine);
+    work += 2;
+    COROUTINE_YIELD(coroutine);
+    work += 3;
+    COROUTINE_YIELD(coroutine);
+    work += 4;
+    COROUTINE_YIELD(coroutine);
+  }
+  COROUTINE_END(coroutine);
+}
+/**
+ * @brief The same steps as a hand-written state machine
+ */
+__attribute__((noinline)) static CoroutineState stepMachine(int* machineState) {
+  switch (*machineState) {
+  case 0:
+    work++;
+    *machineState = 1;
+    break;
+  case 1:
+    work += 2;
+    *machineState = 2;
+    break;
+  case 2:
+    work += 3;
+    *machineState = 3;
+    break;
+  case 3:
+    work += 4;
+    *machineState = 0;
+    break;
+  }
+  return COROUTINE_RUNNING;
+}
+/**
+ * @brief Calls a machine ITERATIONS times
+ * @param useCoroutine TRUE - stepCoroutine, FALSE - stepMachine
+ * @return Time per call in ns
+ */
+static double benchmark(Boolean useCoroutine) {
+  Coroutine coroutine;
+  int machineState = 0;
+  COROUTINE_INITIALIZE(&coroutine);
+  work = 0;
+  double start = getSeconds();
+  for (unsigned int i = 0; i < ITERATIONS; i++) {
+    if (useCoroutine) {
+      stepCoroutine(&coroutine);
+    } else {
+      stepMachine(&machineState);
+    }
+  }
+  double seconds = getSeconds() - start;
+  check(work == ITERATIONS / STEPS * 10, "machine did other work");
+  return seconds * 1e9 / ITERATIONS;
+}
+
+int main(void) {
+  testWaits(TRUE);
+  testWaits(FALSE);
+
+  double machine = benchmark(FALSE);
+  double coroutine = benchmark(TRUE);
+  printf("%u calls of a %d step machine\n", ITERATIONS, STEPS);
+  printf("%-28s %5.2f ns/call\n", "switch state machine", machine);
+  printf("%-28s %5.2f ns/call\n", "coroutine (yield + resume)", coroutine);
+  printf("coroutine_benchmark: %s\n", failures ? "FAILED" : "OK");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,154 @@
+/**
+ * @file    crc_benchmark.c
+ * @brief   Host test and benchmark of the CRC functions.
+ * @details Checks the table driven CRC7 and CRC16-CCITT against bitwise
+ * reference implementations (known SD command tokens, check values, random
+ * buffers calculated in parts) and compares their throughput on 512 byte
+ * sectors. The SD driver calculates the CRC16 of every sector in CRC mode.
+ *
+ * Built and run by the host test Makefile:
+ *
+ *          make -C Tests run
+ *
+ * @date    19.10.2026
+ * @author  Michal Ksiezopolski
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#include "crc.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define SECTOR_SIZE     512     ///< SD card sector
+#define SECTORS         64      ///< Sectors in the benchmark buffer
+#define ITERATIONS      20000   ///< Passes over the buffer
+#define RANDOM_BUFFERS  1000    ///< Random buffers compared with the reference
+
+static uint8_t sectors[SECTORS][SECTOR_SIZE];
+static int failures;
+static uint32_t randomState = 2463534242u; ///< Xorshift state
+
+/**
+ * @brief Bitwise CRC7 (the SD specification algorithm)
+ * @return CRC7 with the end bit, like Crc_calculateCrc7
+ */
+static uint8_t calculateCrc7Bitwise(const uint8_t* data, int length) {
+  uint8_t crc = 0;
+  for (int i = 0; i < length; i++) {
+    uint8_t byte = data[i];
+    for (int bit = 0; bit < 8; bit++) {
+      crc <<= 1;
+      if ((byte ^ crc) & 0x80) {
+        crc ^= 0x09;
+      }
+      byte <<= 1;
+    }
+  }
+  return ((crc & 0x7f) << 1) | 0x01;
+}
+/**
+ * @brief Bitwise CRC16-CCITT (XMODEM)
+ */
+static uint16_t calculateCrc16Bitwise(const uint8_t* data, int length) {
+  uint16_t crc = CRC16_CCITT_INITIAL_VALUE;
+  for (int i = 0; i < length; i++) {
+    crc ^= data[i] << 8;
+    for (int bit = 0; bit < 8; bit++) {
+      crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+  }
+  return crc;
+}
+
+static double getSeconds(void) {
+  struct timespec time;
+  clock_gettime(CLOCK_MONOTONIC, &time);
+  return time.tv_sec + time.tv_nsec * 1e-9;
+}
+static void check(int condition, const char* message) {
+  if (!condition) {
+    printf("crc: %s\n", message);
+    failures++;
+  }
+}
+static uint32_t getRandom(void) {
+  randomState ^= randomState << 13;
+  randomState ^= randomState >> 17;
+  randomState ^= randomState << 5;
+  return randomState;
+}
+/**
+ * @brief Checks the table driven functions
+ */
+static void testCrc(void) {
+  const uint8_t CMD0[] = {0x40, 0x00, 0x00, 0x00, 0x00};
+  const uint8_t CMD8[] = {0x48, 0x00, 0x00, 0x01, 0xaa};
+  const char* CHECK_STRING = "123456789";
+  check(Crc_calculateCrc7(CMD0, sizeof(CMD0)) == 0x95, "CMD0 CRC7 is not 0x95");
+  check(Crc_calculateCrc7(CMD8, sizeof(CMD8)) == 0x87, "CMD8 CRC7 is not 0x87");
+  check(calculateCrc7Bitwise(CMD0, sizeof(CMD0)) == 0x95, "bitwise CMD0 CRC7 is not 0x95");
+  check(Crc_calculateCrc16Ccitt((const uint8_t*)CHECK_STRING, strlen(CHECK_STRING)) == 0x31c3,
+      "CRC16 check value is not 0x31c3");
+  check(calculateCrc16Bitwise((const uint8_t*)CHECK_STRING, strlen(CHECK_STRING)) == 0x31c3,
+      "bitwise CRC16 check value is not 0x31c3");
+
+  uint8_t buffer[SECTOR_SIZE + 3];
+  for (int i = 0; i < RANDOM_BUFFERS; i++) {
+    int length = getRandom() % sizeof(buffer);
+    for (int j = 0; j < length; j++) {
+      buffer[j] = getRandom();
+    }
+    check(Crc_calculateCrc7(buffer, length) == calculateCrc7Bitwise(buffer, length),
+        "CRC7 differs from reference");
+    uint16_t crc16 = calculateCrc16Bitwise(buffer, length);
+    check(Crc_calculateCrc16Ccitt(buffer, length) == crc16, "CRC16 differs from reference");
+    // in two parts - the unrolled loop and the tail start anywhere
+    int split = length ? getRandom() % length : 0;
+    uint16_t partial = Crc_updateCrc16Ccitt(CRC16_CCITT_INITIAL_VALUE, buffer, split);
+    check(Crc_updateCrc16Ccitt(partial, buffer + split, length - split) == crc16,
+        "CRC16 calculated in parts differs");
+  }
+}
+/**
+ * @brief Calculates CRC16 of all sectors ITERATIONS times
+ * @param useTable TRUE - Crc_calculateCrc16Ccitt, FALSE - bitwise
+ * @return Throughput in MB/s
+ */
+static double benchmark(int useTable) {
+  volatile uint16_t result;
+  double start = getSeconds();
+  for (int i = 0; i < ITERATIONS; i++) {
+    for (int sector = 0; sector < SECTORS; sector++) {
+      result = useTable ? Crc_calculateCrc16Ccitt(sectors[sector], SECTOR_SIZE) :
+          calculateCrc16Bitwise(sectors[sector], SECTOR_SIZE);
+    }
+  }
+  (void)result;
+  return (double)ITERATIONS * SECTORS * SECTOR_SIZE / (getSeconds() - start) / 1e6;
+}
+
+int main(void) {
+  testCrc();
+  for (int sector = 0; sector < SECTORS; sector++) {
+    for (int i = 0; i < SECTOR_SIZE; i++) {
+      sectors[sector][i] = getRandom();
+    }
+  }
+  double bitwise = benchmark(0);
+  double table = benchmark(1);
+  printf("CRC16-CCITT of %d byte sectors\n", SECTOR_SIZE);
+  printf("%-24s %7.1f MB/s %6.2f us/sector\n", "bitwise", bitwise, SECTOR_SIZE / bitwise);
+  printf("%-24s %7.1f MB/s %6.2f us/sector\n", "table (Crc module)", table, SECTOR_SIZE / table);
+  printf("crc_benchmark: %s\n", failures ? "FAILED" : "OK");
+  return failures ? 1 : 0;
+}
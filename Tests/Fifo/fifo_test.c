@@ -0,0 +1,363 @@
+/**
+ * @file    fifo_test.c
+ * @brief   Host stress test and benchmark of the FIFO.
+ * @details A producer and a consumer thread pass a pseudo-random byte
+ * sequence through a small FIFO, mixing all producer and consumer
+ * functions, and the consumer checks every byte. Then the throughput is
+ * compared with the previous FIFO (shared count, which needs a critical
+ * section - emulated with a mutex when used from two threads).
+ *
+ * Built and run by the host test Makefile:
+ *
+ *          make -C Tests run
+ *
+ * @date    19.10.2026
+ * @author  Michal Ksiezopolski
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#include "fifo.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define STRESS_FIFO_LENGTH      64          ///< Small, so the indices wrap and the FIFO fills often
+#define STRESS_BYTES            20000000u   ///< Bytes passed in the stress test
+#define BENCHMARK_FIFO_LENGTH   1024
+#define BENCHMARK_BYTES         100000000u  ///< Bytes passed in every benchmark
+#define BLOCK_LENGTH            64          ///< Block length of the bulk benchmarks
+
+/**
+ * @brief The FIFO before the lock-free rewrite (count shared by both sides)
+ */
+typedef struct {
+  volatile int head;
+  volatile int tail;
+  volatile int count;
+  char* dataBuffer;
+  int length;
+} OldFifo;
+
+static Fifo fifo;
+static char fifoBuffer[BENCHMARK_FIFO_LENGTH];
+static OldFifo oldFifo;
+static pthread_mutex_t oldFifoLock = PTHREAD_MUTEX_INITIALIZER;
+static volatile int failures;
+
+static void oldFifoInitialize(OldFifo* old, char* buffer, int length) {
+  old->dataBuffer = buffer;
+  old->length = length;
+  old->head = old->tail = old->count = 0;
+}
+static FifoResultCode oldFifoPush(OldFifo* old, char newData) {
+  if (old->count == old->length) {
+    return FIFO_FULL;
+  }
+  old->dataBuffer[old->head++] = newData;
+  old->count++;
+  if (old->head == old->length) {
+    old->head = 0;
+  }
+  return FIFO_OK;
+}
+static FifoResultCode oldFifoPop(OldFifo* old, char* c) {
+  if (old->count == 0) {
+    return FIFO_EMPTY;
+  }
+  *c = old->dataBuffer[old->tail++];
+  old->count--;
+  if (old->tail == old->length) {
+    old->tail = 0;
+  }
+  return FIFO_OK;
+}
+/**
+ * @brief Next byte of the test sequence (xorshift, same on both sides)
+ */
+static char nextByte(uint32_t* state) {
+  *state ^= *state << 13;
+  *state ^= *state >> 17;
+  *state ^= *state << 5;
+  return (char)*state;
+}
+static double getSeconds(void) {
+  struct timespec time;
+  clock_gettime(CLOCK_MONOTONIC, &time);
+  return time.tv_sec + time.tv_nsec * 1e-9;
+}
+// ******************************* stress test *******************************
+static void* stressProducer(void* argument) {
+  uint32_t sequence = 1;
+  uint32_t random = 12345;
+  char block[100];
+  unsigned int sent = 0;
+  while (sent < STRESS_BYTES) {
+    int mode = nextByte(&random) & 3;
+    int length = 1 + (unsigned char)nextByte(&random) % sizeof(block);
+    if (length > (int)(STRESS_BYTES - sent)) {
+      length = STRESS_BYTES - sent;
+    }
+    if (mode == 0) { // byte by byte
+      uint32_t state = sequence;
+      char data = nextByte(&state);
+      if (Fifo_push(&fifo, data) == FIFO_OK) {
+        sequence = state;
+        sent++;
+      } else {
+        sched_yield();
+      }
+    } else if (mode == 1) { // copy
+      uint32_t state = sequence;
+      for (int i = 0; i < length; i++) {
+        block[i] = nextByte(&state);
+      }
+      int pushed = Fifo_pushMultiple(&fifo, block, length);
+      for (int i = 0; i < pushed; i++) {
+        nextByte(&sequence);
+      }
+      sent += pushed;
+      if (pushed == 0) {
+        sched_yield();
+      }
+    } else { // zero copy
+      FifoSpan span = Fifo_getWritableSpan(&fifo);
+      if (span.length > length) {
+        span.length = length;
+      }
+      for (int i = 0; i < span.length; i++) {
+        span.data[i] = nextByte(&sequence);
+      }
+      Fifo_commit(&fifo, span.length);
+      sent += span.length;
+      if (span.length == 0) {
+        sched_yield();
+      }
+    }
+  }
+  return argument;
+}
+static void checkByte(char data, uint32_t* sequence, unsigned int position) {
+  char expected = nextByte(sequence);
+  if (data != expected && failures++ < 10) {
+    printf("stress: byte %u is 0x%02x, expected 0x%02x\n", position,
+        (unsigned char)data, (unsigned char)expected);
+  }
+}
+static void* stressConsumer(void* argument) {
+  uint32_t sequence = 1;
+  uint32_t random = 54321;
+  char block[100];
+  unsigned int received = 0;
+  while (received < STRESS_BYTES) {
+    int mode = nextByte(&random) & 3;
+    int length = 1 + (unsigned char)nextByte(&random) % sizeof(block);
+    int count = Fifo_getCount(&fifo);
+    if (count < 0 || count > STRESS_FIFO_LENGTH) {
+      if (failures++ < 10) {
+        printf("stress: count %d out of range\n", count);
+      }
+    }
+    if (mode == 0) { // byte by byte, checked with peek and find first
+      char peeked, data;
+      if (Fifo_peek(&fifo, 0, &peeked) != FIFO_OK) {
+        sched_yield();
+        continue;
+      }
+      int found = Fifo_find(&fifo, peeked);
+      if (found != 0 && failures++ < 10) {
+        printf("stress: find returned %d instead of 0\n", found);
+      }
+      if (Fifo_pop(&fifo, &data) != FIFO_OK || data != peeked) {
+        if (failures++ < 10) {
+          printf("stress: pop differs from peek\n");
+        }
+      }
+      checkByte(data, &sequence, received++);
+    } else if (mode == 1) { // copy
+      int popped = Fifo_popMultiple(&fifo, block, length);
+      for (int i = 0; i < popped; i++) {
+        checkByte(block[i], &sequence, received++);
+      }
+      if (popped == 0) {
+        sched_yield();
+      }
+    } else { // zero copy
+      FifoSpan span = Fifo_getReadableSpan(&fifo);
+      if (span.length > length) {
+        span.length = length;
+      }
+      for (int i = 0; i < span.length; i++) {
+        checkByte(span.data[i], &sequence, received++);
+      }
+      Fifo_consume(&fifo, span.length);
+      if (span.length == 0) {
+        sched_yield();
+      }
+    }
+  }
+  return argument;
+}
+static void runStressTest(void) {
+  pthread_t producer, consumer;
+  Fifo_addNewFifo(&fifo, fifoBuffer, STRESS_FIFO_LENGTH);
+  double start = getSeconds();
+  pthread_create(&producer, NULL, stressProducer, NULL);
+  pthread_create(&consumer, NULL, stressConsumer, NULL);
+  pthread_join(producer, NULL);
+  pthread_join(consumer, NULL);
+  if (!Fifo_isEmpty(&fifo) && failures++ < 10) {
+    printf("stress: FIFO not empty at the end\n");
+  }
+  printf("stress: %u bytes through a %d byte FIFO in %.1f s, %d errors\n",
+      STRESS_BYTES, STRESS_FIFO_LENGTH, getSeconds() - start, failures);
+}
+// ******************************** benchmarks *******************************
+static void printResult(const char* name, double seconds) {
+  printf("%-36s %8.1f MB/s %6.2f ns/byte\n", name, BENCHMARK_BYTES / seconds / 1e6,
+      seconds * 1e9 / BENCHMARK_BYTES);
+}
+static void benchmarkSingleThread(void) {
+  char data = 0;
+  unsigned int sum = 0;
+  Fifo_addNewFifo(&fifo, fifoBuffer, BENCHMARK_FIFO_LENGTH);
+  oldFifoInitialize(&oldFifo, fifoBuffer, BENCHMARK_FIFO_LENGTH);
+
+  double start = getSeconds();
+  for (unsigned int i = 0; i < BENCHMARK_BYTES; i += BLOCK_LENGTH) {
+    for (int j = 0; j < BLOCK_LENGTH; j++) {
+      oldFifoPush(&oldFifo, (char)j);
+    }
+    for (int j = 0; j < BLOCK_LENGTH; j++) {
+      oldFifoPop(&oldFifo, &data);
+      sum += data;
+    }
+  }
+  printResult("1 thread, old push/pop", getSeconds() - start);
+
+  start = getSeconds();
+  for (unsigned int i = 0; i < BENCHMARK_BYTES; i += BLOCK_LENGTH) {
+    for (int j = 0; j < BLOCK_LENGTH; j++) {
+      Fifo_push(&fifo, (char)j);
+    }
+    for (int j = 0; j < BLOCK_LENGTH; j++) {
+      Fifo_pop(&fifo, &data);
+      sum += data;
+    }
+  }
+  printResult("1 thread, push/pop", getSeconds() - start);
+
+  char block[BLOCK_LENGTH] = {0};
+  start = getSeconds();
+  for (unsigned int i = 0; i < BENCHMARK_BYTES; i += BLOCK_LENGTH) {
+    Fifo_pushMultiple(&fifo, block, BLOCK_LENGTH);
+    Fifo_popMultiple(&fifo, block, BLOCK_LENGTH);
+    sum += block[0];
+  }
+  printResult("1 thread, pushMultiple/popMultiple", getSeconds() - start);
+  if (sum == 1) {
+    printf("\n"); // keeps the loops from being optimized out
+  }
+}
+static void* oldProducer(void* argument) {
+  for (unsigned int i = 0; i < BENCHMARK_BYTES;) {
+    pthread_mutex_lock(&oldFifoLock); // the IRQ disable around the shared count
+    FifoResultCode result = oldFifoPush(&oldFifo, (char)i);
+    pthread_mutex_unlock(&oldFifoLock);
+    if (result == FIFO_OK) {
+      i++;
+    } else {
+      sched_yield();
+    }
+  }
+  return argument;
+}
+static void* oldConsumer(void* argument) {
+  char data;
+  for (unsigned int i = 0; i < BENCHMARK_BYTES;) {
+    pthread_mutex_lock(&oldFifoLock);
+    FifoResultCode result = oldFifoPop(&oldFifo, &data);
+    pthread_mutex_unlock(&oldFifoLock);
+    if (result == FIFO_OK) {
+      i++;
+    } else {
+      sched_yield();
+    }
+  }
+  return argument;
+}
+static void* producer(void* argument) {
+  for (unsigned int i = 0; i < BENCHMARK_BYTES;) {
+    if (Fifo_push(&fifo, (char)i) == FIFO_OK) {
+      i++;
+    } else {
+      sched_yield();
+    }
+  }
+  return argument;
+}
+static void* consumer(void* argument) {
+  char data;
+  for (unsigned int i = 0; i < BENCHMARK_BYTES;) {
+    if (Fifo_pop(&fifo, &data) == FIFO_OK) {
+      i++;
+    } else {
+      sched_yield();
+    }
+  }
+  return argument;
+}
+static void* bulkProducer(void* argument) {
+  char block[BLOCK_LENGTH] = {0};
+  for (unsigned int i = 0; i < BENCHMARK_BYTES;) {
+    int pushed = Fifo_pushMultiple(&fifo, block, BLOCK_LENGTH);
+    i += pushed;
+    if (pushed == 0) {
+      sched_yield();
+    }
+  }
+  return argument;
+}
+static void* bulkConsumer(void* argument) {
+  char block[BLOCK_LENGTH];
+  for (unsigned int i = 0; i < BENCHMARK_BYTES;) {
+    int popped = Fifo_popMultiple(&fifo, block, BLOCK_LENGTH);
+    i += popped;
+    if (popped == 0) {
+      sched_yield();
+    }
+  }
+  return argument;
+}
+static void benchmarkTwoThreads(const char* name, void* (*producerThread)(void*),
+    void* (*consumerThread)(void*)) {
+  pthread_t producerId, consumerId;
+  Fifo_addNewFifo(&fifo, fifoBuffer, BENCHMARK_FIFO_LENGTH);
+  oldFifoInitialize(&oldFifo, fifoBuffer, BENCHMARK_FIFO_LENGTH);
+  double start = getSeconds();
+  pthread_create(&producerId, NULL, producerThread, NULL);
+  pthread_create(&consumerId, NULL, consumerThread, NULL);
+  pthread_join(producerId, NULL);
+  pthread_join(consumerId, NULL);
+  printResult(name, getSeconds() - start);
+}
+int main(void) {
+  runStressTest();
+  benchmarkSingleThread();
+  benchmarkTwoThreads("2 threads, old push/pop + lock", oldProducer, oldConsumer);
+  benchmarkTwoThreads("2 threads, push/pop", producer, consumer);
+  benchmarkTwoThreads("2 threads, pushMultiple/popMultiple", bulkProducer, bulkConsumer);
+  printf("fifo_test: %s\n", failures ? "FAILED" : "OK");
+  return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,155 @@
+/**
+ * @file    memory_pool_test.c
+ * @brief   Host test of the memory pool.
+ * @details Allocates and frees blocks in random order and checks the
+ * statistics after every step, then checks that frees of foreign and
+ * misaligned pointers and of blocks already free are rejected and counted
+ * without changing the pool, and that user data equal to the free block
+ * marker doesn't make a valid free fail.
+ *
+ * Built and run by the host test Makefile:
+ *
+ *          make -C Tests run
+ *
+ * @date    19.10.2026
+ * @author  Michal Ksiezopolski
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#include "memory_pool.h"
+#include <stdio.h>
+#include <string.h>
+
+#define BLOCK_SIZE    24      ///< Rounded up to 24 (a host pointer is 8 bytes)
+#define BLOCK_COUNT   16
+#define STEPS         100000  ///< Random allocations and frees
+
+uint32_t hostPrimask; ///< PRIMASK of the stand-in boards.h
+
+static MEMORY_POOL_BUFFER(poolBuffer, BLOCK_SIZE, BLOCK_COUNT);
+static MemoryPool pool;
+static uint32_t randomState = 2463534242u; ///< Xorshift state
+static int failures;
+
+static void check(int condition, const char* message) {
+  if (!condition) {
+    printf("memory_pool: %s\n", message);
+    failures++;
+  }
+}
+static uint32_t getRandom(void) {
+  randomState ^= randomState << 13;
+  randomState ^= randomState >> 17;
+  randomState ^= randomState << 5;
+  return randomState;
+}
+/**
+ * @brief Random allocations and frees, every block filled with user data
+ */
+static void testAllocation(void) {
+  void* blocks[BLOCK_COUNT];
+  int allocated = 0;
+  unsigned int maximum = 0;
+  for (int step = 0; step < STEPS; step++) {
+    if (getRandom() % 2 == 0) {
+      void* block = MemoryPool_allocate(&pool);
+      if (allocated == BLOCK_COUNT) {
+        check(block == NULL, "allocated from empty pool");
+        continue;
+      }
+      check(block != NULL, "allocation failed");
+      for (int i = 0; i < allocated; i++) {
+        check(blocks[i] != block, "block allocated twice");
+      }
+      memset(block, allocated, BLOCK_SIZE);
+      blocks[allocated++] = block;
+    } else if (allocated > 0) {
+      int index = getRandom() % allocated;
+      check(MemoryPool_free(&pool, blocks[index]) == MEMORY_POOL_OK, "free failed");
+      blocks[index] = blocks[--allocated];
+    }
+    if (allocated > maximum) {
+      maximum = allocated;
+    }
+    check(pool.usedBlocks == allocated && pool.maximumUsedBlocks == maximum,
+        "wrong statistics");
+  }
+  while (allocated > 0) {
+    check(MemoryPool_free(&pool, blocks[--allocated]) == MEMORY_POOL_OK, "free failed");
+  }
+  check(pool.invalidFrees == 0, "valid free counted as invalid");
+  MemoryPool_resetStatistics(&pool);
+  check(pool.maximumUsedBlocks == 0 && pool.failedAllocations == 0, "statistics not reset");
+}
+/**
+ * @brief Frees which have to be rejected
+ */
+static void testInvalidFrees(void) {
+  uint64_t foreign[BLOCK_SIZE / sizeof(uint64_t)];
+  uint8_t* first = MemoryPool_allocate(&pool);
+  uint8_t* second = MemoryPool_allocate(&pool);
+
+  check(MemoryPool_free(&pool, foreign) == MEMORY_POOL_INVALID_BLOCK, "foreign pointer freed");
+  check(MemoryPool_free(&pool, first + 8) == MEMORY_POOL_INVALID_BLOCK,
+      "pointer inside a block freed");
+  check(MemoryPool_free(&pool, (uint8_t*)poolBuffer + sizeof(poolBuffer)) ==
+      MEMORY_POOL_INVALID_BLOCK, "pointer after the pool freed");
+
+  check(MemoryPool_free(&pool, first) == MEMORY_POOL_OK, "free failed");
+  check(MemoryPool_free(&pool, first) == MEMORY_POOL_DOUBLE_FREE, "double free accepted");
+  check(pool.usedBlocks == 1, "double free changed used blocks");
+  // a block never allocated is in the free list as well
+  uint8_t* neverAllocated = (uint8_t*)poolBuffer + (BLOCK_COUNT - 1) * pool.blockSize;
+  check(MemoryPool_free(&pool, neverAllocated) == MEMORY_POOL_DOUBLE_FREE,
+      "free block freed");
+
+  // user data looking like a free block - the free list is checked
+  memset(second, 0, BLOCK_SIZE);
+  memcpy(second + sizeof(void*), &(uint32_t){0xf4eeb10cu}, sizeof(uint32_t));
+  check(MemoryPool_free(&pool, second) == MEMORY_POOL_OK, "block with marker data not freed");
+  check(pool.usedBlocks == 0, "wrong used blocks");
+  check(MemoryPool_free(&pool, second) == MEMORY_POOL_DOUBLE_FREE,
+      "free of empty pool accepted");
+  check(pool.usedBlocks == 0, "used blocks underflow");
+  check(pool.invalidFrees == 6, "rejected frees not counted");
+
+  // the free list is intact - every block can be allocated once
+  void* blocks[BLOCK_COUNT];
+  for (int i = 0; i < BLOCK_COUNT; i++) {
+    blocks[i] = MemoryPool_allocate(&pool);
+    check(blocks[i] != NULL, "free list broken");
+    for (int j = 0; j < i; j++) {
+      check(blocks[i] != blocks[j], "free list has a block twice");
+    }
+  }
+  check(MemoryPool_allocate(&pool) == NULL && pool.failedAllocations == 1,
+      "allocated from empty pool");
+  for (int i = 0; i < BLOCK_COUNT; i++) {
+    MemoryPool_free(&pool, blocks[i]);
+  }
+  MemoryPool_resetStatistics(&pool);
+  check(pool.invalidFrees == 0, "invalid frees not reset");
+}
+
+int main(void) {
+  check(MemoryPool_initialize(&pool, "test", poolBuffer, BLOCK_SIZE, BLOCK_COUNT) ==
+      MEMORY_POOL_OK, "pool not initialized");
+  testAllocation();
+  testInvalidFrees();
+  // called in a critical section - the interrupts stay disabled
+  hostPrimask = 1;
+  MemoryPool_free(&pool, MemoryPool_allocate(&pool));
+  check(hostPrimask == 1, "interrupts enabled inside critical section");
+
+  printf("memory_pool_test: %s\n", failures ? "FAILED" : "OK");
+  return failures ? 1 : 0;
+}
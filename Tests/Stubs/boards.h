@@ -0,0 +1,40 @@
+/**
+ * @file    boards.h
+ * @brief   Host stand-in for the board header.
+ * @details Only the interrupt mask functions of CMSIS. The host tests are
+ * single threaded, so they only keep the PRIMASK value.
+ * @date    19.10.2026
+ * @author  Michal Ksiezopolski
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#ifndef MYLIBRARIES_HAL_BOARDS_H_
+#define MYLIBRARIES_HAL_BOARDS_H_
+
+#include <inttypes.h>
+
+extern uint32_t hostPrimask; ///< Defined by the test
+
+static inline uint32_t __get_PRIMASK(void) {
+  return hostPrimask;
+}
+static inline void __set_PRIMASK(uint32_t primask) {
+  hostPrimask = primask;
+}
+static inline void __disable_irq(void) {
+  hostPrimask = 1;
+}
+static inline void __enable_irq(void) {
+  hostPrimask = 0;
+}
+
+#endif /* MYLIBRARIES_HAL_BOARDS_H_ */
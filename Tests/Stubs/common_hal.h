@@ -0,0 +1,27 @@
+/**
+ * @file    common_hal.h
+ * @brief   Host stand-in for the common HAL functions used by the timers.
+ * @details Only the functions TIMER refers to, without the board headers.
+ * The test provides the functions.
+ * @date    19.10.2026
+ * @author  Michal Ksiezopolski
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#ifndef INC_COMMON_HAL_H_
+#define INC_COMMON_HAL_H_
+
+#include "utils.h"
+
+void CommonHal_sleepUntilInterrupt(Boolean (*hasPendingWork)(void));
+
+#endif /* INC_COMMON_HAL_H_ */
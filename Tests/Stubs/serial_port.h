@@ -0,0 +1,36 @@
+/**
+ * @file    serial_port.h
+ * @brief   Host stand-in for the serial port used by the console.
+ * @details Only the types and functions the console refers to. The test
+ * provides the functions.
+ * @date    19.10.2026
+ * @author  Michal Ksiezopolski
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#ifndef COMM_H_
+#define COMM_H_
+
+typedef enum {
+  SERIAL_PORT_GOT_FRAME,
+  SERIAL_PORT_NO_FRAME_READY,
+  SERIAL_PORT_FRAME_ERROR,
+  SERIAL_PORT_FRAME_TOO_LARGE,
+} SerialPortResultCode;
+
+typedef struct SerialPort SerialPort;
+
+SerialPort*          SerialPort_getDebugConsole (void);
+SerialPortResultCode SerialPort_getFrame        (SerialPort* port, char* frameBuffer, int* length,
+                                                 int maximumLength);
+
+#endif /* COMM_H_ */
@@ -0,0 +1,399 @@
+/**
+ * @file    timers_test.c
+ * @brief   Host test and benchmark of the soft timer wheel.
+ * @details Drives TIMER with a fake microsecond time base. The fake compare
+ * fires like the TIM5 one (at once for a value not in the future), the
+ * test moves the time and calls Timer_softwareTimersUpdate like a main loop.
+ * After every update the number of callbacks of every timer is compared with
+ * the number of expiries up to the current time, so an early, late, missed or
+ * repeated expiry is caught.
+ *
+ * The benchmark measures starting, cancelling and expiring (with the
+ * cascades) 1000 and 10000 timers.
+ *
+ * Built and run by the host test Makefile:
+ *
+ *          make -C Tests run
+ *
+ * @date    19.10.2026
+ * @author  Michal Ksiezopolski
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#include "timers.h"
+#include "hardware_timers.h"
+#include "cycle_counter.h"
+#include "systick.h"
+#include "common_hal.h"
+#include <stdio.h>
+#include <time.h>
+
+#define CASCADE_TIMERS        2000          ///< One-shot timers up to beyond the wheel range
+#define CASCADE_TIMEOUT_BITS  38            ///< Longest one-shot timeout (2^38 us, wheel reaches 2^36)
+#define PERIODIC_TIMERS       200           ///< Periodic timers
+#define PERIODIC_PERIOD_BITS  22            ///< Longest period (2^22 us)
+#define PERIODIC_TEST_MICROS  (1ull << 24)  ///< Simulated time of the periodic test
+#define BENCHMARK_TIMERS      10000         ///< Most timers in the benchmark
+#define BENCHMARK_ROUNDS      100           ///< Start/cancel rounds
+#define BENCHMARK_STEP_MICROS 100           ///< Main loop period in the expiry benchmark
+#define BENCHMARK_MICROS      10000000      ///< Simulated time of the expiry benchmark
+#define MAXIMUM_MESSAGES      10            ///< Failures printed
+
+/**
+ * @brief Timer with the expected expiries
+ */
+typedef struct {
+  SoftTimer timer;            ///< The timer
+  uint64_t firstExpiryMicros; ///< Time of the first expiry
+  uint64_t periodMicros;      ///< Period, 0 for one-shot timer
+  uint64_t calls;             ///< Number of callbacks
+  Boolean isCancelled;        ///< Cancelled by the test
+  uint64_t cancelledCalls;    ///< Number of callbacks before cancelling
+} TestTimer;
+
+static uint64_t nowMicros = 1000;           ///< Fake time base
+static uint64_t compareMicros = UINT64_MAX; ///< Time the fake compare fires
+static void (*compareCb)(void);             ///< Compare callback of TIMER
+static uint32_t randomState = 2463534242u;  ///< Xorshift state
+static int failures;
+static unsigned int expiries;               ///< Callbacks in the benchmark
+
+static TestTimer cascadeTimers[CASCADE_TIMERS];
+static TestTimer periodicTimers[PERIODIC_TIMERS];
+static SoftTimer benchmarkTimers[BENCHMARK_TIMERS];
+static uint32_t benchmarkTimeouts[BENCHMARK_TIMERS];
+static uint32_t benchmarkPeriods[BENCHMARK_TIMERS];
+
+void HardwareTimers_configureTimerAsFreeRunningWithCompare(HardwareTimers timer,
+    int countingFrequencyHz, void (*callback)(void)) {
+  compareCb = callback;
+}
+uint64_t HardwareTimers_getCounter64(HardwareTimers timer) {
+  return nowMicros;
+}
+void HardwareTimers_setCompare(HardwareTimers timer, uint32_t compareValue) {
+  // like TIM5 - too late, the event is generated at once
+  if ((int32_t)((uint32_t)nowMicros - compareValue) >= 0) {
+    compareMicros = UINT64_MAX;
+    compareCb();
+  } else {
+    compareMicros = nowMicros + (uint32_t)(compareValue - (uint32_t)nowMicros);
+  }
+}
+void SysTick_initialize(void (*tickCb)(void)) {
+}
+void CycleCounter_initialize(void) {
+}
+uint32_t CycleCounter_getCycles(void) {
+  return (uint32_t)CycleCounter_getCycles64();
+}
+uint64_t CycleCounter_getCycles64(void) {
+  return nowMicros * (CycleCounter_getFrequencyHz() / 1000000);
+}
+uint32_t CycleCounter_getFrequencyHz(void) {
+  return 168000000;
+}
+void CommonHal_sleepUntilInterrupt(Boolean (*hasPendingWork)(void)) {
+}
+
+static double getSeconds(void) {
+  struct timespec time;
+  clock_gettime(CLOCK_MONOTONIC, &time);
+  return time.tv_sec + time.tv_nsec * 1e-9;
+}
+static void check(int condition, const char* message) {
+  if (!condition) {
+    if (failures < MAXIMUM_MESSAGES) {
+      printf("timers: %s (time %llu us)\n", message, (unsigned long long)nowMicros);
+    }
+    failures++;
+  }
+}
+static uint32_t getRandom(void) {
+  randomState ^= randomState << 13;
+  randomState ^= randomState >> 17;
+  randomState ^= randomState << 5;
+  return randomState;
+}
+/**
+ * @brief Draws a time with uniformly distributed number of bits
+ * @details Every fourth time is a multiple of a wheel level length +-1,
+ * which hits the slot and level boundaries.
+ * @param maximumBits Time is below 2^maximumBits
+ * @return Time in us (at least 1)
+ */
+static uint64_t getRandomMicros(int maximumBits) {
+  if (getRandom() % 4 == 0) {
+    int shift = 6 * (1 + getRandom() % (maximumBits / 6));
+    uint64_t value = ((uint64_t)(1 + getRandom() % 63) << shift) + (int)(getRandom() % 3) - 1;
+    value &= (1ull << maximumBits) - 1;
+    return value != 0 ? value : 1;
+  }
+  int bits = getRandom() % maximumBits;
+  uint64_t value = ((uint64_t)getRandom() << 32) | getRandom();
+  return (1ull << bits) | (value & ((1ull << bits) - 1));
+}
+/**
+ * @brief Moves the fake time base and calls the timers like a main loop
+ * @param timeMicros New time
+ */
+static void advanceTo(uint64_t timeMicros) {
+  nowMicros = timeMicros;
+  if (nowMicros >= compareMicros) {
+    compareMicros = UINT64_MAX;
+    compareCb();
+  }
+  Timer_softwareTimersUpdate();
+}
+static void countCall(void* context) {
+  TestTimer* timer = context;
+  timer->calls++;
+}
+/**
+ * @brief Starts a test timer
+ * @details Times above 32 bits are started in ms, the rest in us.
+ */
+static void startTestTimer(TestTimer* timer, uint64_t timeoutMicros, uint64_t periodMicros) {
+  Timer_initializeSoftTimer(&timer->timer, countCall, timer);
+  if (timeoutMicros > UINT32_MAX || periodMicros > UINT32_MAX) {
+    timeoutMicros = timeoutMicros / 1000 * 1000;
+    periodMicros = periodMicros / 1000 * 1000;
+    Timer_startSoftTimer(&timer->timer, timeoutMicros / 1000, periodMicros / 1000);
+  } else {
+    Timer_startSoftTimerMicros(&timer->timer, timeoutMicros, periodMicros);
+  }
+  timer->firstExpiryMicros = nowMicros + timeoutMicros;
+  timer->periodMicros = periodMicros;
+  timer->calls = 0;
+  timer->isCancelled = FALSE;
+}
+static void cancelTestTimer(TestTimer* timer) {
+  Timer_cancelSoftTimer(&timer->timer);
+  timer->isCancelled = TRUE;
+  timer->cancelledCalls = timer->calls;
+}
+/**
+ * @brief Time of the next expiry of a timer
+ * @return Time in us, UINT64_MAX if the timer won't expire
+ */
+static uint64_t getNextExpiry(TestTimer* timer) {
+  if (timer->isCancelled || (timer->periodMicros == 0 && timer->calls != 0)) {
+    return UINT64_MAX;
+  }
+  return timer->firstExpiryMicros + timer->calls * timer->periodMicros;
+}
+/**
+ * @brief Compares the callbacks of the timers with their expiries up to now
+ * @return Number of timers which will expire again
+ */
+static int checkTimers(TestTimer* timers, int count) {
+  int pending = 0;
+  for (int i = 0; i < count; i++) {
+    TestTimer* timer = &timers[i];
+    uint64_t expectedCalls;
+    if (timer->isCancelled) {
+      expectedCalls = timer->cancelledCalls;
+    } else if (nowMicros < timer->firstExpiryMicros) {
+      expectedCalls = 0;
+    } else if (timer->periodMicros == 0) {
+      expectedCalls = 1;
+    } else {
+      expectedCalls = (nowMicros - timer->firstExpiryMicros) / timer->periodMicros + 1;
+    }
+    check(timer->calls == expectedCalls, timer->calls < expectedCalls ?
+        "timer expired late" : "timer expired early or too often");
+    Boolean isExpectedActive = (getNextExpiry(timer) != UINT64_MAX) ? TRUE : FALSE;
+    check(Timer_isSoftTimerActive(&timer->timer) == isExpectedActive, "wrong active state");
+    if (isExpectedActive) {
+      pending++;
+    }
+  }
+  return pending;
+}
+/**
+ * @brief Moves the time to a random point near the nearest expiry
+ * @details Exactly to the expiry, just before it or a bit after it (a main
+ * loop doing other work), at most maximumStepMicros.
+ */
+static void advanceNearNextExpiry(TestTimer* timers, int count, uint64_t maximumStepMicros) {
+  uint64_t nextMicros = UINT64_MAX;
+  for (int i = 0; i < count; i++) {
+    uint64_t expiryMicros = getNextExpiry(&timers[i]);
+    if (expiryMicros < nextMicros) {
+      nextMicros = expiryMicros;
+    }
+  }
+  switch (getRandom() % 3) {
+  case 0:
+    nextMicros--;
+    break;
+  case 1:
+    nextMicros += getRandom() % 100;
+    break;
+  }
+  if (nextMicros > nowMicros && nextMicros - nowMicros > maximumStepMicros) {
+    nextMicros = nowMicros + maximumStepMicros;
+  }
+  advanceTo(nextMicros > nowMicros ? nextMicros : nowMicros + 1);
+}
+/**
+ * @brief One-shot timers in all wheel levels and beyond its range
+ * @details Every timer cascades down the levels until it expires.
+ */
+static void testCascading(void) {
+  for (int i = 0; i < CASCADE_TIMERS; i++) {
+    startTestTimer(&cascadeTimers[i], getRandomMicros(CASCADE_TIMEOUT_BITS), 0);
+  }
+  int steps = 0;
+  while (checkTimers(cascadeTimers, CASCADE_TIMERS) > 0) {
+    advanceNearNextExpiry(cascadeTimers, CASCADE_TIMERS, UINT64_MAX);
+    steps++;
+  }
+  printf("cascading: %d one-shot timers up to 2^%d us, %d updates\n",
+      CASCADE_TIMERS, CASCADE_TIMEOUT_BITS, steps);
+}
+/**
+ * @brief Periodic timers re-armed by the wheel, half of them cancelled midway
+ * @details The expiries are counted from the first one, so a drift of the
+ * re-armed timers shows up as a wrong number of callbacks.
+ */
+static void testPeriodic(void) {
+  for (int i = 0; i < PERIODIC_TIMERS; i++) {
+    startTestTimer(&periodicTimers[i], getRandomMicros(PERIODIC_PERIOD_BITS),
+        getRandomMicros(PERIODIC_PERIOD_BITS));
+  }
+  const uint64_t START_MICROS = nowMicros;
+  Boolean isHalfCancelled = FALSE;
+  uint64_t calls = 0;
+  while (nowMicros - START_MICROS < PERIODIC_TEST_MICROS) {
+    if (getRandom() % 2) {
+      advanceNearNextExpiry(periodicTimers, PERIODIC_TIMERS, 1 << 16);
+    } else {
+      advanceTo(nowMicros + 1 + getRandom() % (1 << 16));
+    }
+    checkTimers(periodicTimers, PERIODIC_TIMERS);
+    if (!isHalfCancelled && nowMicros - START_MICROS >= PERIODIC_TEST_MICROS / 2) {
+      isHalfCancelled = TRUE;
+      for (int i = 0; i < PERIODIC_TIMERS; i += 2) {
+        cancelTestTimer(&periodicTimers[i]);
+      }
+    }
+  }
+  for (int i = 0; i < PERIODIC_TIMERS; i++) {
+    calls += periodicTimers[i].calls;
+    cancelTestTimer(&periodicTimers[i]);
+  }
+  printf("periodic: %d timers, %llu expiries in %llu us\n", PERIODIC_TIMERS,
+      (unsigned long long)calls, (unsigned long long)PERIODIC_TEST_MICROS);
+}
+
+static TestTimer pairTimers[2]; ///< Timers cancelling each other
+static void cancelOther(void* context) {
+  countCall(context);
+  Timer_cancelSoftTimer(&pairTimers[context == &pairTimers[0] ? 1 : 0].timer);
+}
+static void restartSelf(void* context) {
+  TestTimer* timer = context;
+  countCall(context);
+  Timer_startSoftTimerMicros(&timer->timer, 0, 0);
+}
+/**
+ * @brief Timers changed by the callbacks during the update
+ */
+static void testCallbacks(void) {
+  TestTimer restarted;
+  // two timers expiring together, each cancels the other - only one is called
+  for (int i = 0; i < 2; i++) {
+    Timer_initializeSoftTimer(&pairTimers[i].timer, cancelOther, &pairTimers[i]);
+    pairTimers[i].calls = 0;
+    Timer_startSoftTimerMicros(&pairTimers[i].timer, 5000, 0);
+  }
+  advanceTo(nowMicros + 5000);
+  check(pairTimers[0].calls + pairTimers[1].calls == 1, "timer cancelled in callback was called");
+  check(!Timer_isSoftTimerActive(&pairTimers[0].timer) &&
+      !Timer_isSoftTimerActive(&pairTimers[1].timer), "timer active after expiry");
+
+  // a timer restarted with no timeout in its callback expires in the next microsecond
+  Timer_initializeSoftTimer(&restarted.timer, restartSelf, &restarted);
+  restarted.calls = 0;
+  Timer_startSoftTimerMicros(&restarted.timer, 64, 0);
+  advanceTo(nowMicros + 64);
+  check(restarted.calls == 1 && Timer_isSoftTimerActive(&restarted.timer),
+      "restarted timer expired in the same microsecond");
+  advanceTo(nowMicros + 1);
+  check(restarted.calls == 2, "restarted timer expired late");
+  Timer_cancelSoftTimer(&restarted.timer);
+  advanceTo(nowMicros + 1000);
+  check(restarted.calls == 2, "cancelled timer was called");
+}
+
+static void countExpiry(void* context) {
+  expiries++;
+}
+/**
+ * @brief Measures start, cancel and expiry cost
+ * @param count Number of timers
+ */
+static void benchmark(int count) {
+  for (int i = 0; i < count; i++) {
+    benchmarkTimeouts[i] = getRandomMicros(32);
+    // 1 ms to 1 s
+    benchmarkPeriods[i] = (1000 << (getRandom() % 10)) + getRandom() % 1000;
+    Timer_initializeSoftTimer(&benchmarkTimers[i], countExpiry, NULL);
+  }
+  double startSeconds = 0;
+  double cancelSeconds = 0;
+  for (int round = 0; round < BENCHMARK_ROUNDS; round++) {
+    double start = getSeconds();
+    for (int i = 0; i < count; i++) {
+      Timer_startSoftTimerMicros(&benchmarkTimers[i], benchmarkTimeouts[i], 0);
+    }
+    double middle = getSeconds();
+    for (int i = 0; i < count; i++) {
+      Timer_cancelSoftTimer(&benchmarkTimers[i]);
+    }
+    startSeconds += middle - start;
+    cancelSeconds += getSeconds() - middle;
+  }
+
+  for (int i = 0; i < count; i++) {
+    Timer_startSoftTimerMicros(&benchmarkTimers[i], benchmarkPeriods[i], benchmarkPeriods[i]);
+  }
+  expiries = 0;
+  double start = getSeconds();
+  for (int i = 0; i < BENCHMARK_MICROS / BENCHMARK_STEP_MICROS; i++) {
+    advanceTo(nowMicros + BENCHMARK_STEP_MICROS);
+  }
+  double tickSeconds = getSeconds() - start;
+  for (int i = 0; i < count; i++) {
+    Timer_cancelSoftTimer(&benchmarkTimers[i]);
+  }
+  printf("%6d %12.1f %12.1f %12.1f %10u\n", count,
+      startSeconds * 1e9 / ((double)count * BENCHMARK_ROUNDS),
+      cancelSeconds * 1e9 / ((double)count * BENCHMARK_ROUNDS),
+      tickSeconds * 1e9 / expiries, expiries);
+}
+
+int main(void) {
+  Timer_initialize();
+  testCascading();
+  testPeriodic();
+  testCallbacks();
+
+  printf("timers  start ns/op cancel ns/op expiry ns/op   expiries\n");
+  benchmark(1000);
+  benchmark(BENCHMARK_TIMERS);
+  printf("(expiry includes the cascades and the update calls, main loop every %d us)\n",
+      BENCHMARK_STEP_MICROS);
+  printf("timers_test: %s\n", failures ? "FAILED" : "OK");
+  return failures ? 1 : 0;
+}